@@ -329,6 +329,68 @@ mkldnn_status_t MKLDNN_API mkldnn_primitive_attr_get_post_ops(
 mkldnn_status_t MKLDNN_API mkldnn_primitive_attr_set_post_ops(
         mkldnn_primitive_attr_t attr, const_mkldnn_post_ops_t post_ops);
 
+/** Returns the sparse weights hint @p sparse_weights for a given @p attr,
+ * previously set by mkldnn_primitive_attr_set_sparse_weights. */
+mkldnn_status_t MKLDNN_API mkldnn_primitive_attr_get_sparse_weights(
+        const_mkldnn_primitive_attr_t attr, int *sparse_weights);
+
+/** Sets the sparse weights hint @p sparse_weights for a given @p attr.
+ *
+ * A non-zero value tells the library that the weights of the primitive are
+ * constant and contain many zeros, so an implementation may compress them
+ * once and skip the zero entries afterwards. The hint does not change the
+ * results and implementations that do not exploit sparsity ignore it.
+ *
+ * The default value is 0.
+ */
+mkldnn_status_t MKLDNN_API mkldnn_primitive_attr_set_sparse_weights(
+        mkldnn_primitive_attr_t attr, int sparse_weights);
+
+/** Returns the quantization @p scale and @p shift of the data of an RNN for
+ * a given @p attr, previously set by
+ * mkldnn_primitive_attr_set_rnn_data_qparams. */
+mkldnn_status_t MKLDNN_API mkldnn_primitive_attr_get_rnn_data_qparams(
+        const_mkldnn_primitive_attr_t attr, float *scale, float *shift);
+
+/** Sets the quantization @p scale and @p shift of the data of an RNN for a
+ * given @p attr.
+ *
+ * The u8 value of an f32 x is saturate(round(scale * x + shift)), with the
+ * rounding mode of the @p attr. The int8 LSTM takes its layer input with
+ * these parameters, keeps its hidden states with them, and uses them for a
+ * u8 destination layer.
+ *
+ * The default values are 1 and 0.
+ */
+mkldnn_status_t MKLDNN_API mkldnn_primitive_attr_set_rnn_data_qparams(
+        mkldnn_primitive_attr_t attr, float scale, float shift);
+
+/** Returns @p count, correspondence scale @p mask, and a pointer to a
+ * constant floating point array of weights @p scales of an RNN for a given
+ * @p attr, previously set by mkldnn_primitive_attr_set_rnn_weights_qparams.
+ *
+ * @warning
+ *      @p scales array points to the internal @p attr field, so user should
+ *      not modify/destroy @p scales. */
+mkldnn_status_t MKLDNN_API mkldnn_primitive_attr_get_rnn_weights_qparams(
+        const_mkldnn_primitive_attr_t attr, int *count, int *mask,
+        const float **scales);
+
+/** Sets the quantization @p scales of the s8 weights of an RNN for a given
+ * @p attr: the s8 value of a weight w is saturate(round(scale * w)).
+ *
+ * The @p mask follows the logical dimensions of the weights in the ldigo
+ * format, and the same scales apply to the layer and the iteration weights:
+ * 0 sets a single scale, (1 << 3) one scale per gate, and
+ * (1 << 3) + (1 << 4) one scale per gate and output channel, the gates
+ * outermost. @p count is the number of @p scales.
+ *
+ * The default is a single scale of 1.
+ */
+mkldnn_status_t MKLDNN_API mkldnn_primitive_attr_set_rnn_weights_qparams(
+        mkldnn_primitive_attr_t attr, int count, int mask,
+        const float *scales);
+
 /** @addtogroup c_api_attributes_post_ops Sequence of post operations
  * An extension for performing extra operations after base operation.
  * @{ */
@@ -402,6 +464,37 @@ mkldnn_status_t MKLDNN_API mkldnn_post_ops_get_params_eltwise(
         const_mkldnn_post_ops_t post_ops, int index, float *scale,
         mkldnn_alg_kind_t *alg, float *alpha, float *beta);
 
+/** Appends depthwise post operation to the @p post_ops with given parameters
+ * @p alg, @p weights_data and @p biases_data.
+ *
+ * The kind of this post operation is #mkldnn_depthwise. The only supported
+ * algorithm is #mkldnn_depthwise_scale_shift, for which the computations
+ * would be:
+ * dst[:, c, :] <- weights_data[c] * op(...)[:, c, :] + biases_data[c]
+ *
+ * @p weights_data and @p biases_data must hold one value per output channel
+ * (including all the groups). @p biases_data might be NULL, in which case no
+ * shift is applied.
+ *
+ * This feature allows folding an inference batch normalization or any
+ * channel-wise affine transformation into the preceding convolution.
+ *
+ * @note
+ *      The library does not copy the data, so the user is responsible for
+ *      keeping @p weights_data and @p biases_data valid and unmodified for
+ *      the lifetime of all the primitives created with this post operation.
+ */
+mkldnn_status_t MKLDNN_API mkldnn_post_ops_append_depthwise(
+        mkldnn_post_ops_t post_ops, mkldnn_alg_kind_t alg,
+        const float *weights_data, const float *biases_data);
+
+/** Gets the depthwise parameters of the post operation with index @p index
+ * in the sequence of @p post_ops.
+ */
+mkldnn_status_t MKLDNN_API mkldnn_post_ops_get_params_depthwise(
+        const_mkldnn_post_ops_t post_ops, int index, mkldnn_alg_kind_t *alg,
+        const float **weights_data, const float **biases_data);
+
 /** @} */
 
 /** @} */
@@ -1062,6 +1155,82 @@ mkldnn_status_t MKLDNN_API mkldnn_rnn_backward_desc_init(
         const mkldnn_memory_desc_t *diff_dst_layer,
         const mkldnn_memory_desc_t *diff_dst_iter_desc);
 
+/** Initializes a rnn descriptor @p rnn_desc for forward propagation on
+ * sequences of variable lengths using @p prop_kind, @p rnn_cell_desc, @p
+ * direction, memory descriptors and @p seq_lengths_desc, the descriptor of
+ * the #mkldnn_s32 lengths of the sequences of the batch (format #mkldnn_x).
+ *
+ * A sequence of length len runs the iterations [0, len) left to right and
+ * [len - 1, 0] right to left: its states are carried unchanged through the
+ * other iterations and its dst_layer is zero there.
+ *
+ * @note the lengths are passed to the primitive as its last input. */
+mkldnn_status_t MKLDNN_API mkldnn_varlen_rnn_forward_desc_init(
+        mkldnn_rnn_desc_t *rnn_desc, mkldnn_prop_kind_t prop_kind,
+        const mkldnn_rnn_cell_desc_t *rnn_cell_desc,
+        const mkldnn_rnn_direction_t direction,
+        const mkldnn_memory_desc_t *src_layer_desc,
+        const mkldnn_memory_desc_t *src_iter_desc,
+        const mkldnn_memory_desc_t *weights_layer_desc,
+        const mkldnn_memory_desc_t *weights_iter_desc,
+        const mkldnn_memory_desc_t *bias_desc,
+        const mkldnn_memory_desc_t *dst_layer_desc,
+        const mkldnn_memory_desc_t *dst_iter_desc,
+        const mkldnn_memory_desc_t *seq_lengths_desc);
+
+/** Initializes a rnn descriptor @p rnn_desc for backward propagation on
+ * sequences of variable lengths, see mkldnn_varlen_rnn_forward_desc_init().
+ * The lengths must be the ones of the forward pass, the diff_src_layer is
+ * zero past the end of a sequence. */
+mkldnn_status_t MKLDNN_API mkldnn_varlen_rnn_backward_desc_init(
+        mkldnn_rnn_desc_t *rnn_desc, mkldnn_prop_kind_t prop_kind,
+        const mkldnn_rnn_cell_desc_t *rnn_cell_desc,
+        const mkldnn_rnn_direction_t direction,
+        const mkldnn_memory_desc_t *src_layer_desc,
+        const mkldnn_memory_desc_t *src_iter_desc,
+        const mkldnn_memory_desc_t *weights_layer_desc,
+        const mkldnn_memory_desc_t *weights_iter_desc,
+        const mkldnn_memory_desc_t *bias_desc,
+        const mkldnn_memory_desc_t *dst_layer_desc,
+        const mkldnn_memory_desc_t *dst_iter_desc,
+        const mkldnn_memory_desc_t *diff_src_layer_desc,
+        const mkldnn_memory_desc_t *diff_src_iter_desc,
+        const mkldnn_memory_desc_t *diff_weights_layer_desc,
+        const mkldnn_memory_desc_t *diff_weights_iter_desc,
+        const mkldnn_memory_desc_t *diff_bias_desc,
+        const mkldnn_memory_desc_t *diff_dst_layer,
+        const mkldnn_memory_desc_t *diff_dst_iter_desc,
+        const mkldnn_memory_desc_t *seq_lengths_desc);
+
+/** Initializes a rnn descriptor @p rnn_desc for the streaming inference of
+ * a left to right rnn with the flag #mkldnn_rnn_stateful, using @p
+ * rnn_cell_desc, memory descriptors and @p seq_lengths_desc, the optional
+ * descriptor of the lengths of the sequences of the batch.
+ *
+ * The primitive keeps the states of each element of the batch between its
+ * executions: an execution continues the sequences of the previous one,
+ * from zero states after the creation of the primitive or
+ * mkldnn_rnn_reset_states(). The n_iter of @p src_layer_desc is the maximum
+ * number of iterations of an execution, the lengths, passed as the last
+ * input, give the ones of the current chunk of each sequence (see
+ * mkldnn_varlen_rnn_forward_desc_init()); the iterations past the longest
+ * are not computed. */
+mkldnn_status_t MKLDNN_API mkldnn_stateful_rnn_forward_desc_init(
+        mkldnn_rnn_desc_t *rnn_desc,
+        const mkldnn_rnn_cell_desc_t *rnn_cell_desc,
+        const mkldnn_memory_desc_t *src_layer_desc,
+        const mkldnn_memory_desc_t *weights_layer_desc,
+        const mkldnn_memory_desc_t *weights_iter_desc,
+        const mkldnn_memory_desc_t *bias_desc,
+        const mkldnn_memory_desc_t *dst_layer_desc,
+        const mkldnn_memory_desc_t *seq_lengths_desc);
+
+/** Resets to zero the states kept by the stateful rnn primitive @p rnn for
+ * the elements [@p mb_begin, @p mb_end) of the batch, so that their next
+ * execution starts new sequences. */
+mkldnn_status_t MKLDNN_API mkldnn_rnn_reset_states(mkldnn_primitive_t rnn,
+        int mb_begin, int mb_end);
+
 /** @} */
 
 /** @} */
@@ -1115,6 +1284,50 @@ mkldnn_status_t MKLDNN_API mkldnn_stream_destroy(mkldnn_stream_t stream);
 
 /** @} */
 
+/** @addtogroup c_api_blas BLAS functions
+ * @{ */
+
+/** SGEMM performs matrix-matrix multiplication operation
+ * C := alpha*op( A )*op( B ) + beta*C,
+ * where  op( X ) is one of
+ * op( X ) = X or op( X ) = X**T,
+ * alpha and beta are scalars, and A, B and C are matrices, with op( A )
+ * an m by k matrix, op( B ) a k by n matrix and C an m by n matrix.
+ * The matrices are column major, as in the Fortran BLAS.
+ *
+ * @note
+ *      The API is different from the standard BLAS routine: it returns
+ *      mkldnn_status_t for error handling and XERBLA is not supported, no
+ *      error message is printed in case of incorrect parameters. */
+mkldnn_status_t MKLDNN_API mkldnn_sgemm(const char *transa,
+        const char *transb, const int *M, const int *N, const int *K,
+        const float *alpha, const float *A, const int *lda,
+        const float *B, const int *ldb,
+        const float *beta, float *C, const int *ldc);
+
+/** SGEMM with a bias and an eltwise epilogue:
+ * C := eltwise( alpha*op( A )*op( B ) + beta*C + bias ).
+ *
+ * @p layout is 'C' for column major and 'R' for row major matrices.
+ * @p bias_kind is 'N' for no bias (@p bias is ignored), 'R' for a bias of
+ * @p M elements, one per row of C, or 'C' for a bias of @p N elements, one
+ * per column of C. @p eltwise_alg is #mkldnn_alg_kind_undef for no eltwise
+ * or one of the eltwise algorithms, with @p eltwise_alpha and
+ * @p eltwise_beta as in #mkldnn_eltwise_desc_t. At most @p nthr threads are
+ * used, 0 means all of them.
+ *
+ * When the library uses its own JIT sgemm (it is not built with CBLAS), the
+ * bias (for beta equal to 0 or 1) and a ReLU with zero negative slope are
+ * applied in registers when C is written, so they cost no extra pass over
+ * C. */
+mkldnn_status_t MKLDNN_API mkldnn_sgemm_ex(char layout, char transa,
+        char transb, int M, int N, int K, float alpha, const float *A,
+        int lda, const float *B, int ldb, float beta, float *C, int ldc,
+        char bias_kind, const float *bias, mkldnn_alg_kind_t eltwise_alg,
+        float eltwise_alpha, float eltwise_beta, int nthr);
+
+/** @} */
+
 /** @addtogroup c_api_service Service functions
  * @{ */
 
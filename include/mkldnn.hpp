@@ -125,6 +125,7 @@ public:
         inner_product = mkldnn_inner_product,
         convolution_relu = mkldnn_convolution_relu,
         rnn = mkldnn_rnn,
+        depthwise = mkldnn_depthwise,
     };
 
     /// A wrapper structure to specify a particular output of a primitive.
@@ -273,6 +274,7 @@ enum algorithm {
     vanilla_rnn = mkldnn_vanilla_rnn,
     vanilla_lstm = mkldnn_vanilla_lstm,
     vanilla_gru = mkldnn_vanilla_gru,
+    depthwise_scale_shift = mkldnn_depthwise_scale_shift,
 };
 
 inline mkldnn_alg_kind_t convert_to_c(algorithm aalgorithm) {
@@ -399,6 +401,22 @@ struct post_ops: public handle<mkldnn_post_ops_t> {
                 "could not get eltwise params");
         alg = static_cast<algorithm>(c_alg);
     }
+
+    void append_depthwise(algorithm alg, const float *weights_data,
+            const float *biases_data) {
+        error::wrap_c_api(mkldnn_post_ops_append_depthwise(get(),
+                    convert_to_c(alg), weights_data, biases_data),
+                "could not append depthwise");
+    }
+
+    void get_params_depthwise(int index, algorithm &alg,
+            const float *&weights_data, const float *&biases_data) const {
+        mkldnn_alg_kind_t c_alg;
+        error::wrap_c_api(mkldnn_post_ops_get_params_depthwise(get(), index,
+                    &c_alg, &weights_data, &biases_data),
+                "could not get depthwise params");
+        alg = static_cast<algorithm>(c_alg);
+    }
 };
 
 #ifndef DOXYGEN_SHOULD_SKIP_THIS
@@ -462,6 +480,49 @@ struct primitive_attr: public handle<mkldnn_primitive_attr_t> {
         error::wrap_c_api(mkldnn_primitive_attr_set_post_ops(get(), ops.get()),
                 "could not set post operation sequence");
     }
+
+    bool get_sparse_weights() const {
+        int result;
+        error::wrap_c_api(mkldnn_primitive_attr_get_sparse_weights(get(),
+                    &result), "could not get sparse weights hint");
+        return result != 0;
+    }
+
+    void set_sparse_weights(bool sparse_weights) {
+        error::wrap_c_api(mkldnn_primitive_attr_set_sparse_weights(get(),
+                    sparse_weights), "could not set sparse weights hint");
+    }
+
+    void get_rnn_data_qparams(float &scale, float &shift) const {
+        error::wrap_c_api(mkldnn_primitive_attr_get_rnn_data_qparams(get(),
+                    &scale, &shift), "could not get rnn data qparams");
+    }
+
+    void set_rnn_data_qparams(float scale, float shift) {
+        error::wrap_c_api(mkldnn_primitive_attr_set_rnn_data_qparams(get(),
+                    scale, shift), "could not set rnn data qparams");
+    }
+
+    void get_rnn_weights_qparams(int &mask, std::vector<float> &scales) const
+    {
+        int count, c_mask;
+        const float *c_scales;
+        error::wrap_c_api(mkldnn_primitive_attr_get_rnn_weights_qparams(get(),
+                    &count, &c_mask, &c_scales),
+                "could not get rnn weights qparams");
+        scales.resize(count);
+
+        mask = c_mask;
+        for (int c = 0; c < count; ++c)
+            scales[c] = c_scales[c];
+    }
+
+    void set_rnn_weights_qparams(int mask, const std::vector<float> &scales)
+    {
+        error::wrap_c_api(mkldnn_primitive_attr_set_rnn_weights_qparams(get(),
+                    (int)scales.size(), mask, &scales[0]),
+                "could not set rnn weights qparams");
+    }
 };
 
 /// @}
@@ -571,6 +632,8 @@ struct memory: public primitive  {
         s16 = mkldnn_s16,
         s8 = mkldnn_s8,
         u8 = mkldnn_u8,
+        bf16 = mkldnn_bf16,
+        f16 = mkldnn_f16,
     };
 
     /// Memory format specification. See #mkldnn_memory_format_t
@@ -619,6 +682,8 @@ struct memory: public primitive  {
         gOhwi16o = mkldnn_gOhwi16o,
         Goihw8g = mkldnn_Goihw8g,
         Goihw16g = mkldnn_Goihw16g,
+        GOihw2g4o = mkldnn_GOihw2g4o,
+        GOihw4g4o = mkldnn_GOihw4g4o,
         gOIhw8o8i = mkldnn_gOIhw8o8i,
         gOIhw16o16i = mkldnn_gOIhw16o16i,
         gIOhw16o16i = mkldnn_gIOhw16o16i,
@@ -3353,6 +3418,47 @@ struct rnn_forward : public primitive {
                         &dst_layer_desc.data, &dst_iter_desc.data),
                     "could not create an RNN forward descriptor");
         }
+        /// On sequences of the variable lengths @p seq_lengths_desc, see
+        /// mkldnn_varlen_rnn_forward_desc_init().
+        desc(prop_kind aprop_kind, rnn_cell::desc cell,
+                const rnn_direction direction,
+                const memory::desc &src_layer_desc,
+                const memory::desc &src_iter_desc,
+                const memory::desc &weights_layer_desc,
+                const memory::desc &weights_iter_desc,
+                const memory::desc &bias_desc,
+                const memory::desc &dst_layer_desc,
+                const memory::desc &dst_iter_desc,
+                const memory::desc &seq_lengths_desc
+            ) {
+            error::wrap_c_api(mkldnn_varlen_rnn_forward_desc_init(&data,
+                        mkldnn::convert_to_c(aprop_kind), cell,
+                        mkldnn::convert_to_c(direction),
+                        &src_layer_desc.data, &src_iter_desc.data,
+                        &weights_layer_desc.data, &weights_iter_desc.data,
+                        &bias_desc.data,
+                        &dst_layer_desc.data, &dst_iter_desc.data,
+                        &seq_lengths_desc.data),
+                    "could not create an RNN forward descriptor");
+        }
+        /// Stateful left to right inference on chunks of at most n_iter
+        /// iterations of the lengths @p seq_lengths_desc, see
+        /// mkldnn_stateful_rnn_forward_desc_init().
+        desc(rnn_cell::desc cell,
+                const memory::desc &src_layer_desc,
+                const memory::desc &weights_layer_desc,
+                const memory::desc &weights_iter_desc,
+                const memory::desc &bias_desc,
+                const memory::desc &dst_layer_desc,
+                const memory::desc &seq_lengths_desc
+            ) {
+            error::wrap_c_api(mkldnn_stateful_rnn_forward_desc_init(&data,
+                        cell, &src_layer_desc.data,
+                        &weights_layer_desc.data, &weights_iter_desc.data,
+                        &bias_desc.data, &dst_layer_desc.data,
+                        &seq_lengths_desc.data),
+                    "could not create a stateful RNN forward descriptor");
+        }
 
     };
     struct primitive_desc : public handle<mkldnn_primitive_desc_t> {
@@ -3364,6 +3470,16 @@ struct rnn_forward : public primitive {
             reset(result);
         }
 
+        primitive_desc(const desc &adesc, const primitive_attr &aattr,
+                const engine &aengine) {
+            mkldnn_primitive_desc_t result;
+            error::wrap_c_api(mkldnn_primitive_desc_create_v2(
+                        &result, &adesc.data, aattr.get(),
+                        aengine.get(), nullptr),
+                "could not create an RNN forward primitive descriptor");
+            reset(result);
+        }
+
         memory::primitive_desc src_layer_primitive_desc() const {
             memory::primitive_desc adesc;
             mkldnn_primitive_desc_t cdesc;
@@ -3490,6 +3606,44 @@ struct rnn_forward : public primitive {
                 "could not create an RNN forward primitive");
         reset(result);
     }
+
+    /// On sequences of the variable lengths @p seq_lengths
+    rnn_forward(const primitive_desc &aprimitive_desc,
+            const primitive::at &src_layer, const primitive::at &src_iter,
+            const primitive::at &weights_layer,
+            const primitive::at &weights_iter, const primitive::at &bias,
+            const primitive::at &seq_lengths,
+            const memory &dst_layer, const memory &dst_iter,
+            const memory &workspace) {
+        mkldnn_primitive_t result;
+        mkldnn_primitive_at_t inputs[6];
+        const_mkldnn_primitive_t outputs[3];
+        int idx=0;
+        inputs[idx++] = src_layer.data;
+        if (!is_null_memory(src_iter.data.primitive))
+            inputs[idx++] = src_iter.data;
+        inputs[idx++] = weights_layer.data;
+        inputs[idx++] = weights_iter.data;
+        if (!is_null_memory(bias.data.primitive)) inputs[idx++] = bias.data;
+        inputs[idx++] = seq_lengths.data;
+
+        idx=0;
+        outputs[idx++] = dst_layer.get();
+        if (!is_null_memory(dst_iter.get())) outputs[idx++] = dst_iter.get();
+        if (!is_null_memory(workspace.get())) outputs[idx++] = workspace.get();
+
+        error::wrap_c_api(mkldnn_primitive_create(&result,
+                    aprimitive_desc.get(), inputs, outputs),
+                "could not create an RNN forward primitive");
+        reset(result);
+    }
+
+    /// Resets the states kept by a stateful RNN for the elements
+    /// [@p mb_begin, @p mb_end) of the batch.
+    void reset_states(int mb_begin, int mb_end) {
+        error::wrap_c_api(mkldnn_rnn_reset_states(get(), mb_begin, mb_end),
+                "could not reset the states of an RNN");
+    }
 };
 
 struct rnn_backward : public primitive {
@@ -3524,6 +3678,39 @@ struct rnn_backward : public primitive {
                         &diff_dst_layer_desc.data, &diff_dst_iter_desc.data),
                     "could not create an RNN backward descriptor");
         }
+        /// On sequences of the variable lengths @p seq_lengths_desc, see
+        /// mkldnn_varlen_rnn_backward_desc_init().
+        desc(prop_kind aprop_kind, rnn_cell::desc cell,
+                const rnn_direction direction,
+                const memory::desc &src_layer_desc,
+                const memory::desc &src_iter_desc,
+                const memory::desc &weights_layer_desc,
+                const memory::desc &weights_iter_desc,
+                const memory::desc &bias_desc,
+                const memory::desc &dst_layer_desc,
+                const memory::desc &dst_iter_desc,
+                const memory::desc &diff_src_layer_desc,
+                const memory::desc &diff_src_iter_desc,
+                const memory::desc &diff_weights_layer_desc,
+                const memory::desc &diff_weights_iter_desc,
+                const memory::desc &diff_bias_desc,
+                const memory::desc &diff_dst_layer_desc,
+                const memory::desc &diff_dst_iter_desc,
+                const memory::desc &seq_lengths_desc) {
+            error::wrap_c_api(mkldnn_varlen_rnn_backward_desc_init(&data,
+                        mkldnn::convert_to_c(aprop_kind), cell,
+                        mkldnn::convert_to_c(direction),
+                        &src_layer_desc.data, &src_iter_desc.data,
+                        &weights_layer_desc.data, &weights_iter_desc.data,
+                        &bias_desc.data,
+                        &dst_layer_desc.data, &dst_iter_desc.data,
+                        &diff_src_layer_desc.data, &diff_src_iter_desc.data,
+                        &diff_weights_layer_desc.data,
+                        &diff_weights_iter_desc.data, &diff_bias_desc.data,
+                        &diff_dst_layer_desc.data, &diff_dst_iter_desc.data,
+                        &seq_lengths_desc.data),
+                    "could not create an RNN backward descriptor");
+        }
 
     };
     struct primitive_desc : public handle<mkldnn_primitive_desc_t> {
@@ -3765,6 +3952,58 @@ struct rnn_backward : public primitive {
                 "could not create an RNN backward primitive");
         reset(result);
     }
+
+    /// On sequences of the variable lengths @p seq_lengths
+    rnn_backward(const primitive_desc &aprimitive_desc,
+                 const primitive::at &src_layer,
+                 const primitive::at &src_iter,
+                 const primitive::at &weights_layer,
+                 const primitive::at &weights_iter,
+                 const primitive::at &bias,
+                 const primitive::at &dst_layer,
+                 const primitive::at &dst_iter,
+                 const memory &diff_src_layer,
+                 const memory &diff_src_iter,
+                 const memory &diff_weights_layer,
+                 const memory &diff_weights_iter,
+                 const memory &diff_bias,
+                 const primitive::at &diff_dst_layer,
+                 const primitive::at &diff_dst_iter,
+                 const primitive::at &workspace,
+                 const primitive::at &seq_lengths) {
+        mkldnn_primitive_t result;
+        mkldnn_primitive_at_t inputs[11];
+        const_mkldnn_primitive_t outputs[5];
+        int idx=0;
+        inputs[idx++] = src_layer.data;
+        if (!is_null_memory(src_iter.data.primitive))
+            inputs[idx++] = src_iter.data;
+        inputs[idx++] = weights_layer.data;
+        inputs[idx++] = weights_iter.data;
+        if (!is_null_memory(bias.data.primitive))
+            inputs[idx++] = bias.data;
+        inputs[idx++] = dst_layer.data;
+        if (!is_null_memory(dst_iter.data.primitive))
+            inputs[idx++] = dst_iter.data;
+        inputs[idx++] = diff_dst_layer.data;
+        if (!is_null_memory(diff_dst_iter.data.primitive))
+            inputs[idx++] = diff_dst_iter.data;
+        inputs[idx++] = workspace.data;
+        inputs[idx++] = seq_lengths.data;
+
+        idx = 0;
+        outputs[idx++] = diff_src_layer.get();
+        if (!is_null_memory(diff_src_iter.get()))
+            outputs[idx++] = diff_src_iter.get();
+        outputs[idx++] = diff_weights_layer.get();
+        outputs[idx++] = diff_weights_iter.get();
+        if (!is_null_memory(diff_bias.get()))
+            outputs[idx++] = diff_bias.get();
+        error::wrap_c_api(mkldnn_primitive_create(&result,
+                    aprimitive_desc.get(), inputs, outputs),
+                "could not create an RNN backward primitive");
+        reset(result);
+    }
 };
 
 /// @}
@@ -3851,6 +4090,45 @@ struct stream: public handle<mkldnn_stream_t> {
 
 /// @}
 
+/// @addtogroup cpp_api_blas BLAS functions
+/// @{
+
+/// Column major SGEMM: C := alpha*op(A)*op(B) + beta*C, see mkldnn_sgemm().
+inline void sgemm(char transa, char transb, int M, int N, int K,
+        float alpha, const float *A, int lda, const float *B, int ldb,
+        float beta, float *C, int ldc) {
+    error::wrap_c_api(mkldnn_sgemm(&transa, &transb, &M, &N, &K, &alpha,
+                A, &lda, B, &ldb, &beta, C, &ldc),
+            "could not run sgemm");
+}
+
+/// SGEMM with a bias: C := alpha*op(A)*op(B) + beta*C + bias, see
+/// mkldnn_sgemm_ex() for @p layout, @p bias_kind and @p nthr.
+inline void sgemm(char layout, char transa, char transb, int M, int N,
+        int K, float alpha, const float *A, int lda, const float *B, int ldb,
+        float beta, float *C, int ldc, char bias_kind, const float *bias,
+        int nthr = 0) {
+    error::wrap_c_api(mkldnn_sgemm_ex(layout, transa, transb, M, N, K, alpha,
+                A, lda, B, ldb, beta, C, ldc, bias_kind, bias,
+                mkldnn_alg_kind_undef, 0.f, 0.f, nthr),
+            "could not run sgemm");
+}
+
+/// SGEMM with a bias and an eltwise epilogue:
+/// C := eltwise(alpha*op(A)*op(B) + beta*C + bias), see mkldnn_sgemm_ex().
+inline void sgemm(char layout, char transa, char transb, int M, int N,
+        int K, float alpha, const float *A, int lda, const float *B, int ldb,
+        float beta, float *C, int ldc, char bias_kind, const float *bias,
+        algorithm eltwise_alg, float eltwise_alpha = 0.f,
+        float eltwise_beta = 0.f, int nthr = 0) {
+    error::wrap_c_api(mkldnn_sgemm_ex(layout, transa, transb, M, N, K, alpha,
+                A, lda, B, ldb, beta, C, ldc, bias_kind, bias,
+                convert_to_c(eltwise_alg), eltwise_alpha, eltwise_beta, nthr),
+            "could not run sgemm");
+}
+
+/// @}
+
 /// @} C++ API
 
 } // namespace mkldnn
@@ -72,6 +72,11 @@ typedef enum {
     mkldnn_s8 = 5,
     /** 8-bit unsigned integer. */
     mkldnn_u8 = 6,
+    /** 16-bit floating point with the 8-bit exponent of f32 (bfloat16): the
+     * upper half of an f32 value, rounded to nearest even. */
+    mkldnn_bf16 = 7,
+    /** 16-bit/half-precision floating point (IEEE binary16). */
+    mkldnn_f16 = 8,
 } mkldnn_data_type_t;
 
 /** Rounding mode */
@@ -245,6 +250,14 @@ typedef enum {
     /** 5D weights tensor in the blocked version of @c goihw format with group
      * data laid out in memory in 16-element blocks. */
     mkldnn_Goihw16g,
+    /** 5D weights tensor in the blocked version of @c goihw format with data
+     * of 2 groups and 4 output channels per group laid out in memory in
+     * 8-element blocks. */
+    mkldnn_GOihw2g4o,
+    /** 5D weights tensor in the blocked version of @c goihw format with data
+     * of 4 groups and 4 output channels per group laid out in memory in
+     * 16-element blocks. */
+    mkldnn_GOihw4g4o,
     /** 5D weights tensor in the @c goihw format with both input and output
      * channels data laid out in memory in 16-element and 4-element blocks. */
     mkldnn_gOhIw16o4i,
@@ -357,6 +370,8 @@ typedef enum {
     mkldnn_convolution_relu,
     /** A rnn primitive. */
     mkldnn_rnn,
+    /** A depthwise (per-channel) operation. Used as a post operation only. */
+    mkldnn_depthwise,
 } mkldnn_primitive_kind_t;
 
 /** Kinds of algorithms. */
@@ -407,6 +422,8 @@ typedef enum {
     mkldnn_vanilla_lstm = 81,
     /** GRU cell */
     mkldnn_vanilla_gru = 82,
+    /** Depthwise: per-channel scale and shift */
+    mkldnn_depthwise_scale_shift = 96,
 } mkldnn_alg_kind_t;
 
 /** Flags for batch-normalization primititve. */
@@ -796,6 +813,14 @@ typedef enum {
     mkldnn_unidirectional = mkldnn_unidirectional_left2right,
 } mkldnn_rnn_direction_t;
 
+/** Flags for RNN primitive. */
+typedef enum {
+    /** The primitive keeps the states of the last iteration of an execution
+     * and starts the next execution from them, instead of taking the states
+     * in src_iter and dst_iter. */
+    mkldnn_rnn_stateful = 0x1U,
+} mkldnn_rnn_flags_t;
+
 /** A descriptor for an rnn operation */
 typedef struct {
     /** The kind of primitive. Used for self identifying the primitive
@@ -836,6 +861,12 @@ typedef struct {
     mkldnn_memory_desc_t diff_dst_layer_desc;
     /** Destination gradient iteration memory descriptor. */
     mkldnn_memory_desc_t diff_dst_iter_desc;
+    /** Sequence lengths memory descriptor: one #mkldnn_s32 length per
+     * element of the batch, zero when all the sequences run the n_iter
+     * iterations. */
+    mkldnn_memory_desc_t seq_lengths_desc;
+    /** RNN flags. Possible values: #mkldnn_rnn_stateful. */
+    unsigned flags;
 } mkldnn_rnn_desc_t;
 
 /** @} */
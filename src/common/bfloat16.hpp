@@ -0,0 +1,56 @@
+/*******************************************************************************
+* Copyright 2018 Intel Corporation
+*
+* Licensed under the Apache License, Version 2.0 (the "License");
+* you may not use this file except in compliance with the License.
+* You may obtain a copy of the License at
+*
+*     http://www.apache.org/licenses/LICENSE-2.0
+*
+* Unless required by applicable law or agreed to in writing, software
+* distributed under the License is distributed on an "AS IS" BASIS,
+* WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+* See the License for the specific language governing permissions and
+* limitations under the License.
+*******************************************************************************/
+
+#ifndef BFLOAT16_HPP
+#define BFLOAT16_HPP
+
+#include <stdint.h>
+
+namespace mkldnn {
+namespace impl {
+
+/* bfloat16 is the upper half of an f32 value: a bf16 value widens to f32 by a
+ * 16-bit left shift and f32 narrows to bf16 by rounding the lower half to
+ * nearest even. NaNs stay (quiet) NaNs on narrowing. */
+struct bfloat16_t {
+    uint16_t raw_bits_;
+
+    bfloat16_t() = default;
+    bfloat16_t(float f) { *this = f; }
+
+    bfloat16_t &operator=(float f) {
+        union { float f; uint32_t u; } v = { f };
+        if ((v.u & 0x7fffffff) > 0x7f800000)
+            raw_bits_ = (uint16_t)((v.u >> 16) | 0x40);
+        else
+            raw_bits_ = (uint16_t)((v.u + 0x7fff + ((v.u >> 16) & 1)) >> 16);
+        return *this;
+    }
+
+    operator float() const {
+        union { uint32_t u; float f; } v = { (uint32_t)raw_bits_ << 16 };
+        return v.f;
+    }
+};
+
+static_assert(sizeof(bfloat16_t) == 2, "bfloat16_t must be 2 bytes");
+
+}
+}
+
+#endif
+
+// vim: et ts=4 sw=4 cindent cino^=l0,\:0,N-s
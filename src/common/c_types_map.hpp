@@ -83,6 +83,7 @@ namespace alg_kind {
     const alg_kind_t vanilla_rnn = mkldnn_vanilla_rnn;
     const alg_kind_t vanilla_lstm = mkldnn_vanilla_lstm;
     const alg_kind_t vanilla_gru = mkldnn_vanilla_gru;
+    const alg_kind_t depthwise_scale_shift = mkldnn_depthwise_scale_shift;
 }
 
 using data_type_t = mkldnn_data_type_t;
@@ -93,6 +94,8 @@ namespace data_type {
     const data_type_t s16 = mkldnn_s16;
     const data_type_t s8 = mkldnn_s8;
     const data_type_t u8 = mkldnn_u8;
+    const data_type_t bf16 = mkldnn_bf16;
+    const data_type_t f16 = mkldnn_f16;
 }
 
 using round_mode_t = mkldnn_round_mode_t;
@@ -149,6 +152,8 @@ namespace memory_format {
     const memory_format_t gOhwi16o = mkldnn_gOhwi16o;
     const memory_format_t Goihw8g = mkldnn_Goihw8g;
     const memory_format_t Goihw16g = mkldnn_Goihw16g;
+    const memory_format_t GOihw2g4o = mkldnn_GOihw2g4o;
+    const memory_format_t GOihw4g4o = mkldnn_GOihw4g4o;
     const memory_format_t gOhIw16o4i = mkldnn_gOhIw16o4i;
     const memory_format_t ncdhw = mkldnn_ncdhw;
     const memory_format_t oidhw = mkldnn_oidhw;
@@ -193,6 +198,7 @@ namespace primitive_kind {
     const primitive_kind_t inner_product = mkldnn_inner_product;
     const primitive_kind_t convolution_relu = mkldnn_convolution_relu;
     const primitive_kind_t rnn = mkldnn_rnn;
+    const primitive_kind_t depthwise = mkldnn_depthwise;
 }
 
 using query_t = mkldnn_query_t;
@@ -0,0 +1,92 @@
+/*******************************************************************************
+* Copyright 2018 Intel Corporation
+*
+* Licensed under the Apache License, Version 2.0 (the "License");
+* you may not use this file except in compliance with the License.
+* You may obtain a copy of the License at
+*
+*     http://www.apache.org/licenses/LICENSE-2.0
+*
+* Unless required by applicable law or agreed to in writing, software
+* distributed under the License is distributed on an "AS IS" BASIS,
+* WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+* See the License for the specific language governing permissions and
+* limitations under the License.
+*******************************************************************************/
+
+#ifndef FLOAT16_HPP
+#define FLOAT16_HPP
+
+#include <stdint.h>
+
+namespace mkldnn {
+namespace impl {
+
+/* IEEE half precision: 1 sign, 5 exponent and 10 mantissa bits. Narrowing
+ * from f32 rounds to nearest even, overflows to infinity and keeps NaNs
+ * (quiet) NaNs; it is the scalar counterpart of vcvtps2ph with imm 0, and
+ * widening is exact like vcvtph2ps. */
+struct float16_t {
+    uint16_t raw_bits_;
+
+    float16_t() = default;
+    float16_t(float f) { *this = f; }
+
+    float16_t &operator=(float f) {
+        union { float f; uint32_t u; } v = { f };
+        const uint32_t sign = (v.u >> 16) & 0x8000;
+        const uint32_t abs = v.u & 0x7fffffff;
+
+        if (abs > 0x7f800000) { // NaN
+            raw_bits_ = (uint16_t)(sign | 0x7e00 | ((abs >> 13) & 0x3ff));
+        } else if (abs >= 0x47800000) { // |f| >= 65536 rounds to infinity
+            raw_bits_ = (uint16_t)(sign | 0x7c00);
+        } else if (abs >= 0x38800000) { // normal f16
+            const uint32_t r = abs + 0xfff + ((abs >> 13) & 1)
+                - ((127 - 15) << 23);
+            raw_bits_ = (uint16_t)(sign | (r >> 13)); // may carry to inf
+        } else { // subnormal f16 or zero: align the implicit one to 2^-24
+            const int shift = 113 - (int)(abs >> 23) + 13;
+            if (shift > 24 + 1) {
+                raw_bits_ = (uint16_t)sign;
+            } else {
+                const uint32_t m = (abs & 0x7fffff) | 0x800000;
+                const uint32_t half = 1u << (shift - 1);
+                const uint32_t rem = m & ((half << 1) - 1);
+                uint32_t r = m >> shift;
+                if (rem > half || (rem == half && (r & 1))) ++r;
+                raw_bits_ = (uint16_t)(sign | r);
+            }
+        }
+        return *this;
+    }
+
+    operator float() const {
+        const uint32_t sign = (uint32_t)(raw_bits_ & 0x8000) << 16;
+        const uint32_t exp = (raw_bits_ >> 10) & 0x1f;
+        uint32_t mant = raw_bits_ & 0x3ff;
+        uint32_t u;
+        if (exp == 0x1f) {
+            u = sign | 0x7f800000 | (mant << 13);
+        } else if (exp != 0) {
+            u = sign | ((exp + 127 - 15) << 23) | (mant << 13);
+        } else if (mant == 0) {
+            u = sign;
+        } else { // subnormal f16 is a normal f32
+            int e = 127 - 15 + 1;
+            while (!(mant & 0x400)) { mant <<= 1; --e; }
+            u = sign | ((uint32_t)e << 23) | ((mant & 0x3ff) << 13);
+        }
+        union { uint32_t u; float f; } v = { u };
+        return v.f;
+    }
+};
+
+static_assert(sizeof(float16_t) == 2, "float16_t must be 2 bytes");
+
+}
+}
+
+#endif
+
+// vim: et ts=4 sw=4 cindent cino^=l0,\:0,N-s
@@ -43,7 +43,7 @@ status_t mkldnn_memory_desc_init(memory_desc_t *memory_desc, int ndims,
     /* memory_desc != 0 */
     bool args_ok = !any_null(memory_desc)
         && 0 < ndims && ndims <= TENSOR_MAX_DIMS
-        && one_of(data_type, f32, s32, s16, s8, u8);
+        && one_of(data_type, f32, s32, s16, s8, u8, bf16, f16);
     if (!args_ok) return invalid_arguments;
 
     memory_desc_t md;
@@ -99,6 +99,8 @@ status_t mkldnn_memory_desc_init(memory_desc_t *memory_desc, int ndims,
     case gOhwi16o:
     case Goihw8g:
     case Goihw16g:
+    case GOihw2g4o:
+    case GOihw4g4o:
     case gOhIw16o4i:
     case ncdhw:
     case goidhw:
@@ -443,6 +443,26 @@ status_t fill_Goihw16g(memory_desc_t &md) {
     return fill_contiguous_blocked(md, block_dims, perm);
 }
 
+status_t fill_GOihw2g4o(memory_desc_t &md) {
+    if (md.ndims != 5) return invalid_arguments;
+
+    const dims_t block_dims = {2, 4, 1, 1, 1};
+    const int perm[] = {
+         0, 1, 2, 3, 4,
+         5, 6, 7, 8, 9};
+    return fill_contiguous_blocked(md, block_dims, perm);
+}
+
+status_t fill_GOihw4g4o(memory_desc_t &md) {
+    if (md.ndims != 5) return invalid_arguments;
+
+    const dims_t block_dims = {4, 4, 1, 1, 1};
+    const int perm[] = {
+         0, 1, 2, 3, 4,
+         5, 6, 7, 8, 9};
+    return fill_contiguous_blocked(md, block_dims, perm);
+}
+
 status_t fill_gOIhw8i16o2i(memory_desc_t &md) {
     if (md.ndims != 5) return invalid_arguments;
 
@@ -591,6 +611,8 @@ status_t memory_desc_wrapper::compute_blocking(memory_desc_t &memory_desc)
     case gOhwi16o: return fill_gOhwi16o(memory_desc);
     case Goihw8g: return fill_Goihw8g(memory_desc);
     case Goihw16g: return fill_Goihw16g(memory_desc);
+    case GOihw2g4o: return fill_GOihw2g4o(memory_desc);
+    case GOihw4g4o: return fill_GOihw4g4o(memory_desc);
     case gOhIw16o4i: return fill_gOhIw16o4i(memory_desc);
     case ncdhw: return fill_ncdhw(memory_desc);
     case oidhw: return fill_oidhw(memory_desc);
@@ -78,7 +78,8 @@ struct memory_desc_wrapper: public c_compatible {
                     OhIw16o4i, OIhw4i16o4i, goihw, gOIhw8i8o, gOIhw16i16o,
                     gOIhw8i16o2i, gOIhw8o16i2o, gOIhw8o8i, gOIhw16o16i, gOihw8o,
                     gOihw16o, gOhwi8o, gOhwi16o, gOhIw16o4i, IOhw16o16i,
-                    gIOhw16o16i, gOIhw4i16o4i, Goihw8g, Goihw16g, ncdhw, oidhw, goidhw,
+                    gIOhw16o16i, gOIhw4i16o4i, Goihw8g, Goihw16g, GOihw2g4o,
+                    GOihw4g4o, ncdhw, oidhw, goidhw,
                     ntc, tnc, ldsnc, ldigo, ldgoi, ldgo));
 
         if (blocking_desc().offset_padding != 0) return 0;
@@ -42,6 +42,8 @@ const char *mkldnn_dt2str(mkldnn_data_type_t v) {
     if (v == mkldnn_s16) return "s16";
     if (v == mkldnn_s8) return "s8";
     if (v == mkldnn_u8) return "u8";
+    if (v == mkldnn_bf16) return "bf16";
+    if (v == mkldnn_f16) return "f16";
     assert(!"unknown dt");
     return "unknown dt";
 }
@@ -98,6 +100,8 @@ const char *mkldnn_fmt2str(mkldnn_memory_format_t v) {
     if (v == mkldnn_gOhwi16o) return "gOhwi16o";
     if (v == mkldnn_Goihw8g) return "Goihw8g";
     if (v == mkldnn_Goihw16g) return "Goihw16g";
+    if (v == mkldnn_GOihw2g4o) return "GOihw2g4o";
+    if (v == mkldnn_GOihw4g4o) return "GOihw4g4o";
     if (v == mkldnn_gOhIw16o4i) return "gOhIw16o4i";
     if (v == mkldnn_oIhw8i) return "oIhw8i";
     if (v == mkldnn_oIhw16i) return "oIhw16i";
@@ -149,6 +153,7 @@ const char *mkldnn_prim_kind2str(mkldnn_primitive_kind_t v) {
     if (v == mkldnn_inner_product) return "inner_product";
     if (v == mkldnn_convolution_relu) return "convolution_relu";
     if (v == mkldnn_rnn) return "rnn";
+    if (v == mkldnn_depthwise) return "depthwise";
     assert(!"unknown prim_kind");
     return "unknown prim_kind";
 }
@@ -177,6 +182,7 @@ const char *mkldnn_alg_kind2str(mkldnn_alg_kind_t v) {
     if (v == mkldnn_vanilla_rnn) return "vanilla_rnn";
     if (v == mkldnn_vanilla_lstm) return "vanilla_lstm";
     if (v == mkldnn_vanilla_gru) return "vanilla_gru";
+    if (v == mkldnn_depthwise_scale_shift) return "depthwise_scale_shift";
     assert(!"unknown alg_kind");
     return "unknown alg_kind";
 }
@@ -21,6 +21,8 @@
 #include <stdint.h>
 
 #include "mkldnn.h"
+#include "bfloat16.hpp"
+#include "float16.hpp"
 #include "c_types_map.hpp"
 #include "nstl.hpp"
 #include "utils.hpp"
@@ -38,6 +40,8 @@ template <> struct prec_traits<data_type::s32> { typedef int32_t type; };
 template <> struct prec_traits<data_type::s16> { typedef int16_t type; };
 template <> struct prec_traits<data_type::s8> { typedef int8_t type; };
 template <> struct prec_traits<data_type::u8> { typedef uint8_t type; };
+template <> struct prec_traits<data_type::bf16> { typedef bfloat16_t type; };
+template <> struct prec_traits<data_type::f16> { typedef float16_t type; };
 
 template <> struct data_traits<float>
 { static constexpr data_type_t data_type = data_type::f32; };
@@ -49,6 +53,10 @@ template <> struct data_traits<int8_t>
 { static constexpr data_type_t data_type = data_type::s8; };
 template <> struct data_traits<uint8_t>
 { static constexpr data_type_t data_type = data_type::u8; };
+template <> struct data_traits<bfloat16_t>
+{ static constexpr data_type_t data_type = data_type::bf16; };
+template <> struct data_traits<float16_t>
+{ static constexpr data_type_t data_type = data_type::f16; };
 
 #define PKIND_TRAITS_INST(op) \
 template <> struct pkind_traits<primitive_kind::op> { \
@@ -93,6 +93,15 @@ struct mkldnn_primitive: public mkldnn::impl::c_compatible {
         assert(this->kind() == mkldnn::impl::primitive_kind::memory);
         return mkldnn::impl::status::invalid_arguments;
     }
+    /** resets the states kept between executions for the elements
+     * [mb_begin, mb_end) of the batch. Applicable for stateful rnn primitives
+     * only. */
+    virtual mkldnn::impl::status_t reset_states(int mb_begin, int mb_end) {
+        UNUSED(mb_begin);
+        UNUSED(mb_end);
+        assert(this->kind() == mkldnn::impl::primitive_kind::rnn);
+        return mkldnn::impl::status::invalid_arguments;
+    }
 
 protected:
     const mkldnn::impl::primitive_desc_t *pd_;
@@ -87,6 +87,26 @@ status_t post_ops_t::append_eltwise(float scale, alg_kind_t alg, float alpha,
     return success;
 }
 
+status_t post_ops_t::append_depthwise(alg_kind_t alg,
+        const float *weights_data, const float *biases_data) {
+    using namespace mkldnn::impl::alg_kind;
+    bool known_alg = one_of(alg, depthwise_scale_shift);
+    if (!known_alg)
+        return invalid_arguments;
+
+    if (len_ == capacity)
+        return out_of_memory;
+
+    entry_[len_].kind = primitive_kind::depthwise;
+    entry_[len_].depthwise.alg = alg;
+    entry_[len_].depthwise.weights_data = weights_data;
+    entry_[len_].depthwise.biases_data = biases_data;
+
+    len_++;
+
+    return success;
+}
+
 status_t primitive_attr_t::set_round_mode(round_mode_t round_mode) {
     using namespace mkldnn::impl::round_mode;
 
@@ -177,6 +197,67 @@ status_t mkldnn_primitive_attr_get_post_ops(const primitive_attr_t *attr,
     return success;
 }
 
+status_t mkldnn_primitive_attr_get_sparse_weights(
+        const primitive_attr_t *attr, int *sparse_weights) {
+    if (any_null(attr, sparse_weights))
+        return invalid_arguments;
+
+    *sparse_weights = attr->sparse_weights_;
+
+    return success;
+}
+
+status_t mkldnn_primitive_attr_set_sparse_weights(primitive_attr_t *attr,
+        int sparse_weights) {
+    if (any_null(attr))
+        return invalid_arguments;
+
+    attr->sparse_weights_ = sparse_weights != 0;
+
+    return success;
+}
+
+status_t mkldnn_primitive_attr_get_rnn_data_qparams(
+        const primitive_attr_t *attr, float *scale, float *shift) {
+    if (any_null(attr, scale, shift))
+        return invalid_arguments;
+
+    *scale = attr->rnn_data_qparams_.scale_;
+    *shift = attr->rnn_data_qparams_.shift_;
+
+    return success;
+}
+
+status_t mkldnn_primitive_attr_set_rnn_data_qparams(primitive_attr_t *attr,
+        float scale, float shift) {
+    if (any_null(attr))
+        return invalid_arguments;
+
+    return attr->rnn_data_qparams_.set(scale, shift);
+}
+
+status_t mkldnn_primitive_attr_get_rnn_weights_qparams(
+        const primitive_attr_t *attr, int *count, int *mask,
+        const float **scales) {
+    if (any_null(attr, count, mask, scales))
+        return invalid_arguments;
+
+    *count = attr->rnn_weights_qparams_.count_;
+    *mask = attr->rnn_weights_qparams_.mask_;
+    *scales = attr->rnn_weights_qparams_.scales_;
+
+    return success;
+}
+
+status_t mkldnn_primitive_attr_set_rnn_weights_qparams(primitive_attr_t *attr,
+        int count, int mask, const float *scales) {
+    bool ok = !any_null(attr, scales) && count > 0 && mask >= 0;
+    if (!ok)
+        return invalid_arguments;
+
+    return attr->rnn_weights_qparams_.set(count, mask, scales);
+}
+
 status_t mkldnn_primitive_attr_set_post_ops(primitive_attr_t *attr,
         const post_ops_t *post_ops) {
     if (any_null(attr, post_ops))
@@ -270,3 +351,29 @@ status_t mkldnn_post_ops_get_params_eltwise(const post_ops_t *post_ops,
 
     return success;
 }
+
+status_t mkldnn_post_ops_append_depthwise(post_ops_t *post_ops,
+        alg_kind_t kind, const float *weights_data,
+        const float *biases_data) {
+    if (any_null(post_ops, weights_data))
+        return invalid_arguments;
+
+    return post_ops->append_depthwise(kind, weights_data, biases_data);
+}
+
+status_t mkldnn_post_ops_get_params_depthwise(const post_ops_t *post_ops,
+        int index, alg_kind_t *alg, const float **weights_data,
+        const float **biases_data) {
+    bool ok = true
+        && simple_get_params_check(post_ops, index, primitive_kind::depthwise)
+        && !any_null(alg, weights_data, biases_data);
+    if (!ok)
+        return invalid_arguments;
+
+    const auto &e = post_ops->entry_[index].depthwise;
+    *alg = e.alg;
+    *weights_data = e.weights_data;
+    *biases_data = e.biases_data;
+
+    return success;
+}
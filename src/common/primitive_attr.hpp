@@ -72,6 +72,23 @@ private:
     }
 };
 
+/* the quantization of the data of an rnn: the u8 value of x is
+ * saturate(round(scale * x + shift)) */
+struct rnn_data_qparams_t: public c_compatible {
+    rnn_data_qparams_t(): scale_(1.), shift_(0.) {}
+
+    bool has_default_values() const { return scale_ == 1. && shift_ == 0.; }
+
+    status_t set(float scale, float shift) {
+        scale_ = scale;
+        shift_ = shift;
+        return status::success;
+    }
+
+    float scale_;
+    float shift_;
+};
+
 }
 }
 
@@ -84,6 +101,11 @@ struct mkldnn_post_ops: public mkldnn::impl::c_compatible {
                 mkldnn::impl::alg_kind_t alg;
                 float scale, alpha, beta;
             } eltwise;
+            struct {
+                mkldnn::impl::alg_kind_t alg;
+                const float *weights_data;
+                const float *biases_data;
+            } depthwise;
         };
 
         bool is_relu(bool require_scale_one = true,
@@ -99,6 +121,11 @@ struct mkldnn_post_ops: public mkldnn::impl::c_compatible {
             return kind == primitive_kind::sum
                 && utils::implication(require_scale_one, sum.scale == 1.f);
         }
+        bool is_depthwise() const {
+            using namespace mkldnn::impl;
+            return kind == primitive_kind::depthwise
+                && depthwise.alg == alg_kind::depthwise_scale_shift;
+        }
     };
 
     mkldnn_post_ops(): len_(0) {}
@@ -106,6 +133,8 @@ struct mkldnn_post_ops: public mkldnn::impl::c_compatible {
     mkldnn::impl::status_t append_sum(float scale);
     mkldnn::impl::status_t append_eltwise(float scale,
             mkldnn::impl::alg_kind_t alg, float alpha, float beta);
+    mkldnn::impl::status_t append_depthwise(mkldnn::impl::alg_kind_t alg,
+            const float *weights_data, const float *biases_data);
 
     int find(mkldnn::impl::primitive_kind_t kind, int start = 0,
             int stop = -1) const {
@@ -121,7 +150,7 @@ struct mkldnn_post_ops: public mkldnn::impl::c_compatible {
     bool contain(mkldnn::impl::primitive_kind_t kind, int index) const
     { return find(kind, index, index + 1) == index; }
 
-    enum { capacity = 4 };
+    enum { capacity = 8 };
 
     int len_;
     entry_t entry_[capacity];
@@ -129,7 +158,8 @@ struct mkldnn_post_ops: public mkldnn::impl::c_compatible {
 
 struct mkldnn_primitive_attr: public mkldnn::impl::c_compatible {
     mkldnn_primitive_attr()
-        : round_mode_(mkldnn::impl::round_mode::nearest) {}
+        : round_mode_(mkldnn::impl::round_mode::nearest)
+        , sparse_weights_(false) {}
 
     mkldnn_primitive_attr *clone() const
     { return new mkldnn_primitive_attr(*this); }
@@ -138,7 +168,11 @@ struct mkldnn_primitive_attr: public mkldnn::impl::c_compatible {
        return true
             && round_mode_ == mkldnn::impl::round_mode::nearest
             && output_scales_.has_default_values()
-            && post_ops_.has_default_values() ;
+            && post_ops_.has_default_values()
+            && rnn_data_qparams_.has_default_values()
+            && rnn_weights_qparams_.has_default_values();
+        /* sparse_weights_ is a hint which never changes the result, so
+         * implementations are free to ignore it */
     }
 
     mkldnn::impl::status_t set_round_mode(
@@ -149,6 +183,9 @@ struct mkldnn_primitive_attr: public mkldnn::impl::c_compatible {
     mkldnn::impl::round_mode_t round_mode_;
     mkldnn::impl::scales_t output_scales_;
     mkldnn::impl::post_ops_t post_ops_;
+    bool sparse_weights_;
+    mkldnn::impl::rnn_data_qparams_t rnn_data_qparams_;
+    mkldnn::impl::scales_t rnn_weights_qparams_;
 };
 
 #endif
@@ -17,6 +17,8 @@
 #ifndef PRIMITIVE_DESC_HPP
 #define PRIMITIVE_DESC_HPP
 
+#include <string.h>
+
 #include "mkldnn.h"
 
 #include "c_types_map.hpp"
@@ -46,6 +48,17 @@ struct mkldnn_primitive_desc: public mkldnn::impl::c_compatible {
 
     virtual void init_info() {}
     const char *info() const { return info_; }
+    /** appends @p str as an extra field to the verbose info. Used by the
+     * primitives to report decisions made at creation time only (e.g. the
+     * reduction scheme) */
+    void add_info(const char *str) {
+#if !defined(DISABLE_VERBOSE)
+        const size_t len = strlen(info_);
+        snprintf(info_ + len, MKLDNN_VERBOSE_BUF_LEN - len, ",%s", str);
+#else
+        UNUSED(str);
+#endif
+    }
 
     virtual const mkldnn::impl::op_desc_t *op_desc() const = 0;
 
@@ -17,6 +17,7 @@
 #include "mkldnn.h"
 
 #include "c_types_map.hpp"
+#include "primitive.hpp"
 #include "type_helpers.hpp"
 #include "utils.hpp"
 
@@ -46,8 +47,22 @@ rnn_desc_t zero_rnn_desc() {
     rd.diff_bias_desc = zero_md();
     rd.diff_dst_layer_desc = zero_md();
     rd.diff_dst_iter_desc = zero_md();
+    rd.seq_lengths_desc = zero_md();
     return rd;
 }
+
+status_t set_seq_lengths(
+        rnn_desc_t *rnn_desc, const memory_desc_t *seq_lengths_desc) {
+    bool args_ok = true && seq_lengths_desc != nullptr
+            && seq_lengths_desc->ndims == 1
+            && seq_lengths_desc->dims[0] == rnn_desc->src_layer_desc.dims[1]
+            && seq_lengths_desc->data_type == data_type::s32;
+    if (!args_ok)
+        return invalid_arguments;
+
+    rnn_desc->seq_lengths_desc = *seq_lengths_desc;
+    return success;
+}
 }
 
 /* Public C Api */
@@ -134,12 +149,11 @@ status_t MKLDNN_API mkldnn_rnn_forward_desc_init(mkldnn_rnn_desc_t *rnn_desc,
             && DIC == weights_layer_desc->dims[4]
             && DIC == weights_iter_desc->dims[4]
             && DLC == dst_layer_desc->dims[2] && L == weights_iter_desc->dims[0]
-            && implication(!is_zero_md(dst_iter_desc), true
+            && (is_zero_md(dst_iter_desc) || (true
                                && DIC == dst_iter_desc->dims[4]
-                               && L == dst_iter_desc->dims[0])
-            && implication(!is_zero_md(bias_desc), L == bias_desc->dims[0])
-            && implication(
-                       !is_zero_md(src_iter_desc), L == src_iter_desc->dims[0]);
+                               && L == dst_iter_desc->dims[0]))
+            && (is_zero_md(bias_desc) || L == bias_desc->dims[0])
+            && (is_zero_md(src_iter_desc) || L == src_iter_desc->dims[0]);
     if (!args_ok)
         return invalid_arguments;
 
@@ -217,12 +231,11 @@ status_t MKLDNN_API mkldnn_rnn_backward_desc_init(mkldnn_rnn_desc_t *rnn_desc,
             && DIC == weights_layer_desc->dims[4]
             && DIC == weights_iter_desc->dims[4]
             && DLC == dst_layer_desc->dims[2] && L == weights_iter_desc->dims[0]
-            && implication(!is_zero_md(dst_iter_desc), true
+            && (is_zero_md(dst_iter_desc) || (true
                                && DIC == dst_iter_desc->dims[4]
-                               && L == dst_iter_desc->dims[0])
-            && implication(!is_zero_md(bias_desc), L == bias_desc->dims[0])
-            && implication(
-                       !is_zero_md(src_iter_desc), L == src_iter_desc->dims[0]);
+                               && L == dst_iter_desc->dims[0]))
+            && (is_zero_md(bias_desc) || L == bias_desc->dims[0])
+            && (is_zero_md(src_iter_desc) || L == src_iter_desc->dims[0]);
     if (!args_ok)
         return invalid_arguments;
 
@@ -252,3 +265,97 @@ status_t MKLDNN_API mkldnn_rnn_backward_desc_init(mkldnn_rnn_desc_t *rnn_desc,
 
     return success;
 }
+
+status_t MKLDNN_API mkldnn_varlen_rnn_forward_desc_init(
+        mkldnn_rnn_desc_t *rnn_desc, prop_kind_t prop_kind,
+        const rnn_cell_desc_t *rnn_cell_desc, const rnn_direction_t direction,
+        const memory_desc_t *src_layer_desc,
+        const memory_desc_t *src_iter_desc,
+        const memory_desc_t *weights_layer_desc,
+        const memory_desc_t *weights_iter_desc, const memory_desc_t *bias_desc,
+        const memory_desc_t *dst_layer_desc,
+        const memory_desc_t *dst_iter_desc,
+        const memory_desc_t *seq_lengths_desc) {
+    mkldnn_rnn_desc_t rd;
+    status_t status = mkldnn_rnn_forward_desc_init(&rd, prop_kind,
+            rnn_cell_desc, direction, src_layer_desc, src_iter_desc,
+            weights_layer_desc, weights_iter_desc, bias_desc, dst_layer_desc,
+            dst_iter_desc);
+    if (status != success)
+        return status;
+    status = set_seq_lengths(&rd, seq_lengths_desc);
+    if (status != success)
+        return status;
+
+    *rnn_desc = rd;
+
+    return success;
+}
+
+status_t MKLDNN_API mkldnn_varlen_rnn_backward_desc_init(
+        mkldnn_rnn_desc_t *rnn_desc, prop_kind_t prop_kind,
+        const rnn_cell_desc_t *rnn_cell_desc, const rnn_direction_t direction,
+        const memory_desc_t *src_layer_desc,
+        const memory_desc_t *src_iter_desc,
+        const memory_desc_t *weights_layer_desc,
+        const memory_desc_t *weights_iter_desc, const memory_desc_t *bias_desc,
+        const memory_desc_t *dst_layer_desc, const memory_desc_t *dst_iter_desc,
+        const memory_desc_t *diff_src_layer_desc,
+        const memory_desc_t *diff_src_iter_desc,
+        const memory_desc_t *diff_weights_layer_desc,
+        const memory_desc_t *diff_weights_iter_desc,
+        const memory_desc_t *diff_bias_desc,
+        const memory_desc_t *diff_dst_layer,
+        const memory_desc_t *diff_dst_iter_desc,
+        const memory_desc_t *seq_lengths_desc) {
+    mkldnn_rnn_desc_t rd;
+    status_t status = mkldnn_rnn_backward_desc_init(&rd, prop_kind,
+            rnn_cell_desc, direction, src_layer_desc, src_iter_desc,
+            weights_layer_desc, weights_iter_desc, bias_desc, dst_layer_desc,
+            dst_iter_desc, diff_src_layer_desc, diff_src_iter_desc,
+            diff_weights_layer_desc, diff_weights_iter_desc, diff_bias_desc,
+            diff_dst_layer, diff_dst_iter_desc);
+    if (status != success)
+        return status;
+    status = set_seq_lengths(&rd, seq_lengths_desc);
+    if (status != success)
+        return status;
+
+    *rnn_desc = rd;
+
+    return success;
+}
+
+status_t MKLDNN_API mkldnn_stateful_rnn_forward_desc_init(
+        mkldnn_rnn_desc_t *rnn_desc, const rnn_cell_desc_t *rnn_cell_desc,
+        const memory_desc_t *src_layer_desc,
+        const memory_desc_t *weights_layer_desc,
+        const memory_desc_t *weights_iter_desc, const memory_desc_t *bias_desc,
+        const memory_desc_t *dst_layer_desc,
+        const memory_desc_t *seq_lengths_desc) {
+    mkldnn_rnn_desc_t rd;
+    status_t status = mkldnn_rnn_forward_desc_init(&rd,
+            prop_kind::forward_inference, rnn_cell_desc,
+            mkldnn_unidirectional_left2right, src_layer_desc, nullptr,
+            weights_layer_desc, weights_iter_desc, bias_desc, dst_layer_desc,
+            nullptr);
+    if (status != success)
+        return status;
+    if (!is_zero_md(seq_lengths_desc)) {
+        status = set_seq_lengths(&rd, seq_lengths_desc);
+        if (status != success)
+            return status;
+    }
+    rd.flags = mkldnn_rnn_stateful;
+
+    *rnn_desc = rd;
+
+    return success;
+}
+
+status_t MKLDNN_API mkldnn_rnn_reset_states(
+        primitive_t *rnn, int mb_begin, int mb_end) {
+    if (any_null(rnn) || rnn->kind() != primitive_kind::rnn)
+        return invalid_arguments;
+    return rnn->reset_states(mb_begin, mb_end);
+}
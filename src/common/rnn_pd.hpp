@@ -146,6 +146,17 @@ struct rnn_pd_t : public primitive_desc_t {
         return !memory_desc_wrapper(desc_.dst_iter_desc).is_zero();
     }
 
+    bool with_seq_lengths() const {
+        return !memory_desc_wrapper(desc_.seq_lengths_desc).is_zero();
+    }
+
+    /* the states of the last iteration are kept by the primitive for its
+     * next execution */
+    bool is_stateful() const { return desc_.flags & mkldnn_rnn_stateful; }
+
+    /* the lengths of the sequences of the batch, the last input */
+    virtual const memory_pd_t *seq_lengths_pd() const { return nullptr; }
+
     mkldnn::impl::alg_kind_t cell_kind() const {
         return desc_.cell_desc.cell_kind;
     }
@@ -173,6 +184,7 @@ struct rnn_fwd_pd_t : public rnn_pd_t {
         case 2: return weights_pd(0);
         case 3: return weights_pd(1);
         case 4: return weights_pd(2);
+        case 5: return seq_lengths_pd();
         default: return nullptr;
         }
     }
@@ -187,7 +199,7 @@ struct rnn_fwd_pd_t : public rnn_pd_t {
     }
 
     virtual int n_inputs() const override {
-        return 3 + with_bias() + with_src_iter();
+        return 3 + with_bias() + with_src_iter() + with_seq_lengths();
     }
 
     virtual int n_outputs() const override {
@@ -216,6 +228,7 @@ struct rnn_bwd_pd_t : public rnn_pd_t {
         case 7: return diff_dst_pd(0);
         case 8: return diff_dst_pd(1);
         case 9: return workspace_pd();
+        case 10: return seq_lengths_pd();
         default: return nullptr;
         }
     }
@@ -232,7 +245,8 @@ struct rnn_bwd_pd_t : public rnn_pd_t {
     }
 
     virtual int n_inputs() const override {
-        return 6 + with_src_iter() + with_bias() + 2 * with_dst_iter();
+        return 6 + with_src_iter() + with_bias() + 2 * with_dst_iter()
+                + with_seq_lengths();
     }
     virtual int n_outputs() const override {
         return 3 + with_src_iter() + with_bias();
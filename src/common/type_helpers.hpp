@@ -52,6 +52,8 @@ ISSPEC(int8_t, int32_t);
 ISSPEC(uint8_t, int32_t);
 ISSPEC(int8_t, int16_t);
 ISSPEC(uint8_t, int16_t);
+ISSPEC(bfloat16_t, float);
+ISSPEC(float16_t, float);
 #undef ISSPEC
 
 namespace types {
@@ -64,6 +66,8 @@ inline size_t data_type_size(data_type_t data_type) {
     case s16: return sizeof(prec_traits<s16>::type);
     case s8: return sizeof(prec_traits<s8>::type);
     case u8: return sizeof(prec_traits<u8>::type);
+    case bf16: return sizeof(prec_traits<bf16>::type);
+    case f16: return sizeof(prec_traits<f16>::type);
     case data_type::undef:
     default: assert(!"unknown data_type");
     }
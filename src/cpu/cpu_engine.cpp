@@ -24,12 +24,14 @@
 #include "cpu_concat.hpp"
 #include "cpu_sum.hpp"
 
+#include "cpu/gemm_u8s8s32x_lstm.hpp"
 #include "cpu/ref_rnn.hpp"
 
 #include "cpu/jit_avx512_core_u8s8s32x_1x1_convolution.hpp"
 #include "cpu/jit_avx512_common_1x1_convolution.hpp"
 #include "cpu/jit_avx512_core_convolution_winograd.hpp"
 #include "cpu/jit_avx512_common_convolution_winograd.hpp"
+#include "cpu/jit_avx2_convolution_winograd.hpp"
 #include "cpu/jit_avx512_core_u8s8s32x_convolution.hpp"
 #include "cpu/jit_avx512_common_convolution.hpp"
 #include "cpu/jit_avx2_1x1_convolution.hpp"
@@ -37,6 +39,7 @@
 #include "cpu/jit_avx2_convolution.hpp"
 #include "cpu/jit_sse42_convolution.hpp"
 #include "cpu/gemm_convolution.hpp"
+#include "cpu/nhwc_gemm_convolution.hpp"
 #include "cpu/gemm_u8s8s32x_convolution.hpp"
 #include "cpu/ref_convolution.hpp"
 #include "cpu/ref_deconvolution.hpp"
@@ -54,8 +57,10 @@
 #include "cpu/ref_batch_normalization.hpp"
 #include "cpu/ref_inner_product.hpp"
 #include "cpu/gemm_inner_product.hpp"
+#include "cpu/gemm_u8s8s32x_inner_product.hpp"
 #include "cpu/jit_uni_inner_product.hpp"
 #include "cpu/jit_uni_dw_convolution.hpp"
+#include "cpu/jit_uni_sparse_convolution.hpp"
 
 namespace mkldnn {
 namespace impl {
@@ -87,9 +92,13 @@ using namespace mkldnn::impl::data_type;
 #define INSTANCE(...) &primitive_desc_t::create<__VA_ARGS__::pd_t>
 static const pd_create_f cpu_impl_list[] = {
     /* RNN */
+    INSTANCE(gemm_u8s8s32x_lstm_fwd_t<f32>),
+    INSTANCE(gemm_u8s8s32x_lstm_fwd_t<u8>),
     INSTANCE(ref_rnn_fwd_t),
     INSTANCE(ref_rnn_bwd_t),
     /* conv */
+    INSTANCE(jit_avx512_common_sparse_convolution_fwd_t),
+    INSTANCE(jit_avx2_sparse_convolution_fwd_t),
     INSTANCE(jit_avx512_common_dw_convolution_fwd_t),
     INSTANCE(jit_avx512_common_dw_convolution_bwd_data_t),
     INSTANCE(jit_avx512_common_1x1_convolution_fwd_f32_t),
@@ -103,6 +112,8 @@ static const pd_create_f cpu_impl_list[] = {
     INSTANCE(jit_avx512_common_convolution_winograd_fwd_t),
     INSTANCE(jit_avx512_common_convolution_winograd_bwd_data_t),
     INSTANCE(jit_avx512_common_convolution_winograd_bwd_weights_t),
+    INSTANCE(jit_avx2_convolution_winograd_fwd_t),
+    INSTANCE(jit_avx2_convolution_winograd_bwd_data_t),
     INSTANCE(jit_avx512_common_convolution_fwd_t<f32>),
     INSTANCE(jit_avx512_common_convolution_bwd_data_t<f32>),
     INSTANCE(jit_avx512_common_convolution_bwd_weights_t<f32>),
@@ -118,6 +129,12 @@ static const pd_create_f cpu_impl_list[] = {
     INSTANCE(jit_avx2_convolution_bwd_data_t),
     INSTANCE(jit_avx2_convolution_bwd_weights_t),
     INSTANCE(jit_sse42_convolution_fwd_t),
+    INSTANCE(jit_avx512_common_nhwc_gemm_convolution_fwd_t),
+    INSTANCE(jit_avx512_common_nhwc_gemm_convolution_bwd_data_t),
+    INSTANCE(jit_avx512_common_nhwc_gemm_convolution_bwd_weights_t),
+    INSTANCE(jit_avx2_nhwc_gemm_convolution_fwd_t),
+    INSTANCE(jit_avx2_nhwc_gemm_convolution_bwd_data_t),
+    INSTANCE(jit_avx2_nhwc_gemm_convolution_bwd_weights_t),
     INSTANCE(mkl_gemm_convolution_fwd_t),
     INSTANCE(mkl_gemm_convolution_bwd_data_t),
     INSTANCE(mkl_gemm_convolution_bwd_weights_t),
@@ -125,8 +142,11 @@ static const pd_create_f cpu_impl_list[] = {
     INSTANCE(jit_avx512_common_gemm_convolution_bwd_data_t),
     INSTANCE(jit_avx512_common_gemm_convolution_bwd_weights_t),
     INSTANCE(jit_avx2_gemm_convolution_fwd_t),
+    INSTANCE(jit_sse42_gemm_convolution_fwd_t),
     INSTANCE(jit_avx2_gemm_convolution_bwd_data_t),
+    INSTANCE(jit_sse42_gemm_convolution_bwd_data_t),
     INSTANCE(jit_avx2_gemm_convolution_bwd_weights_t),
+    INSTANCE(jit_sse42_gemm_convolution_bwd_weights_t),
     INSTANCE(ref_convolution_fwd_t<f32>),
     INSTANCE(ref_convolution_bwd_data_t<f32, f32, f32, f32>),
     INSTANCE(ref_convolution_bwd_weights_t<f32, f32, f32, f32>),
@@ -152,6 +172,8 @@ static const pd_create_f cpu_impl_list[] = {
     INSTANCE(ref_convolution_fwd_t<u8, s8, u8, s32>),
     INSTANCE(ref_convolution_bwd_data_t<s32, s16, s16, s32>),
     INSTANCE(ref_convolution_bwd_weights_t<s16, s32, s16, s32>),
+    /* conv (bf16) */
+    INSTANCE(jit_avx512_common_convolution_fwd_t<bf16, bf16, f32>),
     /* deconv */
     INSTANCE(ref_deconvolution_bwd_weights_t),
     INSTANCE(ref_deconvolution_bwd_data_t),
@@ -159,6 +181,8 @@ static const pd_create_f cpu_impl_list[] = {
     /* eltwise */
     INSTANCE(jit_uni_eltwise_fwd_t<avx512_common>),
     INSTANCE(jit_uni_eltwise_bwd_t<avx512_common>),
+    INSTANCE(jit_uni_eltwise_fwd_t<avx512_common, bf16>),
+    INSTANCE(jit_uni_eltwise_bwd_t<avx512_common, bf16>),
     INSTANCE(jit_uni_eltwise_fwd_t<avx2>),
     INSTANCE(jit_uni_eltwise_bwd_t<avx2>),
     INSTANCE(jit_uni_eltwise_fwd_t<sse42>),
@@ -219,13 +243,25 @@ static const pd_create_f cpu_impl_list[] = {
     INSTANCE(jit_uni_inner_product_fwd_t<avx2>),
     INSTANCE(jit_uni_inner_product_bwd_weights_t<avx2>),
     INSTANCE(jit_uni_inner_product_bwd_data_t<avx2>),
+    INSTANCE(jit_uni_inner_product_fwd_t<sse42>),
+    INSTANCE(jit_uni_inner_product_bwd_weights_t<sse42>),
+    INSTANCE(jit_uni_inner_product_bwd_data_t<sse42>),
     INSTANCE(ref_inner_product_fwd_t<f32>),
     INSTANCE(ref_inner_product_bwd_data_t<f32, f32, f32, f32>),
     INSTANCE(ref_inner_product_bwd_weights_t<f32>),
     /* inner product (int) */
+    INSTANCE(gemm_u8s8s32x_inner_product_fwd_t<u8>),
+    INSTANCE(gemm_u8s8s32x_inner_product_fwd_t<s8>),
+    INSTANCE(gemm_u8s8s32x_inner_product_fwd_t<s32>),
+    INSTANCE(gemm_u8s8s32x_inner_product_fwd_t<f32>),
     INSTANCE(ref_inner_product_fwd_t<s16, s16, s32, s32>),
     INSTANCE(ref_inner_product_bwd_data_t<s32, s16, s16, s32>),
     INSTANCE(ref_inner_product_fwd_t<u8, s8, u8, s32>),
+    /* inner product (bf16) */
+    INSTANCE(jit_avx512_common_inner_product_bf16_fwd_t),
+    /* inner product (f16 weights) */
+    INSTANCE(jit_uni_inner_product_f16_fwd_t<avx512_common>),
+    INSTANCE(jit_uni_inner_product_f16_fwd_t<avx2>),
     /* conv_eltwise */
     INSTANCE(jit_avx512_common_dw_convolution_relu_t),
     INSTANCE(jit_avx512_common_convolution_winograd_relu_t),
@@ -237,9 +273,12 @@ static const pd_create_f cpu_impl_list[] = {
     INSTANCE(jit_sse42_1x1_convolution_relu_t),
     INSTANCE(jit_avx2_convolution_relu_t),
     INSTANCE(jit_sse42_convolution_relu_t),
+    INSTANCE(jit_avx512_common_nhwc_gemm_convolution_relu_t),
+    INSTANCE(jit_avx2_nhwc_gemm_convolution_relu_t),
     INSTANCE(mkl_gemm_convolution_relu_t),
     INSTANCE(jit_avx512_common_gemm_convolution_relu_t),
     INSTANCE(jit_avx2_gemm_convolution_relu_t),
+    INSTANCE(jit_sse42_gemm_convolution_relu_t),
     INSTANCE(ref_convolution_relu_t<f32>),
     /* conv_eltwise (int) */
     INSTANCE(jit_avx512_common_1x1_convolution_relu_s16s16s32_t),
@@ -260,6 +299,8 @@ static const pd_create_f cpu_impl_list[] = {
     INSTANCE(ref_convolution_relu_t<u8, s8, s32, s32>),
     INSTANCE(ref_convolution_relu_t<u8, s8, s8, s32>),
     INSTANCE(ref_convolution_relu_t<u8, s8, u8, s32>),
+    /* conv_eltwise (bf16) */
+    INSTANCE(jit_avx512_common_convolution_relu_t<bf16, bf16, f32>),
     /* eol */
     nullptr,
 };
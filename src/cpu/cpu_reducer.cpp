@@ -15,10 +15,12 @@
 *******************************************************************************/
 
 #include <assert.h>
+#include <stdio.h>
 
 #include "mkldnn_thread.hpp"
 #include "mkldnn_types.h"
 #include "nstl.hpp"
+#include "primitive_desc.hpp"
 #include "utils.hpp"
 
 #include "cpu_reducer.hpp"
@@ -27,6 +29,19 @@ namespace mkldnn {
 namespace impl {
 namespace cpu {
 
+int reduce_subgroup_size(int nthr) {
+    /* with just a few threads the flat reduction is good enough */
+    const int min_nthr_hierarchical = 16;
+    if (nthr < min_nthr_hierarchical) return 1;
+
+    /* balance the # of sources each thread accumulates at the first
+     * (intra-subgroup) and the second (inter-subgroup) levels */
+    int nthr_per_subgroup = 1;
+    while ((nthr_per_subgroup + 1) * (nthr_per_subgroup + 1) <= nthr)
+        ++nthr_per_subgroup;
+    return nthr_per_subgroup;
+}
+
 void reduce_balancer_t::balance() {
     using namespace nstl;
     using namespace utils;
@@ -82,6 +97,23 @@ void reduce_balancer_t::balance() {
     ngroups_ = ngroups;
     nthr_per_group_ = nthr_per_group;
     njobs_per_group_ub_ = njobs_per_group_ub;
+    nthr_per_subgroup_ = syncable_ ? reduce_subgroup_size(nthr_per_group_) : 1;
+}
+
+void reduce_balancer_t::add_info(primitive_desc_t *pd, const char *what) const
+{ add_reduction_info(pd, what, ngroups_, nthr_per_group_, nthr_per_subgroup_); }
+
+void add_reduction_info(primitive_desc_t *pd, const char *what, int ngroups,
+        int nthr_per_group, int nthr_per_subgroup) {
+    char str[64];
+    if (nthr_per_subgroup > 1)
+        snprintf(str, sizeof(str), "%s_reduction:hierarchical:%dx%dx%d",
+                what, ngroups, utils::div_up(nthr_per_group,
+                    nthr_per_subgroup), nthr_per_subgroup);
+    else
+        snprintf(str, sizeof(str), "%s_reduction:flat:%dx%d", what,
+                ngroups, nthr_per_group);
+    pd->add_info(str);
 }
 
 /* reducer jit-ted driver */
@@ -274,12 +306,49 @@ inline reducer_2d_driver_t<data_type> *create_reduce_2d_drv(int n_src,
     return nullptr;
 }
 
+/** creates the drivers for the first level of the hierarchical reduction:
+ * the partial results of the subgroup are accumulated into the buffer of the
+ * subgroup master. The last subgroup might be smaller than the others, hence
+ * the separate (tail) driver */
+template <impl::data_type_t data_type>
+inline void create_reduce_subgroup_drvs(const reduce_balancer_t &balancer,
+        size_t ws_per_thread, reducer_2d_driver_t<data_type> *drv_sub[2]) {
+    drv_sub[0] = drv_sub[1] = nullptr;
+    if (!balancer.hierarchical()) return;
+
+    const int nthr_sub = balancer.nthr_per_subgroup_;
+    const int nthr_sub_tail = balancer.subgrp_nthr(balancer.nsubgroups() - 1);
+    drv_sub[0] = create_reduce_2d_drv<data_type>(nthr_sub - 1, ws_per_thread,
+            0, 0, false);
+    if (nthr_sub_tail != nthr_sub && nthr_sub_tail > 1)
+        drv_sub[1] = create_reduce_2d_drv<data_type>(nthr_sub_tail - 1,
+                ws_per_thread, 0, 0, false);
+}
+
+/** splits @p size elements in cache-line granularity between @p nthr threads
+ * and makes thread @p ithr reduce its part: d[:] += sum(srcs[:]) */
+template <impl::data_type_t data_type>
+inline void reduce_1d_balanced(reducer_2d_driver_t<data_type> *drv,
+        typename prec_traits<data_type>::type *d,
+        const typename prec_traits<data_type>::type *srcs, size_t size,
+        int nthr, int ithr) {
+    typedef typename prec_traits<data_type>::type data_t;
+    const size_t cl = 64 / sizeof(data_t);
+
+    size_t start{0}, end{0};
+    balance211(utils::div_up(size, cl), nthr, ithr, start, end);
+    if (start == end) return;
+
+    const size_t len = nstl::min(end * cl, size) - start * cl;
+    (*drv)(d + start * cl, srcs + start * cl, 1, len);
+}
+
 /* cpu_reducer_t */
 
 template <impl::data_type_t data_type>
 cpu_reducer_t<data_type>::cpu_reducer_t(const reduce_balancer_t &balancer)
     : balancer_(balancer), workspace_(nullptr)
-    , drv_(nullptr), barriers_(nullptr)
+    , drv_(nullptr), drv_sub_{nullptr, nullptr}, barriers_(nullptr)
 {
     allocate_workspace();
     if (balancer_.nthr_per_group_ > 1) {
@@ -287,8 +356,12 @@ cpu_reducer_t<data_type>::cpu_reducer_t(const reduce_balancer_t &balancer)
                 balancer_.ngroups_ * sizeof(simple_barrier::ctx_t), 64);
         for (int i = 0; i < balancer_.ngroups_; ++i)
             simple_barrier::ctx_init(&barriers_[i]);
-        drv_ = create_reduce_2d_drv<data_type>(balancer_.nthr_per_group_ - 1,
-                ws_per_thread(), 0, 0, false);
+        /* the final reduction accumulates subgroup masters only */
+        const int nthr_sub = balancer_.nthr_per_subgroup_;
+        drv_ = create_reduce_2d_drv<data_type>(balancer_.nsubgroups() - 1,
+                nthr_sub * ws_per_thread(), 0, 0, false);
+        create_reduce_subgroup_drvs<data_type>(balancer_, ws_per_thread(),
+                drv_sub_);
     }
 }
 
@@ -297,6 +370,8 @@ cpu_reducer_t<data_type>::~cpu_reducer_t() {
     deallocate_workspace();
     free(barriers_);
     delete drv_;
+    delete drv_sub_[0];
+    delete drv_sub_[1];
 }
 
 template <impl::data_type_t data_type>
@@ -323,6 +398,27 @@ cpu_reducer_t<data_type>::get_local_ptr(int ithr, data_t *dst) {
     return workspace_ + offset_factor * ws_per_thread();
 }
 
+template <impl::data_type_t data_type>
+void cpu_reducer_t<data_type>::reduce_subgroup_nolock(int ithr, data_t *dst) {
+    const int sgrp = balancer_.subgroup_id(ithr);
+    const int nthr_sub = balancer_.subgrp_nthr(sgrp);
+    if (nthr_sub == 1) return;
+
+    auto drv = nthr_sub == balancer_.nthr_per_subgroup_
+        ? drv_sub_[0] : drv_sub_[1];
+
+    /* subgroup master of subgroup 0 is the group master (writes to dst), all
+     * the others keep partial results in the workspace */
+    const int ithr_sub_master = ithr - balancer_.id_in_subgroup(ithr);
+    data_t *d = get_local_ptr(ithr_sub_master, dst);
+    const data_t *wspace = get_local_ptr(ithr_sub_master + 1, dst);
+    const size_t reduction_size
+        = (size_t)balancer_.ithr_njobs(ithr) * balancer_.job_size_;
+
+    reduce_1d_balanced<data_type>(drv, d, wspace, reduction_size, nthr_sub,
+            balancer_.id_in_subgroup(ithr));
+}
+
 template <impl::data_type_t data_type>
 void cpu_reducer_t<data_type>::reduce_nolock(int ithr, data_t *dst) {
     bool redundant_reduction = balancer_.nthr_per_group_ == 1
@@ -342,25 +438,18 @@ void cpu_reducer_t<data_type>::reduce_nolock(int ithr, data_t *dst) {
             d[i] += wspace[i];
     }
 #else
-    using namespace utils;
-
     const int id_in_grp = balancer_.id_in_group(ithr);
     const int njobs_in_grp = balancer_.ithr_njobs(ithr);
-    const size_t cl = 64 / sizeof(data_t);
 
+    /* subgroup masters only (for the flat reduction each thread forms a
+     * subgroup of its own) */
     const size_t reduction_size = njobs_in_grp * balancer_.job_size_;
-    size_t start{0}, end{0};
-    balance211(div_up(reduction_size, cl), balancer_.nthr_per_group_,
-            id_in_grp, start, end);
+    data_t *d = get_local_ptr(ithr - id_in_grp, dst);
+    const data_t *wspace = get_local_ptr(
+            ithr - id_in_grp + balancer_.nthr_per_subgroup_, dst);
 
-    if (start == end) return;
-
-    data_t *d = get_local_ptr(ithr - id_in_grp, dst) + start * cl;
-    const data_t *wspace = get_local_ptr(ithr - id_in_grp + 1, dst)
-        + start * cl;
-    const size_t len = nstl::min(end * cl, reduction_size) - start * cl;
-
-    (*drv_)(d, wspace, 1, len);
+    reduce_1d_balanced<data_type>(drv_, d, wspace, reduction_size,
+            balancer_.nthr_per_group_, id_in_grp);
 #endif
 }
 
@@ -377,17 +466,26 @@ cpu_reducer_2d_t<data_type>::cpu_reducer_2d_t(
     : balancer_(balancer), master_uses_dst_(master_uses_dst)
     , job_size_x_(job_size_x), job_size_y_(job_size_y), x_block_(x_block)
     , dst_x_(dst_x), dst_y_(dst_y), workspace_(nullptr), drv_(nullptr)
-    , barriers_(nullptr)
+    , drv_sub_{nullptr, nullptr}, barriers_(nullptr)
 {
+    /* hierarchical reduction assumes all the partial results are in the
+     * workspace */
+    if (master_uses_dst_) balancer_.nthr_per_subgroup_ = 1;
+
     allocate_workspace();
     if (balancer_.nthr_per_group_ > 1) {
         barriers_ = (simple_barrier::ctx_t *)malloc(
                 balancer_.ngroups_ * sizeof(simple_barrier::ctx_t), 64);
         for (int i = 0; i < balancer_.ngroups_; ++i)
             simple_barrier::ctx_init(&barriers_[i]);
-        const int n_src = balancer_.nthr_per_group_ - master_uses_dst_;
-        drv_ = create_reduce_2d_drv<data_type>(n_src, ws_per_thread(),
-                job_size_x_, dst_x_, !master_uses_dst_);
+        /* the final reduction accumulates subgroup masters only */
+        const int nthr_sub = balancer_.nthr_per_subgroup_;
+        const int n_src = balancer_.nsubgroups() - master_uses_dst_;
+        drv_ = create_reduce_2d_drv<data_type>(n_src,
+                nthr_sub * ws_per_thread(), job_size_x_, dst_x_,
+                !master_uses_dst_);
+        create_reduce_subgroup_drvs<data_type>(balancer_, ws_per_thread(),
+                drv_sub_);
     }
 }
 
@@ -396,6 +494,8 @@ cpu_reducer_2d_t<data_type>::~cpu_reducer_2d_t() {
     deallocate_workspace();
     free(barriers_);
     delete drv_;
+    delete drv_sub_[0];
+    delete drv_sub_[1];
 }
 
 template <impl::data_type_t data_type>
@@ -471,6 +571,28 @@ void cpu_reducer_2d_t<data_type>::reduce_block(const data_t* wspace_base,
 #endif
 }
 
+template <impl::data_type_t data_type>
+void cpu_reducer_2d_t<data_type>::reduce_subgroup_nolock(int ithr,
+        data_t *dst) {
+    const int sgrp = balancer_.subgroup_id(ithr);
+    const int nthr_sub = balancer_.subgrp_nthr(sgrp);
+    if (nthr_sub == 1) return;
+
+    auto drv = nthr_sub == balancer_.nthr_per_subgroup_
+        ? drv_sub_[0] : drv_sub_[1];
+
+    /* the jobs of a group are stored contiguously in the workspace, so the
+     * first level is a plain 1d reduction to the subgroup master buffer */
+    const int ithr_sub_master = ithr - balancer_.id_in_subgroup(ithr);
+    data_t *d = get_local_ptr(ithr_sub_master, dst);
+    const data_t *wspace = get_local_ptr(ithr_sub_master + 1, dst);
+    const size_t reduction_size
+        = (size_t)balancer_.ithr_njobs(ithr) * balancer_.job_size_;
+
+    reduce_1d_balanced<data_type>(drv, d, wspace, reduction_size, nthr_sub,
+            balancer_.id_in_subgroup(ithr));
+}
+
 template <impl::data_type_t data_type>
 void cpu_reducer_2d_t<data_type>::reduce_nolock(int ithr, data_t *dst) {
     bool redundant_reduction = balancer_.nthr_per_group_ == 1
@@ -59,6 +59,14 @@ namespace cpu {
  * different parts of the reduction dimension. Thread 0 in each group is called
  * master (@sa reduce_balancer_t::master()).
  *
+ * If the number of threads within a group is large the reduction becomes
+ * hierarchical: the threads of a group are further divided into subgroups of
+ * neighbouring threads (that are likely to share a core or a socket). First
+ * each subgroup reduces its partial results to the buffer of the subgroup
+ * master, and then the subgroup masters are reduced to the destination. This
+ * keeps most of the memory traffic local and limits the number of streams
+ * each thread accumulates at once (@sa reduce_balancer_t::hierarchical()).
+ *
  * TODO: if threading driver does not allow sync between sub-group of threads
  *       (e.g. Intel(R) TBB) enforce the # of thread per group to be 1
  */
@@ -76,6 +84,9 @@ struct reduce_balancer_t {
     int ngroups_; /** number of independent work (thread) groups */
     int nthr_per_group_; /** number of threads within a single work group */
     int njobs_per_group_ub_; /** the max # of jobs within a work group */
+    int nthr_per_subgroup_; /** number of threads reduced together at the
+                              first level of the hierarchical reduction,
+                              1 for the flat reduction */
 
     bool master(int ithr) const { return id_in_group(ithr) == 0; }
     bool idle(int ithr) const { return ithr >= nthr_per_group_ * ngroups_; }
@@ -95,11 +106,38 @@ struct reduce_balancer_t {
     int ithr_njobs(int ithr) const { return grp_njobs(group_id(ithr)); }
     int ithr_job_off(int ithr) const { return grp_job_off(group_id(ithr)); }
 
+    bool hierarchical() const { return nthr_per_subgroup_ > 1; }
+    int nsubgroups() const {
+        return (nthr_per_group_ + nthr_per_subgroup_ - 1) / nthr_per_subgroup_;
+    }
+    int subgroup_id(int ithr) const
+    { return id_in_group(ithr) / nthr_per_subgroup_; }
+    int id_in_subgroup(int ithr) const
+    { return id_in_group(ithr) % nthr_per_subgroup_; }
+    int subgrp_nthr(int sgrp) const {
+        return nstl::min(nthr_per_subgroup_,
+                nthr_per_group_ - sgrp * nthr_per_subgroup_);
+    }
+
+    /** appends the chosen reduction scheme to the verbose info of @p pd */
+    void add_info(primitive_desc_t *pd, const char *what) const;
+
 private:
     size_t max_buffer_size_;
     void balance();
 };
 
+/** returns the number of threads that should reduce together at the first
+ * level of a hierarchical reduction of @p nthr partial results, or 1 if the
+ * flat (single level) reduction is preferable */
+int reduce_subgroup_size(int nthr);
+
+/** appends the reduction scheme (@p ngroups independent groups of
+ * @p nthr_per_group threads, reduced in subgroups of @p nthr_per_subgroup
+ * threads) to the verbose info of @p pd; @p what names the reduced data */
+void add_reduction_info(primitive_desc_t *pd, const char *what, int ngroups,
+        int nthr_per_group, int nthr_per_subgroup);
+
 /** forward declaration of reduce driver */
 template <impl::data_type_t data_type> struct reducer_2d_driver_t;
 
@@ -181,6 +219,13 @@ struct cpu_reducer_t {
 
         simple_barrier::barrier(&barriers_[balancer_.group_id(ithr)],
                 balancer_.nthr_per_group_);
+#ifndef SIMPLE_IMPL
+        if (balancer_.hierarchical()) {
+            reduce_subgroup_nolock(ithr, dst);
+            simple_barrier::barrier(&barriers_[balancer_.group_id(ithr)],
+                    balancer_.nthr_per_group_);
+        }
+#endif
         reduce_nolock(ithr, dst);
     }
 
@@ -192,8 +237,10 @@ private:
 
     data_t *workspace_; /** data_t[nthr_][njobs_per_group_ub_][jobs_size_] */
     reducer_2d_driver_t<data_type> *drv_;
+    reducer_2d_driver_t<data_type> *drv_sub_[2]; /** full and tail subgroup */
     simple_barrier::ctx_t *barriers_; /** barrier::ctx_t[groups_] */
 
+    void reduce_subgroup_nolock(int ithr, data_t *dst);
     void reduce_nolock(int ithr, data_t *dst);
 };
 
@@ -230,6 +277,13 @@ struct cpu_reducer_2d_t {
 
         simple_barrier::barrier(&barriers_[balancer_.group_id(ithr)],
                 balancer_.nthr_per_group_);
+#ifndef SIMPLE_IMPL
+        if (balancer_.hierarchical()) {
+            reduce_subgroup_nolock(ithr, dst);
+            simple_barrier::barrier(&barriers_[balancer_.group_id(ithr)],
+                    balancer_.nthr_per_group_);
+        }
+#endif
         reduce_nolock(ithr, dst);
     }
 
@@ -244,8 +298,11 @@ private:
 
     data_t *workspace_; /** data_t[nthr_][njobs_per_group_ub_][jobs_size_] */
     reducer_2d_driver_t<data_type> *drv_;
+    reducer_2d_driver_t<data_type> *drv_sub_[2]; /** full and tail subgroup */
     simple_barrier::ctx_t *barriers_; /** barrier::ctx_t[groups_] */
 
+    void reduce_subgroup_nolock(int ithr, data_t *dst);
+
     int choose_x_blocking(int nx, int ny, int nthr_per_grp);
     void reduce_block(const data_t* wspace_base,
             data_t *dst, int job, int start_y, int start_x,
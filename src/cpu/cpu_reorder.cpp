@@ -119,6 +119,10 @@ static const rpd_create_f cpu_reorder_impl_list[] = {
     simple_reorder_t<f32, goihw, f32, Goihw8g, fmt_order::reverse>::pd_t::create,
     simple_reorder_t<f32, goihw, f32, Goihw16g, fmt_order::keep>::pd_t::create,
     simple_reorder_t<f32, goihw, f32, Goihw16g, fmt_order::reverse>::pd_t::create,
+    simple_reorder_t<f32, goihw, f32, GOihw2g4o, fmt_order::keep>::pd_t::create,
+    simple_reorder_t<f32, goihw, f32, GOihw2g4o, fmt_order::reverse>::pd_t::create,
+    simple_reorder_t<f32, goihw, f32, GOihw4g4o, fmt_order::keep>::pd_t::create,
+    simple_reorder_t<f32, goihw, f32, GOihw4g4o, fmt_order::reverse>::pd_t::create,
     simple_reorder_t<f32, any, f32, any, fmt_order::any, spec::reference>::pd_t::create,
     /* reorder with quantization */
     simple_reorder_t<f32, any, s32, any, fmt_order::any, spec::direct_copy>::pd_t::create,
@@ -230,6 +234,24 @@ static const rpd_create_f cpu_reorder_impl_list[] = {
     simple_reorder_t<u8,  nhwc, u8, nChw16c, fmt_order::reverse>::pd_t::create,
     simple_reorder_t<u8,  nhwc, f32, nChw16c, fmt_order::keep>::pd_t::create,
     simple_reorder_t<u8,  nhwc, f32, nChw16c, fmt_order::reverse>::pd_t::create,
+    /* bf16 <-> fp32 */
+    simple_reorder_t<f32, any, bf16, any, fmt_order::any, spec::direct_copy>::pd_t::create,
+    simple_reorder_t<bf16, any, f32, any, fmt_order::any, spec::direct_copy>::pd_t::create,
+    simple_reorder_t<bf16, any, bf16, any, fmt_order::any, spec::direct_copy>::pd_t::create,
+    simple_reorder_t<f32, nchw, bf16, nChw16c, fmt_order::keep>::pd_t::create,
+    simple_reorder_t<bf16, nchw, f32, nChw16c, fmt_order::reverse>::pd_t::create,
+    simple_reorder_t<f32, oihw, bf16, OIhw16i16o, fmt_order::keep>::pd_t::create,
+    simple_reorder_t<f32, goihw, bf16, gOIhw16i16o, fmt_order::keep>::pd_t::create,
+    simple_reorder_t<f32, any, bf16, any, fmt_order::any, spec::reference>::pd_t::create,
+    simple_reorder_t<bf16, any, f32, any, fmt_order::any, spec::reference>::pd_t::create,
+    simple_reorder_t<bf16, any, bf16, any, fmt_order::any, spec::reference>::pd_t::create,
+    /* f16 <-> fp32 */
+    simple_reorder_t<f32, any, f16, any, fmt_order::any, spec::direct_copy>::pd_t::create,
+    simple_reorder_t<f16, any, f32, any, fmt_order::any, spec::direct_copy>::pd_t::create,
+    simple_reorder_t<f16, any, f16, any, fmt_order::any, spec::direct_copy>::pd_t::create,
+    simple_reorder_t<f32, any, f16, any, fmt_order::any, spec::reference>::pd_t::create,
+    simple_reorder_t<f16, any, f32, any, fmt_order::any, spec::reference>::pd_t::create,
+    simple_reorder_t<f16, any, f16, any, fmt_order::any, spec::reference>::pd_t::create,
     /* s32 <-> fp32 */
     simple_reorder_t<f32, any, s32, any, fmt_order::any, spec::reference>::pd_t::create,
     simple_reorder_t<s32, any, f32, any, fmt_order::any, spec::reference>::pd_t::create,
@@ -43,6 +43,7 @@ struct cpu_rnn_fwd_pd_t : public rnn_fwd_pd_t {
         , bias_pd_(engine, &desc_.bias_desc)
         , dst_layer_pd_(engine, &desc_.dst_layer_desc)
         , dst_iter_pd_(engine, &desc_.dst_iter_desc)
+        , seq_lengths_pd_(engine, &desc_.seq_lengths_desc)
         , ws_pd_(engine_) {}
     virtual ~cpu_rnn_fwd_pd_t() {}
 
@@ -72,6 +73,9 @@ struct cpu_rnn_fwd_pd_t : public rnn_fwd_pd_t {
     virtual const cpu_memory_pd_t *workspace_pd(int index = 0) const override {
         return (index == 0 && !ws_pd_.is_zero()) ? &ws_pd_ : nullptr;
     }
+    virtual const cpu_memory_pd_t *seq_lengths_pd() const override {
+        return this->with_seq_lengths() ? &seq_lengths_pd_ : nullptr;
+    }
 
 protected:
     cpu_memory_pd_t src_layer_pd_;
@@ -81,6 +85,7 @@ protected:
     cpu_memory_pd_t bias_pd_;
     cpu_memory_pd_t dst_layer_pd_;
     cpu_memory_pd_t dst_iter_pd_;
+    cpu_memory_pd_t seq_lengths_pd_;
     cpu_memory_pd_t ws_pd_;
 
     virtual status_t set_default_params() {
@@ -101,6 +106,9 @@ protected:
             CHECK(bias_pd_.set_format(ldgo));
         if ((!dst_iter_pd_.is_zero()) && (dst_iter_pd_.desc()->format == any))
             CHECK(dst_iter_pd_.set_format(ldsnc));
+        if ((!seq_lengths_pd_.is_zero())
+                && (seq_lengths_pd_.desc()->format == any))
+            CHECK(seq_lengths_pd_.set_format(x));
 
         return status::success;
     }
@@ -126,6 +134,7 @@ struct cpu_rnn_bwd_pd_t : public rnn_bwd_pd_t {
         , diff_bias_pd_(engine, &desc_.diff_bias_desc)
         , diff_dst_layer_pd_(engine, &desc_.diff_dst_layer_desc)
         , diff_dst_iter_pd_(engine, &desc_.diff_dst_iter_desc)
+        , seq_lengths_pd_(engine, &desc_.seq_lengths_desc)
         , ws_pd_(engine_) {}
     virtual ~cpu_rnn_bwd_pd_t() {}
 
@@ -179,6 +188,9 @@ struct cpu_rnn_bwd_pd_t : public rnn_bwd_pd_t {
     virtual const cpu_memory_pd_t *workspace_pd(int index = 0) const override {
         return (index == 0 && !ws_pd_.is_zero()) ? &ws_pd_ : nullptr;
     }
+    virtual const cpu_memory_pd_t *seq_lengths_pd() const override {
+        return this->with_seq_lengths() ? &seq_lengths_pd_ : nullptr;
+    }
 
 protected:
     cpu_memory_pd_t src_layer_pd_;
@@ -195,6 +207,7 @@ protected:
     cpu_memory_pd_t diff_bias_pd_;
     cpu_memory_pd_t diff_dst_layer_pd_;
     cpu_memory_pd_t diff_dst_iter_pd_;
+    cpu_memory_pd_t seq_lengths_pd_;
     cpu_memory_pd_t ws_pd_;
 
     virtual status_t set_default_params() {
@@ -231,6 +244,9 @@ protected:
         if ((!diff_dst_iter_pd_.is_zero())
                 && (diff_dst_iter_pd_.desc()->format == any))
             CHECK(diff_dst_iter_pd_.set_format(ldsnc));
+        if ((!seq_lengths_pd_.is_zero())
+                && (seq_lengths_pd_.desc()->format == any))
+            CHECK(seq_lengths_pd_.set_format(x));
 
         return status::success;
     }
@@ -0,0 +1,232 @@
+/*******************************************************************************
+* Copyright 2018 Intel Corporation
+*
+* Licensed under the Apache License, Version 2.0 (the "License");
+* you may not use this file except in compliance with the License.
+* You may obtain a copy of the License at
+*
+*     http://www.apache.org/licenses/LICENSE-2.0
+*
+* Unless required by applicable law or agreed to in writing, software
+* distributed under the License is distributed on an "AS IS" BASIS,
+* WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+* See the License for the specific language governing permissions and
+* limitations under the License.
+*******************************************************************************/
+
+#include "mkldnn.h"
+
+#include "c_types_map.hpp"
+#include "math_utils.hpp"
+#include "mkldnn_thread.hpp"
+#include "nstl.hpp"
+#include "utils.hpp"
+
+#include "jit_avx2_gemm_f32.hpp"
+#include "jit_avx512_common_gemm_f32.hpp"
+#include "jit_sse42_gemm_f32.hpp"
+#include "os_blas.hpp"
+
+#include "gemm.hpp"
+
+namespace mkldnn {
+namespace impl {
+namespace cpu {
+
+using namespace mkldnn::impl::status;
+using namespace mkldnn::impl::alg_kind;
+using namespace mkldnn::impl::math;
+
+namespace {
+bool is_trans(char trans) { return trans == 'T' || trans == 't'; }
+
+bool eltwise_ok(alg_kind_t alg) {
+    return utils::one_of(alg, undef, eltwise_relu, eltwise_tanh, eltwise_elu,
+            eltwise_square, eltwise_abs, eltwise_sqrt, eltwise_linear,
+            eltwise_bounded_relu, eltwise_soft_relu, eltwise_logistic);
+}
+
+float eltwise_fwd(alg_kind_t alg, float s, float alpha, float beta) {
+    switch (alg) {
+    case eltwise_relu: return relu_fwd(s, alpha);
+    case eltwise_tanh: return tanh_fwd(s);
+    case eltwise_elu: return elu_fwd(s, alpha);
+    case eltwise_square: return square_fwd(s);
+    case eltwise_abs: return abs_fwd(s);
+    case eltwise_sqrt: return sqrt_fwd(s);
+    case eltwise_linear: return linear_fwd(s, alpha, beta);
+    case eltwise_bounded_relu: return bounded_relu_fwd(s, alpha);
+    case eltwise_soft_relu: return soft_relu_fwd(s);
+    case eltwise_logistic: return logistic_fwd(s);
+    default: assert(!"unknown eltwise alg_kind");
+    }
+    return s;
+}
+
+/* The JIT sgemm objects are created on first use and kept for the lifetime
+ * of the library: generating the kernels costs much more than a small
+ * sgemm. One object per transposition, beta (0, 1 or any other value), bias
+ * (none, per row, per column) and fused relu. The objects are reentrant. */
+template <typename gemm_t>
+gemm_t *get_jit_gemm(bool trans_a, bool trans_b, float beta, int bias_kind,
+        bool relu) {
+    static gemm_t *gemms[2][2][3][3][2];
+
+    const int beta_idx = beta == 0.f ? 0 : beta == 1.f ? 1 : 2;
+    gemm_t *gemm;
+#   pragma omp critical (mkldnn_extended_sgemm)
+    {
+        gemm_t *&g = gemms[trans_a][trans_b][beta_idx][bias_kind][relu];
+        if (g == nullptr)
+            g = new gemm_t(trans_a ? 'T' : 'N', trans_b ? 'T' : 'N', beta,
+                    bias_kind != 0, bias_kind == 2, relu);
+        gemm = g;
+    }
+    return gemm;
+}
+
+template <typename gemm_t>
+void jit_sgemm(bool trans_a, bool trans_b, const int *M, const int *N,
+        const int *K, const float *alpha, const float *A, const int *lda,
+        const float *B, const int *ldb, const float *beta, float *C,
+        const int *ldc, const float *bias, bool bias_per_col, bool relu,
+        int nthr) {
+    const int bias_kind = bias == nullptr ? 0 : bias_per_col ? 2 : 1;
+    gemm_t *gemm = get_jit_gemm<gemm_t>(trans_a, trans_b, *beta, bias_kind,
+            relu);
+    gemm->sgemm(trans_a ? "T" : "N", trans_b ? "T" : "N", M, N, K, alpha, A,
+            lda, B, ldb, beta, C, ldc, bias, nthr);
+}
+}
+
+status_t extended_sgemm(const char *transa, const char *transb,
+        const int *M, const int *N, const int *K, const float *alpha,
+        const float *A, const int *lda, const float *B, const int *ldb,
+        const float *beta, float *C, const int *ldc,
+        const float *bias, bool bias_per_col, alg_kind_t eltwise_alg,
+        float eltwise_alpha, float eltwise_beta, int nthr) {
+    if (utils::any_null(transa, transb, M, N, K, alpha, A, lda, B, ldb, beta,
+                C, ldc))
+        return invalid_arguments;
+
+    const bool trans_a = is_trans(*transa);
+    const bool trans_b = is_trans(*transb);
+    const int m = *M, n = *N, k = *K;
+    const bool args_ok = true
+        && utils::one_of(*transa, 'N', 'n', 'T', 't')
+        && utils::one_of(*transb, 'N', 'n', 'T', 't')
+        && m >= 0 && n >= 0 && k >= 0
+        && *lda >= nstl::max(1, trans_a ? k : m)
+        && *ldb >= nstl::max(1, trans_b ? n : k)
+        && *ldc >= nstl::max(1, m)
+        && eltwise_ok(eltwise_alg);
+    if (!args_ok)
+        return invalid_arguments;
+
+    if (m == 0 || n == 0)
+        return success;
+
+    /* like the gemm convolution, prefer the CBLAS sgemm when there is one */
+#ifdef USE_CBLAS
+    const bool jit_ok = false;
+#else
+    const bool jit_ok = mayiuse(sse42);
+    if (!jit_ok)
+        return unimplemented;
+#endif
+
+    /* the kernels add the bias to C only before any beta scaling is lost,
+     * i.e. for beta 0 or 1, and the relu needs the bias to be added first */
+    const bool fuse_bias = jit_ok && bias != nullptr
+        && utils::one_of(*beta, 0.f, 1.f);
+    const bool fuse_relu = jit_ok && eltwise_alg == eltwise_relu
+        && eltwise_alpha == 0.f && (bias == nullptr || fuse_bias);
+
+    if (jit_ok) {
+        const float *jit_bias = fuse_bias ? bias : nullptr;
+        if (mayiuse(avx512_common))
+            jit_sgemm<jit_avx512_common_gemm_f32>(trans_a, trans_b, M, N, K,
+                    alpha, A, lda, B, ldb, beta, C, ldc, jit_bias,
+                    bias_per_col, fuse_relu, nthr);
+        else if (mayiuse(avx2))
+            jit_sgemm<jit_avx2_gemm_f32>(trans_a, trans_b, M, N, K, alpha,
+                    A, lda, B, ldb, beta, C, ldc, jit_bias, bias_per_col,
+                    fuse_relu, nthr);
+        else
+            jit_sgemm<jit_sse42_gemm_f32>(trans_a, trans_b, M, N, K, alpha,
+                    A, lda, B, ldb, beta, C, ldc, jit_bias, bias_per_col,
+                    fuse_relu, nthr);
+    } else {
+        cblas_sgemm(CblasColMajor, trans_a ? CblasTrans : CblasNoTrans,
+                trans_b ? CblasTrans : CblasNoTrans, m, n, k, *alpha, A, *lda,
+                B, *ldb, *beta, C, *ldc);
+    }
+
+    const bool post_bias = bias != nullptr && !fuse_bias;
+    const bool post_eltwise = eltwise_alg != undef && !fuse_relu;
+    if (!post_bias && !post_eltwise)
+        return success;
+
+    const int ld = *ldc;
+    const int nthr_post = nthr > 0 ? nthr : omp_get_max_threads();
+#   pragma omp parallel for schedule(static) num_threads(nthr_post)
+    for (int j = 0; j < n; ++j) {
+        float *c = &C[(size_t)j * ld];
+        for (int i = 0; i < m; ++i) {
+            float d = c[i];
+            if (post_bias)
+                d += bias[bias_per_col ? j : i];
+            if (post_eltwise)
+                d = eltwise_fwd(eltwise_alg, d, eltwise_alpha, eltwise_beta);
+            c[i] = d;
+        }
+    }
+
+    return success;
+}
+
+}
+}
+}
+
+using namespace mkldnn::impl;
+using namespace mkldnn::impl::cpu;
+
+mkldnn_status_t mkldnn_sgemm(const char *transa, const char *transb,
+        const int *M, const int *N, const int *K, const float *alpha,
+        const float *A, const int *lda, const float *B, const int *ldb,
+        const float *beta, float *C, const int *ldc) {
+    return extended_sgemm(transa, transb, M, N, K, alpha, A, lda, B, ldb,
+            beta, C, ldc);
+}
+
+mkldnn_status_t mkldnn_sgemm_ex(char layout, char transa, char transb,
+        int M, int N, int K, float alpha, const float *A, int lda,
+        const float *B, int ldb, float beta, float *C, int ldc,
+        char bias_kind, const float *bias, mkldnn_alg_kind_t eltwise_alg,
+        float eltwise_alpha, float eltwise_beta, int nthr) {
+    const bool args_ok = true
+        && utils::one_of(layout, 'C', 'c', 'R', 'r')
+        && utils::one_of(bias_kind, 'N', 'n', 'R', 'r', 'C', 'c')
+        && utils::implication(!utils::one_of(bias_kind, 'N', 'n'),
+                bias != nullptr)
+        && nthr >= 0;
+    if (!args_ok)
+        return status::invalid_arguments;
+
+    const float *b = utils::one_of(bias_kind, 'N', 'n') ? nullptr : bias;
+    const bool per_col = utils::one_of(bias_kind, 'C', 'c');
+
+    if (utils::one_of(layout, 'C', 'c'))
+        return extended_sgemm(&transa, &transb, &M, &N, &K, &alpha, A, &lda,
+                B, &ldb, &beta, C, &ldc, b, per_col, eltwise_alg,
+                eltwise_alpha, eltwise_beta, nthr);
+
+    /* row major C is the column major C**T = op(B)**T * op(A)**T, whose
+     * rows are the columns of C */
+    return extended_sgemm(&transb, &transa, &N, &M, &K, &alpha, B, &ldb,
+            A, &lda, &beta, C, &ldc, b, !per_col, eltwise_alg, eltwise_alpha,
+            eltwise_beta, nthr);
+}
+
+// vim: et ts=4 sw=4 cindent cino^=l0,\:0,N-s
@@ -0,0 +1,50 @@
+/*******************************************************************************
+* Copyright 2018 Intel Corporation
+*
+* Licensed under the Apache License, Version 2.0 (the "License");
+* you may not use this file except in compliance with the License.
+* You may obtain a copy of the License at
+*
+*     http://www.apache.org/licenses/LICENSE-2.0
+*
+* Unless required by applicable law or agreed to in writing, software
+* distributed under the License is distributed on an "AS IS" BASIS,
+* WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+* See the License for the specific language governing permissions and
+* limitations under the License.
+*******************************************************************************/
+
+#ifndef CPU_GEMM_HPP
+#define CPU_GEMM_HPP
+
+#include "c_types_map.hpp"
+
+namespace mkldnn {
+namespace impl {
+namespace cpu {
+
+/* Column major sgemm with an epilogue:
+ *     C = eltwise(alpha * op(A) * op(B) + beta * C + bias)
+ * bias has M elements (one per row of C) or, if bias_per_col is set, N
+ * elements (one per column of C); eltwise_alg == alg_kind::undef means no
+ * eltwise. The Intel MKL or CBLAS sgemm is used when the library is built
+ * with one, the JIT sgemm otherwise. The JIT sgemm adds the bias and applies
+ * a relu with zero negative slope in registers when C is written; whatever
+ * is not fused (a bias with beta other than 0 and 1, other eltwise
+ * algorithms, any epilogue of the CBLAS sgemm) is applied by one more pass
+ * over C. At most nthr threads are used, 0 means all of them. */
+status_t extended_sgemm(const char *transa, const char *transb,
+        const int *M, const int *N, const int *K, const float *alpha,
+        const float *A, const int *lda, const float *B, const int *ldb,
+        const float *beta, float *C, const int *ldc,
+        const float *bias = nullptr, bool bias_per_col = false,
+        alg_kind_t eltwise_alg = alg_kind::undef, float eltwise_alpha = 0.f,
+        float eltwise_beta = 0.f, int nthr = 0);
+
+}
+}
+}
+
+#endif
+
+// vim: et ts=4 sw=4 cindent cino^=l0,\:0,N-s
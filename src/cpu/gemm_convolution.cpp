@@ -33,7 +33,30 @@ using namespace mkldnn::impl::memory_format;
 using namespace mkldnn::impl::utils;
 
 template <bool with_relu, bool run_jit, cpu_isa_t isa>
-void _gemm_convolution_fwd_t<with_relu, run_jit, isa>::execute_forward() {
+void _gemm_convolution_fwd_t<with_relu, run_jit, isa>::post_process(
+        data_t *C, const data_t *bias, int os_len) const {
+    const jit_gemm_conv_conf_t &jcp = this->conf_.jcp_;
+    const int M = jcp.os * jcp.od;
+    const bool do_bias = jcp.with_bias && !run_jit;
+    const bool do_relu = this->do_relu_ && !this->fused_relu_;
+    if (!do_bias && !do_relu)
+        return;
+
+    data_t *d = C, b = 0.0;
+    for (int oc = 0; oc < jcp.oc; ++oc) {
+        if (do_bias) b = bias[oc];
+        for (int oS = 0; oS < os_len; ++oS) {
+            if (do_bias) d[oS] += b;
+            if (do_relu && d[oS] < 0)
+                d[oS] *= this->nslope_;
+        }
+        d += M;
+    }
+}
+
+template <bool with_relu, bool run_jit, cpu_isa_t isa>
+void _gemm_convolution_fwd_t<with_relu, run_jit, isa>
+        ::execute_forward_batch_groups() {
     auto src = reinterpret_cast<const data_t *>(this->input_memory(0));
     auto weights = reinterpret_cast<const data_t *>(this->input_memory(1));
     auto bias = reinterpret_cast<const data_t *>(this->input_memory(2));
@@ -45,25 +68,68 @@ void _gemm_convolution_fwd_t<with_relu, run_jit, isa>::execute_forward() {
     const size_t src_step = jcp.ic * jcp.ih * jcp.iw * jcp.id;
     const size_t dst_step = jcp.oc * M;
     const size_t weights_g_size = jcp.ic * jcp.oc * jcp.ks;
+    const size_t col_g_size = (size_t)jcp.ic * jcp.ks * jcp.os_block;
 
     const int K = jcp.ic * jcp.ks;
     const int N = jcp.oc;
     const int m = jcp.os;
-    const int LDA = jcp.need_im2col ? m : M;
-
-    const auto &post_ops = conf_.attr()->post_ops_;
-
-    float nslope = jcp.with_relu ? jcp.relu_negative_slope : 0.f;
-    int entry_idx = -1;
-    for (int idx = 0; idx < post_ops.len_; ++idx) {
-        const auto &e = post_ops.entry_[idx];
-        if (e.is_relu(true, false)) {
-            entry_idx = idx;
-            nslope = post_ops.entry_[entry_idx].eltwise.alpha;
-            break;
+    const int os_block = jcp.need_im2col ? jcp.os_block : m;
+
+    const data_t one = 1.0;
+
+    for (int n = 0; n < jcp.mb; ++n)
+    for (int od = 0; od < jcp.od; ++od)
+    for (int os_start = 0; os_start < m; os_start += os_block) {
+        const int os_len = nstl::min(os_block, m - os_start);
+        const int LDA = jcp.need_im2col ? os_len : M;
+
+        for (int g = 0; g < jcp.ngroups; ++g) {
+            const data_t *_src = src + (n * jcp.ngroups + g) * src_step;
+            data_t *_dst = dst + (n * jcp.ngroups + g) * dst_step;
+            const data_t *A = _src + od * m + os_start;
+            if (jcp.need_im2col) {
+                data_t *_col = this->col_ + g * col_g_size;
+                jit_gemm_convolution_utils::im2col_tile(jcp, _src, _col,
+                        od, os_start, os_len);
+                A = _col;
+            }
+            gemm_a_[g] = A;
+            gemm_b_[g] = weights + g * weights_g_size;
+            gemm_bias_[g] = jcp.with_bias ? bias + g * jcp.oc : nullptr;
+            gemm_c_[g] = _dst + od * m + os_start;
         }
+
+        sgemm_->sgemm_batch("N", "N", &os_len, &N, &K, &one, gemm_a_, &LDA,
+                gemm_b_, &K, &this->beta_, gemm_c_, &M, jcp.ngroups,
+                jcp.with_bias ? gemm_bias_ : nullptr);
+
+        for (int g = 0; g < jcp.ngroups; ++g)
+            post_process(gemm_c_[g], gemm_bias_[g], os_len);
     }
-    const bool do_relu = jcp.with_relu || entry_idx >= 0;
+}
+
+template <bool with_relu, bool run_jit, cpu_isa_t isa>
+void _gemm_convolution_fwd_t<with_relu, run_jit, isa>::execute_forward() {
+    if (this->batch_groups_) {
+        execute_forward_batch_groups();
+        return;
+    }
+
+    auto src = reinterpret_cast<const data_t *>(this->input_memory(0));
+    auto weights = reinterpret_cast<const data_t *>(this->input_memory(1));
+    auto bias = reinterpret_cast<const data_t *>(this->input_memory(2));
+    auto dst = reinterpret_cast<data_t*>(this->memory());
+
+    jit_gemm_conv_conf_t &jcp = this->conf_.jcp_;
+
+    const int M = jcp.os * jcp.od;
+    const size_t src_step = jcp.ic * jcp.ih * jcp.iw * jcp.id;
+    const size_t dst_step = jcp.oc * M;
+    const size_t weights_g_size = jcp.ic * jcp.oc * jcp.ks;
+
+    const int K = jcp.ic * jcp.ks;
+    const int N = jcp.oc;
+    const int m = jcp.os;
 
     const data_t one = 1.0;
 
@@ -73,7 +139,8 @@ void _gemm_convolution_fwd_t<with_relu, run_jit, isa>::execute_forward() {
         const int ithr = omp_get_thread_num();
         const int nthr = omp_get_num_threads();
 
-        data_t *_col = this->col_ + (size_t)ithr * jcp.ic * jcp.ks * jcp.os;
+        data_t *_col = this->col_
+            + (size_t)ithr * jcp.ic * jcp.ks * jcp.os_block;
 
         int g{0}, n{0}, od{0};
         size_t start = 0, end = 0;
@@ -86,35 +153,33 @@ void _gemm_convolution_fwd_t<with_relu, run_jit, isa>::execute_forward() {
             const data_t *_weights = weights + g * weights_g_size;
             data_t *_dst = dst + (n * jcp.ngroups + g) * dst_step;
 
-            if (jcp.need_im2col)
-            {
-                if (jcp.id == 1)
-                    jit_gemm_convolution_utils::im2col(jcp, _src, _col);
-                else
-                    jit_gemm_convolution_utils::im2col_3d(jcp, _src, _col, od);
-            }
-
-            if (run_jit) {
-                sgemm_->sgemm("N", "N", &m, &N, &K, &one,
-                    jcp.need_im2col ? _col : _src + od * m, &LDA, _weights, &K,
-                    &this->beta_, _dst + od * m, &M);
-            } else {
-                cblas_sgemm(CblasColMajor, CblasNoTrans, CblasNoTrans, m, N,
-                    K, one, jcp.need_im2col ? _col : _src + od * m, LDA,
-                    _weights, K, this->beta_, _dst + od * m, M);
-            }
+            /* with im2col the spatial dimension is processed by tiles of
+             * os_block points, so that the column buffer written by
+             * im2col_tile() is still in cache when sgemm reads it */
+            const int os_block = jcp.need_im2col ? jcp.os_block : m;
+            for (int os_start = 0; os_start < m; os_start += os_block) {
+                const int os_len = nstl::min(os_block, m - os_start);
+                const int LDA = jcp.need_im2col ? os_len : M;
+                const data_t *A = _src + od * m + os_start;
+                if (jcp.need_im2col) {
+                    jit_gemm_convolution_utils::im2col_tile(jcp, _src, _col,
+                            od, os_start, os_len);
+                    A = _col;
+                }
+                data_t *C = _dst + od * m + os_start;
 
-            if (jcp.with_bias || do_relu) {
-                data_t *d = _dst + od * m, b = 0.0;
-                for (int oc = 0; oc < jcp.oc; ++oc) {
-                    if(jcp.with_bias) b = bias[g * jcp.oc + oc];
-                    for (int oS = 0; oS < m; ++oS) {
-                        if (jcp.with_bias) d[oS] += b;
-                        if (do_relu && d[oS] < 0)
-                            d[oS] *= nslope;
-                    }
-                    d += M;
+                if (run_jit) {
+                    sgemm_->sgemm("N", "N", &os_len, &N, &K, &one, A, &LDA,
+                        _weights, &K, &this->beta_, C, &M,
+                        jcp.with_bias ? bias + g * jcp.oc : nullptr);
+                } else {
+                    cblas_sgemm(CblasColMajor, CblasNoTrans, CblasNoTrans,
+                        os_len, N, K, one, A, LDA, _weights, K, this->beta_,
+                        C, M);
                 }
+
+                post_process(C, jcp.with_bias ? bias + g * jcp.oc : nullptr,
+                        os_len);
             }
             nd_iterator_step(g, jcp.ngroups, n, jcp.mb, od, jcp.od);
         }
@@ -311,17 +376,21 @@ void _gemm_convolution_bwd_weights_t<run_jit, isa>::execute_backward_weights() {
 
 template struct _gemm_convolution_fwd_t<true, true, avx512_common>;
 template struct _gemm_convolution_fwd_t<true, true, avx2>;
+template struct _gemm_convolution_fwd_t<true, true, sse42>;
 template struct _gemm_convolution_fwd_t<false, true, avx512_common>;
 template struct _gemm_convolution_fwd_t<false, true, avx2>;
+template struct _gemm_convolution_fwd_t<false, true, sse42>;
 template struct _gemm_convolution_fwd_t<true, false, isa_any>;
 template struct _gemm_convolution_fwd_t<false, false, isa_any>;
 
 template struct _gemm_convolution_bwd_data_t<true, avx512_common>;
 template struct _gemm_convolution_bwd_data_t<true, avx2>;
+template struct _gemm_convolution_bwd_data_t<true, sse42>;
 template struct _gemm_convolution_bwd_data_t<false, isa_any>;
 
 template struct _gemm_convolution_bwd_weights_t<true, avx512_common>;
 template struct _gemm_convolution_bwd_weights_t<true, avx2>;
+template struct _gemm_convolution_bwd_weights_t<true, sse42>;
 template struct _gemm_convolution_bwd_weights_t<false, isa_any>;
 
 }
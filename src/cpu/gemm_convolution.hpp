@@ -21,6 +21,7 @@
 #include "cpu_convolution_pd.hpp"
 #include "cpu_engine.hpp"
 #include "jit_avx2_gemm_f32.hpp"
+#include "jit_sse42_gemm_f32.hpp"
 #include "jit_avx512_common_gemm_f32.hpp"
 #include "jit_primitive_conf.hpp"
 #include "gemm_convolution_utils.hpp"
@@ -135,7 +136,8 @@ struct _gemm_convolution_fwd_t: public cpu_primitive_t {
     _gemm_convolution_fwd_t(const pd_t *pd, const input_vector &inputs,
            const output_vector &outputs)
         : cpu_primitive_t(&conf_, inputs, outputs), conf_(*pd), sgemm_(nullptr)
-        , col_(nullptr)
+        , col_(nullptr), batch_groups_(false), gemm_a_(nullptr)
+        , gemm_b_(nullptr), gemm_bias_(nullptr), gemm_c_(nullptr)
     {
         using namespace prop_kind;
 
@@ -143,25 +145,61 @@ struct _gemm_convolution_fwd_t: public cpu_primitive_t {
         const data_t one = 1.0, zero = 0.0;
         beta_ = post_ops.find(primitive_kind::sum) >= 0 ? one : zero;
 
-        if (run_jit)
-            sgemm_ = new jit_uni_gemm_f32('N', 'N', beta_, false);
-
         jit_gemm_convolution_utils::init_conf(conf_.jcp_,
             *(conf_.cdesc()), conf_.src_pd(), conf_.weights_pd(0),
             conf_.dst_pd(), with_relu, conf_.negative_slope());
 
+        const auto &jcp = conf_.jcp_;
+        nslope_ = jcp.with_relu ? jcp.relu_negative_slope : 0.f;
+        int entry_idx = -1;
+        for (int idx = 0; idx < post_ops.len_; ++idx) {
+            const auto &e = post_ops.entry_[idx];
+            if (e.is_relu(true, false)) {
+                entry_idx = idx;
+                nslope_ = post_ops.entry_[entry_idx].eltwise.alpha;
+                break;
+            }
+        }
+        do_relu_ = jcp.with_relu || entry_idx >= 0;
+
+        /* the jit sgemm adds the bias (one value per column of the output
+         * tile, i.e. per output channel) and applies a relu with zero
+         * negative slope when it writes the output */
+        fused_relu_ = run_jit && do_relu_ && nslope_ == 0.f;
+        if (run_jit)
+            sgemm_ = new jit_uni_gemm_f32('N', 'N', beta_, jcp.with_bias,
+                    true, fused_relu_);
+
         nthr_ = this->conf_.jcp_.os / omp_get_max_threads() < 512 &&
                 utils::implication(this->conf_.jcp_.od == 1,
                 (this->conf_.jcp_.mb != 1 || this->conf_.jcp_.ngroups > 2)) ?
                 omp_get_max_threads() : 1;
 
+        /* when the convolution is too small to be split between the threads
+         * by groups and images, the sgemms of all the groups are issued as
+         * one batch so that they run side by side, each on a part of the
+         * threads; every group then needs its own im2col buffer */
+        batch_groups_ = run_jit && nthr_ == 1 && jcp.ngroups > 1
+            && omp_get_max_threads() > 1;
+        if (batch_groups_) {
+            gemm_a_ = new const data_t *[jcp.ngroups];
+            gemm_b_ = new const data_t *[jcp.ngroups];
+            gemm_bias_ = new const data_t *[jcp.ngroups];
+            gemm_c_ = new data_t *[jcp.ngroups];
+        }
+
+        jit_gemm_convolution_utils::init_os_block(this->conf_.jcp_, nthr_);
         jit_gemm_convolution_utils::prepare_ws_col<data_t>(this->conf_.jcp_,
-                &this->col_, nthr_);
+                &this->col_, batch_groups_ ? jcp.ngroups : nthr_);
     }
 
     ~_gemm_convolution_fwd_t() {
         if (run_jit) delete sgemm_;
         free(this->col_);
+        delete [] gemm_a_;
+        delete [] gemm_b_;
+        delete [] gemm_bias_;
+        delete [] gemm_c_;
     };
 
     typedef typename prec_traits<data_type::f32>::type data_t;
@@ -173,13 +211,21 @@ struct _gemm_convolution_fwd_t: public cpu_primitive_t {
 
 private:
     void execute_forward();
+    void execute_forward_batch_groups();
+    void post_process(data_t *C, const data_t *bias, int os_len) const;
     pd_t conf_;
-    using jit_uni_gemm_f32 = typename utils::conditional
-          <isa == avx2, jit_avx2_gemm_f32, jit_avx512_common_gemm_f32>::type;
+    using jit_uni_gemm_f32 = typename utils::conditional3
+          <isa == sse42, jit_sse42_gemm_f32, isa == avx2, jit_avx2_gemm_f32,
+          jit_avx512_common_gemm_f32>::type;
     jit_uni_gemm_f32 *sgemm_;
     data_t *col_;
     data_t beta_;
+    data_t nslope_;
+    bool do_relu_, fused_relu_;
     int nthr_;
+    bool batch_groups_;
+    const data_t **gemm_a_, **gemm_b_, **gemm_bias_;
+    data_t **gemm_c_;
 };
 
 using jit_avx512_common_gemm_convolution_fwd_t =
@@ -188,8 +234,12 @@ using jit_avx512_common_gemm_convolution_relu_t =
                          _gemm_convolution_fwd_t<true, true, avx512_common>;
 using jit_avx2_gemm_convolution_fwd_t =
                          _gemm_convolution_fwd_t<false, true, avx2>;
+using jit_sse42_gemm_convolution_fwd_t =
+                         _gemm_convolution_fwd_t<false, true, sse42>;
 using jit_avx2_gemm_convolution_relu_t =
                          _gemm_convolution_fwd_t<true, true, avx2>;
+using jit_sse42_gemm_convolution_relu_t =
+                         _gemm_convolution_fwd_t<true, true, sse42>;
 using mkl_gemm_convolution_fwd_t =
                          _gemm_convolution_fwd_t<false, false, isa_any>;
 using mkl_gemm_convolution_relu_t =
@@ -303,8 +353,9 @@ struct _gemm_convolution_bwd_data_t: public cpu_primitive_t {
 private:
     void execute_backward_data();
     pd_t conf_;
-    using jit_uni_gemm_f32 = typename utils::conditional
-          <isa == avx2, jit_avx2_gemm_f32, jit_avx512_common_gemm_f32>::type;
+    using jit_uni_gemm_f32 = typename utils::conditional3
+          <isa == sse42, jit_sse42_gemm_f32, isa == avx2, jit_avx2_gemm_f32,
+          jit_avx512_common_gemm_f32>::type;
     jit_uni_gemm_f32 *sgemm_;
     data_t *col_;
     int nthr_;
@@ -314,6 +365,8 @@ using jit_avx512_common_gemm_convolution_bwd_data_t =
                          _gemm_convolution_bwd_data_t<true, avx512_common>;
 using jit_avx2_gemm_convolution_bwd_data_t =
                          _gemm_convolution_bwd_data_t<true, avx2>;
+using jit_sse42_gemm_convolution_bwd_data_t =
+                         _gemm_convolution_bwd_data_t<true, sse42>;
 using mkl_gemm_convolution_bwd_data_t =
                          _gemm_convolution_bwd_data_t<false, isa_any>;
 
@@ -439,8 +492,9 @@ struct _gemm_convolution_bwd_weights_t: public cpu_primitive_t {
 private:
     void execute_backward_weights();
     pd_t conf_;
-    using jit_uni_gemm_f32 = typename utils::conditional
-          <isa == avx2, jit_avx2_gemm_f32, jit_avx512_common_gemm_f32>::type;
+    using jit_uni_gemm_f32 = typename utils::conditional3
+          <isa == sse42, jit_sse42_gemm_f32, isa == avx2, jit_avx2_gemm_f32,
+          jit_avx512_common_gemm_f32>::type;
     jit_uni_gemm_f32 *sgemm_0, *sgemm_1;
     data_t *col_, *wei_reduction_;
     int nthr_;
@@ -450,6 +504,8 @@ using jit_avx512_common_gemm_convolution_bwd_weights_t =
                          _gemm_convolution_bwd_weights_t<true, avx512_common>;
 using jit_avx2_gemm_convolution_bwd_weights_t =
                          _gemm_convolution_bwd_weights_t<true, avx2>;
+using jit_sse42_gemm_convolution_bwd_weights_t =
+                         _gemm_convolution_bwd_weights_t<true, sse42>;
 using mkl_gemm_convolution_bwd_weights_t =
                          _gemm_convolution_bwd_weights_t<false, isa_any>;
 
@@ -20,6 +20,7 @@
 #include "utils.hpp"
 #include "type_helpers.hpp"
 #include "gemm_convolution_utils.hpp"
+#include "jit_generator.hpp"
 
 namespace mkldnn {
 namespace impl {
@@ -201,6 +202,51 @@ void im2col(
     }
 }
 
+/* col[ic][kd][kh][kw][os_block] <-- im[ic][id][ih][iw] for the output
+ * points [os_start, os_start + os_block) of the plane od. Unlike im2col()
+ * the padded points are zeroed here, as their position within the tile
+ * changes from one tile to another */
+void im2col_tile(jit_gemm_conv_conf_t &jcp, const float *im, float *col,
+        int od, int os_start, int os_block) {
+    const size_t im_step = jcp.ih * jcp.iw * jcp.id;
+    const size_t col_step = jcp.ks * os_block;
+    const int oh_start = os_start / jcp.ow;
+    const int oh_end = (os_start + os_block - 1) / jcp.ow + 1;
+
+    #pragma omp parallel for
+    for (int ic = 0; ic < jcp.ic; ++ic) {
+        const float *im_loc = im + ic * im_step;
+        float *col_ = col + ic * col_step;
+        for (int kd = 0; kd < jcp.kd; ++kd) {
+        const int id = od * jcp.stride_d - jcp.f_pad + kd * (1 + jcp.dilate_d);
+        const bool id_pad = id < 0 || id >= jcp.id;
+        const float *im_ = im_loc + id * jcp.ih * jcp.iw;
+        for (int kh = 0; kh < jcp.kh; ++kh) {
+        for (int kw = 0; kw < jcp.kw; ++kw) {
+            for (int oh = oh_start; oh < oh_end; ++oh) {
+                const int ow_s = oh == oh_start ? os_start % jcp.ow : 0;
+                const int ow_e = nstl::min(jcp.ow,
+                        os_start + os_block - oh * jcp.ow);
+                float *col_row = col_ + oh * jcp.ow - os_start;
+                const int ih = oh * jcp.stride_h - jcp.t_pad
+                    + kh * (1 + jcp.dilate_h);
+                if (id_pad || ih < 0 || ih >= jcp.ih) {
+                    for (int ow = ow_s; ow < ow_e; ++ow)
+                        col_row[ow] = 0.f;
+                    continue;
+                }
+                const float *im_row = im_ + ih * jcp.iw;
+                for (int ow = ow_s; ow < ow_e; ++ow) {
+                    const int iw = ow * jcp.stride_w - jcp.l_pad
+                        + kw * (1 + jcp.dilate_w);
+                    col_row[ow] = (iw < 0 || iw >= jcp.iw) ? 0.f : im_row[iw];
+                }
+            }
+            col_ += os_block;
+        }}}
+    }
+}
+
 /* col[oh][ow][kh][kw][ic] <-- im2col_u8(im[ih][iw][ic]) */
 void im2col_u8(
     jit_gemm_conv_conf_t &jcp, const uint8_t *im, uint8_t *col) {
@@ -212,15 +258,19 @@ void im2col_u8(
             for (int kh = 0; kh < jcp.kh; ++kh) {
                 const int ih = oh * jcp.stride_h
                     - jcp.t_pad + kh * (1 + jcp.dilate_h);
-                if (ih < 0 || ih >= jcp.ih) continue;
 
                 for (int kw = 0; kw < jcp.kw; ++kw) {
                     const int iw = ow * jcp.stride_w
                         - jcp.l_pad + kw * (1 + jcp.dilate_w);
-                    if (iw < 0 || iw >= jcp.iw) continue;
 
                     const size_t col_idx = (((oh * jcp.ow + ow) * jcp.kh + kh)
                             * jcp.kw + kw) * jcp.ic;
+                    if (ih < 0 || ih >= jcp.ih || iw < 0 || iw >= jcp.iw) {
+                        /* col is reused, so the padding has to be written */
+                        for (int ic = 0; ic < jcp.ic; ++ic)
+                            col[col_idx + ic] = 0;
+                        continue;
+                    }
                     const size_t im_idx
                         = (ih * jcp.iw + iw) * jcp.ngroups * jcp.ic;
 
@@ -364,6 +414,24 @@ void init_conf(
     jcp.ks = jcp.kh * jcp.kw * jcp.kd;
     jcp.need_im2col = !(jcp.oh == jcp.ih && jcp.ow == jcp.iw
         && jcp.od == jcp.id && jcp.ks == 1);
+    jcp.os_block = jcp.os;
+}
+
+void init_os_block(jit_gemm_conv_conf_t &jcp, int nthr) {
+    if (!jcp.need_im2col)
+        return;
+
+    /* the im2col tile is written right before the sgemm reads it, so keep
+     * it in L2: half of the L2 of each thread sharing the tile. Too narrow
+     * tiles make sgemm inefficient, hence the lower bound */
+    const int min_os_block = 64;
+    const int nthr_per_tile = nthr == 1 ? omp_get_max_threads() : 1;
+    const size_t L2_capacity = get_cache_size(2, true) / 2 * nthr_per_tile;
+    const size_t tile_point_sz = sizeof(float) * jcp.ic * jcp.ks;
+    const int os_block = (int)(L2_capacity / tile_point_sz);
+
+    jcp.os_block = nstl::min(jcp.os, nstl::max(min_os_block,
+                utils::rnd_dn(os_block, 16)));
 }
 
 template <typename src_t>
@@ -372,7 +440,7 @@ status_t prepare_ws_col(jit_gemm_conv_conf_t &jcp, src_t **col, const int nthr)
         *col = nullptr;
         return status::success;
     }
-    const size_t im2col_sz_per_thr = jcp.os * jcp.ks * jcp.ic;
+    const size_t im2col_sz_per_thr = jcp.os_block * jcp.ks * jcp.ic;
     const size_t im2col_sz = nthr * im2col_sz_per_thr;
     *col = (src_t *)malloc(im2col_sz * sizeof(src_t), 64);
     if (*col == nullptr) return status::out_of_memory;
@@ -32,6 +32,8 @@ namespace jit_gemm_convolution_utils {
     void im2col_3d (jit_gemm_conv_conf_t &jcp, const float *im, float *col,
         int od);
     void im2col (jit_gemm_conv_conf_t &jcp, const float *im, float *col);
+    void im2col_tile(jit_gemm_conv_conf_t &jcp, const float *im, float *col,
+        int od, int os_start, int os_block);
     void im2col_u8(jit_gemm_conv_conf_t &jcp, const uint8_t *im, uint8_t *col);
     void col2im_3d (jit_gemm_conv_conf_t &jcp, const float *col, float *im,
         int od);
@@ -42,6 +44,8 @@ namespace jit_gemm_convolution_utils {
         const memory_desc_wrapper &weights_d, const memory_desc_wrapper &dst_d,
         bool with_relu = false, float relu_negative_slope = -1.0);
 
+    void init_os_block(jit_gemm_conv_conf_t &jcp, int nthr);
+
     template <typename src_t>
     status_t prepare_ws_col(jit_gemm_conv_conf_t &jcp, src_t **col,
             const int nthr);
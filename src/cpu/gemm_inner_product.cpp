@@ -18,6 +18,7 @@
 #include "type_helpers.hpp"
 #include "mkldnn_thread.hpp"
 
+#include "gemm.hpp"
 #include "gemm_inner_product.hpp"
 #include "os_blas.hpp"
 
@@ -61,18 +62,6 @@ inline void cblas_gemm<data_type::f32>(CBLAS_LAYOUT layout,
             M, N, K, alpha, A, lda, B, ldb, beta, C, ldc);
 }
 
-template <data_type_t data_type>
-inline void cblas_axpy(cblas_int N,
-        data_t<data_type> alpha, const data_t<data_type> *X, cblas_int incx,
-        data_t<data_type> *Y, cblas_int incy);
-
-template <>
-inline void cblas_axpy<data_type::f32>(cblas_int N,
-        float alpha, const float *X, cblas_int incx,
-        float *Y, cblas_int incy) {
-    cblas_saxpy(N, alpha, X, incx, Y, incy);
-}
-
 }
 #endif
 
@@ -90,18 +79,20 @@ void gemm_inner_product_fwd_t<data_type>::execute_forward() {
     auto bias = reinterpret_cast<const data_t *>(this->input_memory(2));
     auto dst = reinterpret_cast<data_t*>(this->memory());
 
-    const memory_desc_wrapper dst_d(conf_.dst_pd());
     // TODO: consistency checks
-    const cblas_int MB = conf_.MB();
-    const cblas_int OC = conf_.OC();
-    const cblas_int IC = conf_.IC_total();
-
-    cblas_gemm<data_type>(CblasColMajor, CblasTrans, CblasNoTrans, OC, MB, IC,
-            1.0, weights, IC, src, IC, 0.0, dst, OC);
-    if (bias)
-#       pragma omp parallel for schedule(static)
-        for (cblas_int mb = 0; mb < MB; mb++)
-            cblas_axpy<data_type>(OC, 1.0, bias, 1, dst + dst_d.blk_off(mb), 1);
+    const int MB = conf_.MB();
+    const int OC = conf_.OC();
+    const int IC = conf_.IC_total();
+
+    /* the bias and the eltwise post-op are applied by the sgemm epilogue */
+    const auto &po = conf_.attr()->post_ops_;
+    const bool with_eltwise = po.len_ == 1;
+    const float one = 1.0, zero = 0.0;
+    extended_sgemm("T", "N", &OC, &MB, &IC, &one, weights, &IC, src, &IC,
+            &zero, dst, &OC, bias, false,
+            with_eltwise ? po.entry_[0].eltwise.alg : alg_kind::undef,
+            with_eltwise ? po.entry_[0].eltwise.alpha : 0.f,
+            with_eltwise ? po.entry_[0].eltwise.beta : 0.f);
 #endif
 }
 
@@ -66,12 +66,25 @@ struct gemm_inner_product_fwd_t: public cpu_primitive_t {
                 && memory_desc_wrapper(src_pd()).is_dense()
                 && memory_desc_wrapper(dst_pd()).is_dense()
                 && memory_desc_wrapper(weights_pd()).is_dense()
-                && attr()->has_default_values();
+                && attr()->output_scales_.has_default_values()
+                && post_ops_ok();
             return ok ? status::success : status::unimplemented;
 #else
             return status::unimplemented;
 #endif
         }
+
+    protected:
+        bool post_ops_ok() const {
+            using namespace primitive_kind;
+            auto const &po = attr()->post_ops_;
+            switch (po.len_) {
+            case 0: return true;
+            case 1: return po.entry_[0].kind == eltwise
+                    && po.entry_[0].eltwise.scale == 1.f;
+            default: return false;
+            }
+        }
     };
 
     gemm_inner_product_fwd_t(const pd_t *pd, const input_vector &inputs,
@@ -35,7 +35,6 @@ using namespace mkldnn::impl::math;
 
 template <bool with_relu, data_type_t dst_type>
 void _gemm_u8s8s32x_convolution_fwd_t<with_relu, dst_type>::execute_forward() {
-#if USE_MKL_IGEMM
     auto src_base = reinterpret_cast<const src_data_t *>(this->input_memory(0));
     auto wei_base = reinterpret_cast<const wei_data_t *>(this->input_memory(1));
     auto bia_base = reinterpret_cast<const char *>(this->input_memory(2));
@@ -55,8 +54,8 @@ void _gemm_u8s8s32x_convolution_fwd_t<with_relu, dst_type>::execute_forward() {
     const size_t dst_g_stride = dst_md.blk_off(0, 1) * jcp.oc;
     const size_t dst_os_stride = dst_md.blk_off(0, 0, 0, 1);
 
-    auto get_bias = [=, &bia_base](size_t off) -> acc_data_t {
-#       define CASE(dt) case dt: return (acc_data_t)\
+    auto get_bias = [=, &bia_base](size_t off) -> float {
+#       define CASE(dt) case dt: return (float)\
         (*((const prec_traits<dt>::type *)bia_base + off))
         switch (conf_.cdesc()->bias_desc.data_type) {
         CASE(data_type::s8);
@@ -127,9 +126,20 @@ void _gemm_u8s8s32x_convolution_fwd_t<with_relu, dst_type>::execute_forward() {
             const int8_t off_a = 0, off_b = 0;
             const int32_t off_c = 0;
 
+#if USE_MKL_IGEMM
             cblas_gemm_s8u8s32(CblasColMajor, CblasNoTrans, CblasNoTrans,
                     CblasFixOffset, M, N, K, 1., wei, M * jcp.ngroups, off_a,
-                    jcp.need_im2col ? col : src, K, off_b, 0., acc, M, &off_c);
+                    jcp.need_im2col ? col : src,
+                    jcp.need_im2col ? K : K * jcp.ngroups, off_b, 0., acc, M,
+                    &off_c);
+#else
+            const int LDA = M * jcp.ngroups;
+            const int LDB = jcp.need_im2col ? K : K * jcp.ngroups;
+            const float one = 1.f, zero = 0.f;
+            igemm_->igemm(&M, &N, &K, &one, wei, &LDA, &off_a,
+                    jcp.need_im2col ? col : src, &LDB, &off_b, &zero, acc, &M,
+                    &off_c);
+#endif
 
             if (use_fast_path) {
 #               if _OPENMP >= 201307
@@ -138,7 +148,8 @@ void _gemm_u8s8s32x_convolution_fwd_t<with_relu, dst_type>::execute_forward() {
 #               pragma omp parallel for
 #               endif
                 for (int o = 0; o < jcp.os * jcp.oc; ++o) {
-                    float d = fast_path_alpha * acc[o] + sum_scale * dst[o];
+                    float d = fast_path_alpha * acc[o];
+                    if (do_sum) d += sum_scale * dst[o];
                     if (do_relu && d < 0) d *= nslope;
                     dst[o] = qz_a1b0<float, dst_data_t>()(d, rmode);
                 }
@@ -164,7 +175,6 @@ void _gemm_u8s8s32x_convolution_fwd_t<with_relu, dst_type>::execute_forward() {
             nd_iterator_step(n, jcp.mb, g, jcp.ngroups);
         }
     }
-#endif
 }
 
 using namespace data_type;
@@ -22,6 +22,7 @@
 #include "cpu_engine.hpp"
 #include "jit_primitive_conf.hpp"
 #include "gemm_convolution_utils.hpp"
+#include "jit_uni_gemm_u8s8s32.hpp"
 
 #include "os_blas.hpp"
 
@@ -38,7 +39,7 @@ struct _gemm_u8s8s32x_convolution_fwd_t: public cpu_primitive_t {
             : _cpu_convolution_fwd_pd_t<with_relu>(engine, adesc, attr,
                     hint_fwd_pd), jcp_({}) {}
 
-        DECLARE_COMMON_PD_T("gemm:blas",
+        DECLARE_COMMON_PD_T(USE_MKL_IGEMM ? "gemm:blas" : "gemm:jit",
                 _gemm_u8s8s32x_convolution_fwd_t<with_relu, dst_type>);
 
         virtual status_t init() override {
@@ -48,9 +49,7 @@ struct _gemm_u8s8s32x_convolution_fwd_t: public cpu_primitive_t {
             assert(this->engine()->kind() == engine_kind::cpu);
 
             bool ok = true
-#if !USE_MKL_IGEMM
-                && false
-#endif
+                && (USE_MKL_IGEMM || jit_uni_gemm_u8s8s32::is_available())
                 && this->set_default_params() == status::success
                 && utils::one_of(this->cdesc_().prop_kind,
                         prop_kind::forward_training,
@@ -110,7 +109,7 @@ struct _gemm_u8s8s32x_convolution_fwd_t: public cpu_primitive_t {
     _gemm_u8s8s32x_convolution_fwd_t(const pd_t *pd, const input_vector &inputs,
            const output_vector &outputs)
         : cpu_primitive_t(&conf_, inputs, outputs), conf_(*pd), col_(nullptr)
-        , acc_(nullptr)
+        , acc_(nullptr), igemm_(nullptr)
     {
         jit_gemm_convolution_utils::init_conf(conf_.jcp_,
             *(conf_.cdesc()), conf_.src_pd(), conf_.weights_pd(0),
@@ -123,11 +122,15 @@ struct _gemm_u8s8s32x_convolution_fwd_t: public cpu_primitive_t {
                 this->conf_.jcp_, &this->col_, nthr_);
         jit_gemm_convolution_utils::prepare_ws_acc<acc_data_t>(
                 this->conf_.jcp_, &this->acc_, nthr_);
+
+        if (!USE_MKL_IGEMM)
+            igemm_ = new jit_uni_gemm_u8s8s32('N', 'N', 'F');
     }
 
     ~_gemm_u8s8s32x_convolution_fwd_t() {
         free(this->col_);
         free(this->acc_);
+        delete igemm_;
     };
 
     typedef typename prec_traits<data_type::u8>::type src_data_t;
@@ -146,6 +149,7 @@ private:
     src_data_t *col_;
     acc_data_t *acc_;
     int nthr_;
+    jit_uni_gemm_u8s8s32 *igemm_;
 };
 
 }
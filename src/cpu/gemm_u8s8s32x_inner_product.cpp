@@ -0,0 +1,101 @@
+/*******************************************************************************
+* Copyright 2018 Intel Corporation
+*
+* Licensed under the Apache License, Version 2.0 (the "License");
+* you may not use this file except in compliance with the License.
+* You may obtain a copy of the License at
+*
+*     http://www.apache.org/licenses/LICENSE-2.0
+*
+* Unless required by applicable law or agreed to in writing, software
+* distributed under the License is distributed on an "AS IS" BASIS,
+* WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+* See the License for the specific language governing permissions and
+* limitations under the License.
+*******************************************************************************/
+
+#include "c_types_map.hpp"
+#include "type_helpers.hpp"
+#include "mkldnn_thread.hpp"
+
+#include "simple_q10n.hpp"
+
+#include "gemm_u8s8s32x_inner_product.hpp"
+
+namespace mkldnn {
+namespace impl {
+namespace cpu {
+
+using namespace mkldnn::impl::data_type;
+
+template <data_type_t dst_type>
+void gemm_u8s8s32x_inner_product_fwd_t<dst_type>::execute_forward() {
+    auto src = reinterpret_cast<const src_data_t *>(this->input_memory(0));
+    auto weights = reinterpret_cast<const wei_data_t *>(this->input_memory(1));
+    auto bias = reinterpret_cast<const char *>(this->input_memory(2));
+    auto dst = reinterpret_cast<dst_data_t *>(this->memory());
+
+    const int MB = conf_.MB();
+    const int OC = conf_.OC();
+    const int IC = conf_.IC_total();
+
+    const int lda = conf_.wei_trans() ? IC : OC;
+    const float one = 1.f, zero = 0.f;
+    const int8_t off_a = 0, off_b = 0;
+    const int32_t off_c = 0;
+    igemm_->igemm(&OC, &MB, &IC, &one, weights, &lda, &off_a, src, &IC,
+            &off_b, &zero, acc_, &OC, &off_c);
+
+    const auto bias_dt = conf_.desc()->bias_desc.data_type;
+    auto get_bias = [=](int oc) -> float {
+#       define CASE(dt) case dt: \
+        return (float)((const prec_traits<dt>::type *)bias)[oc]
+        switch (bias_dt) {
+        CASE(s8);
+        CASE(u8);
+        CASE(s32);
+        CASE(f32);
+        default: assert(!"unimplemented");
+        }
+#       undef CASE
+        return 0;
+    };
+
+    /* scale_idx_mult = 1 for per_oc scales and 0, otherwise */
+    const int scale_idx_mult = conf_.attr()->output_scales_.mask_ == (1 << 1);
+    const float *scales = conf_.attr()->output_scales_.scales_;
+    const auto rmode = conf_.attr()->round_mode_;
+
+    const auto &post_ops = conf_.attr()->post_ops_;
+    const bool do_sum = post_ops.contain(primitive_kind::sum, 0);
+    const float sum_scale = do_sum ? post_ops.entry_[0].sum.scale : 0;
+    const bool do_relu = post_ops.find(primitive_kind::eltwise) != -1;
+    const float nslope = do_relu
+        ? post_ops.entry_[post_ops.find(primitive_kind::eltwise)].eltwise.alpha
+        : 0;
+
+#   pragma omp parallel for collapse(2) schedule(static)
+    for (int mb = 0; mb < MB; ++mb) {
+        for (int oc = 0; oc < OC; ++oc) {
+            const size_t off = (size_t)mb * OC + oc;
+            float d = (float)acc_[off];
+            if (bias)
+                d += get_bias(oc);
+            d *= scales[oc * scale_idx_mult];
+            if (do_sum) d += sum_scale * dst[off];
+            if (do_relu && d < 0) d *= nslope;
+            dst[off] = qz_a1b0<float, dst_data_t>()(d, rmode);
+        }
+    }
+}
+
+template struct gemm_u8s8s32x_inner_product_fwd_t<f32>;
+template struct gemm_u8s8s32x_inner_product_fwd_t<s32>;
+template struct gemm_u8s8s32x_inner_product_fwd_t<s8>;
+template struct gemm_u8s8s32x_inner_product_fwd_t<u8>;
+
+}
+}
+}
+
+// vim: et ts=4 sw=4 cindent cino^=l0,\:0,N-s
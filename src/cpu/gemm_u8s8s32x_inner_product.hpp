@@ -0,0 +1,136 @@
+/*******************************************************************************
+* Copyright 2018 Intel Corporation
+*
+* Licensed under the Apache License, Version 2.0 (the "License");
+* you may not use this file except in compliance with the License.
+* You may obtain a copy of the License at
+*
+*     http://www.apache.org/licenses/LICENSE-2.0
+*
+* Unless required by applicable law or agreed to in writing, software
+* distributed under the License is distributed on an "AS IS" BASIS,
+* WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+* See the License for the specific language governing permissions and
+* limitations under the License.
+*******************************************************************************/
+
+#ifndef CPU_GEMM_U8S8S32X_INNER_PRODUCT_HPP
+#define CPU_GEMM_U8S8S32X_INNER_PRODUCT_HPP
+
+#include <assert.h>
+
+#include "c_types_map.hpp"
+#include "cpu_inner_product_pd.hpp"
+#include "cpu_engine.hpp"
+#include "type_helpers.hpp"
+#include "utils.hpp"
+
+#include "jit_uni_gemm_u8s8s32.hpp"
+
+namespace mkldnn {
+namespace impl {
+namespace cpu {
+
+/* u8 x s8 -> s32 forward inner product on top of the integer gemm, with the
+ * output scales, round mode, sum and relu post-ops of the int8 convolutions */
+template <impl::data_type_t dst_type>
+struct gemm_u8s8s32x_inner_product_fwd_t: public cpu_primitive_t {
+    struct pd_t: public cpu_inner_product_fwd_pd_t {
+        pd_t(engine_t *engine, const inner_product_desc_t *adesc,
+                const primitive_attr_t *attr,
+                const inner_product_fwd_pd_t *hint_fwd_pd)
+            : cpu_inner_product_fwd_pd_t(engine, adesc, attr, hint_fwd_pd) {}
+
+        DECLARE_COMMON_PD_T("gemm:jit", gemm_u8s8s32x_inner_product_fwd_t);
+
+        virtual status_t init() override {
+            using namespace prop_kind;
+            using namespace data_type;
+            using namespace memory_format;
+            using namespace utils;
+            assert(engine()->kind() == engine_kind::cpu);
+            bool ok = true
+                && jit_uni_gemm_u8s8s32::is_available()
+                && this->set_default_params() == status::success
+                && one_of(desc()->prop_kind, forward_training,
+                        forward_inference)
+                && ndims() != 5
+                && desc()->src_desc.data_type == u8
+                && desc()->weights_desc.data_type == s8
+                && desc()->dst_desc.data_type == dst_type
+                && desc()->accum_data_type == s32
+                && implication(this->with_bias(), one_of(
+                            desc()->bias_desc.data_type, f32, s32, s8, u8))
+                && implication(src_pd_.desc()->format == nchw,
+                        weights_pd_.desc()->format == oihw)
+                && implication(src_pd_.desc()->format == nhwc,
+                        weights_pd_.desc()->format == hwio)
+                && implication(src_pd_.desc()->format == nc,
+                        one_of(weights_pd_.desc()->format, oi, io))
+                && one_of(src_pd_.desc()->format, nchw, nhwc, nc)
+                && dst_pd_.desc()->format == nc
+                && memory_desc_wrapper(src_pd()).is_dense()
+                && memory_desc_wrapper(dst_pd()).is_dense()
+                && memory_desc_wrapper(weights_pd()).is_dense()
+                && post_ops_ok();
+            return ok ? status::success : status::unimplemented;
+        }
+
+        /* weights are oc x ic(hw) for 'T' and ic(hw) x oc for 'N' */
+        bool wei_trans() const {
+            using namespace memory_format;
+            return utils::one_of(weights_pd_.desc()->format, oihw, oi);
+        }
+
+    protected:
+        bool post_ops_ok() const {
+            using namespace primitive_kind;
+            auto const &po = attr()->post_ops_;
+            switch (po.len_) {
+            case 0: return true;
+            case 1: return po.entry_[0].is_relu() || po.contain(sum, 0);
+            case 2: return po.contain(sum, 0) && po.entry_[1].is_relu();
+            default: return false;
+            }
+        }
+    };
+
+    gemm_u8s8s32x_inner_product_fwd_t(const pd_t *pd,
+            const input_vector &inputs, const output_vector &outputs)
+        : cpu_primitive_t(&conf_, inputs, outputs), conf_(*pd), acc_(nullptr)
+    {
+        igemm_ = new jit_uni_gemm_u8s8s32(conf_.wei_trans() ? 'T' : 'N', 'N',
+                'F');
+        acc_ = (acc_data_t *)malloc(sizeof(acc_data_t) * conf_.MB()
+                * conf_.OC(), 64);
+    }
+
+    ~gemm_u8s8s32x_inner_product_fwd_t() {
+        delete igemm_;
+        free(acc_);
+    }
+
+    typedef typename prec_traits<data_type::u8>::type src_data_t;
+    typedef typename prec_traits<data_type::s8>::type wei_data_t;
+    typedef typename prec_traits<dst_type>::type dst_data_t;
+    typedef typename prec_traits<data_type::s32>::type acc_data_t;
+
+    virtual void execute(event_t *e) {
+        execute_forward();
+        e->set_state(event_t::ready);
+    }
+
+private:
+    void execute_forward();
+    pd_t conf_;
+    jit_uni_gemm_u8s8s32 *igemm_;
+    acc_data_t *acc_;
+};
+
+}
+}
+}
+
+#endif
+
+// vim: et ts=4 sw=4 cindent cino^=l0,\:0,N-s
@@ -0,0 +1,280 @@
+/*******************************************************************************
+* Copyright 2018 Intel Corporation
+*
+* Licensed under the Apache License, Version 2.0 (the "License");
+* you may not use this file except in compliance with the License.
+* You may obtain a copy of the License at
+*
+*     http://www.apache.org/licenses/LICENSE-2.0
+*
+* Unless required by applicable law or agreed to in writing, software
+* distributed under the License is distributed on an "AS IS" BASIS,
+* WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+* See the License for the specific language governing permissions and
+* limitations under the License.
+*******************************************************************************/
+
+#include "c_types_map.hpp"
+#include "math_utils.hpp"
+#include "mkldnn_thread.hpp"
+#include "type_helpers.hpp"
+
+#include "simple_q10n.hpp"
+
+#include "gemm_u8s8s32x_lstm.hpp"
+
+namespace mkldnn {
+namespace impl {
+namespace cpu {
+
+using namespace mkldnn::impl::data_type;
+using namespace mkldnn::impl::math;
+using namespace mkldnn::impl::utils;
+
+#define AOC array_offset_calculator
+
+template <data_type_t dst_type>
+gemm_u8s8s32x_lstm_fwd_t<dst_type>::gemm_u8s8s32x_lstm_fwd_t(
+        const pd_t *pd, const input_vector &inputs,
+        const output_vector &outputs)
+    : cpu_primitive_t(&conf_, inputs, outputs), conf_(*pd) {
+    const size_t T = conf_.T(), MB = conf_.MB(), D = conf_.D(),
+          G = conf_.G(), DIC = conf_.DIC();
+
+    igemm_ = new jit_uni_gemm_u8s8s32('N', 'N', 'F');
+    ws_h_ = (src_data_t *)malloc(
+            sizeof(src_data_t) * D * 2 * (T + 2) * MB * DIC, 64);
+    ws_c_ = (float *)malloc(sizeof(float) * 2 * MB * DIC, 64);
+    ws_gates_ = (acc_data_t *)malloc(
+            sizeof(acc_data_t) * T * MB * G * DIC, 64);
+    compensation_ = (float *)malloc(sizeof(float) * G * DIC, 64);
+    inv_scales_ = (float *)malloc(sizeof(float) * G * DIC, 64);
+
+    const float data_scale = conf_.attr()->rnn_data_qparams_.scale_;
+    const float *wei_scales = conf_.attr()->rnn_weights_qparams_.scales_;
+    for (int g = 0; g < (int)G; g++)
+        for (int o = 0; o < (int)DIC; o++)
+            inv_scales_[g * DIC + o] = 1.f
+                    / (data_scale * wei_scales[conf_.wei_scale_idx(g, o)]);
+}
+
+template <data_type_t dst_type>
+gemm_u8s8s32x_lstm_fwd_t<dst_type>::~gemm_u8s8s32x_lstm_fwd_t() {
+    delete igemm_;
+    free(ws_h_);
+    free(ws_c_);
+    free(ws_gates_);
+    free(compensation_);
+    free(inv_scales_);
+}
+
+/* the u8 data x + shift contributes shift * sum(w) to the s32 gates, which
+ * is removed at the dequantization. The weights are ldigo, i.e. a
+ * n_input x (G * DIC) matrix. */
+template <data_type_t dst_type>
+void gemm_u8s8s32x_lstm_fwd_t<dst_type>::compute_compensation(
+        const wei_data_t *weights_layer, const wei_data_t *weights_iter) {
+    const int m = conf_.G() * conf_.DIC();
+    const int SLC = conf_.SLC(), SIC = conf_.SIC();
+    const float shift = conf_.attr()->rnn_data_qparams_.shift_;
+
+#   pragma omp parallel
+    {
+        int start{0}, end{0};
+        balance211(m, omp_get_num_threads(), omp_get_thread_num(), start,
+                end);
+        for (int j = start; j < end; j++)
+            compensation_[j] = 0.f;
+        for (int i = 0; i < SLC; i++)
+            for (int j = start; j < end; j++)
+                compensation_[j] += weights_layer[(size_t)i * m + j];
+        for (int i = 0; i < SIC; i++)
+            for (int j = start; j < end; j++)
+                compensation_[j] += weights_iter[(size_t)i * m + j];
+        for (int j = start; j < end; j++)
+            compensation_[j] *= shift;
+    }
+}
+
+/* the f32 elementwise part of the cell of an iteration on the dequantized
+ * gates, the same as the reference lstm */
+template <data_type_t dst_type>
+void gemm_u8s8s32x_lstm_fwd_t<dst_type>::cell_elemwise(
+        const acc_data_t *gates_, const float *bias_, const float *c_tm1_,
+        float *c_t_, src_data_t *h_t_) {
+    const int MB = conf_.MB(), G = conf_.G(), DIC = conf_.DIC();
+    const float scale = conf_.attr()->rnn_data_qparams_.scale_;
+    const float shift = conf_.attr()->rnn_data_qparams_.shift_;
+    const auto rmode = conf_.attr()->round_mode_;
+
+    AOC<const acc_data_t, 3> gates(gates_, MB, G, DIC);
+    AOC<const float, 2> bias(bias_, G, DIC);
+    AOC<const float, 2> compensation(compensation_, G, DIC);
+    AOC<const float, 2> inv_scales(inv_scales_, G, DIC);
+    AOC<const float, 2> c_tm1(c_tm1_, MB, DIC);
+    AOC<float, 2> c_t(c_t_, MB, DIC);
+    AOC<src_data_t, 2> h_t(h_t_, MB, DIC);
+
+#   pragma omp parallel for collapse(2) schedule(static)
+    for (int b = 0; b < MB; b++) {
+        for (int j = 0; j < DIC; j++) {
+            auto gate = [&](int g) {
+                return ((float)gates(b, g, j) - compensation(g, j))
+                        * inv_scales(g, j) + bias(g, j);
+            };
+            const float g0 = logistic_fwd(gate(0));
+            const float g1 = logistic_fwd(gate(1));
+            const float g2 = logistic_fwd(gate(2));
+            const float g3 = tanh_fwd(gate(3));
+
+            const float c = g0 * c_tm1(b, j) + g1 * g3;
+            c_t(b, j) = c;
+            h_t(b, j) = round_and_saturate<src_data_t>(
+                    scale * g2 * tanh_fwd(c) + shift, rmode);
+        }
+    }
+}
+
+template <data_type_t dst_type>
+void gemm_u8s8s32x_lstm_fwd_t<dst_type>::execute_forward() {
+    int input_idx = 0;
+    auto src_layer = reinterpret_cast<const src_data_t *>(
+            this->input_memory(input_idx++));
+    auto src_iter = conf_.with_src_iter() ?
+            reinterpret_cast<const float *>(this->input_memory(input_idx++)) :
+            nullptr;
+    auto weights_layer = reinterpret_cast<const wei_data_t *>(
+            this->input_memory(input_idx++));
+    auto weights_iter = reinterpret_cast<const wei_data_t *>(
+            this->input_memory(input_idx++));
+    auto bias = reinterpret_cast<const float *>(
+            this->input_memory(input_idx++));
+    auto dst_layer = reinterpret_cast<dst_data_t *>(this->memory(0));
+    auto dst_iter = conf_.with_dst_iter() ?
+            reinterpret_cast<float *>(this->memory(1)) : nullptr;
+
+    const memory_desc_wrapper src_layer_d(conf_.src_pd(0));
+    const memory_desc_wrapper src_iter_d(conf_.src_pd(1));
+    const memory_desc_wrapper weights_layer_d(conf_.weights_pd(0));
+    const memory_desc_wrapper weights_iter_d(conf_.weights_pd(1));
+    const memory_desc_wrapper bias_d(conf_.weights_pd(2));
+    const memory_desc_wrapper dst_layer_d(conf_.dst_pd(0));
+    const memory_desc_wrapper dst_iter_d(conf_.dst_pd(1));
+
+    const int T = conf_.T(), MB = conf_.MB(), L = conf_.L(), D = conf_.D();
+    const int SLC = conf_.SLC(), DIC = conf_.DIC();
+    const int m = conf_.G() * DIC, n_all = MB * T;
+    const auto direction = conf_.direction();
+
+    const float scale = conf_.attr()->rnn_data_qparams_.scale_;
+    const float shift = conf_.attr()->rnn_data_qparams_.shift_;
+    const auto rmode = conf_.attr()->round_mode_;
+    auto dequantize = [=](src_data_t h) { return ((float)h - shift) / scale; };
+
+    const float one = 1.f, zero = 0.f;
+    const int8_t off_a = 0, off_b = 0;
+    const int32_t off_c = 0;
+
+    AOC<src_data_t, 5> ws_h(ws_h_, D, 2, T + 2, MB, DIC);
+    AOC<float, 3> ws_c(ws_c_, 2, MB, DIC);
+
+    for (int dir = 0; dir < D; dir++) {
+        const bool is_reversed = dir == D - 1
+                && direction != mkldnn_unidirectional_left2right;
+        for (int lay = 0; lay < L; lay++) {
+            const int cur = lay % 2, prev = (lay + 1) % 2;
+            const wei_data_t *w_layer
+                    = weights_layer + weights_layer_d.blk_off(lay, dir);
+            const wei_data_t *w_iter
+                    = weights_iter + weights_iter_d.blk_off(lay, dir);
+            const float *b = bias + bias_d.blk_off(lay, dir);
+
+            compute_compensation(w_layer, w_iter);
+
+            /* the inputs of all the iterations at once, in the order of the
+             * user for both directions */
+            const src_data_t *input = lay == 0 ?
+                    src_layer + src_layer_d.blk_off(0) :
+                    &ws_h(dir, prev, 1, 0, 0);
+            igemm_->igemm(&m, &n_all, &SLC, &one, w_layer, &m, &off_a, input,
+                    &SLC, &off_b, &zero, ws_gates_, &m, &off_c);
+
+            const int t_init = is_reversed ? T + 1 : 0;
+#           pragma omp parallel for collapse(2) schedule(static)
+            for (int mb = 0; mb < MB; mb++) {
+                for (int o = 0; o < DIC; o++) {
+                    float h = 0.f, c = 0.f;
+                    if (src_iter) {
+                        h = src_iter[src_iter_d.blk_off(lay, dir, 0, mb, o)];
+                        c = src_iter[src_iter_d.blk_off(lay, dir, 1, mb, o)];
+                    }
+                    ws_h(dir, cur, t_init, mb, o)
+                            = round_and_saturate<src_data_t>(
+                                    scale * h + shift, rmode);
+                    ws_c(0, mb, o) = c;
+                }
+            }
+
+            for (int i = 0; i < T; i++) {
+                const int t = is_reversed ? T - 1 - i : i;
+                const int t_prev = is_reversed ? t + 2 : t;
+                acc_data_t *gates = ws_gates_ + (size_t)t * MB * m;
+                igemm_->igemm(&m, &MB, &DIC, &one, w_iter, &m, &off_a,
+                        &ws_h(dir, cur, t_prev, 0, 0), &DIC, &off_b, &one,
+                        gates, &m, &off_c);
+                cell_elemwise(gates, b, &ws_c(i % 2, 0, 0),
+                        &ws_c((i + 1) % 2, 0, 0), &ws_h(dir, cur, t + 1, 0, 0));
+            }
+
+            if (dst_iter) {
+                const int t_last = is_reversed ? 1 : T;
+#               pragma omp parallel for collapse(2) schedule(static)
+                for (int mb = 0; mb < MB; mb++) {
+                    for (int o = 0; o < DIC; o++) {
+                        dst_iter[dst_iter_d.blk_off(lay, dir, 0, mb, o)]
+                                = dequantize(ws_h(dir, cur, t_last, mb, o));
+                        dst_iter[dst_iter_d.blk_off(lay, dir, 1, mb, o)]
+                                = ws_c(T % 2, mb, o);
+                    }
+                }
+            }
+        }
+    }
+
+    /* the u8 destination has the qparams of the data */
+    auto to_dst = [=](float f) {
+        return dst_type == f32 ? (dst_data_t)f :
+            round_and_saturate<dst_data_t>(scale * f + shift, rmode);
+    };
+    const int last = (L - 1) % 2;
+#   pragma omp parallel for collapse(2) schedule(static)
+    for (int t = 0; t < T; t++) {
+        for (int mb = 0; mb < MB; mb++) {
+            dst_data_t *dst = dst_layer + dst_layer_d.blk_off(t, mb);
+            for (int o = 0; o < DIC; o++) {
+                const float h = dequantize(ws_h(0, last, t + 1, mb, o));
+                switch (direction) {
+                case mkldnn_bidirectional_concat:
+                    dst[o] = to_dst(h);
+                    dst[DIC + o] = to_dst(
+                            dequantize(ws_h(1, last, t + 1, mb, o)));
+                    break;
+                case mkldnn_bidirectional_sum:
+                    dst[o] = to_dst(
+                            h + dequantize(ws_h(1, last, t + 1, mb, o)));
+                    break;
+                default: dst[o] = to_dst(h);
+                }
+            }
+        }
+    }
+}
+
+template struct gemm_u8s8s32x_lstm_fwd_t<f32>;
+template struct gemm_u8s8s32x_lstm_fwd_t<u8>;
+
+}
+}
+}
+
+// vim: et ts=4 sw=4 cindent cino^=l0,\:0,N-s
@@ -0,0 +1,162 @@
+/*******************************************************************************
+* Copyright 2018 Intel Corporation
+*
+* Licensed under the Apache License, Version 2.0 (the "License");
+* you may not use this file except in compliance with the License.
+* You may obtain a copy of the License at
+*
+*     http://www.apache.org/licenses/LICENSE-2.0
+*
+* Unless required by applicable law or agreed to in writing, software
+* distributed under the License is distributed on an "AS IS" BASIS,
+* WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+* See the License for the specific language governing permissions and
+* limitations under the License.
+*******************************************************************************/
+
+#ifndef CPU_GEMM_U8S8S32X_LSTM_HPP
+#define CPU_GEMM_U8S8S32X_LSTM_HPP
+
+#include <assert.h>
+
+#include "c_types_map.hpp"
+#include "cpu_engine.hpp"
+#include "cpu_rnn_pd.hpp"
+#include "type_helpers.hpp"
+#include "utils.hpp"
+
+#include "jit_uni_gemm_u8s8s32.hpp"
+
+namespace mkldnn {
+namespace impl {
+namespace cpu {
+
+/* u8 x s8 -> s32 lstm inference on top of the integer gemm.
+ *
+ * The layer input and the h states are u8 with the rnn data qparams of the
+ * attributes, the weights s8 with the rnn weights qparams. The gates are
+ * accumulated in s32 by the gemms of the input and of the states, and
+ * dequantized for the f32 elementwise part of the cell, the c states stay
+ * f32. The initial and final states of the user are f32. */
+template <impl::data_type_t dst_type>
+struct gemm_u8s8s32x_lstm_fwd_t: public cpu_primitive_t {
+    struct pd_t: public cpu_rnn_fwd_pd_t {
+        pd_t(engine_t *engine, const rnn_desc_t *adesc,
+                const primitive_attr_t *attr,
+                const rnn_fwd_pd_t *hint_fwd_pd)
+            : cpu_rnn_fwd_pd_t(engine, adesc, attr, hint_fwd_pd) {}
+
+        DECLARE_COMMON_PD_T("gemm:jit", gemm_u8s8s32x_lstm_fwd_t);
+
+        status_t init() {
+            using namespace prop_kind;
+            using namespace data_type;
+            using namespace memory_format;
+            using namespace utils;
+            assert(engine()->kind() == engine_kind::cpu);
+            bool ok = true
+                && jit_uni_gemm_u8s8s32::is_available()
+                && this->set_default_params() == status::success
+                && desc()->prop_kind == forward_inference
+                && cell_kind() == alg_kind::vanilla_lstm
+                && this->with_bias()
+                && !this->with_seq_lengths()
+                && !this->is_stateful()
+                && implication(L() > 1, SLC() == DIC())
+                && SIC() == DIC()
+                && desc()->src_layer_desc.data_type == u8
+                && desc()->weights_layer_desc.data_type == s8
+                && desc()->weights_iter_desc.data_type == s8
+                && desc()->bias_desc.data_type == f32
+                && desc()->dst_layer_desc.data_type == dst_type
+                && implication(this->with_src_iter(),
+                        desc()->src_iter_desc.data_type == f32)
+                && implication(this->with_dst_iter(),
+                        desc()->dst_iter_desc.data_type == f32)
+                && src_layer_pd_.desc()->format == tnc
+                && dst_layer_pd_.desc()->format == tnc
+                && weights_layer_pd_.desc()->format == ldigo
+                && weights_iter_pd_.desc()->format == ldigo
+                && bias_pd_.desc()->format == ldgo
+                && implication(this->with_src_iter(),
+                        src_iter_pd_.desc()->format == ldsnc)
+                && implication(this->with_dst_iter(),
+                        dst_iter_pd_.desc()->format == ldsnc)
+                && memory_desc_wrapper(src_pd()).is_dense()
+                && memory_desc_wrapper(dst_pd()).is_dense()
+                && attr_ok();
+            return ok ? status::success : status::unimplemented;
+        }
+
+        /* the index of the weights scale of the gate g and the output
+         * channel o */
+        int wei_scale_idx(int g, int o) const {
+            switch (attr()->rnn_weights_qparams_.mask_) {
+            case 0: return 0;
+            case 1 << 3: return g;
+            default: return g * DIC() + o;
+            }
+        }
+
+    protected:
+        bool attr_ok() const {
+            const auto &wei_scales = attr()->rnn_weights_qparams_;
+            const int mask = wei_scales.mask_;
+            const int count = mask == 0 ? 1 : mask == 1 << 3 ? G() : G() * DIC();
+            return true
+                && attr()->output_scales_.has_default_values()
+                && attr()->post_ops_.has_default_values()
+                && attr()->rnn_data_qparams_.scale_ != 0.f
+                && utils::one_of(mask, 0, 1 << 3, (1 << 3) + (1 << 4))
+                && wei_scales.count_ == count;
+        }
+    };
+
+    gemm_u8s8s32x_lstm_fwd_t(const pd_t *pd, const input_vector &inputs,
+            const output_vector &outputs);
+    ~gemm_u8s8s32x_lstm_fwd_t();
+
+    typedef typename prec_traits<data_type::u8>::type src_data_t;
+    typedef typename prec_traits<data_type::s8>::type wei_data_t;
+    typedef typename prec_traits<dst_type>::type dst_data_t;
+    typedef typename prec_traits<data_type::s32>::type acc_data_t;
+
+    virtual void execute(event_t *e) {
+        execute_forward();
+        e->set_state(event_t::ready);
+    }
+
+private:
+    void execute_forward();
+    void compute_compensation(const wei_data_t *weights_layer,
+            const wei_data_t *weights_iter);
+    void cell_elemwise(const acc_data_t *gates, const float *bias,
+            const float *c_tm1, float *c_t, src_data_t *h_t);
+
+    pd_t conf_;
+    jit_uni_gemm_u8s8s32 *igemm_;
+
+    /* the h states of the layers of a direction, in the order of the user
+     * iterations: [n_direction][2][n_iter + 2][batch][s_size], the layers
+     * alternate between the two buffers of their direction. The iteration
+     * t is at t + 1, the initial state of the left to right direction at 0
+     * and of the right to left one at n_iter + 1 */
+    src_data_t *ws_h_;
+    /* the c states of the current and previous iterations */
+    float *ws_c_;
+    /* the gates of all the iterations of a layer: [n_iter][batch][G][s] */
+    acc_data_t *ws_gates_;
+    /* the sum of the weights of the input and the state by gate and output
+     * channel, times the data shift, and the inverse of the product of the
+     * data and weights scales */
+    float *compensation_;
+    float *inv_scales_;
+};
+
+}
+}
+}
+
+#endif
+
+// vim: et ts=4 sw=4 cindent cino^=l0,\:0,N-s
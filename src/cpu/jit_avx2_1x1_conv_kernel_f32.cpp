@@ -21,6 +21,7 @@
 #include "cpu_memory.hpp"
 
 #include "jit_avx2_1x1_conv_kernel_f32.hpp"
+#include "jit_conv_tuning.hpp"
 
 #define GET_OFF(field) offsetof(jit_1x1_conv_call_s, field)
 
@@ -192,7 +193,7 @@ void jit_avx2_1x1_conv_kernel_f32::reduce_loop(int load_loop_blk, int ur,
 
         L(store_noadd);
 
-        if (jcp.with_relu) {
+        if (jcp.with_relu || jcp.with_depthwise) {
             assert(ur * load_loop_blk < 14);
 
             jit_tagged_label store_norelu(
@@ -200,23 +201,58 @@ void jit_avx2_1x1_conv_kernel_f32::reduce_loop(int load_loop_blk, int ur,
             test(reg_reduce_pos_flag, FLAG_REDUCE_LAST);
             jz(store_norelu, T_NEAR);
 
-            vxorps(vzero, vzero, vzero);
-            if (jcp.relu_negative_slope == 0) {
-               ymm_relu_ns = vzero;
+            auto apply_relu = [=]() {
+                vxorps(vzero, vzero, vzero);
+                if (jcp.relu_negative_slope == 0) {
+                   ymm_relu_ns = vzero;
+                } else {
+                   mov(imm_addr64, float2int(jcp.relu_negative_slope));
+                   movq(xmm_relu_ns, imm_addr64);
+                   uni_vbroadcastss(ymm_relu_ns, xmm_relu_ns);
+                }
+
+                for (int j = 0; j < ur; ++j)
+                    for (int i = 0; i < load_loop_blk; ++i) {
+                        vcmpgtps(vmask, vreg_accum(i, j), vzero);
+                        vmulps(ymm_res_ns, ymm_relu_ns, vreg_accum(i, j));
+                        vblendvps(vreg_accum(i, j), ymm_res_ns,
+                                 vreg_accum(i, j), vmask);
+                    }
+            };
+
+            auto apply_depthwise = [=](const float *data, bool is_scale) {
+                mov(imm_addr64, reinterpret_cast<size_t>(data));
+                add(imm_addr64, ptr[rsp + reg_oc_off_stack_offt]);
+                for (int j = 0; j < ur; ++j)
+                    for (int i = 0; i < load_loop_blk; ++i) {
+                        auto c_ptr = ptr[imm_addr64
+                            + sizeof(float) * jcp.oc_block * i];
+                        if (is_scale)
+                            vmulps(vreg_accum(i, j), vreg_accum(i, j), c_ptr);
+                        else
+                            vaddps(vreg_accum(i, j), vreg_accum(i, j), c_ptr);
+                    }
+            };
+
+            const auto &p = attr_.post_ops_;
+            if (p.len_ == 0) {
+                apply_relu(); // convolution_relu primitive
             } else {
-               mov(imm_addr64, float2int(jcp.relu_negative_slope));
-               movq(xmm_relu_ns, imm_addr64);
-               uni_vbroadcastss(ymm_relu_ns, xmm_relu_ns);
+                for (int i = 0; i < p.len_; i++) {
+                    const auto &e = p.entry_[i];
+                    if (e.is_relu()) {
+                        apply_relu();
+                    } else if (e.is_depthwise()) {
+                        apply_depthwise(e.depthwise.weights_data, true);
+                        if (e.depthwise.biases_data != nullptr)
+                            apply_depthwise(e.depthwise.biases_data, false);
+                    }
+                }
             }
 
             for (int j = 0; j < ur; ++j)
-                for (int i = 0; i < load_loop_blk; ++i) {
-                    vcmpgtps(vmask, vreg_accum(i, j), vzero);
-                    vmulps(ymm_res_ns, ymm_relu_ns, vreg_accum(i, j));
-                    vblendvps(vreg_accum(i, j), ymm_res_ns,
-                             vreg_accum(i, j), vmask);
+                for (int i = 0; i < load_loop_blk; ++i)
                     vmovups(output_ptr(i, j), vreg_accum(i, j));
-                }
 
             jmp(store_done, T_NEAR);
             L(store_norelu);
@@ -349,6 +385,11 @@ void jit_avx2_1x1_conv_kernel_f32::generate()
         } else
             mov(reg_bias_data, ptr[param1 + GET_OFF(bias_data)]);
     }
+    if (jcp.with_depthwise) {
+        sub(rsp, stack_space_needed);
+        mov(imm_addr64, ptr[param1 + GET_OFF(oc_off)]);
+        mov(ptr[rsp + reg_oc_off_stack_offt], imm_addr64);
+    }
 
     mov(reg_load_loop_work, ptr[param1 + GET_OFF(load_dim)]);
     mov(reg_bcast_loop_work, ptr[param1 + GET_OFF(bcast_dim)]);
@@ -364,6 +405,9 @@ void jit_avx2_1x1_conv_kernel_f32::generate()
         case forward_training:
         case forward_inference:
             add(reg_bias_data, load_loop_blk * jcp.oc_block * sizeof(float));
+            if (jcp.with_depthwise)
+                add(qword[rsp + reg_oc_off_stack_offt],
+                        load_loop_blk * jcp.oc_block * sizeof(float));
             add(reg_output_data,
                     load_loop_blk * jcp.os * jcp.oc_block * sizeof(float));
             break;
@@ -424,7 +468,9 @@ void jit_avx2_1x1_conv_kernel_f32::generate()
     L(load_loop_blk_end);
 
     if (jcp.with_bias && jcp.prop_kind == backward_weights)
-        add(rsp, 8);
+        add(rsp, stack_space_needed);
+    if (jcp.with_depthwise)
+        add(rsp, stack_space_needed);
 
     postamble();
 }
@@ -435,19 +481,18 @@ bool jit_avx2_1x1_conv_kernel_f32::post_ops_ok(
 
     auto is_relu = [&](int idx) { return p.entry_[idx].is_relu(); };
     auto is_sum = [&](int idx) { return p.entry_[idx].is_sum(); };
+    auto is_depthwise = [&](int idx) { return p.entry_[idx].is_depthwise(); };
+    auto is_simple = [&](int idx) { return is_relu(idx) || is_depthwise(idx); };
 
-    switch (p.len_) {
-    case 0: return true; // no post_ops
-    case 1:
-        return true // sum OR relu
-                && !jcp.with_relu && (is_relu(0) || is_sum(0));
-    case 2:
-        return true // sum->relu
-                && !jcp.with_relu && (is_sum(0) && is_relu(1));
-    default: return false;
-    }
+    if (p.len_ > 0 && jcp.with_relu) return false;
 
-    return false;
+    /* sum is allowed at the very beginning only, followed by any sequence
+     * of relu and depthwise post-ops */
+    for (int idx = 0; idx < p.len_; idx++)
+        if (!(is_simple(idx) || (idx == 0 && is_sum(idx))))
+            return false;
+
+    return true;
 }
 
 status_t jit_avx2_1x1_conv_kernel_f32::init_conf(jit_1x1_conv_conf_t &jcp,
@@ -500,6 +545,7 @@ status_t jit_avx2_1x1_conv_kernel_f32::init_conf(jit_1x1_conv_conf_t &jcp,
         jcp.with_relu = p.find(primitive_kind::eltwise) != -1;
         jcp.relu_negative_slope = 0;
     }
+    jcp.with_depthwise = p.find(primitive_kind::depthwise) != -1;
 
     constexpr memory_format_t weights_formats[2][2] = {
         { OIhw8i8o, OIhw8o8i },
@@ -660,6 +706,29 @@ status_t jit_avx2_1x1_conv_kernel_f32::init_conf(jit_1x1_conv_conf_t &jcp,
     jcp.nb_load_blocking_max = load_blocking_max / jcp.load_block;
     jcp.nb_reduce_blocking = reduce_blocking / jcp.reduce_block;
 
+    /* the offline tuned blocking of the forward driver, the kernel itself
+     * does not depend on it */
+    conv_tuning_params_t tp;
+    const conv_tuning_shape_t shape = { jcp.ngroups, jcp.mb, jcp.ic, jcp.ih,
+        jcp.iw, jcp.oc, jcp.oh, jcp.ow, jcp.kh, jcp.kw, jcp.stride_h,
+        jcp.stride_w, jcp.t_pad, jcp.l_pad, 0, 0 };
+    if (one_of(jcp.prop_kind, forward_training, forward_inference)
+            && conv_tuning_lookup(JIT_IMPL_NAME_HELPER("jit_1x1:", avx2, ""),
+                shape, tp)) {
+        if (tp.nb_bcast_blocking > 0) {
+            jcp.nb_bcast_blocking = tp.nb_bcast_blocking;
+            jcp.nb_bcast_blocking_max = nstl::max(jcp.nb_bcast_blocking_max,
+                    tp.nb_bcast_blocking);
+        }
+        if (tp.nb_load_blocking > 0) {
+            jcp.nb_load_blocking = tp.nb_load_blocking;
+            jcp.nb_load_blocking_max = nstl::max(jcp.nb_load_blocking_max,
+                    tp.nb_load_blocking);
+        }
+        if (tp.nb_reduce_blocking > 0)
+            jcp.nb_reduce_blocking = tp.nb_reduce_blocking;
+    }
+
     jcp.nb_bcast = div_up(jcp.bcast_dim, jcp.bcast_block);
     jcp.nb_load = div_up(jcp.load_dim, jcp.load_block);
     jcp.nb_reduce = div_up(jcp.reduce_dim, jcp.reduce_block);
@@ -84,7 +84,8 @@ private:
     reg64_t reg_diff_bias_data = bcast_loop_iter;
 
     int reg_diff_bias_data_stack_offt = 0;
-    int stack_space_needed = 8;
+    int reg_oc_off_stack_offt = 8;
+    int stack_space_needed = 16;
 
     ymm_t vreg_bcast = ymm_t(15);
     Xbyak::Xmm xmm_relu_ns = Xbyak::Xmm(13);
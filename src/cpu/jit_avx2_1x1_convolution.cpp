@@ -108,6 +108,7 @@ void _jit_avx2_1x1_convolution_fwd_t<with_relu>::execute_forward() {
                 p.output_data = &dst[dst_off];
 
                 p.bias_data = &bias[_ocb * jcp.oc_block];
+                p.oc_off = _ocb * jcp.oc_block * sizeof(float);
 
                 for (int icb = 0; icb < nb_ic; icb += nb_ic_blocking) {
                     p.reduce_pos_flag = 0
@@ -306,6 +307,10 @@ jit_avx2_1x1_convolution_bwd_weights_t::jit_avx2_1x1_convolution_bwd_weights_t(
                     oc_block, conf_.G() * conf_.OC() / oc_block,
                     conf_.MB(), max_buffer_size));
 
+    reducer_weights_->balancer_.add_info(&conf_, "wei");
+    if (reducer_bias_)
+        reducer_bias_->balancer_.add_info(&conf_, "bia");
+
     init_rtus_driver<avx2>(this);
 }
 
@@ -21,6 +21,7 @@
 #include "cpu_memory.hpp"
 
 #include "jit_avx2_conv_kernel_f32.hpp"
+#include "jit_uni_conv_ic_split.hpp"
 
 #define GET_OFF(field) offsetof(jit_conv_call_s, field)
 
@@ -212,28 +213,68 @@ void jit_avx2_conv_fwd_kernel_f32::width_blk_step(int ur_w,
     jit_tagged_label done_label("done", pad_tag, oc_blocks_tag);
     jit_tagged_label regular_store_label("store", pad_tag, oc_blocks_tag);
 
-    if (this->jcp.with_relu) {
+    if (jcp.with_relu || jcp.with_depthwise) {
         assert(oc_blocks * ur_w < 15);
         test(reg_ci_flag, FLAG_IC_LAST);
         je(regular_store_label, T_NEAR);
 
-        vxorps(yzero, yzero, yzero);
-        if (jcp.relu_negative_slope == 0) {
-           ymm_relu_ns = yzero;
+        auto apply_relu = [=]() {
+            vxorps(yzero, yzero, yzero);
+            if (jcp.relu_negative_slope == 0) {
+               ymm_relu_ns = yzero;
+            } else {
+               mov(imm_addr64, float2int(jcp.relu_negative_slope));
+               movq(xmm_relu_ns, imm_addr64);
+               uni_vbroadcastss(ymm_relu_ns, xmm_relu_ns);
+            }
+
+            for (int ii = 0; ii < oc_blocks; ii++) {
+                for (int jj = 0; jj < ur_w; jj++) {
+                    Ymm reg_out = Ymm(ur_w * ii + jj);
+
+                    vcmpgtps(ymask, reg_out, yzero);
+                    vmulps(ymm_res_ns, ymm_relu_ns, reg_out);
+                    vblendvps(reg_out, ymm_res_ns, reg_out, ymask);
+                }
+            }
+        };
+
+        auto apply_depthwise = [=](const float *data, bool is_scale) {
+            mov(imm_addr64, reinterpret_cast<size_t>(data));
+            add(imm_addr64, ptr[param1 + GET_OFF(oc_off)]);
+
+            for (int ii = 0; ii < oc_blocks; ii++) {
+                const size_t c_off = sizeof(float) * ii * oc_blk;
+                for (int jj = 0; jj < ur_w; jj++) {
+                    Ymm reg_out = Ymm(ur_w * ii + jj);
+                    if (is_scale)
+                        vmulps(reg_out, reg_out, yword[imm_addr64 + c_off]);
+                    else
+                        vaddps(reg_out, reg_out, yword[imm_addr64 + c_off]);
+                }
+            }
+        };
+
+        const auto &p = attr_.post_ops_;
+        if (p.len_ == 0) {
+            apply_relu(); // convolution_relu primitive
         } else {
-           mov(imm_addr64, float2int(jcp.relu_negative_slope));
-           movq(xmm_relu_ns, imm_addr64);
-           uni_vbroadcastss(ymm_relu_ns, xmm_relu_ns);
+            for (int i = 0; i < p.len_; i++) {
+                const auto &e = p.entry_[i];
+                if (e.is_relu()) {
+                    apply_relu();
+                } else if (e.is_depthwise()) {
+                    apply_depthwise(e.depthwise.weights_data, true);
+                    if (e.depthwise.biases_data != nullptr)
+                        apply_depthwise(e.depthwise.biases_data, false);
+                }
+            }
         }
 
         for (int ii = 0; ii < oc_blocks; ii++) {
             for (int jj = 0; jj < ur_w; jj++) {
                 const size_t o_off = (ii * oh * ow + jj) * oc_blk;
                 Ymm reg_out = Ymm(ur_w * ii + jj);
-
-                vcmpgtps(ymask, reg_out, yzero);
-                vmulps(ymm_res_ns, ymm_relu_ns, reg_out);
-                vblendvps(reg_out, ymm_res_ns, reg_out, ymask);
                 vmovups(yword[reg_output + sizeof(float) * o_off], reg_out);
             }
         }
@@ -353,19 +394,18 @@ bool jit_avx2_conv_fwd_kernel_f32::post_ops_ok(
 
     auto is_relu = [&](int idx) { return p.entry_[idx].is_relu(); };
     auto is_sum = [&](int idx) { return p.entry_[idx].is_sum(); };
+    auto is_depthwise = [&](int idx) { return p.entry_[idx].is_depthwise(); };
+    auto is_simple = [&](int idx) { return is_relu(idx) || is_depthwise(idx); };
 
-    switch (p.len_) {
-    case 0: return true; // no post_ops
-    case 1:
-        return true // sum OR relu
-                && !jcp.with_relu && (is_relu(0) || is_sum(0));
-    case 2:
-        return true // sum->relu
-                && !jcp.with_relu && (is_sum(0) && is_relu(1));
-    default: return false;
-    }
+    if (p.len_ > 0 && jcp.with_relu) return false;
+
+    /* sum is allowed at the very beginning only, followed by any sequence
+     * of relu and depthwise post-ops */
+    for (int idx = 0; idx < p.len_; idx++)
+        if (!(is_simple(idx) || (idx == 0 && is_sum(idx))))
+            return false;
 
-    return false;
+    return true;
 }
 
 status_t jit_avx2_conv_fwd_kernel_f32::init_conf(jit_conv_conf_t &jcp,
@@ -416,6 +456,7 @@ status_t jit_avx2_conv_fwd_kernel_f32::init_conf(jit_conv_conf_t &jcp,
         jcp.with_relu = p.find(primitive_kind::eltwise) != -1;
         jcp.relu_negative_slope = 0.f;
     }
+    jcp.with_depthwise = p.find(primitive_kind::depthwise) != -1;
 
     const bool flat = jcp.ic == 3;
     const bool mimo = !flat;
@@ -476,6 +517,14 @@ status_t jit_avx2_conv_fwd_kernel_f32::init_conf(jit_conv_conf_t &jcp,
         jcp.nb_ic_blocking_max = jcp.nb_ic_blocking;
     }
 
+    jcp.nthr_ic_b = 1;
+    if (dst_d.is_dense()) {
+        const int work_amount = jcp.ngroups
+            * div_up(jcp.nb_oc, jcp.nb_oc_blocking) * jcp.oh;
+        jcp.nthr_ic_b = conv_fwd_ic_split_nthr(jcp, work_amount,
+                omp_get_max_threads());
+    }
+
     return status::success;
 }
 
@@ -0,0 +1,253 @@
+/*******************************************************************************
+* Copyright 2018 Intel Corporation
+*
+* Licensed under the Apache License, Version 2.0 (the "License");
+* you may not use this file except in compliance with the License.
+* You may obtain a copy of the License at
+*
+*     http://www.apache.org/licenses/LICENSE-2.0
+*
+* Unless required by applicable law or agreed to in writing, software
+* distributed under the License is distributed on an "AS IS" BASIS,
+* WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+* See the License for the specific language governing permissions and
+* limitations under the License.
+*******************************************************************************/
+
+#include "c_types_map.hpp"
+#include "mkldnn_thread.hpp"
+#include "nstl.hpp"
+#include "type_helpers.hpp"
+#include "utils.hpp"
+#include "cpu_memory.hpp"
+
+#include "jit_avx2_conv_winograd_kernel_f32.hpp"
+
+namespace mkldnn {
+namespace impl {
+namespace cpu {
+
+using namespace mkldnn::impl::memory_format;
+using namespace mkldnn::impl::utils;
+using namespace Xbyak;
+
+void jit_avx2_conv_winograd_data_kernel_f32::generate() {
+    const int n_ur = jcp.dimN_reg_block;
+    const int m_ur = jcp.dimM_reg_block;
+    const int K_reg = jcp.dimK_reg_block;
+
+    /* ymm0 .. ymm(n_ur * m_ur - 1) accumulate the result, the next m_ur
+     * registers keep U, the last one is used to broadcast V */
+    auto ymm_acc = [=](int n, int m) { return Ymm(n * m_ur + m); };
+    auto ymm_srcA = [=](int m) { return Ymm(n_ur * m_ur + m); };
+    Ymm ymm_srcB = Ymm(15);
+    assert(n_ur * m_ur + m_ur + 1 <= 16);
+
+    preamble();
+
+    mov(reg_dimN_loop_cnt, jcp.dimN_block / n_ur);
+    Label dimN_loop;
+    L(dimN_loop); {
+        for (int n = 0; n < n_ur; n++)
+            for (int m = 0; m < m_ur; m++)
+                uni_vpxor(ymm_acc(n, m), ymm_acc(n, m), ymm_acc(n, m));
+
+        mov(reg_srcA_loc, reg_srcA);
+        mov(reg_srcB_loc, reg_srcB);
+        mov(reg_dimK_loop_cnt, jcp.dimK_nb_block);
+        Label dimK_loop;
+        L(dimK_loop); {
+            for (int k = 0; k < K_reg; k++) {
+                for (int m = 0; m < m_ur; m++)
+                    vmovups(ymm_srcA(m), ptr[reg_srcA_loc
+                            + typesize * (k * m_ur + m) * simd_w]);
+                for (int n = 0; n < n_ur; n++) {
+                    vbroadcastss(ymm_srcB, ptr[reg_srcB_loc
+                            + typesize * (n * simd_w + k)]);
+                    for (int m = 0; m < m_ur; m++)
+                        vfmadd231ps(ymm_acc(n, m), ymm_srcA(m), ymm_srcB);
+                }
+            }
+            add(reg_srcA_loc, typesize * K_reg * m_ur * simd_w);
+            add(reg_srcB_loc, typesize * jcp.dimN_block * simd_w);
+            dec(reg_dimK_loop_cnt);
+            jnz(dimK_loop, T_NEAR);
+        }
+
+        for (int m = 0; m < m_ur; m++)
+            for (int n = 0; n < n_ur; n++)
+                vmovups(ptr[reg_dstC + typesize
+                        * (m * jcp.dimN_block + n) * simd_w], ymm_acc(n, m));
+
+        add(reg_dstC, typesize * n_ur * simd_w);
+        add(reg_srcB, typesize * n_ur * simd_w);
+        dec(reg_dimN_loop_cnt);
+        jnz(dimN_loop, T_NEAR);
+    }
+
+    postamble();
+}
+
+bool jit_avx2_conv_winograd_data_kernel_f32::post_ops_ok(
+        const primitive_attr_t &attr) {
+    /* post-ops are applied by the output transform in the order they are
+     * given, so any sequence of the supported ones works */
+    const auto &p = attr.post_ops_;
+    for (int i = 0; i < p.len_; i++) {
+        const auto &e = p.entry_[i];
+        if (!(e.is_sum(false) || e.is_relu(true, false) || e.is_depthwise()))
+            return false;
+    }
+    return true;
+}
+
+status_t jit_avx2_conv_winograd_data_kernel_f32::init_conf_common(
+        jit_conv_winograd_conf_t &jcp, const convolution_desc_t &cd,
+        const memory_desc_wrapper &src_d, const memory_desc_wrapper &weights_d,
+        const memory_desc_wrapper &dst_d) {
+    if (!mayiuse(avx2))
+        return status::unimplemented;
+
+    const bool with_groups = weights_d.ndims() == src_d.ndims() + 1;
+
+    jcp.ngroups = with_groups ? weights_d.dims()[0] : 1;
+    jcp.mb = src_d.dims()[0];
+    jcp.oc = dst_d.dims()[1] / jcp.ngroups;
+    jcp.ic = src_d.dims()[1] / jcp.ngroups;
+    jcp.ih = src_d.dims()[2];
+    jcp.iw = src_d.dims()[3];
+    jcp.oh = dst_d.dims()[2];
+    jcp.ow = dst_d.dims()[3];
+    jcp.kh = weights_d.dims()[with_groups + 2];
+    jcp.kw = weights_d.dims()[with_groups + 3];
+    jcp.t_pad = cd.padding[0][0];
+    jcp.l_pad = cd.padding[0][1];
+    jcp.stride_h = cd.strides[0];
+    jcp.stride_w = cd.strides[1];
+    jcp.dilate_h = cd.dilates[0];
+    jcp.dilate_w = cd.dilates[1];
+    jcp.r_pad = nstl::max(
+            0, (jcp.ow - 1) * jcp.stride_w + jcp.kw - jcp.iw - jcp.l_pad);
+    jcp.b_pad = nstl::max(
+            0, (jcp.oh - 1) * jcp.stride_h + jcp.kh - jcp.ih - jcp.t_pad);
+    jcp.ihp = jcp.ih + jcp.t_pad + jcp.b_pad;
+    jcp.iwp = jcp.iw + jcp.l_pad + jcp.r_pad;
+    jcp.ohp = jcp.oh;
+    jcp.owp = jcp.ow;
+
+    // Checking conditions not supported by these kernels
+    if (jcp.ngroups != 1)
+        return status::unimplemented;
+    if ((jcp.kh != 3) || (jcp.kw != 3))
+        return status::unimplemented;
+    if ((jcp.dilate_h != 0) || (jcp.dilate_w != 0))
+        return status::unimplemented;
+    if ((jcp.stride_h != 1) || (jcp.stride_w != 1))
+        return status::unimplemented;
+    if ((jcp.ic % simd_w) != 0 || (jcp.oc % simd_w) != 0)
+        return status::unimplemented;
+
+    if (src_d.format() != nChw8c)
+        return status::unimplemented;
+    if (weights_d.format() != OIhw8i8o)
+        return status::unimplemented;
+    if (dst_d.format() != nChw8c)
+        return status::unimplemented;
+
+    return status::success;
+}
+
+void jit_avx2_conv_winograd_data_kernel_f32::init_conf_kernel(
+        jit_conv_winograd_conf_t &jcp, int dimM, int dimN, int dimK) {
+    jcp.ver = ver_fma;
+    jcp.sched_policy = WSCHED_DATA_W_S_G_D;
+
+    jcp.dimM = dimM;
+    jcp.dimN = dimN;
+    jcp.dimK = dimK;
+
+    /* register blocking: dimN_reg_block x dimM_reg_block accumulators,
+     * dimM_reg_block registers for U and one for broadcasting V */
+    jcp.dimM_simd_block = simd_w;
+    jcp.dimM_reg_block = (dimM / simd_w) % 3 == 0 ? 3
+        : (dimM / simd_w) % 2 == 0 ? 2 : 1;
+    jcp.dimM_nb_block = dimM / simd_w / jcp.dimM_reg_block;
+    jcp.dimN_reg_block = 12 / jcp.dimM_reg_block;
+
+    jcp.dimK_reg_block = simd_w;
+    jcp.dimK_block = 1;
+    jcp.dimK_nb_block = dimK / simd_w;
+
+    /* dimN block of V should stay in L2 while it is multiplied by all the
+     * dimM blocks of U */
+    const int L2_capacity = get_cache_size(2, true) / 2 / sizeof(float);
+    const int nb_reg_max = nstl::max(1,
+            L2_capacity / (dimK * jcp.dimN_reg_block));
+    const int nb_reg = nstl::min(nb_reg_max,
+            div_up(dimN, jcp.dimN_reg_block));
+    jcp.dimN_block = nb_reg * jcp.dimN_reg_block;
+    jcp.dimN_nb_block = div_up(dimN, jcp.dimN_block);
+}
+
+status_t jit_avx2_conv_winograd_data_kernel_f32::init_conf_fwd(
+        jit_conv_winograd_conf_t &jcp, const convolution_desc_t &cd,
+        const memory_desc_wrapper &src_d, const memory_desc_wrapper &weights_d,
+        const memory_desc_wrapper &dst_d, const primitive_attr_t &attr) {
+    status_t st = init_conf_common(jcp, cd, src_d, weights_d, dst_d);
+    if (st != status::success)
+        return st;
+
+    if (!post_ops_ok(attr))
+        return status::unimplemented;
+
+    jcp.itiles = div_up(jcp.ow, tile_size);
+    jcp.jtiles = div_up(jcp.oh, tile_size);
+    jcp.ntiles = jcp.mb * jcp.itiles * jcp.jtiles;
+
+    jcp.with_bias = cd.bias_desc.format != memory_format::undef;
+    jcp.with_sum = attr.post_ops_.find(primitive_kind::sum) != -1;
+    jcp.with_depthwise = attr.post_ops_.find(primitive_kind::depthwise) != -1;
+
+    init_conf_kernel(jcp, jcp.oc, jcp.ntiles, jcp.ic);
+    jcp.ic_simd_block = jcp.dimK_reg_block;
+    jcp.nb_ic = jcp.dimK_nb_block;
+    jcp.oc_simd_block = jcp.dimM_simd_block;
+    jcp.oc_reg_block = jcp.dimM_reg_block;
+    jcp.nb_oc = jcp.dimM_nb_block;
+    jcp.tile_block_ur = jcp.dimN_reg_block;
+    jcp.tile_block = jcp.dimN_nb_block;
+
+    return status::success;
+}
+
+status_t jit_avx2_conv_winograd_data_kernel_f32::init_conf_bwd_data(
+        jit_conv_winograd_conf_t &jcp, const convolution_desc_t &cd,
+        const memory_desc_wrapper &diff_src_d,
+        const memory_desc_wrapper &weights_d,
+        const memory_desc_wrapper &diff_dst_d) {
+    status_t st = init_conf_common(jcp, cd, diff_src_d, weights_d,
+            diff_dst_d);
+    if (st != status::success)
+        return st;
+
+    jcp.itiles = div_up(jcp.iw, tile_size);
+    jcp.jtiles = div_up(jcp.ih, tile_size);
+    jcp.ntiles = jcp.mb * jcp.itiles * jcp.jtiles;
+
+    init_conf_kernel(jcp, jcp.ic, jcp.ntiles, jcp.oc);
+    jcp.oc_simd_block = jcp.dimK_reg_block;
+    jcp.nb_oc = jcp.dimK_nb_block;
+    jcp.ic_simd_block = jcp.dimM_simd_block;
+    jcp.ic_reg_block = jcp.dimM_reg_block;
+    jcp.nb_ic = jcp.dimM_nb_block;
+    jcp.tile_block_ur = jcp.dimN_reg_block;
+    jcp.tile_block = jcp.dimN_nb_block;
+
+    return status::success;
+}
+
+}
+}
+}
+
+// vim: et ts=4 sw=4 cindent cino^=l0,\:0,N-s
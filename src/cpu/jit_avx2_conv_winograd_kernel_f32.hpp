@@ -0,0 +1,95 @@
+/*******************************************************************************
+* Copyright 2018 Intel Corporation
+*
+* Licensed under the Apache License, Version 2.0 (the "License");
+* you may not use this file except in compliance with the License.
+* You may obtain a copy of the License at
+*
+*     http://www.apache.org/licenses/LICENSE-2.0
+*
+* Unless required by applicable law or agreed to in writing, software
+* distributed under the License is distributed on an "AS IS" BASIS,
+* WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+* See the License for the specific language governing permissions and
+* limitations under the License.
+*******************************************************************************/
+
+#ifndef JIT_AVX2_CONV_WINOGRAD_KERNEL_F32_HPP
+#define JIT_AVX2_CONV_WINOGRAD_KERNEL_F32_HPP
+
+#include "c_types_map.hpp"
+#include "cpu_memory.hpp"
+
+#include "jit_generator.hpp"
+#include "jit_primitive_conf.hpp"
+
+namespace mkldnn {
+namespace impl {
+namespace cpu {
+
+/** Winograd F(4x4, 3x3) gemm kernel for forward and backward by data.
+ *
+ * Notation (the same as for avx512_common):
+ *   FWD: dimM:oc, dimN:ntiles, dimK:ic,
+ *   BWD: dimM:ic, dimN:ntiles, dimK:oc.
+ *
+ * For each of alpha x alpha points of the transformed tile the kernel
+ * computes M[dimM_reg_block][dimN_block][simd_w] +=
+ *     V[dimK / simd_w][dimN_block][simd_w] * U[dimK][dimM_reg_block][simd_w],
+ * i.e. one dimN block of tiles times dimM_reg_block simd blocks of the
+ * output channels. The whole reduction dimension is processed at once. */
+struct jit_avx2_conv_winograd_data_kernel_f32 : public jit_generator {
+    enum { alpha = 6, tile_size = 4, simd_w = 8 };
+
+    jit_avx2_conv_winograd_data_kernel_f32(jit_conv_winograd_conf_t ajcp)
+        : jcp(ajcp)
+    {
+        this->generate();
+        gemm_loop_ker = (decltype(gemm_loop_ker))this->getCode();
+    }
+
+    DECLARE_CPU_JIT_AUX_FUNCTIONS(jit_avx2_conv_winograd_data_kernel_f32)
+
+    static bool post_ops_ok(const primitive_attr_t &attr);
+
+    static status_t init_conf_fwd(jit_conv_winograd_conf_t &jcp,
+            const convolution_desc_t &cd, const memory_desc_wrapper &src_d,
+            const memory_desc_wrapper &weights_d,
+            const memory_desc_wrapper &dst_d, const primitive_attr_t &attr);
+
+    static status_t init_conf_bwd_data(jit_conv_winograd_conf_t &jcp,
+            const convolution_desc_t &cd, const memory_desc_wrapper &diff_src_d,
+            const memory_desc_wrapper &weights_d,
+            const memory_desc_wrapper &diff_dst_d);
+
+    jit_conv_winograd_conf_t jcp;
+    void (*gemm_loop_ker)(float *, const float *, const float *);
+
+private:
+    using reg64_t = const Xbyak::Reg64;
+    enum { typesize = sizeof(float) };
+
+    static status_t init_conf_common(jit_conv_winograd_conf_t &jcp,
+            const convolution_desc_t &cd, const memory_desc_wrapper &src_d,
+            const memory_desc_wrapper &weights_d,
+            const memory_desc_wrapper &dst_d);
+    static void init_conf_kernel(jit_conv_winograd_conf_t &jcp, int dimM,
+            int dimN, int dimK);
+
+    void generate();
+
+    reg64_t reg_dstC = abi_param1;
+    reg64_t reg_srcA = abi_param2;
+    reg64_t reg_srcB = abi_param3;
+
+    reg64_t reg_srcA_loc = r12;
+    reg64_t reg_srcB_loc = r13;
+    reg64_t reg_dimN_loop_cnt = r10;
+    reg64_t reg_dimK_loop_cnt = r11;
+};
+
+}
+}
+}
+
+#endif
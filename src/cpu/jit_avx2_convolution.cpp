@@ -18,6 +18,7 @@
 
 #include "c_types_map.hpp"
 #include "jit_avx2_convolution.hpp"
+#include "jit_uni_conv_ic_split.hpp"
 #include "utils.hpp"
 #include "mkldnn_thread.hpp"
 #include "type_helpers.hpp"
@@ -98,10 +99,13 @@ void _jit_avx2_convolution_fwd_t<with_relu>::execute_forward() {
                         par_conv.flags |= FLAG_IC_FIRST;
                     }
 
-                    if (jcp.with_relu && icb + 1 == jcp.nb_ic) {
+                    if ((jcp.with_relu || jcp.with_depthwise)
+                            && icb + 1 == jcp.nb_ic) {
                         par_conv.flags |= FLAG_IC_LAST;
                     }
 
+                    par_conv.oc_off = _oc * jcp.oc_block * sizeof(float);
+
                     par_conv.oc_blocks =
                             nstl::min(ocb + ocb_num, jcp.nb_oc) - ocb;
 
@@ -125,8 +129,96 @@ void _jit_avx2_convolution_fwd_t<with_relu>::execute_forward() {
     }
 }
 
+template <bool with_relu>
+void _jit_avx2_convolution_fwd_t<with_relu>::execute_forward_ic_split() {
+    auto src = reinterpret_cast<const data_t *>(this->input_memory(0));
+    auto weights = reinterpret_cast<const data_t *>(this->input_memory(1));
+    auto bias = reinterpret_cast<const data_t *>(this->input_memory(2));
+    auto dst = reinterpret_cast<data_t *>(this->memory());
+
+    const memory_desc_wrapper src_d(conf_.src_pd());
+    const memory_desc_wrapper dst_d(conf_.dst_pd());
+    const memory_desc_wrapper weights_d(conf_.weights_pd(0));
+    const memory_desc_wrapper bias_d(conf_.weights_pd(1));
+
+    const auto &jcp = kernel_->jcp;
+    assert(jcp.mb == 1 && jcp.nthr_ic_b > 1);
+
+    const int nthr_ic_b = jcp.nthr_ic_b;
+    const size_t dst_base = dst_d.blk_off(0);
+
+    int ocb_work = div_up(jcp.nb_oc, jcp.nb_oc_blocking);
+    const size_t work_amount = nthr_ic_b * jcp.ngroups * ocb_work * jcp.oh;
+
+    auto ker = [&](const int ithr, const int nthr) {
+        size_t start{0}, end{0};
+        balance211(work_amount, nthr, ithr, start, end);
+
+        size_t icg{0}, g{0}, ocbb{0}, oh{0};
+        nd_iterator_init(start, icg, nthr_ic_b, g, jcp.ngroups, ocbb, ocb_work,
+                         oh, jcp.oh);
+        for (size_t iwork = start; iwork < end; ++iwork) {
+            int icb_s{0}, icb_e{0};
+            balance211(jcp.nb_ic, nthr_ic_b, (int)icg, icb_s, icb_e);
+
+            int ocb = ocbb * jcp.nb_oc_blocking;
+            int ocb_num = jcp.nb_oc_blocking;
+
+            for (int icb = icb_s; icb < icb_e; ++icb) {
+                jit_conv_call_s par_conv = {};
+
+                const int ij = oh * jcp.stride_h;
+                const int i_t_overflow = nstl::max(0, jcp.t_pad - ij);
+                const int i_b_overflow = nstl::max(jcp.ih, ij
+                    + (jcp.kh-1) * (jcp.dilate_h+1) - jcp.t_pad+1) - jcp.ih;
+
+                const size_t _oc = g * jcp.nb_oc + ocb;
+                const size_t _ic = g * jcp.nb_ic + icb;
+
+                const int ih = nstl::max(ij - jcp.t_pad
+                    + div_up(i_t_overflow,
+                             (jcp.dilate_h+1)) * (jcp.dilate_h + 1), 0);
+                par_conv.src = &src[src_d.blk_off(0, _ic, ih, 0)];
+
+                par_conv.dst = &ic_split_buf_[icg * ic_split_part_size_
+                    + dst_d.blk_off(0, _oc, oh, 0) - dst_base];
+
+                const int wh = div_up(i_t_overflow, (jcp.dilate_h + 1));
+                par_conv.filt = &weights[conf_.with_groups()
+                                    ? weights_d.blk_off(g, ocb, icb, wh, 0)
+                                    : weights_d.blk_off(ocb, icb, wh, 0)];
+
+                if (icb == icb_s)
+                    par_conv.flags |= FLAG_IC_FIRST;
+
+                par_conv.oc_blocks =
+                        nstl::min(ocb + ocb_num, jcp.nb_oc) - ocb;
+
+                par_conv.kw_padding = 0;
+                const int kh_padding = jcp.kh
+                    - div_up(i_t_overflow, (jcp.dilate_h + 1))
+                    - div_up(i_b_overflow, (jcp.dilate_h + 1));
+                par_conv.kh_padding = nstl::max(0, kh_padding);
+                ic_split_kernel_->jit_ker(&par_conv);
+            }
+            nd_iterator_step(icg, nthr_ic_b, g, jcp.ngroups, ocbb, ocb_work,
+                            oh, jcp.oh);
+        }
+    };
+
+#pragma omp parallel
+    {
+        ker(omp_get_thread_num(), omp_get_num_threads());
+    }
+
+    conv_fwd_ic_split_reduce(jcp, dst + dst_base, ic_split_buf_,
+            ic_split_part_size_, bias ? bias + bias_d.blk_off(0) : nullptr);
+}
+
 template void _jit_avx2_convolution_fwd_t<true>::execute_forward();
 template void _jit_avx2_convolution_fwd_t<false>::execute_forward();
+template void _jit_avx2_convolution_fwd_t<true>::execute_forward_ic_split();
+template void _jit_avx2_convolution_fwd_t<false>::execute_forward_ic_split();
 
 void jit_avx2_convolution_bwd_data_t::execute_backward_data() {
     auto diff_dst = reinterpret_cast<const data_t *>(this->input_memory(0));
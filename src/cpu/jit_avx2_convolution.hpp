@@ -90,20 +90,51 @@ struct _jit_avx2_convolution_fwd_t: public cpu_primitive_t {
     _jit_avx2_convolution_fwd_t(const pd_t *pd, const input_vector &inputs,
             const output_vector &outputs)
         : cpu_primitive_t(&conf_, inputs, outputs), conf_(*pd)
-    { kernel_ = new jit_avx2_conv_fwd_kernel_f32(conf_.jcp_, *conf_.attr()); }
-    ~_jit_avx2_convolution_fwd_t() { delete kernel_; };
+        , ic_split_kernel_(nullptr), ic_split_buf_(nullptr)
+    {
+        kernel_ = new jit_avx2_conv_fwd_kernel_f32(conf_.jcp_, *conf_.attr());
+
+        const auto &jcp = conf_.jcp_;
+        if (jcp.nthr_ic_b > 1) {
+            /* the partial results are plain sums, bias and post-ops are
+             * applied by the reduction */
+            jit_conv_conf_t jcp_part = jcp;
+            jcp_part.with_bias = jcp_part.with_sum = false;
+            jcp_part.with_relu = jcp_part.with_depthwise = false;
+            ic_split_kernel_ = new jit_avx2_conv_fwd_kernel_f32(jcp_part,
+                    *conf_.attr());
+            ic_split_part_size_ = (size_t)jcp.ngroups * jcp.nb_oc
+                * jcp.oc_block * jcp.oh * jcp.ow;
+            ic_split_buf_ = (data_t *)malloc(sizeof(data_t)
+                    * jcp.nthr_ic_b * ic_split_part_size_, 64);
+        }
+    }
+    ~_jit_avx2_convolution_fwd_t() {
+        delete kernel_;
+        delete ic_split_kernel_;
+        free(ic_split_buf_);
+    };
 
     typedef typename prec_traits<data_type::f32>::type data_t;
 
     virtual void execute(event_t *e) {
-        execute_forward();
+        if (conf_.jcp_.nthr_ic_b > 1)
+            execute_forward_ic_split();
+        else
+            execute_forward();
         e->set_state(event_t::ready);
     }
 
 private:
     void execute_forward();
+    void execute_forward_ic_split();
     pd_t conf_;
     jit_avx2_conv_fwd_kernel_f32 *kernel_;
+
+    /* minibatch 1 latency driver, see jit_uni_conv_ic_split.hpp */
+    jit_avx2_conv_fwd_kernel_f32 *ic_split_kernel_;
+    data_t *ic_split_buf_;
+    size_t ic_split_part_size_;
 };
 
 using jit_avx2_convolution_fwd_t = _jit_avx2_convolution_fwd_t<false>;
@@ -252,6 +283,10 @@ struct jit_avx2_convolution_bwd_weights_t: public cpu_primitive_t {
                     reduce_balancer_t(max_threads, j.oc_block,
                         j.ngroups * j.nb_oc, j.mb, max_buffer_size));
         }
+
+        reducer_weights_->balancer_.add_info(&conf_, "wei");
+        if (reducer_bias_)
+            reducer_bias_->balancer_.add_info(&conf_, "bia");
     }
     ~jit_avx2_convolution_bwd_weights_t() { delete kernel_; };
 
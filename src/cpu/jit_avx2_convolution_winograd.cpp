@@ -0,0 +1,461 @@
+/*******************************************************************************
+* Copyright 2018 Intel Corporation
+*
+* Licensed under the Apache License, Version 2.0 (the "License");
+* you may not use this file except in compliance with the License.
+* You may obtain a copy of the License at
+*
+*     http://www.apache.org/licenses/LICENSE-2.0
+*
+* Unless required by applicable law or agreed to in writing, software
+* distributed under the License is distributed on an "AS IS" BASIS,
+* WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+* See the License for the specific language governing permissions and
+* limitations under the License.
+*******************************************************************************/
+
+#include "mkldnn_types.h"
+
+#include "c_types_map.hpp"
+#include "mkldnn_thread.hpp"
+#include "type_helpers.hpp"
+#include "utils.hpp"
+
+#include "jit_avx2_convolution_winograd.hpp"
+
+#ifndef _MSC_VER
+#define pragma_unroll _Pragma("unroll")
+#else
+#define pragma_unroll
+#endif
+
+namespace mkldnn {
+namespace impl {
+namespace cpu {
+
+using namespace mkldnn::impl::status;
+using namespace mkldnn::impl::memory_format;
+using namespace mkldnn::impl::utils;
+
+namespace {
+
+enum {
+    alpha = jit_avx2_conv_winograd_data_kernel_f32::alpha,
+    tile_size = jit_avx2_conv_winograd_data_kernel_f32::tile_size,
+    simd_w = jit_avx2_conv_winograd_data_kernel_f32::simd_w,
+};
+
+/* The transforms are the same as in the avx512_common implementation
+ * (including the scaling of the points), only the vector length differs */
+void trans_I_4x4_3x3(float Iw[alpha][alpha][simd_w],
+        float I[alpha][alpha][simd_w]) {
+    float T[alpha][alpha][simd_w];
+    float t0[simd_w];
+    float t1[simd_w];
+    float t2[simd_w];
+    float t3[simd_w];
+    float t4[simd_w];
+    float t5[simd_w];
+
+pragma_unroll
+    for (int i = 0; i < alpha; i++) {
+#pragma omp simd
+        for (int v = 0; v < simd_w; v++) {
+            t0[v] = I[2][i][v] * -2.25f + I[4][i][v];
+            t1[v] = I[1][i][v] * -2.25f + I[3][i][v];
+            t2[v] = I[2][i][v] * -0.390625f + I[4][i][v];
+            t3[v] = I[1][i][v] * -0.390625f + I[3][i][v];
+            t4[v] = I[0][i][v] * 0.87890625f + I[4][i][v];
+            t5[v] = I[1][i][v] * 0.87890625f + I[5][i][v];
+
+            T[0][i][v] = I[2][i][v] * -2.640625f + t4[v];
+            T[1][i][v] = t1[v] * 0.625f + t0[v];
+            T[2][i][v] = t1[v] * -0.625f + t0[v];
+            T[3][i][v] = t3[v] * 1.5f + t2[v];
+            T[4][i][v] = t3[v] * -1.5f + t2[v];
+            T[5][i][v] = I[3][i][v] * -2.640625f + t5[v];
+        }
+    }
+
+pragma_unroll
+    for (int i = 0; i < alpha; i++) {
+#pragma omp simd
+        for (int v = 0; v < simd_w; v++) {
+            t0[v] = T[i][2][v] * -2.25f + T[i][4][v];
+            t1[v] = T[i][1][v] * -2.25f + T[i][3][v];
+            t2[v] = T[i][2][v] * -0.390625f + T[i][4][v];
+            t3[v] = T[i][1][v] * -0.390625f + T[i][3][v];
+            t4[v] = T[i][0][v] * 0.87890625f + T[i][4][v];
+            t5[v] = T[i][1][v] * 0.87890625f + T[i][5][v];
+
+            Iw[i][0][v] = T[i][2][v] * -2.640625f + t4[v];
+            Iw[i][1][v] = t1[v] * 0.625f + t0[v];
+            Iw[i][2][v] = t1[v] * -0.625f + t0[v];
+            Iw[i][3][v] = t3[v] * 1.5f + t2[v];
+            Iw[i][4][v] = t3[v] * -1.5f + t2[v];
+            Iw[i][5][v] = T[i][3][v] * -2.640625f + t5[v];
+        }
+    }
+}
+
+void trans_W_4x4_3x3(float Fw_[alpha][alpha][simd_w][simd_w],
+        float F[3][3][simd_w][simd_w]) {
+    float Fw[alpha][simd_w];
+    float T[alpha][3][simd_w];
+    float t0[simd_w];
+    float t1[simd_w];
+    float t2[simd_w];
+
+    for (int j = 0; j < simd_w; j++) {
+pragma_unroll
+        for (int i = 0; i < 3; i++) {
+#pragma omp simd
+            for (int k = 0; k < simd_w; k++) {
+                t0[k] = 0.26890756302521f * F[2][i][j][k];
+                t1[k] = -t0[k] - 0.688403361344538f * F[0][i][j][k];
+                t2[k] = t0[k] + 0.119514472455649f * F[0][i][j][k];
+
+                T[0][i][k] = 1.13777777777778f * F[0][i][j][k];
+                T[1][i][k] = t1[k] - 0.430252100840336f * F[1][i][j][k];
+                T[2][i][k] = t1[k] + 0.430252100840336f * F[1][i][j][k];
+                T[3][i][k] = t2[k] + 0.179271708683473f * F[1][i][j][k];
+                T[4][i][k] = t2[k] - 0.179271708683473f * F[1][i][j][k];
+                T[5][i][k] = F[2][i][j][k];
+            }
+        }
+pragma_unroll
+        for (int i = 0; i < alpha; i++) {
+#pragma omp simd
+            for (int k = 0; k < simd_w; k++) {
+                t0[k] = 0.26890756302521f * T[i][2][k];
+                t1[k] = -t0[k] - 0.688403361344538f * T[i][0][k];
+                t2[k] = t0[k] + 0.119514472455649f * T[i][0][k];
+
+                Fw[0][k] = 1.13777777777778f * T[i][0][k];
+                Fw[1][k] = t1[k] - 0.430252100840336f * T[i][1][k];
+                Fw[2][k] = t1[k] + 0.430252100840336f * T[i][1][k];
+                Fw[3][k] = t2[k] + 0.179271708683473f * T[i][1][k];
+                Fw[4][k] = t2[k] - 0.179271708683473f * T[i][1][k];
+                Fw[5][k] = T[i][2][k];
+            }
+            for (int l = 0; l < alpha; l++)
+#pragma omp simd
+                for (int k = 0; k < simd_w; k++)
+                    Fw_[i][l][j][k] = Fw[l][k];
+        }
+    }
+}
+
+void trans_O_4x4_3x3(float Mw[alpha][alpha][simd_w],
+        float O[tile_size][tile_size][simd_w]) {
+    float T[tile_size][alpha][simd_w];
+    float t0[simd_w];
+    float t1[simd_w];
+    float t2[simd_w];
+    float t3[simd_w];
+
+pragma_unroll
+    for (int i = 0; i < alpha; i++) {
+#pragma omp simd
+        for (int v = 0; v < simd_w; v++) {
+            t0[v] = Mw[1][i][v] + Mw[2][i][v];
+            t1[v] = Mw[3][i][v] + Mw[4][i][v];
+            t2[v] = Mw[1][i][v] - Mw[2][i][v];
+            t3[v] = Mw[3][i][v] - Mw[4][i][v];
+
+            T[0][i][v] = t0[v] + t1[v] + Mw[0][i][v];
+            T[1][i][v] = t2[v] * 0.625f + t3[v] * 1.5f;
+            T[2][i][v] = t0[v] * 0.390625f + t1[v] * 2.25f;
+            T[3][i][v] = t2[v] * 0.244140625f + t3[v] * 3.375f + Mw[5][i][v];
+        }
+    }
+pragma_unroll
+    for (int i = 0; i < tile_size; i++) {
+#pragma omp simd
+        for (int v = 0; v < simd_w; v++) {
+            t0[v] = T[i][1][v] + T[i][2][v];
+            t1[v] = T[i][3][v] + T[i][4][v];
+            t2[v] = T[i][1][v] - T[i][2][v];
+            t3[v] = T[i][3][v] - T[i][4][v];
+
+            O[i][0][v] = t0[v] + t1[v] + T[i][0][v];
+            O[i][1][v] = t2[v] * 0.625f + t3[v] * 1.5f;
+            O[i][2][v] = t0[v] * 0.390625f + t1[v] * 2.25f;
+            O[i][3][v] = t2[v] * 0.244140625f + t3[v] * 3.375f + T[i][5][v];
+        }
+    }
+}
+
+/* Transforms all the tiles of one image for one simd block of the input
+ * channels. V layout: [alpha][alpha][dimN_nb_block][dimK/simd_w]
+ * [dimN_block][simd_w] */
+template <bool is_fwd>
+void input_transform_data(int image, int K_blk,
+        const jit_conv_winograd_conf_t &jcp, const float *inp, float *tinp) {
+    const int inpw = is_fwd ? jcp.iw : jcp.ow;
+    const int inph = is_fwd ? jcp.ih : jcp.oh;
+    const int l_pad = is_fwd ? jcp.l_pad : jcp.iw + jcp.r_pad - jcp.ow;
+    const int t_pad = is_fwd ? jcp.t_pad : jcp.ih + jcp.t_pad - jcp.oh;
+    float Iw[alpha][alpha][simd_w];
+    float I[alpha][alpha][simd_w];
+
+    array_offset_calculator<float, 6> V(tinp, alpha, alpha,
+            jcp.dimN_nb_block, jcp.dimK / simd_w, jcp.dimN_block, simd_w);
+
+    int tile = image * jcp.jtiles * jcp.itiles;
+    for (int tj = 0; tj < jcp.jtiles; tj++) {
+        for (int ti = 0; ti < jcp.itiles; ti++, tile++) {
+            for (int j = 0; j < alpha; j++) {
+                const int ydim = tj * tile_size + j - t_pad;
+                for (int i = 0; i < alpha; i++) {
+                    const int xdim = ti * tile_size + i - l_pad;
+                    if (0 <= ydim && ydim < inph && 0 <= xdim && xdim < inpw) {
+                        const float *pinp = inp
+                            + (ydim * inpw + xdim) * simd_w;
+#pragma omp simd
+                        for (int v = 0; v < simd_w; v++)
+                            I[j][i][v] = pinp[v];
+                    } else {
+#pragma omp simd
+                        for (int v = 0; v < simd_w; v++)
+                            I[j][i][v] = 0.f;
+                    }
+                }
+            }
+
+            trans_I_4x4_3x3(Iw, I);
+
+            const int N_blk = tile / jcp.dimN_block;
+            const int N_off = tile % jcp.dimN_block;
+            for (int j = 0; j < alpha; j++)
+                for (int i = 0; i < alpha; i++) {
+                    float *pV = &V(j, i, N_blk, K_blk, N_off, 0);
+#pragma omp simd
+                    for (int v = 0; v < simd_w; v++)
+                        pV[v] = Iw[j][i][v];
+                }
+        }
+    }
+
+    /* the last dimN block is padded up to dimN_block tiles; the padded part
+     * is never read back, but keep it zero to avoid denormals and NaNs */
+    if (image == jcp.mb - 1) {
+        const int N_blk = jcp.dimN_nb_block - 1;
+        for (int j = 0; j < alpha; j++)
+            for (int i = 0; i < alpha; i++)
+                for (int N_off = tile - N_blk * jcp.dimN_block;
+                        N_off < jcp.dimN_block; N_off++) {
+                    float *pV = &V(j, i, N_blk, K_blk, N_off, 0);
+#pragma omp simd
+                    for (int v = 0; v < simd_w; v++)
+                        pV[v] = 0.f;
+                }
+    }
+}
+
+/* Transforms one simd_w x simd_w block of the weights. U layout:
+ * [alpha][alpha][dimM_nb_block][dimK][dimM_reg_block][simd_w] */
+template <bool is_fwd>
+void weight_transform_data(int M_blk, int K_blk,
+        const jit_conv_winograd_conf_t &jcp, const float *wp, float *twp) {
+    float Fw[alpha][alpha][simd_w][simd_w];
+    float F[3][3][simd_w][simd_w];
+
+    /* F[j][i][k][m]: k goes along dimK, m along dimM */
+    for (int j = 0; j < 3; j++) {
+        for (int i = 0; i < 3; i++) {
+            for (int v1 = 0; v1 < simd_w; v1++) {
+                const float *base_inp = is_fwd
+                    ? wp + ((j * 3 + i) * simd_w + v1) * simd_w
+                    : wp + (((2 - j) * 3 + (2 - i)) * simd_w + v1) * simd_w;
+#pragma omp simd
+                for (int v2 = 0; v2 < simd_w; v2++) {
+                    if (is_fwd)
+                        F[j][i][v1][v2] = base_inp[v2];
+                    else
+                        F[j][i][v2][v1] = base_inp[v2];
+                }
+            }
+        }
+    }
+
+    trans_W_4x4_3x3(Fw, F);
+
+    array_offset_calculator<float, 6> U(twp, alpha, alpha, jcp.dimM_nb_block,
+            jcp.dimK, jcp.dimM_reg_block, simd_w);
+    const int M_nb = M_blk / jcp.dimM_reg_block;
+    const int M_reg = M_blk % jcp.dimM_reg_block;
+    for (int j = 0; j < alpha; j++)
+        for (int i = 0; i < alpha; i++)
+            for (int k = 0; k < simd_w; k++) {
+                float *pU = &U(j, i, M_nb, K_blk * simd_w + k, M_reg, 0);
+#pragma omp simd
+                for (int v = 0; v < simd_w; v++)
+                    pU[v] = Fw[j][i][k][v];
+            }
+}
+
+/* Transforms all the tiles of one image for one simd block of the output
+ * channels and applies bias and post-ops. M layout: [alpha][alpha]
+ * [dimN_nb_block][dimM/simd_w][dimN_block][simd_w] */
+template <bool is_fwd>
+void output_transform_data(int image, int M_blk,
+        const jit_conv_winograd_conf_t &jcp, const post_ops_t &p_ops,
+        const float *toutp, float *outp, const float *bias) {
+    const int outw = is_fwd ? jcp.ow : jcp.iw;
+    const int outh = is_fwd ? jcp.oh : jcp.ih;
+    float Ow[alpha][alpha][simd_w];
+    float O[tile_size][tile_size][simd_w];
+
+    array_offset_calculator<const float, 6> M(toutp, alpha, alpha,
+            jcp.dimN_nb_block, jcp.dimM / simd_w, jcp.dimN_block, simd_w);
+
+    int tile = image * jcp.jtiles * jcp.itiles;
+    for (int tj = 0; tj < jcp.jtiles; tj++) {
+        for (int ti = 0; ti < jcp.itiles; ti++, tile++) {
+            const int N_blk = tile / jcp.dimN_block;
+            const int N_off = tile % jcp.dimN_block;
+            for (int j = 0; j < alpha; j++)
+                for (int i = 0; i < alpha; i++) {
+                    const float *pM = &M(j, i, N_blk, M_blk, N_off, 0);
+#pragma omp simd
+                    for (int v = 0; v < simd_w; v++)
+                        Ow[j][i][v] = pM[v];
+                }
+
+            trans_O_4x4_3x3(Ow, O);
+
+            for (int j = 0; j < tile_size; j++) {
+                const int ydim = tj * tile_size + j;
+                if (ydim >= outh)
+                    break;
+                for (int i = 0; i < tile_size; i++) {
+                    const int xdim = ti * tile_size + i;
+                    if (xdim >= outw)
+                        break;
+                    float *pout = outp + (ydim * outw + xdim) * simd_w;
+                    float *o = O[j][i];
+                    if (is_fwd) {
+                        if (jcp.with_bias)
+#pragma omp simd
+                            for (int v = 0; v < simd_w; v++)
+                                o[v] += bias[v];
+                        for (int idx = 0; idx < p_ops.len_; idx++) {
+                            const auto &e = p_ops.entry_[idx];
+                            if (e.is_sum(false)) {
+#pragma omp simd
+                                for (int v = 0; v < simd_w; v++)
+                                    o[v] += e.sum.scale * pout[v];
+                            } else if (e.is_relu(true, false)) {
+#pragma omp simd
+                                for (int v = 0; v < simd_w; v++)
+                                    o[v] = o[v] < 0.f
+                                        ? o[v] * e.eltwise.alpha : o[v];
+                            } else if (e.is_depthwise()) {
+                                const float *w = e.depthwise.weights_data
+                                    + M_blk * simd_w;
+                                const float *b = e.depthwise.biases_data
+                                    + M_blk * simd_w;
+#pragma omp simd
+                                for (int v = 0; v < simd_w; v++)
+                                    o[v] = o[v] * w[v] + b[v];
+                            }
+                        }
+                    }
+#pragma omp simd
+                    for (int v = 0; v < simd_w; v++)
+                        pout[v] = o[v];
+                }
+            }
+        }
+    }
+}
+
+}
+
+template <bool is_fwd>
+void _jit_avx2_convolution_winograd_t<is_fwd>::_execute_data_W_S_G_D(
+        float *inp_ptr, float *out_ptr, float *wei_ptr, float *bias_ptr) {
+    const auto &jcp = kernel_->jcp;
+    const auto &p_ops = attr_->post_ops_;
+
+    const int inph = is_fwd ? jcp.ih : jcp.oh;
+    const int inpw = is_fwd ? jcp.iw : jcp.ow;
+    const int outh = is_fwd ? jcp.oh : jcp.ih;
+    const int outw = is_fwd ? jcp.ow : jcp.iw;
+
+    /* Notation:
+       FWD: dimM:oc, dimN:ntiles, dimK:ic,
+       BWD: dimM:ic, dimN:ntiles, dimK:oc,
+       FWD/BWD: V: src/diff_dst transform, U:weight transform,
+                M:dst/diff_src transform  */
+    const int nb_M = jcp.dimM / simd_w;
+    const int nb_K = jcp.dimK / simd_w;
+
+    array_offset_calculator<float, 5> input(inp_ptr,
+            jcp.mb, nb_K, inph, inpw, simd_w);
+    array_offset_calculator<float, 5> output(out_ptr,
+            jcp.mb, nb_M, outh, outw, simd_w);
+    array_offset_calculator<float, 6> weights(wei_ptr,
+            jcp.oc / simd_w, jcp.ic / simd_w, jcp.kh, jcp.kw, simd_w, simd_w);
+
+    char *sp = scratchpad_->get();
+    float *U_ptr = (float *)sp;
+    float *V_ptr = (float *)(sp + V_offset_);
+    float *M_ptr = (float *)(sp + M_offset_);
+
+    array_offset_calculator<float, 6> U(U_ptr, alpha, alpha,
+            jcp.dimM_nb_block, jcp.dimK, jcp.dimM_reg_block, simd_w);
+    array_offset_calculator<float, 6> V(V_ptr, alpha, alpha,
+            jcp.dimN_nb_block, nb_K, jcp.dimN_block, simd_w);
+    array_offset_calculator<float, 6> M(M_ptr, alpha, alpha,
+            jcp.dimN_nb_block, nb_M, jcp.dimN_block, simd_w);
+
+#pragma omp parallel
+    {
+#pragma omp for nowait collapse(2)
+        for (int img = 0; img < jcp.mb; img++)
+            for (int K_blk = 0; K_blk < nb_K; K_blk++)
+                input_transform_data<is_fwd>(img, K_blk, jcp,
+                        &input(img, K_blk, 0, 0, 0), V_ptr);
+
+#pragma omp for nowait collapse(2) schedule(static)
+        for (int ofm = 0; ofm < jcp.oc / simd_w; ofm++)
+            for (int ifm = 0; ifm < jcp.ic / simd_w; ifm++)
+                weight_transform_data<is_fwd>(is_fwd ? ofm : ifm,
+                        is_fwd ? ifm : ofm, jcp,
+                        &weights(ofm, ifm, 0, 0, 0, 0), U_ptr);
+
+#pragma omp barrier
+#pragma omp for collapse(4) schedule(static)
+        for (int oj = 0; oj < alpha; oj++)
+            for (int oi = 0; oi < alpha; oi++)
+                for (int N_blk = 0; N_blk < jcp.dimN_nb_block; N_blk++)
+                    for (int M_blk = 0; M_blk < jcp.dimM_nb_block; M_blk++)
+                        kernel_->gemm_loop_ker(
+                                &M(oj, oi, N_blk,
+                                    M_blk * jcp.dimM_reg_block, 0, 0),
+                                &U(oj, oi, M_blk, 0, 0, 0),
+                                &V(oj, oi, N_blk, 0, 0, 0));
+
+#pragma omp for collapse(2)
+        for (int img = 0; img < jcp.mb; img++)
+            for (int M_blk = 0; M_blk < nb_M; M_blk++)
+                output_transform_data<is_fwd>(img, M_blk, jcp, p_ops, M_ptr,
+                        &output(img, M_blk, 0, 0, 0),
+                        bias_ptr + M_blk * simd_w);
+    }
+}
+
+template void
+_jit_avx2_convolution_winograd_t<true>::_execute_data_W_S_G_D(
+        float *, float *, float *, float *);
+template void
+_jit_avx2_convolution_winograd_t<false>::_execute_data_W_S_G_D(
+        float *, float *, float *, float *);
+
+}
+}
+}
+
+// vim: et ts=4 sw=4 cindent cino^=l0,\:0,N-s
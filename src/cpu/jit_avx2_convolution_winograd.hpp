@@ -0,0 +1,236 @@
+/*******************************************************************************
+* Copyright 2018 Intel Corporation
+*
+* Licensed under the Apache License, Version 2.0 (the "License");
+* you may not use this file except in compliance with the License.
+* You may obtain a copy of the License at
+*
+*     http://www.apache.org/licenses/LICENSE-2.0
+*
+* Unless required by applicable law or agreed to in writing, software
+* distributed under the License is distributed on an "AS IS" BASIS,
+* WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+* See the License for the specific language governing permissions and
+* limitations under the License.
+*******************************************************************************/
+
+#ifndef CPU_JIT_AVX2_CONVOLUTION_WINOGRAD_HPP
+#define CPU_JIT_AVX2_CONVOLUTION_WINOGRAD_HPP
+
+#include "c_types_map.hpp"
+#include "cpu_convolution_pd.hpp"
+#include "cpu_engine.hpp"
+#include "scratchpad.hpp"
+
+#include "jit_avx2_conv_winograd_kernel_f32.hpp"
+
+namespace mkldnn {
+namespace impl {
+namespace cpu {
+
+template <bool is_fwd>
+struct _jit_avx2_convolution_winograd_t {
+
+    _jit_avx2_convolution_winograd_t(const jit_conv_winograd_conf_t &jcp,
+            const primitive_attr_t *attr)
+        : kernel_(nullptr), scratchpad_(nullptr), attr_(attr) {
+        kernel_ = new jit_avx2_conv_winograd_data_kernel_f32(jcp);
+
+        const int alpha = jit_avx2_conv_winograd_data_kernel_f32::alpha;
+        const size_t dimN_padded = (size_t)jcp.dimN_nb_block * jcp.dimN_block;
+        const size_t page_size = PAGE_2M;
+        const size_t U_sz = alpha * alpha * jcp.dimK * jcp.dimM
+            * sizeof(float);
+        const size_t V_sz = alpha * alpha * jcp.dimK * dimN_padded
+            * sizeof(float);
+        const size_t M_sz = alpha * alpha * jcp.dimM * dimN_padded
+            * sizeof(float);
+        V_offset_ = utils::rnd_up(U_sz, page_size);
+        M_offset_ = V_offset_ + utils::rnd_up(V_sz, page_size);
+        scratchpad_ = create_scratchpad(M_offset_ + M_sz);
+    }
+
+    ~_jit_avx2_convolution_winograd_t() {
+        delete kernel_;
+        delete scratchpad_;
+    };
+
+protected:
+    void _execute_data_W_S_G_D(float *inp_ptr, float *out_ptr,
+            float *wei_ptr, float *bias_ptr = NULL);
+
+    jit_avx2_conv_winograd_data_kernel_f32 *kernel_;
+    // Buffer required to store transforms in the frequency domain
+    scratchpad_t *scratchpad_;
+    size_t V_offset_, M_offset_;
+    const primitive_attr_t *attr_;
+};
+
+struct jit_avx2_convolution_winograd_fwd_t
+     : _jit_avx2_convolution_winograd_t<true>
+     , public cpu_primitive_t
+    {
+    struct pd_t : public cpu_convolution_fwd_pd_t {
+        pd_t(engine_t *engine, const convolution_desc_t *adesc,
+                const primitive_attr_t *attr,
+                const typename pd_t::base_class *hint_fwd_pd)
+            : cpu_convolution_fwd_pd_t(engine, adesc, attr, hint_fwd_pd)
+            , jcp_({}) {}
+
+        DECLARE_COMMON_PD_T(
+                JIT_IMPL_NAME_HELPER("jit_wino:", avx2, ""),
+                jit_avx2_convolution_winograd_fwd_t);
+
+        virtual status_t init() override
+        {
+            using namespace prop_kind;
+            assert(this->engine()->kind() == engine_kind::cpu);
+            bool ok = true && this->set_default_params() == status::success
+                    && utils::one_of(this->cdesc_().prop_kind, forward_training,
+                               forward_inference)
+                    && this->cdesc_().alg_kind == alg_kind::convolution_winograd
+                    && utils::everyone_is(data_type::f32,
+                               this->cdesc_().src_desc.data_type,
+                               this->cdesc_().weights_desc.data_type,
+                               this->cdesc_().dst_desc.data_type)
+                    && utils::implication(this->with_bias(), data_type::f32
+                                       == this->cdesc_().bias_desc.data_type);
+            if (!ok)
+                return status::unimplemented;
+
+            return jit_avx2_conv_winograd_data_kernel_f32::init_conf_fwd(
+                    jcp_, this->cdesc_(), *this->src_pd_.desc(),
+                    *this->weights_pd_.desc(), *this->dst_pd_.desc(),
+                    *this->attr());
+        }
+
+        jit_conv_winograd_conf_t jcp_;
+
+    protected:
+        virtual status_t set_default_params() override
+        {
+            using namespace memory_format;
+            if (this->src_pd_.desc()->format == any)
+                CHECK(this->src_pd_.set_format(nChw8c));
+            if (this->dst_pd_.desc()->format == any)
+                CHECK(this->dst_pd_.set_format(nChw8c));
+            if (this->weights_pd_.desc()->format == any)
+                CHECK(this->weights_pd_.set_format(
+                        this->with_groups() ? gOIhw8i8o : OIhw8i8o));
+            if (this->bias_pd_.desc()->format == any)
+                CHECK(this->bias_pd_.set_format(x));
+            return status::success;
+        }
+    };
+
+    jit_avx2_convolution_winograd_fwd_t(const pd_t *pd,
+            const input_vector &inputs, const output_vector &outputs)
+        : _jit_avx2_convolution_winograd_t<true>(pd->jcp_, pd->attr())
+        , cpu_primitive_t(&conf_, inputs, outputs)
+        , conf_(*pd) {}
+
+    ~jit_avx2_convolution_winograd_fwd_t(){};
+
+    typedef typename prec_traits<data_type::f32>::type data_t;
+
+    virtual void execute(event_t *e)
+    {
+        float *src = (float *)this->input_memory(0);
+        float *dst = (float *)this->memory();
+        float *weights = (float *)this->input_memory(1);
+        float *bias = (float *)this->input_memory(2);
+
+        this->_execute_data_W_S_G_D(src, dst, weights, bias);
+        e->set_state(event_t::ready);
+    }
+
+private:
+    pd_t conf_;
+};
+
+struct jit_avx2_convolution_winograd_bwd_data_t
+        : _jit_avx2_convolution_winograd_t<false>,
+        public cpu_primitive_t {
+    struct pd_t : public cpu_convolution_bwd_data_pd_t {
+        pd_t(engine_t *engine, const convolution_desc_t *adesc,
+                const primitive_attr_t *attr,
+                const convolution_fwd_pd_t *hint_fwd_pd)
+            : cpu_convolution_bwd_data_pd_t(engine, adesc, attr, hint_fwd_pd)
+            , jcp_({}) {}
+
+        DECLARE_COMMON_PD_T(
+                JIT_IMPL_NAME_HELPER("jit_wino:", avx2, ""),
+                jit_avx2_convolution_winograd_bwd_data_t);
+
+        virtual status_t init() override
+        {
+            using namespace prop_kind;
+            assert(this->engine()->kind() == engine_kind::cpu);
+            bool ok = true && this->set_default_params() == status::success
+                    && utils::one_of(this->desc()->prop_kind, backward_data)
+                    && this->desc()->alg_kind == alg_kind::convolution_winograd
+                    && utils::everyone_is(data_type::f32,
+                               this->desc()->diff_src_desc.data_type,
+                               this->desc()->weights_desc.data_type,
+                               this->desc()->diff_dst_desc.data_type);
+            if (!ok)
+                return status::unimplemented;
+
+            return jit_avx2_conv_winograd_data_kernel_f32::init_conf_bwd_data(
+                    jcp_, *this->desc(), *this->diff_src_pd_.desc(),
+                    *this->weights_pd_.desc(), *this->diff_dst_pd_.desc());
+        }
+
+        jit_conv_winograd_conf_t jcp_;
+
+    protected:
+        virtual status_t set_default_params() override
+        {
+            using namespace memory_format;
+
+            if (this->diff_src_pd_.desc()->format == any)
+                CHECK(this->diff_src_pd_.set_format(nChw8c));
+            if (this->diff_dst_pd_.desc()->format == any)
+                CHECK(this->diff_dst_pd_.set_format(nChw8c));
+            if (this->weights_pd_.desc()->format == any)
+                CHECK(this->weights_pd_.set_format(
+                        this->with_groups() ? gOIhw8i8o : OIhw8i8o));
+            return status::success;
+        }
+    };
+
+    jit_avx2_convolution_winograd_bwd_data_t(const pd_t *pd,
+            const input_vector &inputs, const output_vector &outputs)
+        : _jit_avx2_convolution_winograd_t<false>(pd->jcp_, pd->attr())
+        , cpu_primitive_t(&conf_, inputs, outputs)
+        , conf_(*pd) {}
+
+    ~jit_avx2_convolution_winograd_bwd_data_t(){};
+
+    typedef typename prec_traits<data_type::f32>::type data_t;
+
+    virtual void execute(event_t *e)
+    {
+        float *diff_dst = (float *)this->input_memory(0);
+        float *diff_src = (float *)this->memory();
+        float *weights = (float *)this->input_memory(1);
+
+        if (conf_.desc()->prop_kind == prop_kind::backward_data)
+            this->_execute_data_W_S_G_D(diff_dst, diff_src, weights, NULL);
+        else
+            assert(!"invalid prop_kind");
+
+        e->set_state(event_t::ready);
+    }
+
+private:
+    pd_t conf_;
+};
+
+}
+}
+}
+
+#endif
+
+// vim: et ts=4 sw=4 cindent cino^=l0,\:0,N-s
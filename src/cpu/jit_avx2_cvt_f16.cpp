@@ -0,0 +1,97 @@
+/*******************************************************************************
+* Copyright 2018 Intel Corporation
+*
+* Licensed under the Apache License, Version 2.0 (the "License");
+* you may not use this file except in compliance with the License.
+* You may obtain a copy of the License at
+*
+*     http://www.apache.org/licenses/LICENSE-2.0
+*
+* Unless required by applicable law or agreed to in writing, software
+* distributed under the License is distributed on an "AS IS" BASIS,
+* WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+* See the License for the specific language governing permissions and
+* limitations under the License.
+*******************************************************************************/
+
+#include "jit_avx2_cvt_f16.hpp"
+
+#define GET_OFF(field) offsetof(jit_cvt_f16_call_s, field)
+
+namespace mkldnn {
+namespace impl {
+namespace cpu {
+
+using namespace Xbyak;
+
+void jit_avx2_cvt_f16_to_f32::generate() {
+    const int simd_w = 8;
+    const int unroll = 4;
+
+    Reg64 reg_inp = r8;
+    Reg64 reg_out = r9;
+    Reg64 reg_nelems = r10;
+    Reg32 reg_tmp = eax;
+
+    Label unroll_loop, unroll_loop_end, simd_loop, simd_loop_end;
+    Label tail_loop, tail_loop_end;
+
+    this->preamble();
+
+    mov(reg_inp, ptr[this->param1 + GET_OFF(inp)]);
+    mov(reg_out, ptr[this->param1 + GET_OFF(out)]);
+    mov(reg_nelems, ptr[this->param1 + GET_OFF(nelems)]);
+
+    L(unroll_loop); {
+        cmp(reg_nelems, unroll * simd_w);
+        jl(unroll_loop_end, T_NEAR);
+
+        for (int i = 0; i < unroll; i++)
+            vcvtph2ps(Ymm(i), ptr[reg_inp + i * simd_w * sizeof(float16_t)]);
+        for (int i = 0; i < unroll; i++)
+            vmovups(ptr[reg_out + i * simd_w * sizeof(float)], Ymm(i));
+
+        add(reg_inp, unroll * simd_w * sizeof(float16_t));
+        add(reg_out, unroll * simd_w * sizeof(float));
+        sub(reg_nelems, unroll * simd_w);
+        jmp(unroll_loop, T_NEAR);
+    }
+    L(unroll_loop_end);
+
+    L(simd_loop); {
+        cmp(reg_nelems, simd_w);
+        jl(simd_loop_end, T_NEAR);
+
+        vcvtph2ps(Ymm(0), ptr[reg_inp]);
+        vmovups(ptr[reg_out], Ymm(0));
+
+        add(reg_inp, simd_w * sizeof(float16_t));
+        add(reg_out, simd_w * sizeof(float));
+        sub(reg_nelems, simd_w);
+        jmp(simd_loop, T_NEAR);
+    }
+    L(simd_loop_end);
+
+    L(tail_loop); {
+        cmp(reg_nelems, 0);
+        jle(tail_loop_end, T_NEAR);
+
+        movzx(reg_tmp, word[reg_inp]);
+        vmovd(Xmm(0), reg_tmp);
+        vcvtph2ps(Xmm(0), Xmm(0));
+        vmovss(ptr[reg_out], Xmm(0));
+
+        add(reg_inp, sizeof(float16_t));
+        add(reg_out, sizeof(float));
+        sub(reg_nelems, 1);
+        jmp(tail_loop, T_NEAR);
+    }
+    L(tail_loop_end);
+
+    vzeroupper();
+    this->postamble();
+}
+
+}
+}
+}
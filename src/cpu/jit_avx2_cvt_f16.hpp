@@ -0,0 +1,64 @@
+/*******************************************************************************
+* Copyright 2018 Intel Corporation
+*
+* Licensed under the Apache License, Version 2.0 (the "License");
+* you may not use this file except in compliance with the License.
+* You may obtain a copy of the License at
+*
+*     http://www.apache.org/licenses/LICENSE-2.0
+*
+* Unless required by applicable law or agreed to in writing, software
+* distributed under the License is distributed on an "AS IS" BASIS,
+* WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+* See the License for the specific language governing permissions and
+* limitations under the License.
+*******************************************************************************/
+
+#ifndef JIT_AVX2_CVT_F16_HPP
+#define JIT_AVX2_CVT_F16_HPP
+
+#include "c_types_map.hpp"
+#include "jit_generator.hpp"
+#include "mkldnn_traits.hpp"
+
+namespace mkldnn {
+namespace impl {
+namespace cpu {
+
+struct jit_cvt_f16_call_s {
+    const void *inp;
+    float *out;
+    size_t nelems;
+};
+
+/* Widens f16 values to f32 with the F16C vcvtph2ps, eight values per
+ * instruction. Used to unpack f16 weights block by block right before an
+ * f32 sgemm consumes them. */
+struct jit_avx2_cvt_f16_to_f32: public jit_generator {
+    DECLARE_CPU_JIT_AUX_FUNCTIONS(jit_avx2_cvt_f16_to_f32)
+
+    jit_avx2_cvt_f16_to_f32() {
+        this->generate();
+        jit_ker = (void (*)(jit_cvt_f16_call_s *))this->getCode();
+    }
+
+    static bool is_applicable() {
+        return mayiuse(avx2) && cpu.has(Xbyak::util::Cpu::tF16C);
+    }
+
+    void operator()(float *out, const float16_t *inp, size_t nelems) const {
+        jit_cvt_f16_call_s p = { inp, out, nelems };
+        jit_ker(&p);
+    }
+
+    void (*jit_ker)(jit_cvt_f16_call_s *);
+
+private:
+    void generate();
+};
+
+}
+}
+}
+
+#endif
@@ -264,28 +264,62 @@ void jit_avx512_common_1x1_conv_kernel::reduce_loop(int load_loop_blk,
             }
 
         L(store_noadd);
-        if (jcp.with_relu) {
+        if (jcp.with_relu || jcp.with_depthwise) {
             assert(ur * load_loop_blk <= 30);
 
             Label store_norelu;
             test(reg_reduce_pos_flag, FLAG_REDUCE_LAST);
             jz(store_norelu, T_NEAR);
 
-            vpxord(zmm_zero, zmm_zero, zmm_zero);
-            if (jcp.relu_negative_slope == 0) {
-                zmm_relu_ns = zmm_zero;
-            } else {
-                mov(imm_addr64, float2int((float)jcp.relu_negative_slope));
-                vmovq(xmm_relu_ns, imm_addr64);
-                vbroadcastss(zmm_relu_ns, xmm_relu_ns);
-            }
+            auto apply_relu = [=]() {
+                vpxord(zmm_zero, zmm_zero, zmm_zero);
+                if (jcp.relu_negative_slope == 0) {
+                    zmm_relu_ns = zmm_zero;
+                } else {
+                    mov(imm_addr64,
+                            float2int((float)jcp.relu_negative_slope));
+                    vmovq(xmm_relu_ns, imm_addr64);
+                    vbroadcastss(zmm_relu_ns, xmm_relu_ns);
+                }
 
-            for (int i_ur = 0; i_ur < ur; ++i_ur)
-                for (int i_load = 0; i_load < load_loop_blk; ++i_load) {
-                    vcmp(vmask, vreg_accum(i_load, i_ur), zmm_zero,
-                        _cmp_lt_os);
-                    vmul(vreg_accum(i_load, i_ur), vmask,
-                        vreg_accum(i_load, i_ur), zmm_relu_ns);
+                for (int i_ur = 0; i_ur < ur; ++i_ur)
+                    for (int i_load = 0; i_load < load_loop_blk; ++i_load) {
+                        vcmp(vmask, vreg_accum(i_load, i_ur), zmm_zero,
+                            _cmp_lt_os);
+                        vmul(vreg_accum(i_load, i_ur), vmask,
+                            vreg_accum(i_load, i_ur), zmm_relu_ns);
+                }
+            };
+
+            auto apply_depthwise = [=](const float *data, bool is_scale) {
+                mov(imm_addr64, reinterpret_cast<size_t>(data));
+                add(imm_addr64, qword[rsp + oc_off_offt]);
+                for (int i_ur = 0; i_ur < ur; ++i_ur)
+                    for (int i_load = 0; i_load < load_loop_blk; ++i_load) {
+                        auto r = vreg_accum(i_load, i_ur);
+                        auto c_ptr = EVEX_compress_addr(imm_addr64,
+                                jcp.typesize_out * jcp.load_block * i_load);
+                        if (is_scale)
+                            vmulps(r, r, c_ptr);
+                        else
+                            vaddps(r, r, c_ptr);
+                    }
+            };
+
+            const auto &p = attr_.post_ops_;
+            if (p.len_ == 0) {
+                apply_relu(); // convolution_relu primitive
+            } else {
+                for (int i = 0; i < p.len_; i++) {
+                    const auto &e = p.entry_[i];
+                    if (e.is_relu()) {
+                        apply_relu();
+                    } else if (e.is_depthwise()) {
+                        apply_depthwise(e.depthwise.weights_data, true);
+                        if (e.depthwise.biases_data != nullptr)
+                            apply_depthwise(e.depthwise.biases_data, false);
+                    }
+                }
             }
             L(store_norelu);
         }
@@ -516,6 +550,10 @@ void jit_avx512_common_1x1_conv_kernel::generate()
     mov(reg_load_loop_work, ptr[param1 + GET_OFF(load_dim)]);
     mov(reg_bcast_loop_work, ptr[param1 + GET_OFF(bcast_dim)]);
     mov(EVEX_compress_addr(rsp, bcast_loop_work_offt), reg_bcast_loop_work);
+    if (jcp.with_depthwise) {
+        mov(imm_addr64, ptr[param1 + GET_OFF(oc_off)]);
+        mov(qword[rsp + oc_off_offt], imm_addr64);
+    }
     mov(reg_reduce_loop_work, ptr[param1 + GET_OFF(reduce_dim)]);
     mov(reg_reduce_pos_flag, ptr[param1 + GET_OFF(reduce_pos_flag)]);
     if (one_of(jcp.prop_kind, forward_training, forward_inference))
@@ -531,6 +569,9 @@ void jit_avx512_common_1x1_conv_kernel::generate()
         case forward_inference:
             add(reg_bias_data,
                 load_loop_blk * jcp.load_block * jcp.typesize_out);
+            if (jcp.with_depthwise)
+                add(qword[rsp + oc_off_offt],
+                    load_loop_blk * jcp.load_block * jcp.typesize_out);
             add(reg_output_data,
                 load_loop_blk * jcp.bcast_dim * jcp.load_block *
                     jcp.typesize_out);
@@ -622,19 +663,18 @@ bool jit_avx512_common_1x1_conv_kernel::post_ops_ok(
 
     auto is_relu = [&](int idx) { return p.entry_[idx].is_relu(); };
     auto is_sum = [&](int idx) { return p.entry_[idx].is_sum(); };
+    auto is_depthwise = [&](int idx) { return p.entry_[idx].is_depthwise(); };
+    auto is_simple = [&](int idx) { return is_relu(idx) || is_depthwise(idx); };
 
-    switch (p.len_) {
-    case 0: return true; // no post_ops
-    case 1:
-        return true // sum OR relu
-                && !jcp.with_relu && (is_relu(0) || is_sum(0));
-    case 2:
-        return true // sum->relu
-                && !jcp.with_relu && (is_sum(0) && is_relu(1));
-    default: return false;
-    }
+    if (p.len_ > 0 && jcp.with_relu) return false;
+
+    /* sum is allowed at the very beginning only, followed by any sequence
+     * of relu and depthwise post-ops */
+    for (int idx = 0; idx < p.len_; idx++)
+        if (!(is_simple(idx) || (idx == 0 && is_sum(idx))))
+            return false;
 
-    return false;
+    return true;
 }
 
 status_t jit_avx512_common_1x1_conv_kernel::init_conf(
@@ -689,6 +729,7 @@ status_t jit_avx512_common_1x1_conv_kernel::init_conf(
         jcp.with_relu = p.find(primitive_kind::eltwise) != -1;
         jcp.relu_negative_slope = 0;
     }
+    jcp.with_depthwise = p.find(primitive_kind::depthwise) != -1;
 
     bool args_ok = true
         && jcp.ngroups == 1
@@ -771,6 +812,9 @@ status_t jit_avx512_common_1x1_conv_kernel::init_conf(
         return status::unimplemented;
     }
 
+    if (jcp.with_depthwise && jcp.ver == ver_4vnni)
+        return status::unimplemented;
+
     const int SMALL_SPATIAL = 10;
     const int BIG_SPATIAL = 28;
     const int BIG_REDUCE_DIM = 1024;
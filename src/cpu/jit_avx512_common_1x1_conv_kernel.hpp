@@ -93,6 +93,7 @@ struct jit_avx512_common_1x1_conv_kernel : public jit_generator {
     Xbyak::Zmm vreg_bcast = Xbyak::Zmm(31);
 
     int bcast_loop_work_offt = 0;
+    int oc_off_offt = 8;
     int stack_space_needed = 16;
 
     void bcast_loop(int load_loop_blk);
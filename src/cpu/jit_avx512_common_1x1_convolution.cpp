@@ -156,6 +156,7 @@ void _jit_avx512_common_1x1_convolution_fwd_t
 
             p.output_data = &dst[dst_off];
             p.bias_data = &bias[_ocb * jcp.oc_block];
+            p.oc_off = _ocb * jcp.oc_block * sizeof(dst_data_t);
             p.load_data = &weights[conf_.with_groups()
                 ? weights_d.blk_off(g, ocb, icb)
                 : weights_d.blk_off(ocb, icb)];
@@ -431,6 +432,7 @@ jit_avx512_common_1x1_convolution_bwd_weights_t ::
         reducer_bias_ = new cpu_reducer_t<data_type::f32>(
                 reduce_balancer_t(jcp.nthr, jcp.oc_block,
                         jcp.ngroups * jcp.nb_load, jcp.mb, max_buffer_size));
+        reducer_bias_->balancer_.add_info(&conf_, "bia");
     }
     if (jcp.transpose_src) {
         const size_t tr_src_size =
@@ -21,6 +21,8 @@
 #include "cpu_memory.hpp"
 
 #include "jit_avx512_common_conv_kernel.hpp"
+#include "jit_conv_tuning.hpp"
+#include "jit_uni_conv_ic_split.hpp"
 
 #define GET_OFF(field) offsetof(jit_conv_call_s, field)
 #define KNx_L2_EFFECTIVE_CAPACITY ((512-64)*1024)
@@ -50,6 +52,7 @@ inline void pick_loop_order(jit_conv_conf_t &jcp) {
     case ver_4vnni:
     case ver_vnni: 
         // TBD: Tune on HW
+    case ver_bf16:
     case ver_4fma:
         jcp.loop_order
             = (w <= small_spatial && h <= small_spatial) ? loop_cgn : loop_gnc;
@@ -117,24 +120,60 @@ void jit_avx512_common_conv_fwd_kernel::store_output(int ur_w)
     }
 
     L(relu_label);
-    if (jcp.with_relu) {
-        vpxord(zmm_zero, zmm_zero, zmm_zero);
-        if (jcp.relu_negative_slope == 0 || jcp.ver == ver_4vnni) {
-            zmm_relu_ns = zmm_zero;
-        } else {
-            mov(imm_addr64, float2int(jcp.relu_negative_slope));
-            vmovq(xmm_relu_ns, imm_addr64);
-            vbroadcastss(zmm_relu_ns, xmm_relu_ns);
-        }
+    if (jcp.with_relu || jcp.with_depthwise) {
         cmp(reg_channel, jcp.nb_ic - 1);
         jl(store_label, T_NEAR);
-        for (int k = 0; k < jcp.nb_oc_blocking; k++)
-            for (int j = 0; j < ur_w; j++){
-                Opmask kmask = Opmask(7);
-                Zmm zmm = zmm_out(j, k);
-                vcmp(kmask, zmm, zmm_zero, _cmp_lt_os);
-                vmul(zmm, kmask, zmm, zmm_relu_ns);
+
+        auto apply_relu = [=]() {
+            vpxord(zmm_zero, zmm_zero, zmm_zero);
+            if (jcp.relu_negative_slope == 0 || jcp.ver == ver_4vnni) {
+                zmm_relu_ns = zmm_zero;
+            } else {
+                mov(imm_addr64, float2int(jcp.relu_negative_slope));
+                vmovq(xmm_relu_ns, imm_addr64);
+                vbroadcastss(zmm_relu_ns, xmm_relu_ns);
             }
+            for (int k = 0; k < jcp.nb_oc_blocking; k++)
+                for (int j = 0; j < ur_w; j++){
+                    Opmask kmask = Opmask(7);
+                    Zmm zmm = zmm_out(j, k);
+                    vcmp(kmask, zmm, zmm_zero, _cmp_lt_os);
+                    vmul(zmm, kmask, zmm, zmm_relu_ns);
+                }
+        };
+
+        auto apply_depthwise = [=](const float *data, bool is_scale) {
+            mov(imm_addr64, reinterpret_cast<size_t>(data));
+            add(imm_addr64, ptr[param1 + GET_OFF(oc_off)]);
+            for (int k = 0; k < jcp.nb_oc_blocking; k++) {
+                int c_offset = typesize * k * jcp.oc_block;
+                for (int j = 0; j < ur_w; j++) {
+                    Zmm zmm = zmm_out(j, k);
+                    if (is_scale)
+                        vmulps(zmm, zmm,
+                                EVEX_compress_addr(imm_addr64, c_offset));
+                    else
+                        vaddps(zmm, zmm,
+                                EVEX_compress_addr(imm_addr64, c_offset));
+                }
+            }
+        };
+
+        const auto &p = attr_.post_ops_;
+        if (p.len_ == 0) {
+            apply_relu(); // convolution_relu primitive
+        } else {
+            for (int i = 0; i < p.len_; i++) {
+                const auto &e = p.entry_[i];
+                if (e.is_relu()) {
+                    apply_relu();
+                } else if (e.is_depthwise()) {
+                    apply_depthwise(e.depthwise.weights_data, true);
+                    if (e.depthwise.biases_data != nullptr)
+                        apply_depthwise(e.depthwise.biases_data, false);
+                }
+            }
+        }
     }
 
     L(store_label);
@@ -585,17 +624,32 @@ void jit_avx512_common_conv_fwd_kernel::compute_loop_fma_core(int ur_w,
                 if (jcp.kernel_kind == expl_bcast) {
                     for (int jj = jj_start; jj < jj_end; jj++) {
                         int aux_input_offset = input_offset(jj, ic, ki);
-                        vbroadcastss(zmm_inp(jj, nb_oc_block),
-                            ptr[aux_reg_inp + aux_input_offset]);
+                        Zmm zmm_src = zmm_inp(jj, nb_oc_block);
+                        if (jcp.ver == ver_bf16) {
+                            /* bf16 -> f32 is a 16-bit left shift */
+                            vpbroadcastw(zmm_src,
+                                ptr[aux_reg_inp + aux_input_offset]);
+                            vpslld(zmm_src, zmm_src, 16);
+                        } else {
+                            vbroadcastss(zmm_src,
+                                ptr[aux_reg_inp + aux_input_offset]);
+                        }
                     }
                 }
                 for (int ii = 0; ii < nb_oc_block; ii++) {
                     int aux_kernel_offset = jcp.typesize_in
                         * (ii * jcp.nb_ic * jcp.kh * jcp.kw * ic_block
                         * oc_block + ki * ic_block * oc_block + ic * oc_block);
-                    if (jj_end - jj_start > 0)
-                        vmovups(zmm_wei, EVEX_compress_addr(aux_reg_ker,
-                            aux_kernel_offset));
+                    if (jj_end - jj_start > 0) {
+                        if (jcp.ver == ver_bf16) {
+                            vpmovzxwd(zmm_wei,
+                                ptr[aux_reg_ker + aux_kernel_offset]);
+                            vpslld(zmm_wei, zmm_wei, 16);
+                        } else {
+                            vmovups(zmm_wei, EVEX_compress_addr(aux_reg_ker,
+                                aux_kernel_offset));
+                        }
+                    }
                     for (int jj = jj_start; jj < jj_end; jj++)
                         if (jcp.kernel_kind == expl_bcast)
                             vfmadd231ps(zmm_out(jj, ii),
@@ -718,6 +772,8 @@ void jit_avx512_common_conv_fwd_kernel::compute_loop(int ur_w,
             compute_loop_4fma_1st(ur_w, pad_l, pad_r);
         else
             compute_loop_4fma(ur_w, pad_l, pad_r);
+    else if (jcp.ver == ver_bf16)
+        compute_loop_fma_core(ur_w, pad_l, pad_r);
     else if (jcp.ver == ver_fma)
         if (jcp.is_1stconv || mayiuse(avx512_mic))
             compute_loop_fma(ur_w, pad_l, pad_r);
@@ -829,19 +885,18 @@ bool jit_avx512_common_conv_fwd_kernel::post_ops_ok(
 
     auto is_relu = [&](int idx) { return p.entry_[idx].is_relu(); };
     auto is_sum = [&](int idx) { return p.entry_[idx].is_sum(); };
+    auto is_depthwise = [&](int idx) { return p.entry_[idx].is_depthwise(); };
+    auto is_simple = [&](int idx) { return is_relu(idx) || is_depthwise(idx); };
 
-    switch (p.len_) {
-    case 0: return true; // no post_ops
-    case 1:
-        return true // sum OR relu
-                && !jcp.with_relu && (is_relu(0) || is_sum(0));
-    case 2:
-        return true // sum->relu
-                && !jcp.with_relu && (is_sum(0) && is_relu(1));
-    default: return false;
-    }
+    if (p.len_ > 0 && jcp.with_relu) return false;
+
+    /* sum is allowed at the very beginning only, followed by any sequence
+     * of relu and depthwise post-ops */
+    for (int idx = 0; idx < p.len_; idx++)
+        if (!(is_simple(idx) || (idx == 0 && is_sum(idx))))
+            return false;
 
-    return false;
+    return true;
 }
 
 status_t jit_avx512_common_conv_fwd_kernel::init_conf(jit_conv_conf_t &jcp,
@@ -902,6 +957,7 @@ status_t jit_avx512_common_conv_fwd_kernel::init_conf(jit_conv_conf_t &jcp,
         jcp.with_relu = p.find(primitive_kind::eltwise) != -1;
         jcp.relu_negative_slope = 0;
     }
+    jcp.with_depthwise = p.find(primitive_kind::depthwise) != -1;
 
     jcp.is_1stconv = is_1stconv(jcp);
     if (jcp.ic % simd_w != 0 && !jcp.is_1stconv)
@@ -988,10 +1044,31 @@ status_t jit_avx512_common_conv_fwd_kernel::init_conf(jit_conv_conf_t &jcp,
             if (!one_of(weights_d.format(), OIhw16i16o, gOIhw16i16o))
                 return status::unimplemented;
         }
+    } else if (mayiuse(avx512_core)
+            && src_d.data_type() == data_type::bf16
+            && weights_d.data_type() == data_type::bf16
+            && dst_d.data_type() == data_type::f32) {
+        /* bf16 inputs are widened to f32 on load and accumulated in f32,
+         * which halves the bytes read without changing the math */
+        if (jcp.is_1stconv)
+            return status::unimplemented;
+
+        jcp.ver = ver_bf16;
+        jcp.typesize_in = sizeof(bfloat16_t);
+        jcp.typesize_out = sizeof(float);
+
+        const auto w_format = with_groups ? gOIhw16i16o : OIhw16i16o;
+        if (weights_d.format() == any)
+            CHECK(weights_pd.set_format(w_format));
+        if (!one_of(weights_d.format(), OIhw16i16o, gOIhw16i16o))
+            return status::unimplemented;
     } else {
         return status::unimplemented;
     }
 
+    if (jcp.with_depthwise && !one_of(jcp.ver, ver_fma, ver_4fma))
+        return status::unimplemented;
+
     if (jcp.is_1stconv) {
         jcp.ur_w = nstl::min(jcp.ow, regs);
     } else {
@@ -1074,6 +1151,22 @@ status_t jit_avx512_common_conv_fwd_kernel::init_conf(jit_conv_conf_t &jcp,
         }
     }
 
+    /* the conversion on load is cheaper when every input point is widened
+     * once per broadcast, so bf16 always uses the explicit broadcast */
+    if (jcp.ver == ver_bf16) {
+        jcp.kernel_kind = expl_bcast;
+        jcp.nb_oc_blocking = 4;
+        if (jcp.nb_oc < jcp.nb_oc_blocking) jcp.nb_oc_blocking = jcp.nb_oc;
+        if (jcp.nb_oc % jcp.nb_oc_blocking != 0)
+            for (int i = jcp.nb_oc_blocking; i > 0; i--)
+                if (jcp.nb_oc % i == 0) {
+                    jcp.nb_oc_blocking = i;
+                    break;
+                }
+        jcp.ur_w = 31 / (jcp.nb_oc_blocking + 1);
+        if (jcp.ow < jcp.ur_w)  jcp.ur_w = jcp.ow;
+    }
+
     if (jcp.ver == ver_fma && mayiuse(avx512_core)) {
         int try_nb_oc_blocking = 2;
         unsigned int ker_inp_size = typesize * (jcp.iw / jcp.stride_w)
@@ -1119,6 +1212,36 @@ status_t jit_avx512_common_conv_fwd_kernel::init_conf(jit_conv_conf_t &jcp,
         }
     }
 
+    /* the offline tuned blocking replaces the heuristics above if the kernel
+     * can be generated with it */
+    conv_tuning_params_t tp;
+    const conv_tuning_shape_t shape = { jcp.ngroups, jcp.mb, jcp.ic, jcp.ih,
+        jcp.iw, jcp.oc, jcp.oh, jcp.ow, jcp.kh, jcp.kw, jcp.stride_h,
+        jcp.stride_w, jcp.t_pad, jcp.l_pad, 0, 0 };
+    const bool tuned = one_of(jcp.ver, ver_fma, ver_4fma)
+        && conv_tuning_lookup(JIT_IMPL_NAME_HELPER("jit:", avx512_common, ""),
+                shape, tp);
+    if (tuned) {
+        const int ur_w = tp.ur_w > 0 ? tp.ur_w : jcp.ur_w;
+        const int nb_oc_blocking = tp.nb_oc_blocking > 0
+            ? tp.nb_oc_blocking : jcp.nb_oc_blocking;
+        const int ur_w_tail = jcp.ow % ur_w;
+        const int r_pad_no_tail = nstl::max(0, (jcp.ow - ur_w_tail - 1)
+                * jcp.stride_w + jcp.kw - jcp.iw - jcp.l_pad);
+        const bool blocking_ok = true
+            && ur_w <= jcp.ow
+            && jcp.nb_oc % nb_oc_blocking == 0
+            && implication(jcp.is_1stconv, nb_oc_blocking == 1)
+            && (nb_oc_blocking == 1
+                    ? ur_w <= regs : ur_w * (nb_oc_blocking + 1) <= 31)
+            && jcp.l_pad <= ur_w
+            && r_pad_no_tail <= ur_w;
+        if (blocking_ok) {
+            jcp.ur_w = ur_w;
+            jcp.nb_oc_blocking = nb_oc_blocking;
+        }
+    }
+
     jcp.ur_w_tail = jcp.ow % jcp.ur_w;
 
     bool args_ok = true
@@ -1134,6 +1257,8 @@ status_t jit_avx512_common_conv_fwd_kernel::init_conf(jit_conv_conf_t &jcp,
         return status::unimplemented;
 
     pick_loop_order(jcp);
+    if (tuned && one_of(tp.loop_order, loop_cgn, loop_gnc))
+        jcp.loop_order = (conv_loop_order_t)tp.loop_order;
 
     jcp.nb_ic_L2 = jcp.nb_ic;
 
@@ -1158,6 +1283,16 @@ status_t jit_avx512_common_conv_fwd_kernel::init_conf(jit_conv_conf_t &jcp,
             }
         }
     }
+
+    jcp.nthr_ic_b = 1;
+    if (everyone_is(data_type::f32, src_d.data_type(), dst_d.data_type())
+            && dst_d.is_dense()) {
+        const int work_amount = jcp.ngroups * jcp.nb_oc / jcp.nb_oc_blocking
+            * jcp.oh;
+        jcp.nthr_ic_b = conv_fwd_ic_split_nthr(jcp, work_amount,
+                omp_get_max_threads());
+    }
+
     return status::success;
 }
 
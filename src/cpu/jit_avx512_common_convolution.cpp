@@ -17,6 +17,7 @@
 #include "mkldnn_types.h"
 #include "c_types_map.hpp"
 #include "jit_avx512_common_convolution.hpp"
+#include "jit_uni_conv_ic_split.hpp"
 #include "mkldnn_thread.hpp"
 #include "type_helpers.hpp"
 #include "utils.hpp"
@@ -35,7 +36,7 @@ using jit_conv_ker_t = void (*)(jit_conv_call_s *);
 
 inline void jit_conv_ker_pipeline(jit_conv_ker_t ker, jit_conv_call_s &p,
         const void *src, const void *dst, const void *filt, const void *bias,
-        int channel, int kh_padding)
+        int channel, int kh_padding, size_t oc_off = 0)
 {
 #define PIPELINE(field) \
     do { \
@@ -49,6 +50,7 @@ inline void jit_conv_ker_pipeline(jit_conv_ker_t ker, jit_conv_call_s &p,
     PIPELINE(bias);
     PIPELINE(channel);
     PIPELINE(kh_padding);
+    PIPELINE(oc_off);
 
     if (p.src)
         ker(&p);
@@ -137,7 +139,8 @@ void _jit_avx512_common_convolution_fwd_t
                         jit_conv_ker_pipeline(kernel_->jit_ker, par_conv,
                             src_c + i_t_overflow * src_h_stride,
                             dst_c, wht_w + i_t_overflow * wht_h_stride,
-                            bias_w, icb, kh_padding);
+                            bias_w, icb, kh_padding,
+                            g_oc * sizeof(dst_data_t));
 
                         src_c += src_h_stride * jcp.stride_h;
                         dst_c += dst_h_stride;
@@ -161,12 +164,113 @@ void _jit_avx512_common_convolution_fwd_t
                 src, dst, weights, bias, 0, 0);
     }
 }
+template <bool with_relu, data_type_t src_type, data_type_t wei_type,
+          data_type_t dst_type>
+void _jit_avx512_common_convolution_fwd_t
+    <with_relu, src_type, wei_type, dst_type>::execute_forward_ic_split()
+{
+    auto src = reinterpret_cast<const src_data_t *>(this->input_memory(0));
+    auto weights = reinterpret_cast<const wei_data_t *>(this->input_memory(1));
+    auto bias = reinterpret_cast<const dst_data_t *>(this->input_memory(2));
+    auto dst = reinterpret_cast<dst_data_t *>(this->memory());
+
+    const memory_desc_wrapper src_d(conf_.src_pd());
+    const memory_desc_wrapper dst_d(conf_.dst_pd());
+    const memory_desc_wrapper weights_d(conf_.weights_pd(0));
+    const memory_desc_wrapper bias_d(conf_.weights_pd(1));
+
+    const auto &jcp = kernel_->jcp;
+    assert(jcp.mb == 1 && jcp.nthr_ic_b > 1);
+
+    const int nthr_ic_b = jcp.nthr_ic_b;
+    const size_t dst_base = dst_d.blk_off(0);
+
+#   pragma omp parallel
+    {
+        int ithr = omp_get_thread_num(), nthr = omp_get_num_threads();
+
+        /* the groups of input channels are the outermost dimension, so a
+         * thread mostly works with the weights of a single group */
+        int oc_chunks = jcp.nb_oc / jcp.nb_oc_blocking;
+        int start, end;
+        int work_amount = nthr_ic_b * jcp.ngroups * oc_chunks * jcp.oh;
+        balance211(work_amount, nthr, ithr, start, end);
+
+        jit_conv_call_s par_conv = { 0 };
+        size_t src_h_stride = src_d.blk_off(0, 0, 1);
+        size_t src_c_stride = src_d.blk_off(0, 1);
+        size_t dst_h_stride = dst_d.blk_off(0, 0, 1);
+        size_t wht_h_stride = wht_blk_off(weights_d, 0, 0, 0, 1);
+        size_t wht_ic_stride = wht_blk_off(weights_d, 0, 0, 1);
+
+        int icg{0}, g{0}, occ{0}, oh_s{0};
+        nd_iterator_init(start,
+            icg, nthr_ic_b, occ, oc_chunks, g, jcp.ngroups, oh_s, jcp.oh);
+
+        while (start < end) {
+            int icb_s{0}, icb_e{0};
+            balance211(jcp.nb_ic, nthr_ic_b, icg, icb_s, icb_e);
+
+            int ocb = occ * jcp.nb_oc_blocking;
+            int g_ocb = g * jcp.nb_oc + ocb;
+            int g_oc = g_ocb * jcp.oc_block;
+            int g_icb = g * jcp.nb_ic;
+
+            int work_rem = end - start;
+            int ih_s = -jcp.t_pad + oh_s * jcp.stride_h;
+            int oh_e = oh_s + work_rem > jcp.oh ? jcp.oh : oh_s + work_rem;
+
+            auto dst_w = ic_split_buf_ + icg * ic_split_part_size_
+                + dst_d.blk_off(0, g_ocb, oh_s) - dst_base;
+            auto src_w = src + src_d.blk_off(0, g_icb + icb_s, ih_s);
+            auto wht_w = weights + wht_blk_off(weights_d, g, ocb, icb_s);
+
+            for (int icb = icb_s; icb < icb_e; ++icb) {
+                auto src_c = src_w;
+                auto dst_c = dst_w;
+                for (int oj = oh_s, ij = ih_s;
+                        oj < oh_e; ++oj, ij += jcp.stride_h)
+                {
+                    int i_t_overflow = -min(0, ij);
+                    int i_b_overflow = max(jcp.ih, ij + jcp.kh) - jcp.ih;
+                    int kh_padding = nstl::max(0,
+                        jcp.kh - i_t_overflow - i_b_overflow);
+
+                    jit_conv_ker_pipeline(ic_split_kernel_->jit_ker, par_conv,
+                        src_c + i_t_overflow * src_h_stride,
+                        dst_c, wht_w + i_t_overflow * wht_h_stride,
+                        nullptr, icb - icb_s, kh_padding,
+                        g_oc * sizeof(dst_data_t));
+
+                    src_c += src_h_stride * jcp.stride_h;
+                    dst_c += dst_h_stride;
+                }
+                src_w += src_c_stride;
+                wht_w += wht_ic_stride;
+            }
+
+            nd_iterator_jump(start, end,
+                icg, nthr_ic_b, occ, oc_chunks, g, jcp.ngroups, oh_s, jcp.oh);
+        }
+
+        jit_conv_ker_pipeline(ic_split_kernel_->jit_ker, par_conv,
+                src, dst, weights, bias, 0, 0);
+    }
+
+    conv_fwd_ic_split_reduce(jcp, dst + dst_base, ic_split_buf_,
+            ic_split_part_size_, bias ? bias + bias_d.blk_off(0) : nullptr);
+}
+
 template struct _jit_avx512_common_convolution_fwd_t<false, data_type::f32>;
 template struct _jit_avx512_common_convolution_fwd_t<true, data_type::f32>;
 template struct _jit_avx512_common_convolution_fwd_t<false, data_type::s16,
         data_type::s16, data_type::s32>;
 template struct _jit_avx512_common_convolution_fwd_t<true, data_type::s16,
         data_type::s16, data_type::s32>;
+template struct _jit_avx512_common_convolution_fwd_t<false, data_type::bf16,
+        data_type::bf16, data_type::f32>;
+template struct _jit_avx512_common_convolution_fwd_t<true, data_type::bf16,
+        data_type::bf16, data_type::f32>;
 
 template <data_type_t diff_dst_type, data_type_t wei_type,
           data_type_t diff_src_type>
@@ -302,6 +406,7 @@ jit_avx512_common_convolution_bwd_weights_t(const pd_t *pd,
     kernel_ = new jit_avx512_common_conv_bwd_weights_kernel_f32(j);
 
     balance();
+    nthr_mb_per_subgroup_ = reduce_subgroup_size(nthr_mb_);
 
     if (utils::one_of(j.ver, ver_4fma, ver_4vnni, ver_vnni)) {
         trans_kernel_ = create_trans_src(&j);
@@ -370,6 +475,10 @@ jit_avx512_common_convolution_bwd_weights_t(const pd_t *pd,
                     nthr_, j.oc_block, j.ngroups * j.nb_oc, j.mb,
                     max_buffer_size));
     }
+
+    add_reduction_info(&conf_, "wei", 1, nthr_mb_, nthr_mb_per_subgroup_);
+    if (reducer_bias_)
+        reducer_bias_->balancer_.add_info(&conf_, "bia");
 }
 
 template <data_type_t src_type, data_type_t diff_dst_type,
@@ -740,42 +849,73 @@ void jit_avx512_common_convolution_bwd_weights_t<src_type, diff_dst_type,
     const int ic_b_kh_work = ti->ic_b_work * jcp.kh;
     const int work = ti->g_work * ti->oc_b_work * ic_b_kh_work;
 
-    int start{0}, end{0};
-    balance211(work, nthr_mb_, ti->ithr_mb, start, end);
-    if (start == end) return;
-
-    for (int thr_mb = 1; thr_mb < nthr_mb_; ++thr_mb) {
-        int w = start;
-        int sub_g_start{0}, sub_oc_b_start{0}, sub_ic_b_kh_start{0};
-        nd_iterator_init(w, sub_g_start, ti->g_work, sub_oc_b_start,
-                ti->oc_b_work, sub_ic_b_kh_start, ic_b_kh_work);
-        while (w < end) {
-            const int g = ti->g_start + sub_g_start;
-            const int oc_b = ti->oc_b_start + sub_oc_b_start;
-            const int ic_b = ti->ic_b_start + sub_ic_b_kh_start / jcp.kh;
-            const int kh = sub_ic_b_kh_start % jcp.kh;
-
-            const int acc_size
-                = nstl::min(end - w, ic_b_kh_work - sub_ic_b_kh_start)
-                * jcp.kw * jcp.ic_block * jcp.oc_block;
-
-            const size_t off
-                = wht_blk_off(diff_weights_d, g, oc_b, ic_b, kh);
-            diff_weights_data_t *d
-                = (diff_weights_data_t *)ti->diff_weights + off;
-            diff_weights_data_t *s
-                = ws_reduction_ + (thr_mb - 1) * wei_size + off;
-
-            acc_ker_->accumulate(d, s, acc_size);
-
-            nd_iterator_jump(w, end, sub_g_start, ti->g_work, sub_oc_b_start,
+    auto wei_ptr = [&](int thr_mb) {
+        return thr_mb == 0
+            ? (diff_weights_data_t *)ti->diff_weights
+            : ws_reduction_ + (thr_mb - 1) * wei_size;
+    };
+
+    /* accumulates the partial results of threads src_thr_mb_start,
+     * src_thr_mb_start + src_thr_mb_step, ... (up to src_thr_mb_end) into
+     * the ones of the thread dst_thr_mb for the given part of the work */
+    auto reduce = [&](int start, int end, int dst_thr_mb,
+            int src_thr_mb_start, int src_thr_mb_end, int src_thr_mb_step) {
+        for (int thr_mb = src_thr_mb_start; thr_mb < src_thr_mb_end;
+                thr_mb += src_thr_mb_step) {
+            int w = start;
+            int sub_g_start{0}, sub_oc_b_start{0}, sub_ic_b_kh_start{0};
+            nd_iterator_init(w, sub_g_start, ti->g_work, sub_oc_b_start,
                     ti->oc_b_work, sub_ic_b_kh_start, ic_b_kh_work);
+            while (w < end) {
+                const int g = ti->g_start + sub_g_start;
+                const int oc_b = ti->oc_b_start + sub_oc_b_start;
+                const int ic_b = ti->ic_b_start + sub_ic_b_kh_start / jcp.kh;
+                const int kh = sub_ic_b_kh_start % jcp.kh;
+
+                const int acc_size
+                    = nstl::min(end - w, ic_b_kh_work - sub_ic_b_kh_start)
+                    * jcp.kw * jcp.ic_block * jcp.oc_block;
+
+                const size_t off
+                    = wht_blk_off(diff_weights_d, g, oc_b, ic_b, kh);
+                acc_ker_->accumulate(wei_ptr(dst_thr_mb) + off,
+                        wei_ptr(thr_mb) + off, acc_size);
+
+                nd_iterator_jump(w, end, sub_g_start, ti->g_work,
+                        sub_oc_b_start, ti->oc_b_work, sub_ic_b_kh_start,
+                        ic_b_kh_work);
+            }
         }
+    };
+
+    const int nthr_sub = nthr_mb_per_subgroup_;
+    int start{0}, end{0};
 
-        if (jcp.with_bias && jcp.is_1stconv && jcp.ver == ver_4fma) {
-            if (ti->ithr == 0)
-                acc_ker_->accumulate((diff_weights_data_t *)ti->diff_bias,
-                    diff_bias_ws, bia_size);
+    if (nthr_sub > 1) {
+        /* hierarchical reduction, first level: within subgroups of
+         * neighbouring threads to the partial results of the subgroup master
+         * (for subgroup 0 that is diff_weights itself) */
+        const int sgrp_start = ti->ithr_mb / nthr_sub * nthr_sub;
+        const int sgrp_end = nstl::min(sgrp_start + nthr_sub, nthr_mb_);
+        balance211(work, sgrp_end - sgrp_start, ti->ithr_mb - sgrp_start,
+                start, end);
+        if (start != end)
+            reduce(start, end, sgrp_start, sgrp_start + 1, sgrp_end, 1);
+
+        simple_barrier::barrier(&reduction_bctx_, nthr_);
+    }
+
+    /* second level (or the only one for the flat reduction): subgroup
+     * masters to diff_weights */
+    balance211(work, nthr_mb_, ti->ithr_mb, start, end);
+    if (start != end)
+        reduce(start, end, 0, nthr_sub, nthr_mb_, nthr_sub);
+
+    if (jcp.with_bias && jcp.is_1stconv && jcp.ver == ver_4fma
+            && ti->ithr == 0) {
+        for (int thr_mb = 1; thr_mb < nthr_mb_; ++thr_mb) {
+            acc_ker_->accumulate((diff_weights_data_t *)ti->diff_bias,
+                diff_bias_ws, bia_size);
             diff_bias_ws += bia_size;
         }
     }
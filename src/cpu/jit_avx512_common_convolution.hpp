@@ -79,11 +79,31 @@ struct _jit_avx512_common_convolution_fwd_t : public cpu_primitive_t {
     _jit_avx512_common_convolution_fwd_t(const pd_t *pd,
             const input_vector &inputs, const output_vector &outputs)
         : cpu_primitive_t(&conf_, inputs, outputs), conf_(*pd)
+        , ic_split_kernel_(nullptr), ic_split_buf_(nullptr)
     {
         kernel_ = new jit_avx512_common_conv_fwd_kernel(conf_.jcp_,
                     *conf_.attr());
+
+        const auto &jcp = conf_.jcp_;
+        if (jcp.nthr_ic_b > 1) {
+            /* the partial results are plain sums, bias and post-ops are
+             * applied by the reduction */
+            jit_conv_conf_t jcp_part = jcp;
+            jcp_part.with_bias = jcp_part.with_sum = false;
+            jcp_part.with_relu = jcp_part.with_depthwise = false;
+            ic_split_kernel_ = new jit_avx512_common_conv_fwd_kernel(
+                    jcp_part, *conf_.attr());
+            ic_split_part_size_ = (size_t)jcp.ngroups * jcp.nb_oc
+                * jcp.oc_block * jcp.oh * jcp.ow;
+            ic_split_buf_ = (dst_data_t *)malloc(sizeof(dst_data_t)
+                    * jcp.nthr_ic_b * ic_split_part_size_, 64);
+        }
     }
-    ~_jit_avx512_common_convolution_fwd_t() { delete kernel_; };
+    ~_jit_avx512_common_convolution_fwd_t() {
+        delete kernel_;
+        delete ic_split_kernel_;
+        free(ic_split_buf_);
+    };
 
     typedef typename prec_traits<src_type>::type src_data_t;
     typedef typename prec_traits<wei_type>::type wei_data_t;
@@ -91,14 +111,23 @@ struct _jit_avx512_common_convolution_fwd_t : public cpu_primitive_t {
 
     virtual void execute(event_t *e)
     {
-        execute_forward();
+        if (conf_.jcp_.nthr_ic_b > 1)
+            execute_forward_ic_split();
+        else
+            execute_forward();
         e->set_state(event_t::ready);
     }
 
 private:
     void execute_forward();
+    void execute_forward_ic_split();
     pd_t conf_;
     jit_avx512_common_conv_fwd_kernel *kernel_;
+
+    /* minibatch 1 latency driver, see jit_uni_conv_ic_split.hpp */
+    jit_avx512_common_conv_fwd_kernel *ic_split_kernel_;
+    dst_data_t *ic_split_buf_;
+    size_t ic_split_part_size_;
 };
 
 template <impl::data_type_t src_type, impl::data_type_t wei_type = src_type,
@@ -297,6 +326,7 @@ private:
     diff_weights_data_t *ws_reduction_;
 
     int nthr_, nthr_mb_, nthr_g_, nthr_oc_b_, nthr_ic_b_;
+    int nthr_mb_per_subgroup_; /** 1 for the flat diff_weights reduction */
     simple_barrier::ctx_t *tr_src_bctx_, *tr_diff_dst_bctx_, reduction_bctx_;
 };
 
@@ -17,6 +17,7 @@
 #include <math.h>
 
 #include "mkldnn_thread.hpp"
+#include "nstl.hpp"
 #include "utils.hpp"
 
 #include "jit_avx512_common_gemm_f32.hpp"
@@ -46,6 +47,7 @@ using namespace Xbyak;
 
 struct jit_avx512_common_gemm_f32::xbyak_gemm : public jit_generator {
     xbyak_gemm(char transa, char transb, float beta, bool hasBias = false,
+            bool isColBias = false, bool hasRelu = false,
             void *code_ptr = nullptr,
             size_t code_size = 80 * Xbyak::DEFAULT_MAX_CODE_SIZE)
         : jit_generator(code_ptr, code_size)
@@ -117,6 +119,7 @@ struct jit_avx512_common_gemm_f32::xbyak_gemm : public jit_generator {
         auto VBIAS1 = zmm1;
         auto VBIAS2 = zmm2;
         auto VBIAS3 = zmm3;
+        auto VZERO = zmm5;
 
         auto PREFETCHSIZEA = ver == ver_avx512_core ? 48 : 80;
         auto PREFETCHSIZEB = 16;
@@ -285,10 +288,10 @@ struct jit_avx512_common_gemm_f32::xbyak_gemm : public jit_generator {
             outLocalLabel();
         };
 
-        // Function to update C, covering masking and other considerations
+        // Function to update C, covering masking and other considerations;
+        // reg already holds alpha * A * B + bias
         auto update = [&](Zmm reg, bool useCO1, int offset, int mask,
                 bool useScale = false) {
-            vmulps(reg, reg, VALPHA);
             if (!isBeta0) {
                 if (!useScale) {
                     switch (mask) {
@@ -356,6 +359,8 @@ struct jit_avx512_common_gemm_f32::xbyak_gemm : public jit_generator {
                 } else {
                     vfmadd132ps(zmm0, reg, VBETA);
                 }
+                if (hasRelu)
+                    vmaxps(zmm0, zmm0, VZERO);
                 if (!useScale) {
                     switch (mask) {
                     case 0:
@@ -412,6 +417,8 @@ struct jit_avx512_common_gemm_f32::xbyak_gemm : public jit_generator {
                     }
                 }
             } else {
+                if (hasRelu)
+                    vmaxps(reg, reg, VZERO);
                 if (!useScale) {
                     switch (mask) {
                     case 0:
@@ -1213,8 +1220,17 @@ struct jit_avx512_common_gemm_f32::xbyak_gemm : public jit_generator {
                 vbroadcastss(VBETA, BETA);
             }
 
+            if (hasRelu)
+                vpxorq(VZERO, VZERO, VZERO);
+
             // Write back the results; all beta cases need to be handled
-            if (hasBias) {
+            if (hasBias && isColBias) {
+                // I counts the columns left, including the current block
+                mov(BIAS1, N);
+                sub(BIAS1, I);
+                sal(BIAS1, BASE_SHIFT);
+                add(BIAS1, BIAS);
+            } else if (hasBias) {
                 mov(BIAS1, BIAS);
                 if (isUnmasked || unroll_m > 16)
                     vmovups(VBIAS1, ptr[BIAS1 + 0 * SIZE]);
@@ -1241,8 +1257,12 @@ struct jit_avx512_common_gemm_f32::xbyak_gemm : public jit_generator {
                     lea(CO2, ptr[CO1 + LDC * 2]);
                 if (i == 4 || i == 6)
                     lea(CO2, ptr[CO2 + LDC * 2]);
+                if (hasBias && isColBias)
+                    vbroadcastss(VBIAS1, ptr[BIAS1 + i * SIZE]);
                 if (hasBias)
-                    vaddps(regs[i], VBIAS1, regs[i]);
+                    vfmadd213ps(regs[i], VALPHA, VBIAS1);
+                else
+                    vmulps(regs[i], regs[i], VALPHA);
                 if (isUnmasked || unroll_m > 16) {
                     update(regs[i], useCO1, 0, 0, useScale);
                 } else {
@@ -1250,7 +1270,10 @@ struct jit_avx512_common_gemm_f32::xbyak_gemm : public jit_generator {
                 }
                 if (unroll_m >= 32) {
                     if (hasBias)
-                        vaddps(regs[i + 8], VBIAS2, regs[i + 8]);
+                        vfmadd213ps(regs[i + 8], VALPHA,
+                                isColBias ? VBIAS1 : VBIAS2);
+                    else
+                        vmulps(regs[i + 8], regs[i + 8], VALPHA);
                     if (isUnmasked || unroll_m > 32) {
                         update(regs[i + 8], useCO1, 16, 0, useScale);
                     } else {
@@ -1259,7 +1282,10 @@ struct jit_avx512_common_gemm_f32::xbyak_gemm : public jit_generator {
                 }
                 if (unroll_m >= 48) {
                     if (hasBias)
-                        vaddps(regs[i + 16], VBIAS3, regs[i + 16]);
+                        vfmadd213ps(regs[i + 16], VALPHA,
+                                isColBias ? VBIAS1 : VBIAS3);
+                    else
+                        vmulps(regs[i + 16], regs[i + 16], VALPHA);
                     if (isUnmasked) {
                         update(regs[i + 16], useCO1, 32, 0, useScale);
                     } else {
@@ -1577,7 +1603,7 @@ struct jit_avx512_common_gemm_f32::xbyak_gemm : public jit_generator {
             }
 
             // Compute next address of BIAS
-            if (hasBias) {
+            if (hasBias && !isColBias) {
                 add(BIAS, unroll_m * SIZE);
             }
 
@@ -1725,7 +1751,7 @@ typedef void (*ker)(long long int, long long int, long long int, float *,
 void jit_avx512_common_gemm_f32::sgemm_nocopy_driver(const char *transa,
         const char *transb, int m, int n, int k, const float *alpha,
         const float *a, int lda, const float *b, int ldb, const float *beta,
-        float *c, int ldc, const float *bias, float *ws)
+        float *c, int ldc, const float *bias, bool relu, float *ws)
 {
     bool isTransA = (*transa == 'T' || *transa == 't');
     bool isTransB = (*transb == 'T' || *transb == 't');
@@ -1749,6 +1775,17 @@ void jit_avx512_common_gemm_f32::sgemm_nocopy_driver(const char *transa,
                     c[i + j * ldc] *= beta[0];
         }
 
+        if (bias != NULL || relu) {
+            for (j = 0; j < n; j++)
+                for (i = 0; i < m; i++) {
+                    float &d = c[i + j * ldc];
+                    if (bias != NULL)
+                        d += isColBias_ ? bias[j] : bias[i];
+                    if (relu && d < 0)
+                        d = 0;
+                }
+        }
+
         return;
     }
 
@@ -1805,12 +1842,22 @@ void jit_avx512_common_gemm_f32::sgemm_nocopy_driver(const char *transa,
                 curC = c + Bm + Bn * ldc;
                 if (bias != NULL) {
                     if (Bk == 0) {
-                        curBias = bias + Bm;
+                        curBias = bias + (isColBias_ ? Bn : Bm);
                     } else {
                         curBias = NULL;
                     }
                 }
-                if (Bk == 0) {
+                // The epilogue is applied by the kernels updating the last
+                // K block only
+                if (relu && Bk + sizeK == k) {
+                    assert(Bk > 0 || *beta != 0.0 || bias != NULL
+                            || !hasBias_);
+                    (*(Bk == 0 ? ker_bn_relu_ : ker_b1_relu_))(
+                            (long long int)sizeM, (long long int)sizeN,
+                            (long long int)sizeK, alpha, curA,
+                            (long long int)lda, curB, (long long int)ldb,
+                            beta, curC, (long long int)ldc, curBias, ws);
+                } else if (Bk == 0) {
                     if (*beta == 0.0 && bias == NULL)
                         (*ker_b0_)((long long int)sizeM, (long long int)sizeN,
                                 (long long int)sizeK, alpha, curA,
@@ -2054,10 +2101,17 @@ inline void jit_avx512_common_gemm_f32::calc_nthr_nocopy_avx512_common(int m,
 void jit_avx512_common_gemm_f32::sgemm(const char *transa, const char *transb,
         const int *p_m, const int *p_n, const int *p_k, const float *p_alpha,
         const float *A, const int *p_lda, const float *B, const int *p_ldb,
-        const float *p_beta, float *C, const int *p_ldc, const float *bias)
+        const float *p_beta, float *C, const int *p_ldc, const float *bias,
+        int nthr_max)
 {
-    assert(*transa == transa_ && *transb == transb_ && *p_beta == beta_);
+    // beta is read at run time by the kernels, any beta other than 0 and 1
+    // goes to the kernels built for a generic one
+    assert(*transa == transa_ && *transb == transb_);
+    assert(*p_beta == beta_ || (utils::one_of(beta_, 0.f, 1.f) == false
+                && utils::one_of(*p_beta, 0.f, 1.f) == false));
     int nthr = (omp_in_parallel()) ? 1 : omp_get_max_threads();
+    if (nthr_max > 0)
+        nthr = nstl::min(nthr, nthr_max);
     int m = *p_m;
     int n = *p_n;
     int k = *p_k;
@@ -2069,8 +2123,6 @@ void jit_avx512_common_gemm_f32::sgemm(const char *transa, const char *transb,
 
     int nthr_m, nthr_n, nthr_k, nthr_mn;
 
-    assert(nthr <= nthrs_);
-
     // Determine threading partitioning
     calc_nthr_nocopy_avx512_common(
             m, n, k, nthr, &nthr_m, &nthr_n, &nthr_k, &MB, &NB, &KB);
@@ -2081,13 +2133,15 @@ void jit_avx512_common_gemm_f32::sgemm(const char *transa, const char *transb,
 
     nthr_mn = nthr_m * nthr_n;
 
-    unsigned int volatile *ompstatus = (unsigned int volatile *)ompstatus_;
-    if (!ompstatus) return;
-
+    // The reduction flags are per call, so that an object can be used by
+    // several threads at once
+    unsigned int volatile *ompstatus = NULL;
     float *c_buffers = NULL;
     float *ws_buffers = NULL;
 
     if (nthr_k > 1) {
+        ompstatus = (unsigned int volatile *)malloc(
+                sizeof(unsigned int) * nthr * CACHE_LINE_SIZE, 64);
         for (int i = 0; i < nthr; i++)
             ompstatus[i * CACHE_LINE_SIZE] = 0;
 
@@ -2166,7 +2220,7 @@ void jit_avx512_common_gemm_f32::sgemm(const char *transa, const char *transb,
                     myBeta = beta;
                     ld = ldc;
                     if (hasBias_)
-                        myBias = &(bias[m_from]);
+                        myBias = &(bias[isColBias_ ? n_from : m_from]);
                 } else {
                     myC = c_buffers + MB * NB * (cbase + ithr_omp_k - 1);
                     myBeta = 0.0;
@@ -2174,8 +2228,11 @@ void jit_avx512_common_gemm_f32::sgemm(const char *transa, const char *transb,
                     myBias = NULL;
                 }
 
+                // With a split K the partial sums are reduced below, so the
+                // relu waits for the reduction
                 sgemm_nocopy_driver(transa, transb, myM, myN, myK, p_alpha, myA,
-                        lda, myB, ldb, &myBeta, myC, ld, myBias, ws);
+                        lda, myB, ldb, &myBeta, myC, ld, myBias,
+                        hasRelu_ && nthr_k == 1, ws);
 
                 if (nthr_k > 1)
                     ompstatus[(ibase + ithr_omp_k) * CACHE_LINE_SIZE] = 1;
@@ -2214,27 +2271,186 @@ void jit_avx512_common_gemm_f32::sgemm(const char *transa, const char *transb,
                                 &C[m_from + (n_from + n1) * ldc], ldc);
                     }
                 }
+
+                if (hasRelu_) {
+                    for (int j = n_from + n1; j < n_from + n1 + n2; j++)
+                        for (int i = m_from; i < m_from + myM; i++)
+                            C[i + j * ldc] = nstl::max(C[i + j * ldc], 0.f);
+                }
             }
         }
     }
 
-    if (nthr_k > 1)
+    if (nthr_k > 1) {
         free(c_buffers);
+        free((void *)ompstatus);
+    }
+    free(ws_buffers);
+}
+
+namespace {
+/* leading dimension of the packed A: whole cache lines per column */
+inline int packed_lda(int m) { return rnd_up(m, CACHE_LINE_SIZE); }
+}
+
+float *jit_avx512_common_gemm_f32::sgemm_pack_alloc(int m, int k)
+{
+    return (float *)malloc(
+            sizeof(float) * packed_lda(m) * nstl::max(k, 1), PAGE_4K);
+}
+
+void jit_avx512_common_gemm_f32::sgemm_pack_free(float *packed_A)
+{
+    free(packed_A);
+}
+
+void jit_avx512_common_gemm_f32::sgemm_pack(const char *transa, const int *p_m,
+        const int *p_k, const float *A, const int *p_lda, float *packed_A)
+{
+    const bool isTransA = (*transa == 'T' || *transa == 't');
+    const int m = *p_m;
+    const int k = *p_k;
+    const int lda = *p_lda;
+    const int ld = packed_lda(m);
+
+    // Columns of op(A) are written by blocks of a cache line, so that the
+    // transposition reads whole cache lines of A as well
+    const int nb_k = div_up(k, CACHE_LINE_SIZE);
+#pragma omp parallel for schedule(static)
+    for (int kb = 0; kb < nb_k; kb++) {
+        const int k_s = kb * CACHE_LINE_SIZE;
+        const int k_e = nstl::min(k, k_s + CACHE_LINE_SIZE);
+        if (isTransA) {
+            for (int i = 0; i < m; i++)
+                for (int j = k_s; j < k_e; j++)
+                    packed_A[i + (size_t)j * ld] = A[j + (size_t)i * lda];
+        } else {
+            for (int j = k_s; j < k_e; j++)
+                for (int i = 0; i < m; i++)
+                    packed_A[i + (size_t)j * ld] = A[i + (size_t)j * lda];
+        }
+        for (int j = k_s; j < k_e; j++)
+            for (int i = m; i < ld; i++)
+                packed_A[i + (size_t)j * ld] = 0.0;
+    }
+}
+
+void jit_avx512_common_gemm_f32::sgemm_compute(const char *transb, const int *p_m,
+        const int *p_n, const int *p_k, const float *p_alpha,
+        const float *packed_A, const float *B, const int *p_ldb,
+        const float *p_beta, float *C, const int *p_ldc, const float *bias)
+{
+    assert(transa_ == 'N' || transa_ == 'n');
+    const int ld = packed_lda(*p_m);
+    sgemm("N", transb, p_m, p_n, p_k, p_alpha, packed_A, &ld, B, p_ldb,
+            p_beta, C, p_ldc, bias);
+}
+
+void jit_avx512_common_gemm_f32::sgemm_batch(const char *transa, const char *transb,
+        const int *p_m, const int *p_n, const int *p_k, const float *p_alpha,
+        const float **A, const int *p_lda, const float **B, const int *p_ldb,
+        const float *p_beta, float **C, const int *p_ldc, int batch,
+        const float **bias)
+{
+    int nthr = (omp_in_parallel()) ? 1 : omp_get_max_threads();
+    int m = *p_m;
+    int n = *p_n;
+    int k = *p_k;
+    int lda = *p_lda;
+    int ldb = *p_ldb;
+    int ldc = *p_ldc;
+
+    // A gemm split between all the threads pays for the fork-join and the
+    // reduction along K only if it leaves enough work to every thread.
+    // Smaller gemms of the batch run side by side instead, each on its own
+    // group of threads and without splitting K.
+    const double min_work_per_thr = 1 << 20;
+    if (batch <= 1 || nthr == 1
+            || (double)m * n * k >= nthr * min_work_per_thr) {
+        for (int b = 0; b < batch; b++)
+            sgemm(transa, transb, p_m, p_n, p_k, p_alpha, A[b], p_lda, B[b],
+                    p_ldb, p_beta, C[b], p_ldc, bias ? bias[b] : NULL);
+        return;
+    }
+
+    const int nthr_grp = nstl::max(1, nthr / batch);
+    const int ngrp = nthr / nthr_grp;
+
+    int nthr_m, nthr_n, nthr_k, MB, NB, KB;
+    calc_nthr_nocopy_avx512_common(m, n, k, nthr_grp, &nthr_m, &nthr_n, &nthr_k, &MB, &NB, &KB);
+    UNUSED(nthr_k);
+    UNUSED(KB);
+
+    float *ws_buffers = NULL;
+    const size_t ws_elems_per_thr = k * 48 + 64;
+    const size_t ws_size_per_thr
+            = utils::rnd_up(ws_elems_per_thr * sizeof(float), PAGE_4K);
+    if (k > STACK_K_CAPACITY) {
+        ws_buffers = (float *)malloc(ngrp * nthr_grp * ws_size_per_thr,
+                PAGE_4K);
+    }
+
+#pragma omp parallel num_threads(ngrp * nthr_grp)
+    {
+        const int ithr = omp_get_thread_num();
+        const int igrp = ithr / nthr_grp;
+        const int ithr_grp = ithr % nthr_grp;
+        float *ws = ws_buffers ?
+                ws_buffers + ithr * ws_size_per_thr / sizeof(float) : 0;
+
+        const int m_from = MB * (ithr_grp % nthr_m);
+        const int m_to = nstl::min(m, m_from + MB);
+        const int n_from = NB * (ithr_grp / nthr_m);
+        const int n_to = nstl::min(n, n_from + NB);
+        const int myM = m_to - m_from;
+        const int myN = n_to - n_from;
+
+        if (ithr_grp < nthr_m * nthr_n && myM > 0 && myN > 0) {
+            for (int b = igrp; b < batch; b += ngrp) {
+                const float *myA = (*transa == 'N' || *transa == 'n')
+                        ? &(A[b][m_from]) : &(A[b][m_from * lda]);
+                const float *myB = (*transb == 'N' || *transb == 'n')
+                        ? &(B[b][n_from * ldb]) : &(B[b][n_from]);
+                const float *myBias = (hasBias_ && bias)
+                        ? &(bias[b][isColBias_ ? n_from : m_from]) : NULL;
+                sgemm_nocopy_driver(transa, transb, myM, myN, k, p_alpha,
+                        myA, lda, myB, ldb, p_beta,
+                        &(C[b][m_from + n_from * ldc]), ldc, myBias,
+                        hasRelu_, ws);
+            }
+        }
+    }
+
     free(ws_buffers);
 }
 
+void jit_avx512_common_gemm_f32::sgemm_compute_batch(const char *transb, const int *p_m,
+        const int *p_n, const int *p_k, const float *p_alpha,
+        const float **packed_A, const float **B, const int *p_ldb,
+        const float *p_beta, float **C, const int *p_ldc, int batch,
+        const float **bias)
+{
+    assert(transa_ == 'N' || transa_ == 'n');
+    const int ld = packed_lda(*p_m);
+    sgemm_batch("N", transb, p_m, p_n, p_k, p_alpha, packed_A, &ld, B,
+            p_ldb, p_beta, C, p_ldc, batch, bias);
+}
+
 jit_avx512_common_gemm_f32::jit_avx512_common_gemm_f32(
-        char transa, char transb, float beta, bool hasBias)
+        char transa, char transb, float beta, bool hasBias, bool isColBias,
+        bool hasRelu)
 {
     transa_ = transa;
     transb_ = transb;
     beta_ = beta;
     hasBias_ = hasBias;
+    isColBias_ = hasBias && isColBias;
+    hasRelu_ = hasRelu;
     if (hasBias) {
-        assert(beta == 0.0);
+        assert(beta == 0.0 || beta == 1.0);
     }
-    ker_bn_ = new xbyak_gemm(transa, transb, beta, hasBias);
-    if (beta != 1.0) {
+    ker_bn_ = new xbyak_gemm(transa, transb, beta, hasBias, isColBias_);
+    if (beta != 1.0 || hasBias) {
         ker_b1_ = new xbyak_gemm(transa, transb, 1.0);
     } else {
         ker_b1_ = ker_bn_;
@@ -2244,22 +2460,23 @@ jit_avx512_common_gemm_f32::jit_avx512_common_gemm_f32(
     } else {
         ker_b0_ = ker_bn_;
     }
-
-    nthrs_ = omp_get_max_threads();
-    ompstatus_ = (unsigned int *)malloc(
-        sizeof(unsigned int *) * nthrs_ * CACHE_LINE_SIZE, 64);
-    assert(ompstatus_);
-
+    ker_bn_relu_ = ker_b1_relu_ = NULL;
+    if (hasRelu) {
+        ker_bn_relu_ = new xbyak_gemm(transa, transb, beta, hasBias,
+                isColBias_, true);
+        ker_b1_relu_ = new xbyak_gemm(transa, transb, 1.0, false, false, true);
+    }
 }
 
 jit_avx512_common_gemm_f32::~jit_avx512_common_gemm_f32()
 {
     delete ker_bn_;
-    if (beta_ != 1.0)
+    if (ker_b1_ != ker_bn_)
         delete ker_b1_;
-    if (beta_ != 0.0 || (beta_ == 0.0 && hasBias_))
+    if (ker_b0_ != ker_bn_)
         delete ker_b0_;
-    free(ompstatus_);
+    delete ker_bn_relu_;
+    delete ker_b1_relu_;
 }
 }
 }
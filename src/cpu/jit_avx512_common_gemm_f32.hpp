@@ -26,13 +26,48 @@ namespace cpu {
 
 class jit_avx512_common_gemm_f32 {
 public:
+    /* C = alpha * op(A) * op(B) + beta * C + bias, followed by a relu for an
+     * object created with hasRelu. bias has one value per row of C, or per
+     * column of C with isColBias. At most nthr_max threads are used, 0 means
+     * all of them. */
     void sgemm(const char *transa, const char *transb, const int *M,
             const int *N, const int *K, const float *alpha, const float *A,
             const int *lda, const float *B, const int *ldb, const float *beta,
-            float *C, const int *ldc, const float *bias = NULL);
+            float *C, const int *ldc, const float *bias = NULL,
+            int nthr_max = 0);
 
-    jit_avx512_common_gemm_f32(
-            char transa, char transb, float beta, bool hasBias = false);
+    /* Packed A: op(A) is stored once in the layout the non-transposed
+     * kernel streams without copying (column major, cache line aligned
+     * columns), so that it is not transposed or realigned again by every
+     * sgemm_compute() call. sgemm_compute() requires an object created with
+     * transa == 'N'. The buffer is allocated with sgemm_pack_alloc() and
+     * released with sgemm_pack_free(). */
+    static float *sgemm_pack_alloc(int m, int k);
+    static void sgemm_pack(const char *transa, const int *M, const int *K,
+            const float *A, const int *lda, float *packed_A);
+    static void sgemm_pack_free(float *packed_A);
+    void sgemm_compute(const char *transb, const int *M, const int *N,
+            const int *K, const float *alpha, const float *packed_A,
+            const float *B, const int *ldb, const float *beta, float *C,
+            const int *ldc, const float *bias = NULL);
+
+    /* Batch of gemms with the same sizes and arguments but the matrices
+     * (and bias) of each one passed in arrays of batch pointers. Small gemms
+     * are spread over the threads instead of being split between all of
+     * them one after another. */
+    void sgemm_batch(const char *transa, const char *transb, const int *M,
+            const int *N, const int *K, const float *alpha, const float **A,
+            const int *lda, const float **B, const int *ldb,
+            const float *beta, float **C, const int *ldc, int batch,
+            const float **bias = NULL);
+    void sgemm_compute_batch(const char *transb, const int *M, const int *N,
+            const int *K, const float *alpha, const float **packed_A,
+            const float **B, const int *ldb, const float *beta, float **C,
+            const int *ldc, int batch, const float **bias = NULL);
+
+    jit_avx512_common_gemm_f32(char transa, char transb, float beta,
+            bool hasBias = false, bool isColBias = false,
+            bool hasRelu = false);
     ~jit_avx512_common_gemm_f32();
 
 private:
@@ -42,7 +77,7 @@ private:
     void sgemm_nocopy_driver(const char *transa, const char *transb, int m,
             int n, int k, const float *alpha, const float *a, int lda,
             const float *b, int ldb, const float *beta, float *c, int ldc,
-            const float *bias, float *ws);
+            const float *bias, bool relu, float *ws);
     inline void partition_unit_diff(
             int ithr, int nthr, int n, int *t_offset, int *t_block);
     inline void sum_two_matrices(
@@ -53,11 +88,10 @@ private:
 
     char transa_, transb_;
     float beta_;
-    bool hasBias_;
+    bool hasBias_, isColBias_, hasRelu_;
     struct xbyak_gemm;
     xbyak_gemm *ker_bn_, *ker_b1_, *ker_b0_;
-    unsigned int *ompstatus_;
-    int nthrs_;
+    xbyak_gemm *ker_bn_relu_, *ker_b1_relu_;
 };
 }
 }
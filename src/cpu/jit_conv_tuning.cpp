@@ -0,0 +1,150 @@
+/*******************************************************************************
+* Copyright 2018 Intel Corporation
+*
+* Licensed under the Apache License, Version 2.0 (the "License");
+* you may not use this file except in compliance with the License.
+* You may obtain a copy of the License at
+*
+*     http://www.apache.org/licenses/LICENSE-2.0
+*
+* Unless required by applicable law or agreed to in writing, software
+* distributed under the License is distributed on an "AS IS" BASIS,
+* WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+* See the License for the specific language governing permissions and
+* limitations under the License.
+*******************************************************************************/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "nstl.hpp"
+#include "utils.hpp"
+
+#include "jit_conv_tuning.hpp"
+#include "jit_primitive_conf.hpp"
+
+namespace mkldnn {
+namespace impl {
+namespace cpu {
+
+namespace {
+
+const int max_key_len = 512;
+const int max_params_len = 256;
+
+struct table_entry_t {
+    char key[max_key_len]; /* <impl> <shape> */
+    conv_tuning_params_t params;
+};
+
+void reset_params(conv_tuning_params_t &p) {
+    p.ur_w = p.nb_oc_blocking = p.loop_order = -1;
+    p.nb_bcast_blocking = p.nb_load_blocking = p.nb_reduce_blocking = -1;
+}
+
+/* parses "<name>=<value>[,<name>=<value>...]", unknown names are an error */
+bool parse_params(const char *str, conv_tuning_params_t &p) {
+    reset_params(p);
+    while (*str) {
+        const char *eq = strchr(str, '=');
+        if (eq == NULL) return false;
+        const size_t name_len = eq - str;
+        char *end = NULL;
+        int value = -1;
+        const char *value_str = eq + 1;
+
+        auto is = [&](const char *name) {
+            return strlen(name) == name_len && !strncmp(str, name, name_len);
+        };
+
+        if (is("loop_order")) {
+            if (!strncmp(value_str, "cgn", 3)) value = loop_cgn;
+            else if (!strncmp(value_str, "gnc", 3)) value = loop_gnc;
+            else if (!strncmp(value_str, "ngc", 3)) value = loop_ngc;
+            else return false;
+            end = (char *)value_str + 3;
+        } else {
+            value = (int)strtol(value_str, &end, 10);
+            if (end == value_str || value <= 0) return false;
+        }
+
+        if (is("ur_w")) p.ur_w = value;
+        else if (is("nb_oc_blocking")) p.nb_oc_blocking = value;
+        else if (is("loop_order")) p.loop_order = value;
+        else if (is("nb_bcast_blocking")) p.nb_bcast_blocking = value;
+        else if (is("nb_load_blocking")) p.nb_load_blocking = value;
+        else if (is("nb_reduce_blocking")) p.nb_reduce_blocking = value;
+        else return false;
+
+        if (*end == ',') ++end;
+        else if (*end != '\0') return false;
+        str = end;
+    }
+    return true;
+}
+
+void shape2key(char *key, const char *impl_name,
+        const conv_tuning_shape_t &s) {
+    snprintf(key, max_key_len,
+            "%s g%dmb%dic%dih%diw%doc%doh%dow%dkh%dkw%dsh%dsw%dph%dpw%d"
+            "dh%ddw%d", impl_name, s.ngroups, s.mb, s.ngroups * s.ic, s.ih,
+            s.iw, s.ngroups * s.oc, s.oh, s.ow, s.kh, s.kw, s.stride_h,
+            s.stride_w, s.t_pad, s.l_pad, s.dilate_h, s.dilate_w);
+}
+
+/* the lines that cannot be parsed are skipped */
+nstl::vector<table_entry_t> *load_table() {
+    auto table = new nstl::vector<table_entry_t>();
+
+    const int len = 1024;
+    char file_name[len];
+    if (mkldnn_getenv(file_name, "MKLDNN_CONV_TUNING_TABLE", len) <= 0)
+        return table;
+
+    FILE *fp = mkldnn_fopen(file_name, "r");
+    if (fp == NULL) return table;
+
+    char impl[max_key_len / 2], shape[max_key_len / 2];
+    char params[max_params_len];
+    char line[2 * max_key_len];
+    while (fgets(line, sizeof(line), fp)) {
+        if (line[0] == '#') continue;
+        if (sscanf(line, "%255s %255s %255s", impl, shape, params) != 3)
+            continue;
+        table_entry_t e;
+        if (!parse_params(params, e.params)) continue;
+        snprintf(e.key, max_key_len, "%s %s", impl, shape);
+        table->push_back(e);
+    }
+    fclose(fp);
+
+    return table;
+}
+
+}
+
+bool conv_tuning_lookup(const char *impl_name,
+        const conv_tuning_shape_t &shape, conv_tuning_params_t &params) {
+    char override_params[max_params_len];
+    if (mkldnn_getenv(override_params, "MKLDNN_CONV_TUNING_PARAMS",
+                max_params_len) > 0)
+        return parse_params(override_params, params);
+
+    static const nstl::vector<table_entry_t> *table = load_table();
+    if (table->size() == 0) return false;
+
+    char key[max_key_len];
+    shape2key(key, impl_name, shape);
+    for (size_t i = 0; i < table->size(); ++i) {
+        if (!strcmp((*table)[i].key, key)) {
+            params = (*table)[i].params;
+            return true;
+        }
+    }
+    return false;
+}
+
+}
+}
+}
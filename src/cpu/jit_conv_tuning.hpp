@@ -0,0 +1,72 @@
+/*******************************************************************************
+* Copyright 2018 Intel Corporation
+*
+* Licensed under the Apache License, Version 2.0 (the "License");
+* you may not use this file except in compliance with the License.
+* You may obtain a copy of the License at
+*
+*     http://www.apache.org/licenses/LICENSE-2.0
+*
+* Unless required by applicable law or agreed to in writing, software
+* distributed under the License is distributed on an "AS IS" BASIS,
+* WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+* See the License for the specific language governing permissions and
+* limitations under the License.
+*******************************************************************************/
+
+#ifndef CPU_JIT_CONV_TUNING_HPP
+#define CPU_JIT_CONV_TUNING_HPP
+
+#include "c_types_map.hpp"
+
+namespace mkldnn {
+namespace impl {
+namespace cpu {
+
+/* Blocking parameters of the JIT convolutions found by the offline tuner
+ * (benchdnn --conv --tune=FILE, see tests/benchdnn/README.md).
+ *
+ * The table is read once from the file named by MKLDNN_CONV_TUNING_TABLE.
+ * Every line of it is
+ *     <impl> <shape> <name>=<value>[,<name>=<value>...]
+ * where <impl> is the implementation name (e.g. jit:avx512_common) and
+ * <shape> is g*mb*ic*ih*iw*oc*oh*ow*kh*kw*sh*sw*ph*pw*dh*dw with the total
+ * numbers of channels, e.g.
+ *     jit:avx512_common g1mb1ic80ih28iw28oc176oh28ow28kh3kw3sh1sw1ph1pw1dh0dw0 ur_w=14,nb_oc_blocking=1,loop_order=gnc
+ *
+ * MKLDNN_CONV_TUNING_PARAMS=<name>=<value>[,...] overrides the table for all
+ * the convolutions of any shape; the tuner sets it to try the candidates.
+ *
+ * The values that are not set stay -1, and the init_conf functions keep
+ * their heuristics for them. The values that are set are validated by the
+ * init_conf functions, which fall back to the heuristics if the kernel
+ * cannot be generated with them. */
+struct conv_tuning_params_t {
+    int ur_w;
+    int nb_oc_blocking;
+    int loop_order; /* conv_loop_order_t */
+    int nb_bcast_blocking;
+    int nb_load_blocking;
+    int nb_reduce_blocking;
+};
+
+struct conv_tuning_shape_t {
+    int ngroups, mb;
+    int ic, ih, iw; /* ic is per group */
+    int oc, oh, ow; /* oc is per group */
+    int kh, kw;
+    int stride_h, stride_w;
+    int t_pad, l_pad;
+    int dilate_h, dilate_w;
+};
+
+/* returns true and fills params if there are any tuned parameters for the
+ * shape in the table or in the override */
+bool conv_tuning_lookup(const char *impl_name,
+        const conv_tuning_shape_t &shape, conv_tuning_params_t &params);
+
+}
+}
+}
+
+#endif
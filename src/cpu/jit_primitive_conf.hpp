@@ -25,7 +25,7 @@ namespace cpu {
 
 /* convolution */
 enum conv_version_t {ver_unused, ver_fma, ver_avx512_core, ver_4fma, ver_4vnni,
-                     ver_vnni};
+                     ver_vnni, ver_bf16};
 enum conv_loop_order_t {loop_cgn, loop_gnc, loop_ngc};
 enum conv_1x1_loop_order_t {loop_rbl, loop_rlb, loop_lbr, loop_lrb, loop_blr,
                             loop_brl};
@@ -56,6 +56,7 @@ struct jit_conv_conf_t {
     bool with_bias, with_relu;
     float relu_negative_slope;
     bool with_sum;
+    bool with_depthwise;
 
     int ihp, iwp, ohp, owp;
     int nb_ic, ic_block;
@@ -64,6 +65,7 @@ struct jit_conv_conf_t {
     int nb_ic_blocking_max;
     int nb_ic_L2;
     int nb_oc_L2;
+    int nthr_ic_b; // threads splitting the reduction over ic, minibatch 1
     int ur_h, ur_w;
     int ur_w_tail;
     bool is_1stconv;
@@ -193,9 +195,19 @@ struct jit_conv_call_s {
     size_t ur_w;
     size_t ur_str_w;
     size_t ch_blocks;
+    size_t oc_off;
+    size_t oc_off_prf;
     int flags;
 };
 
+struct jit_sparse_conv_call_s {
+    const void *src;
+    const void *dst; /* hack, non-const for forward */
+    const void *wei_val;
+    const void *wei_off;
+    size_t nnz;
+};
+
 struct jit_1x1_conv_conf_t {
     prop_kind_t prop_kind;
     conv_version_t ver;
@@ -210,6 +222,7 @@ struct jit_1x1_conv_conf_t {
     bool with_bias, with_relu;
     float relu_negative_slope;
     bool with_sum;
+    bool with_depthwise;
 
     int is, os;
     int ic_block, oc_block;
@@ -264,6 +277,7 @@ struct jit_gemm_conv_conf_t {
     int is, os, ks;
     int ic_block, oc_block;
     bool need_im2col;
+    int os_block; // # of spatial points in one im2col tile (forward)
 };
 
 struct jit_1x1_conv_call_s {
@@ -281,6 +295,7 @@ struct jit_1x1_conv_call_s {
     size_t output_stride; // used in backward_weights only
 
     size_t reduce_pos_flag;
+    size_t oc_off; // used in forward with depthwise post-ops only
 };
 
 /* pooling */
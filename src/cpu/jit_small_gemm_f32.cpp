@@ -0,0 +1,481 @@
+/*******************************************************************************
+* Copyright 2018 Intel Corporation
+*
+* Licensed under the Apache License, Version 2.0 (the "License");
+* you may not use this file except in compliance with the License.
+* You may obtain a copy of the License at
+*
+*     http://www.apache.org/licenses/LICENSE-2.0
+*
+* Unless required by applicable law or agreed to in writing, software
+* distributed under the License is distributed on an "AS IS" BASIS,
+* WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+* See the License for the specific language governing permissions and
+* limitations under the License.
+*******************************************************************************/
+
+#include "mkldnn_thread.hpp"
+#include "nstl.hpp"
+#include "utils.hpp"
+
+#include "jit_small_gemm_f32.hpp"
+
+namespace mkldnn {
+namespace impl {
+namespace cpu {
+
+using namespace mkldnn::impl::utils;
+
+using namespace Xbyak;
+#define SIZE 4
+
+namespace {
+struct jit_small_gemm_call_s {
+    const float *a;
+    const float *b;
+    float *c;
+    const float *bias;
+};
+
+/* the products with up to max_work multiply-adds whose rows give each
+ * thread at most max_work_per_thr of them; below min_work_per_thr a thread
+ * costs more than it brings */
+const size_t max_work = 1 << 22;
+const size_t max_work_per_thr = 1 << 18;
+const size_t min_work_per_thr = 1 << 16;
+/* keeps all the offsets of the unrolled loops in 32 bits */
+const int max_ld = 1 << 20;
+
+inline bool is_trans(char trans) { return trans == 'T' || trans == 't'; }
+inline int simd_w() { return mayiuse(avx512_common) ? 16 : 8; }
+}
+
+struct jit_small_gemm_f32::xbyak_small_gemm : public jit_generator {
+    DECLARE_CPU_JIT_AUX_FUNCTIONS(jit_small_gemm_f32_xbyak_small_gemm)
+
+    xbyak_small_gemm(bool isTransA, bool isTransB, int m, int n, int k,
+            int lda, int ldb, int ldc, float beta, bool hasBias,
+            bool hasRelu)
+        : isTransA_(isTransA), isTransB_(isTransB), m_(m), n_(n), k_(k)
+        , lda_(lda), ldb_(ldb), ldc_(ldc), beta_(beta), hasBias_(hasBias)
+        , hasRelu_(hasRelu), is_avx512_(mayiuse(avx512_common))
+        , V_(is_avx512_ ? 16 : 8)
+    {
+        /* mr_ vectors (rows of A**T) by nr_ columns of C in the accumulators,
+         * plus mr_ registers for A and one for B; with AVX2 one more holds
+         * the mask of the tail; the columns are split in even blocks of
+         * up to 6 */
+        const int n_vregs = is_avx512_ ? 31 : 14;
+        nr_ = div_up(n_, div_up(n_, 6));
+        mr_ = nstl::min(n_vregs / (nr_ + 1), is_avx512_ ? 8 : 6);
+        mr_ = nstl::min(mr_, isTransA_ ? m_ : div_up(m_, V_));
+
+        if (is_avx512_)
+            generate<Zmm>();
+        else
+            generate<Ymm>();
+        ker_ = getCode<void (*)(const jit_small_gemm_call_s *)>();
+    }
+
+    void (*ker_)(const jit_small_gemm_call_s *);
+
+private:
+    const bool isTransA_, isTransB_;
+    const int m_, n_, k_, lda_, ldb_, ldc_;
+    const float beta_;
+    const bool hasBias_, hasRelu_, is_avx512_;
+    const int V_;
+    int mr_, nr_;
+
+    Reg64 reg_a = r8; // A of the tile of C
+    Reg64 reg_b = r9; // B of the block of columns of C
+    Reg64 reg_c = r10; // the tile of C
+    Reg64 reg_bias = r11; // bias of the tile of C
+    Reg64 reg_aa = r12; // A and B along k
+    Reg64 reg_bb = r13;
+    Reg64 reg_kcnt = r14;
+    Reg64 reg_mcnt = r15;
+    Reg64 reg_ncnt = rax;
+    Reg64 reg_c_blk = rbx; // the block of columns of C
+    Reg64 reg_a_base = rsi;
+    Reg64 reg_bias_base = rdx;
+    Reg64 reg_tmp = rcx;
+
+    Opmask k_tail = k1;
+    Label l_table;
+
+    int acc_idx(int i, int j) { return j * mr_ + i; }
+    int a_idx(int i) { return mr_ * nr_ + i; }
+    /* free after the loop on k: beta and zero for the relu */
+    int beta_idx() { return mr_ * nr_; }
+    int zero_idx() { return mr_ * nr_ + 1; }
+    int b_idx() { return is_avx512_ ? 31 : 15; }
+    int mask_idx() { return 14; }
+
+    template <typename Vmm>
+    void load(int idx, const Address &addr, bool masked) {
+        if (!masked)
+            vmovups(Vmm(idx), addr);
+        else if (is_avx512_)
+            vmovups(Zmm(idx) | k_tail | T_z, addr);
+        else
+            vmaskmovps(Ymm(idx), Ymm(mask_idx()), addr);
+    }
+
+    template <typename Vmm>
+    void store(const Address &addr, int idx, bool masked) {
+        if (!masked)
+            vmovups(addr, Vmm(idx));
+        else if (is_avx512_)
+            vmovups(addr, Zmm(idx) | k_tail);
+        else
+            vmaskmovps(addr, Ymm(mask_idx()), Ymm(idx));
+    }
+
+    template <typename Vmm>
+    void zero(int idx) {
+        /* vxorps on zmm needs AVX512DQ */
+        if (is_avx512_)
+            vpxord(Zmm(idx), Zmm(idx), Zmm(idx));
+        else
+            vxorps(Ymm(idx), Ymm(idx), Ymm(idx));
+    }
+
+    /* sum of the elements of the accumulator in its first element */
+    template <typename Vmm>
+    void reduce(int idx) {
+        const Vmm v(idx), t(b_idx());
+        if (is_avx512_) {
+            vshuff32x4(Zmm(b_idx()), Zmm(idx), Zmm(idx), 0x4E);
+            vaddps(v, v, t);
+            vshuff32x4(Zmm(b_idx()), Zmm(idx), Zmm(idx), 0xB1);
+        } else {
+            vperm2f128(Ymm(b_idx()), Ymm(idx), Ymm(idx), 0x1);
+        }
+        vaddps(v, v, t);
+        vpermilps(t, v, 0x4E);
+        vaddps(v, v, t);
+        vpermilps(t, v, 0xB1);
+        vaddps(v, v, t);
+    }
+
+    /* the steps along k, unrolled; step(u) emits the step at the offset u
+     * from reg_aa and reg_bb, which move by a_step and b_step bytes */
+    template <typename F>
+    void k_loop(int nsteps, int unroll, int a_step, int b_step, F step) {
+        mov(reg_aa, reg_a);
+        mov(reg_bb, reg_b);
+        const int nloops = nsteps / unroll;
+        if (nloops > 0) {
+            Label l_k;
+            if (nloops > 1)
+                mov(reg_kcnt, nloops);
+            L(l_k);
+            for (int u = 0; u < unroll; u++)
+                step(u);
+            add(reg_aa, unroll * a_step);
+            add(reg_bb, unroll * b_step);
+            if (nloops > 1) {
+                dec(reg_kcnt);
+                jnz(l_k, T_NEAR);
+            }
+        }
+        for (int u = 0; u < nsteps % unroll; u++)
+            step(u);
+    }
+
+    /* op(A) = A: a tile of mv vectors of rows, the last one partial with
+     * tail, by nr columns */
+    template <typename Vmm>
+    void tile_n(int mv, bool tail, int nr) {
+        for (int j = 0; j < nr; j++)
+            for (int i = 0; i < mv; i++)
+                zero<Vmm>(acc_idx(i, j));
+
+        auto b_addr = [&](int u, int j) {
+            return isTransB_ ? ptr[reg_bb + (u * ldb_ + j) * SIZE]
+                : ptr[reg_bb + (j * ldb_ + u) * SIZE];
+        };
+        k_loop(k_, 4, lda_ * SIZE, (isTransB_ ? ldb_ : 1) * SIZE,
+                [&](int u) {
+            for (int i = 0; i < mv; i++)
+                load<Vmm>(a_idx(i), ptr[reg_aa + (u * lda_ + i * V_) * SIZE],
+                        tail && i == mv - 1);
+            for (int j = 0; j < nr; j++) {
+                vbroadcastss(Vmm(b_idx()), b_addr(u, j));
+                for (int i = 0; i < mv; i++)
+                    vfmadd231ps(Vmm(acc_idx(i, j)), Vmm(a_idx(i)),
+                            Vmm(b_idx()));
+            }
+        });
+
+        const Vmm v_beta(beta_idx()), v_zero(zero_idx()), v_tmp(b_idx());
+        if (!one_of(beta_, 0.0f, 1.0f))
+            vbroadcastss(v_beta, ptr[reg_tmp]);
+        if (hasRelu_)
+            zero<Vmm>(zero_idx());
+        for (int j = 0; j < nr; j++)
+            for (int i = 0; i < mv; i++) {
+                const Vmm v_acc(acc_idx(i, j));
+                const bool masked = tail && i == mv - 1;
+                const Address c_addr = ptr[reg_c + (j * ldc_ + i * V_) * SIZE];
+                if (beta_ != 0.0f) {
+                    load<Vmm>(b_idx(), c_addr, masked);
+                    if (beta_ == 1.0f)
+                        vaddps(v_acc, v_acc, v_tmp);
+                    else
+                        vfmadd231ps(v_acc, v_beta, v_tmp);
+                }
+                if (hasBias_) {
+                    load<Vmm>(b_idx(), ptr[reg_bias + i * V_ * SIZE], masked);
+                    vaddps(v_acc, v_acc, v_tmp);
+                }
+                if (hasRelu_)
+                    vmaxps(v_acc, v_acc, v_zero);
+                store<Vmm>(c_addr, acc_idx(i, j), masked);
+            }
+    }
+
+    /* op(A) = A**T: a tile of mrows rows by nr columns, the dot products
+     * are computed by vectors along k and reduced */
+    template <typename Vmm>
+    void tile_t(int mrows, int nr) {
+        for (int j = 0; j < nr; j++)
+            for (int i = 0; i < mrows; i++)
+                zero<Vmm>(acc_idx(i, j));
+
+        auto step = [&](int u, bool masked) {
+            for (int i = 0; i < mrows; i++)
+                load<Vmm>(a_idx(i), ptr[reg_aa + (i * lda_ + u * V_) * SIZE],
+                        masked);
+            for (int j = 0; j < nr; j++) {
+                load<Vmm>(b_idx(), ptr[reg_bb + (j * ldb_ + u * V_) * SIZE],
+                        masked);
+                for (int i = 0; i < mrows; i++)
+                    vfmadd231ps(Vmm(acc_idx(i, j)), Vmm(a_idx(i)),
+                            Vmm(b_idx()));
+            }
+        };
+        const int nsteps = k_ / V_;
+        k_loop(nsteps, 2, V_ * SIZE, V_ * SIZE,
+                [&](int u) { step(u, false); });
+        if (k_ % V_)
+            step(nsteps % 2, true);
+
+        const Xmm x_beta(beta_idx()), x_zero(zero_idx()), x_tmp(b_idx());
+        if (!one_of(beta_, 0.0f, 1.0f))
+            vmovss(x_beta, ptr[reg_tmp]);
+        if (hasRelu_)
+            zero<Vmm>(zero_idx());
+        for (int j = 0; j < nr; j++)
+            for (int i = 0; i < mrows; i++) {
+                reduce<Vmm>(acc_idx(i, j));
+                const Xmm x_acc(acc_idx(i, j));
+                const Address c_addr = ptr[reg_c + (j * ldc_ + i) * SIZE];
+                if (beta_ == 1.0f)
+                    vaddss(x_acc, x_acc, c_addr);
+                else if (beta_ != 0.0f) {
+                    vmovss(x_tmp, c_addr);
+                    vfmadd231ss(x_acc, x_beta, x_tmp);
+                }
+                if (hasBias_)
+                    vaddss(x_acc, x_acc, ptr[reg_bias + i * SIZE]);
+                if (hasRelu_)
+                    vmaxss(x_acc, x_acc, x_zero);
+                vmovss(c_addr, x_acc);
+            }
+    }
+
+    /* the tiles of a block of nr columns */
+    template <typename Vmm>
+    void m_loop(int nr) {
+        const int tile_m = isTransA_ ? mr_ : mr_ * V_;
+        const int m_tiles = m_ / tile_m;
+        const int m_tail = m_ % tile_m;
+
+        mov(reg_a, reg_a_base);
+        mov(reg_c, reg_c_blk);
+        if (hasBias_)
+            mov(reg_bias, reg_bias_base);
+        if (m_tiles > 0) {
+            Label l_m;
+            if (m_tiles > 1)
+                mov(reg_mcnt, m_tiles);
+            L(l_m);
+            if (isTransA_)
+                tile_t<Vmm>(mr_, nr);
+            else
+                tile_n<Vmm>(mr_, false, nr);
+            add(reg_a, (isTransA_ ? tile_m * lda_ : tile_m) * SIZE);
+            add(reg_c, tile_m * SIZE);
+            if (hasBias_)
+                add(reg_bias, tile_m * SIZE);
+            if (m_tiles > 1) {
+                dec(reg_mcnt);
+                jnz(l_m, T_NEAR);
+            }
+        }
+        if (m_tail > 0) {
+            if (isTransA_)
+                tile_t<Vmm>(m_tail, nr);
+            else
+                tile_n<Vmm>(div_up(m_tail, V_), m_tail % V_ != 0, nr);
+        }
+    }
+
+    template <typename Vmm>
+    void generate() {
+#define GET_OFF(field) offsetof(jit_small_gemm_call_s, field)
+        preamble();
+
+        mov(reg_a_base, ptr[param1 + GET_OFF(a)]);
+        mov(reg_b, ptr[param1 + GET_OFF(b)]);
+        mov(reg_c_blk, ptr[param1 + GET_OFF(c)]);
+        mov(reg_bias_base, ptr[param1 + GET_OFF(bias)]);
+
+        /* the rows of op(A) or k past the last whole vector */
+        const int tail = isTransA_ ? k_ % V_ : m_ % V_;
+        if (tail) {
+            if (is_avx512_) {
+                mov(reg_tmp.cvt32(), (1 << tail) - 1);
+                kmovw(k_tail, reg_tmp.cvt32());
+            } else {
+                mov(reg_tmp, l_table);
+                vmovups(Ymm(mask_idx()), ptr[reg_tmp + SIZE]);
+            }
+        }
+        mov(reg_tmp, l_table); // beta
+
+        const int n_blks = n_ / nr_;
+        const int n_tail = n_ % nr_;
+        const int b_blk_step = (isTransB_ ? nr_ : nr_ * ldb_) * SIZE;
+        if (n_blks > 0) {
+            Label l_n;
+            if (n_blks > 1)
+                mov(reg_ncnt, n_blks);
+            L(l_n);
+            m_loop<Vmm>(nr_);
+            add(reg_b, b_blk_step);
+            add(reg_c_blk, nr_ * ldc_ * SIZE);
+            if (n_blks > 1) {
+                dec(reg_ncnt);
+                jnz(l_n, T_NEAR);
+            }
+        }
+        if (n_tail > 0)
+            m_loop<Vmm>(n_tail);
+
+        postamble();
+
+        /* beta, then the mask of the AVX2 tail */
+        align(64);
+        L(l_table);
+        dd(float2int(beta_));
+        for (int i = 0; i < 8; i++)
+            dd(i < tail ? 0xffffffff : 0);
+#undef GET_OFF
+    }
+};
+
+bool jit_small_gemm_f32::is_applicable(char transa, char transb, int m,
+        int n, int k, int lda, int ldb, int ldc) {
+    if (!mayiuse(avx2))
+        return false;
+    const bool isTransA = is_trans(transa);
+    const size_t work = (size_t)m * n * k;
+    const int nthr = nstl::min(omp_get_max_threads(),
+            div_up(m, isTransA ? 1 : simd_w()));
+    return true
+        && implication(isTransA, !is_trans(transb))
+        && m > 0 && n > 0 && k > 0
+        && nstl::max(lda, nstl::max(ldb, ldc)) <= max_ld
+        && work <= max_work
+        && work <= nthr * max_work_per_thr;
+}
+
+jit_small_gemm_f32::jit_small_gemm_f32(char transa, char transb, int m,
+        int n, int k, int lda, int ldb, int ldc, float beta, bool hasBias,
+        bool hasRelu)
+    : isTransA_(is_trans(transa)), m_(m), n_(n), k_(k), lda_(lda), ldb_(ldb)
+    , ldc_(ldc), ker_tail_(nullptr)
+{
+    assert(is_applicable(transa, transb, m, n, k, lda, ldb, ldc));
+
+    const size_t work = (size_t)m * n * k;
+    const int nthr = (int)nstl::min((size_t)omp_get_max_threads(),
+            nstl::max((size_t)1, work / min_work_per_thr));
+    m_thr_ = nstl::min(m, rnd_up(div_up(m, nthr),
+                isTransA_ ? 1 : simd_w()));
+    nthr_ = div_up(m, m_thr_);
+    const int m_tail = m - (nthr_ - 1) * m_thr_;
+
+    const bool isTransB = is_trans(transb);
+    ker_ = new xbyak_small_gemm(isTransA_, isTransB, m_thr_, n, k, lda, ldb,
+            ldc, beta, hasBias, hasRelu);
+    if (m_tail != m_thr_)
+        ker_tail_ = new xbyak_small_gemm(isTransA_, isTransB, m_tail, n, k,
+                lda, ldb, ldc, beta, hasBias, hasRelu);
+}
+
+jit_small_gemm_f32::~jit_small_gemm_f32()
+{
+    delete ker_;
+    delete ker_tail_;
+}
+
+void jit_small_gemm_f32::ker(int ithr, const float *A, const float *B,
+        float *C, const float *bias) const
+{
+    const int i0 = ithr * m_thr_;
+    jit_small_gemm_call_s p;
+    p.a = &A[isTransA_ ? (size_t)i0 * lda_ : i0];
+    p.b = B;
+    p.c = &C[i0];
+    p.bias = bias ? &bias[i0] : nullptr;
+    if (ithr == nthr_ - 1 && ker_tail_)
+        ker_tail_->ker_(&p);
+    else
+        ker_->ker_(&p);
+}
+
+void jit_small_gemm_f32::sgemm(const float *A, const float *B, float *C,
+        const float *bias) const
+{
+    if (nthr_ == 1) {
+        ker(0, A, B, C, bias);
+        return;
+    }
+
+#   pragma omp parallel num_threads(nthr_)
+    {
+        for (int ithr = omp_get_thread_num(); ithr < nthr_;
+                ithr += omp_get_num_threads())
+            ker(ithr, A, B, C, bias);
+    }
+}
+
+void jit_small_gemm_f32::sgemm_batch(int batch, const float **A,
+        const float **B, float **C) const
+{
+    const int work_amount = batch * nthr_;
+    if (work_amount == 1) {
+        ker(0, A[0], B[0], C[0], nullptr);
+        return;
+    }
+
+    const int nthr = nstl::min(work_amount, omp_get_max_threads());
+#   pragma omp parallel num_threads(nthr)
+    {
+        for (int iwork = omp_get_thread_num(); iwork < work_amount;
+                iwork += omp_get_num_threads()) {
+            const int b = iwork / nthr_;
+            ker(iwork % nthr_, A[b], B[b], C[b], nullptr);
+        }
+    }
+}
+
+}
+}
+}
+
+// vim: et ts=4 sw=4 cindent cino^=l0,\:0,N-s
@@ -0,0 +1,85 @@
+/*******************************************************************************
+* Copyright 2018 Intel Corporation
+*
+* Licensed under the Apache License, Version 2.0 (the "License");
+* you may not use this file except in compliance with the License.
+* You may obtain a copy of the License at
+*
+*     http://www.apache.org/licenses/LICENSE-2.0
+*
+* Unless required by applicable law or agreed to in writing, software
+* distributed under the License is distributed on an "AS IS" BASIS,
+* WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+* See the License for the specific language governing permissions and
+* limitations under the License.
+*******************************************************************************/
+
+#ifndef JIT_SMALL_GEMM_F32_HPP
+#define JIT_SMALL_GEMM_F32_HPP
+
+#include "c_types_map.hpp"
+#include "jit_generator.hpp"
+
+namespace mkldnn {
+namespace impl {
+namespace cpu {
+
+/* sgemm for one fixed shape, for the small products of the rnn cells and of
+ * the inner products where copying A and B and partitioning the threads cost
+ * more than the products themselves in the general jit sgemms.
+ *
+ * m, n, k, the leading dimensions and beta are fixed when the kernel is
+ * generated: the register blocking is chosen for n, the loops have constant
+ * trip counts and the edges are handled by masks. A and B are read in place,
+ * without packing, and alpha is 1. The rows of C are split once for all
+ * between the threads the amount of work justifies.
+ *
+ * op(A) = A with op(B) = B or B**T: the columns of A are loaded by vectors
+ * and multiplied by the broadcast elements of B.
+ * op(A) = A**T with op(B) = B: the rows of A and the columns of B are both
+ * contiguous along k, the dot products are reduced at the end. */
+class jit_small_gemm_f32 {
+public:
+    static bool is_applicable(char transa, char transb, int m, int n, int k,
+            int lda, int ldb, int ldc);
+
+    /* C = op(A) * op(B) + beta * C + bias, followed by a relu for an object
+     * created with hasRelu. bias has one value per row of C. */
+    void sgemm(const float *A, const float *B, float *C,
+            const float *bias = NULL) const;
+
+    /* the batch products of the shape run side by side: the blocks of rows
+     * of all of them are distributed between the threads */
+    void sgemm_batch(int batch, const float **A, const float **B,
+            float **C) const;
+
+    /* the object computes the products of this shape */
+    bool has_shape(int m, int n, int k, int lda, int ldb, int ldc) const {
+        return m == m_ && n == n_ && k == k_ && lda == lda_ && ldb == ldb_
+            && ldc == ldc_;
+    }
+
+    jit_small_gemm_f32(char transa, char transb, int m, int n, int k,
+            int lda, int ldb, int ldc, float beta, bool hasBias = false,
+            bool hasRelu = false);
+    ~jit_small_gemm_f32();
+
+private:
+    struct xbyak_small_gemm;
+
+    /* the block of rows of C of the thread ithr */
+    void ker(int ithr, const float *A, const float *B, float *C,
+            const float *bias) const;
+
+    bool isTransA_;
+    int m_, n_, k_, lda_, ldb_, ldc_;
+    int nthr_, m_thr_; // rows of C per thread, the last one takes the rest
+    xbyak_small_gemm *ker_, *ker_tail_;
+};
+}
+}
+}
+
+#endif
+
+// vim: et ts=4 sw=4 cindent cino^=l0,\:0,N-s
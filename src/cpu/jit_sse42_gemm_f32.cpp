@@ -0,0 +1,566 @@
+/*******************************************************************************
+* Copyright 2018 Intel Corporation
+*
+* Licensed under the Apache License, Version 2.0 (the "License");
+* you may not use this file except in compliance with the License.
+* You may obtain a copy of the License at
+*
+*     http://www.apache.org/licenses/LICENSE-2.0
+*
+* Unless required by applicable law or agreed to in writing, software
+* distributed under the License is distributed on an "AS IS" BASIS,
+* WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+* See the License for the specific language governing permissions and
+* limitations under the License.
+*******************************************************************************/
+
+#include "mkldnn_thread.hpp"
+#include "nstl.hpp"
+#include "utils.hpp"
+
+#include "jit_sse42_gemm_f32.hpp"
+
+#define CACHE_LINE_SIZE 16
+
+namespace mkldnn {
+namespace impl {
+namespace cpu {
+
+using namespace mkldnn::impl::utils;
+
+using namespace Xbyak;
+#define SIZE 4
+#define UNROLL_M 8
+#define UNROLL_N 6
+/* the A block stays in L2 and the B block in L3 */
+#define BLOCK_M 128
+#define BLOCK_N 192
+#define BLOCK_K 256
+#define MIN_WORK_PER_THR (1 << 16)
+
+namespace {
+struct jit_sse42_gemm_call_s {
+    const float *a;
+    const float *b;
+    float *c;
+    size_t k;
+    size_t ldc;
+};
+
+/* leading dimension of the packed A: whole cache lines per column */
+inline int packed_lda(int m) { return rnd_up(m, CACHE_LINE_SIZE); }
+
+/* op(A), m x k, by panels of UNROLL_M rows stored k-major and scaled by
+ * alpha; the rows past m are zeroed */
+void pack_a(bool isTransA, int m, int k, float alpha, const float *a,
+        int lda, float *a_buf) {
+    for (int i0 = 0; i0 < m; i0 += UNROLL_M) {
+        const int mr = nstl::min(UNROLL_M, m - i0);
+        float *p = &a_buf[i0 * k];
+        if (isTransA) {
+            for (int i = 0; i < mr; i++) {
+                const float *a_row = &a[(size_t)(i0 + i) * lda];
+                for (int kk = 0; kk < k; kk++)
+                    p[kk * UNROLL_M + i] = alpha * a_row[kk];
+            }
+        } else {
+            for (int kk = 0; kk < k; kk++) {
+                const float *a_col = &a[i0 + (size_t)kk * lda];
+                for (int i = 0; i < mr; i++)
+                    p[kk * UNROLL_M + i] = alpha * a_col[i];
+            }
+        }
+        for (int kk = 0; kk < k; kk++)
+            for (int i = mr; i < UNROLL_M; i++)
+                p[kk * UNROLL_M + i] = 0.0f;
+    }
+}
+
+/* op(B), k x n, by panels of UNROLL_N columns stored k-major; the columns
+ * past n are zeroed */
+void pack_b(bool isTransB, int k, int n, const float *b, int ldb,
+        float *b_buf) {
+    for (int j0 = 0; j0 < n; j0 += UNROLL_N) {
+        const int nr = nstl::min(UNROLL_N, n - j0);
+        float *p = &b_buf[j0 * k];
+        if (isTransB) {
+            for (int kk = 0; kk < k; kk++) {
+                const float *b_row = &b[j0 + (size_t)kk * ldb];
+                for (int j = 0; j < nr; j++)
+                    p[kk * UNROLL_N + j] = b_row[j];
+            }
+        } else {
+            for (int j = 0; j < nr; j++) {
+                const float *b_col = &b[(size_t)(j0 + j) * ldb];
+                for (int kk = 0; kk < k; kk++)
+                    p[kk * UNROLL_N + j] = b_col[kk];
+            }
+        }
+        for (int kk = 0; kk < k; kk++)
+            for (int j = nr; j < UNROLL_N; j++)
+                p[kk * UNROLL_N + j] = 0.0f;
+    }
+}
+}
+
+#define GET_OFF(field) offsetof(jit_sse42_gemm_call_s, field)
+
+/* C(8 x 6) = A(8 x k) * B(k x 6), or C += with accumulate, for the packed
+ * panels of A and B. The 12 accumulators, 2 columns of A, the broadcast
+ * element of B and a temporary take the 16 xmm registers. */
+struct jit_sse42_gemm_f32::xbyak_gemm : public jit_generator {
+    DECLARE_CPU_JIT_AUX_FUNCTIONS(jit_sse42_gemm_f32_xbyak_gemm)
+
+    xbyak_gemm(bool accumulate)
+    {
+        Reg64 reg_a = r8;
+        Reg64 reg_b = r9;
+        Reg64 reg_c = r10;
+        Reg64 reg_k = r11;
+        Reg64 reg_ldc = r12;
+        Reg64 reg_c3 = r13;
+
+        Xmm vA0 = xmm12, vA1 = xmm13, vB = xmm14, vTmp = xmm15;
+        auto vC = [](int i, int j) { return Xmm(2 * j + i); };
+
+        auto fma_step = [&](int u) {
+            movaps(vA0, ptr[reg_a + (u * UNROLL_M + 0) * SIZE]);
+            movaps(vA1, ptr[reg_a + (u * UNROLL_M + 4) * SIZE]);
+            for (int j = 0; j < UNROLL_N; j++) {
+                movss(vB, ptr[reg_b + (u * UNROLL_N + j) * SIZE]);
+                shufps(vB, vB, 0);
+                movaps(vTmp, vB);
+                mulps(vTmp, vA0);
+                addps(vC(0, j), vTmp);
+                mulps(vB, vA1);
+                addps(vC(1, j), vB);
+            }
+        };
+
+        /* columns 0..2 are addressed from C, 3..5 from C + 3 * ldc */
+        auto c_addr = [&](int j, int off) {
+            const Reg64 &base = j < 3 ? reg_c : reg_c3;
+            return j % 3 == 0 ? ptr[base + off]
+                : ptr[base + reg_ldc * (j % 3) + off];
+        };
+
+        Label l_main, l_tail, l_tail_loop, l_store;
+
+        preamble();
+
+        mov(reg_a, ptr[param1 + GET_OFF(a)]);
+        mov(reg_b, ptr[param1 + GET_OFF(b)]);
+        mov(reg_c, ptr[param1 + GET_OFF(c)]);
+        mov(reg_k, ptr[param1 + GET_OFF(k)]);
+        mov(reg_ldc, ptr[param1 + GET_OFF(ldc)]);
+        shl(reg_ldc, 2);
+        lea(reg_c3, ptr[reg_c + reg_ldc * 2]);
+        add(reg_c3, reg_ldc);
+
+        for (int j = 0; j < UNROLL_N; j++)
+            for (int i = 0; i < 2; i++)
+                xorps(vC(i, j), vC(i, j));
+
+        cmp(reg_k, 4);
+        jl(l_tail, T_NEAR);
+        L(l_main);
+        {
+            prefetcht0(ptr[reg_a + 8 * UNROLL_M * SIZE]);
+            prefetcht0(ptr[reg_a + 8 * UNROLL_M * SIZE + 64]);
+            for (int u = 0; u < 4; u++)
+                fma_step(u);
+            add(reg_a, 4 * UNROLL_M * SIZE);
+            add(reg_b, 4 * UNROLL_N * SIZE);
+            sub(reg_k, 4);
+            cmp(reg_k, 4);
+            jge(l_main, T_NEAR);
+        }
+
+        L(l_tail);
+        test(reg_k, reg_k);
+        jz(l_store, T_NEAR);
+        L(l_tail_loop);
+        {
+            fma_step(0);
+            add(reg_a, UNROLL_M * SIZE);
+            add(reg_b, UNROLL_N * SIZE);
+            dec(reg_k);
+            jnz(l_tail_loop, T_NEAR);
+        }
+
+        L(l_store);
+        for (int j = 0; j < UNROLL_N; j++) {
+            for (int i = 0; i < 2; i++) {
+                if (accumulate) {
+                    movups(vTmp, c_addr(j, 4 * i * SIZE));
+                    addps(vC(i, j), vTmp);
+                }
+                movups(c_addr(j, 4 * i * SIZE), vC(i, j));
+            }
+        }
+
+        postamble();
+
+        ker_ = reinterpret_cast<decltype(ker_)>(
+                const_cast<uint8_t *>(this->getCode()));
+    }
+
+    void operator()(jit_sse42_gemm_call_s *p) const { (*ker_)(p); }
+
+private:
+    void (*ker_)(jit_sse42_gemm_call_s *);
+};
+
+#undef GET_OFF
+
+/* the bias and the relu of the tile, once its last block of K is done */
+void jit_sse42_gemm_f32::post_tile(int m, int n, float *c, int ldc,
+        const float *bias)
+{
+    for (int j = 0; j < n; j++) {
+        float *c_col = &c[(size_t)j * ldc];
+        for (int i = 0; i < m; i++) {
+            float d = c_col[i];
+            if (hasBias_)
+                d += bias[isColBias_ ? j : i];
+            if (hasRelu_ && d < 0.0f)
+                d = 0.0f;
+            c_col[i] = d;
+        }
+    }
+}
+
+size_t jit_sse42_gemm_f32::ws_elems_per_thr(int m, int n, int k)
+{
+    const int kb = nstl::min(BLOCK_K, k);
+    return (size_t)nstl::min(BLOCK_M, rnd_up(m, UNROLL_M)) * kb
+        + (size_t)nstl::min(BLOCK_N, rnd_up(n, UNROLL_N)) * kb;
+}
+
+/* C(m x n) of a thread: blocks of B (BLOCK_K x BLOCK_N) and A
+ * (BLOCK_M x BLOCK_K) are packed into ws and multiplied by tiles of
+ * UNROLL_M x UNROLL_N. beta is applied with the first block of K, the bias
+ * and the relu with the last one, while the tile is in cache. */
+void jit_sse42_gemm_f32::sgemm_thr(int m, int n, int k, float alpha,
+        const float *a, int lda, const float *b, int ldb, float beta,
+        float *c, int ldc, const float *bias, float *ws)
+{
+    const bool isTransA = (transa_ == 'T' || transa_ == 't');
+    const bool isTransB = (transb_ == 'T' || transb_ == 't');
+
+    if (k == 0) {
+        for (int j = 0; j < n; j++)
+            for (int i = 0; i < m; i++) {
+                float &d = c[i + (size_t)j * ldc];
+                d = beta == 0.0f ? 0.0f : beta * d;
+            }
+        if (hasBias_ || hasRelu_)
+            post_tile(m, n, c, ldc, bias);
+        return;
+    }
+
+    float *a_buf = ws;
+    float *b_buf = ws
+        + (size_t)nstl::min(BLOCK_M, rnd_up(m, UNROLL_M)) * nstl::min(
+                BLOCK_K, k);
+    float tile[UNROLL_M * UNROLL_N];
+
+    for (int j0 = 0; j0 < n; j0 += BLOCK_N) {
+        const int nb = nstl::min(BLOCK_N, n - j0);
+        for (int k0 = 0; k0 < k; k0 += BLOCK_K) {
+            const int kb = nstl::min(BLOCK_K, k - k0);
+            const bool first = k0 == 0;
+            const bool last = k0 + kb == k;
+            pack_b(isTransB, kb, nb,
+                    isTransB ? &b[j0 + (size_t)k0 * ldb]
+                             : &b[k0 + (size_t)j0 * ldb],
+                    ldb, b_buf);
+
+            for (int i0 = 0; i0 < m; i0 += BLOCK_M) {
+                const int mb = nstl::min(BLOCK_M, m - i0);
+                pack_a(isTransA, mb, kb, alpha,
+                        isTransA ? &a[k0 + (size_t)i0 * lda]
+                                 : &a[i0 + (size_t)k0 * lda],
+                        lda, a_buf);
+
+                for (int jr = 0; jr < nb; jr += UNROLL_N)
+                for (int ir = 0; ir < mb; ir += UNROLL_M) {
+                    const int mr = nstl::min(UNROLL_M, mb - ir);
+                    const int nr = nstl::min(UNROLL_N, nb - jr);
+                    float *c_tile = &c[i0 + ir + (size_t)(j0 + jr) * ldc];
+
+                    jit_sse42_gemm_call_s p;
+                    p.a = &a_buf[ir * kb];
+                    p.b = &b_buf[jr * kb];
+                    p.k = kb;
+                    if (mr == UNROLL_M && nr == UNROLL_N) {
+                        p.c = c_tile;
+                        p.ldc = ldc;
+                        if (first && beta == 0.0f) {
+                            (*ker_b0_)(&p);
+                        } else {
+                            if (first && beta != 1.0f)
+                                for (int j = 0; j < nr; j++)
+                                    for (int i = 0; i < mr; i++)
+                                        c_tile[i + (size_t)j * ldc] *= beta;
+                            (*ker_b1_)(&p);
+                        }
+                    } else {
+                        p.c = tile;
+                        p.ldc = UNROLL_M;
+                        (*ker_b0_)(&p);
+                        for (int j = 0; j < nr; j++)
+                            for (int i = 0; i < mr; i++) {
+                                float &d = c_tile[i + (size_t)j * ldc];
+                                const float t = tile[i + j * UNROLL_M];
+                                d = !first ? d + t
+                                    : beta == 0.0f ? t : beta * d + t;
+                            }
+                    }
+
+                    if (last && (hasBias_ || hasRelu_))
+                        post_tile(mr, nr, c_tile, ldc, hasBias_
+                                ? &bias[isColBias_ ? j0 + jr : i0 + ir]
+                                : NULL);
+                }
+            }
+        }
+    }
+}
+
+/* 2D grid of threads over C, there is no split along K: the blocks of the
+ * threads are whole tiles and the grid minimizes the block of the slowest
+ * thread, packing included */
+void jit_sse42_gemm_f32::calc_nthr_sse42(int m, int n, int nthrs,
+        int *nthrs_m, int *nthrs_n, int *BM, int *BN)
+{
+    int best_nthr_m = 1;
+    double best_cost = 0.0;
+    for (int nthr_m = 1; nthr_m <= nthrs; nthr_m++) {
+        const int nthr_n = nthrs / nthr_m;
+        const double mb = rnd_up(div_up(m, nthr_m), UNROLL_M);
+        const double nb = rnd_up(div_up(n, nthr_n), UNROLL_N);
+        const double cost = mb * nb + 2 * (mb + nb);
+        if (nthr_m == 1 || cost < best_cost) {
+            best_cost = cost;
+            best_nthr_m = nthr_m;
+        }
+    }
+
+    *BM = rnd_up(div_up(m, best_nthr_m), UNROLL_M);
+    *BN = rnd_up(div_up(n, nthrs / best_nthr_m), UNROLL_N);
+    *nthrs_m = div_up(m, *BM);
+    *nthrs_n = div_up(n, *BN);
+}
+
+void jit_sse42_gemm_f32::sgemm(const char *transa, const char *transb,
+        const int *p_m, const int *p_n, const int *p_k, const float *p_alpha,
+        const float *A, const int *p_lda, const float *B, const int *p_ldb,
+        const float *p_beta, float *C, const int *p_ldc, const float *bias,
+        int nthr_max)
+{
+    assert(*transa == transa_ && *transb == transb_);
+    const bool isTransA = (*transa == 'T' || *transa == 't');
+    const bool isTransB = (*transb == 'T' || *transb == 't');
+
+    const int m = *p_m;
+    const int n = *p_n;
+    const int k = *p_k;
+    const int lda = *p_lda;
+    const int ldb = *p_ldb;
+    const int ldc = *p_ldc;
+    if (m <= 0 || n <= 0)
+        return;
+
+    int nthr = (omp_in_parallel()) ? 1 : omp_get_max_threads();
+    if (nthr_max > 0)
+        nthr = nstl::min(nthr, nthr_max);
+    const double work = (double)m * n * nstl::max(k, 1);
+    nthr = nstl::max(1, (int)nstl::min((double)nthr, work / MIN_WORK_PER_THR));
+
+    int nthr_m, nthr_n, MB, NB;
+    calc_nthr_sse42(m, n, nthr, &nthr_m, &nthr_n, &MB, &NB);
+    nthr = nthr_m * nthr_n;
+
+    const size_t ws_size_per_thr = rnd_up(
+            ws_elems_per_thr(MB, NB, k) * sizeof(float), PAGE_4K);
+    float *ws_buffers = (float *)malloc(nthr * ws_size_per_thr, PAGE_4K);
+
+    auto thr_gemm = [&](int ithr) {
+        const int m_from = MB * (ithr % nthr_m);
+        const int m_to = nstl::min(m, m_from + MB);
+        const int n_from = NB * (ithr / nthr_m);
+        const int n_to = nstl::min(n, n_from + NB);
+        if (m_from >= m_to || n_from >= n_to)
+            return;
+
+        const float *myA = isTransA ? &A[(size_t)m_from * lda] : &A[m_from];
+        const float *myB = isTransB ? &B[n_from] : &B[(size_t)n_from * ldb];
+        const float *myBias = hasBias_
+            ? &bias[isColBias_ ? n_from : m_from] : NULL;
+        sgemm_thr(m_to - m_from, n_to - n_from, k, *p_alpha, myA, lda, myB,
+                ldb, *p_beta, &C[m_from + (size_t)n_from * ldc], ldc, myBias,
+                ws_buffers + ithr * ws_size_per_thr / sizeof(float));
+    };
+
+    if (nthr == 1) {
+        thr_gemm(0);
+    } else {
+#pragma omp parallel num_threads(nthr)
+        thr_gemm(omp_get_thread_num());
+    }
+
+    free(ws_buffers);
+}
+
+float *jit_sse42_gemm_f32::sgemm_pack_alloc(int m, int k)
+{
+    return (float *)malloc(
+            sizeof(float) * packed_lda(m) * nstl::max(k, 1), PAGE_4K);
+}
+
+void jit_sse42_gemm_f32::sgemm_pack_free(float *packed_A)
+{
+    free(packed_A);
+}
+
+void jit_sse42_gemm_f32::sgemm_pack(const char *transa, const int *p_m,
+        const int *p_k, const float *A, const int *p_lda, float *packed_A)
+{
+    const bool isTransA = (*transa == 'T' || *transa == 't');
+    const int m = *p_m;
+    const int k = *p_k;
+    const int lda = *p_lda;
+    const int ld = packed_lda(m);
+
+#pragma omp parallel for schedule(static)
+    for (int j = 0; j < k; j++) {
+        for (int i = 0; i < m; i++)
+            packed_A[i + (size_t)j * ld] = isTransA
+                ? A[j + (size_t)i * lda] : A[i + (size_t)j * lda];
+        for (int i = m; i < ld; i++)
+            packed_A[i + (size_t)j * ld] = 0.0;
+    }
+}
+
+void jit_sse42_gemm_f32::sgemm_compute(const char *transb, const int *p_m,
+        const int *p_n, const int *p_k, const float *p_alpha,
+        const float *packed_A, const float *B, const int *p_ldb,
+        const float *p_beta, float *C, const int *p_ldc, const float *bias)
+{
+    assert(transa_ == 'N' || transa_ == 'n');
+    const int ld = packed_lda(*p_m);
+    sgemm("N", transb, p_m, p_n, p_k, p_alpha, packed_A, &ld, B, p_ldb,
+            p_beta, C, p_ldc, bias);
+}
+
+void jit_sse42_gemm_f32::sgemm_batch(const char *transa, const char *transb,
+        const int *p_m, const int *p_n, const int *p_k, const float *p_alpha,
+        const float **A, const int *p_lda, const float **B, const int *p_ldb,
+        const float *p_beta, float **C, const int *p_ldc, int batch,
+        const float **bias)
+{
+    const bool isTransA = (*transa == 'T' || *transa == 't');
+    const bool isTransB = (*transb == 'T' || *transb == 't');
+
+    int nthr = (omp_in_parallel()) ? 1 : omp_get_max_threads();
+    const int m = *p_m;
+    const int n = *p_n;
+    const int k = *p_k;
+    const int lda = *p_lda;
+    const int ldb = *p_ldb;
+    const int ldc = *p_ldc;
+
+    /* as for the other jit sgemms, the small gemms of the batch run side
+     * by side, each on its own group of threads */
+    const double work = (double)m * n * nstl::max(k, 1);
+    if (batch <= 1 || nthr == 1 || work >= nthr * (double)MIN_WORK_PER_THR) {
+        for (int b = 0; b < batch; b++)
+            sgemm(transa, transb, p_m, p_n, p_k, p_alpha, A[b], p_lda, B[b],
+                    p_ldb, p_beta, C[b], p_ldc, bias ? bias[b] : NULL);
+        return;
+    }
+    if (m <= 0 || n <= 0)
+        return;
+
+    const int nthr_grp = nstl::max(1, nstl::min(nthr / batch,
+                (int)(work / MIN_WORK_PER_THR)));
+    const int ngrp = nstl::min(batch, nthr / nthr_grp);
+
+    int nthr_m, nthr_n, MB, NB;
+    calc_nthr_sse42(m, n, nthr_grp, &nthr_m, &nthr_n, &MB, &NB);
+    const int nthr_in_grp = nthr_m * nthr_n;
+
+    const size_t ws_size_per_thr = rnd_up(
+            ws_elems_per_thr(MB, NB, k) * sizeof(float), PAGE_4K);
+    float *ws_buffers = (float *)malloc(
+            ngrp * nthr_in_grp * ws_size_per_thr, PAGE_4K);
+
+#pragma omp parallel num_threads(ngrp * nthr_in_grp)
+    {
+        const int ithr = omp_get_thread_num();
+        const int igrp = ithr / nthr_in_grp;
+        const int ithr_grp = ithr % nthr_in_grp;
+        float *ws = ws_buffers + ithr * ws_size_per_thr / sizeof(float);
+
+        const int m_from = MB * (ithr_grp % nthr_m);
+        const int m_to = nstl::min(m, m_from + MB);
+        const int n_from = NB * (ithr_grp / nthr_m);
+        const int n_to = nstl::min(n, n_from + NB);
+
+        if (m_from < m_to && n_from < n_to) {
+            for (int b = igrp; b < batch; b += ngrp) {
+                const float *myA = isTransA
+                    ? &A[b][(size_t)m_from * lda] : &A[b][m_from];
+                const float *myB = isTransB
+                    ? &B[b][n_from] : &B[b][(size_t)n_from * ldb];
+                const float *myBias = (hasBias_ && bias)
+                    ? &bias[b][isColBias_ ? n_from : m_from] : NULL;
+                sgemm_thr(m_to - m_from, n_to - n_from, k, *p_alpha, myA,
+                        lda, myB, ldb, *p_beta,
+                        &C[b][m_from + (size_t)n_from * ldc], ldc, myBias,
+                        ws);
+            }
+        }
+    }
+
+    free(ws_buffers);
+}
+
+void jit_sse42_gemm_f32::sgemm_compute_batch(const char *transb,
+        const int *p_m, const int *p_n, const int *p_k, const float *p_alpha,
+        const float **packed_A, const float **B, const int *p_ldb,
+        const float *p_beta, float **C, const int *p_ldc, int batch,
+        const float **bias)
+{
+    assert(transa_ == 'N' || transa_ == 'n');
+    const int ld = packed_lda(*p_m);
+    sgemm_batch("N", transb, p_m, p_n, p_k, p_alpha, packed_A, &ld, B,
+            p_ldb, p_beta, C, p_ldc, batch, bias);
+}
+
+jit_sse42_gemm_f32::jit_sse42_gemm_f32(
+        char transa, char transb, float beta, bool hasBias, bool isColBias,
+        bool hasRelu)
+{
+    transa_ = transa;
+    transb_ = transb;
+    beta_ = beta;
+    hasBias_ = hasBias;
+    isColBias_ = hasBias && isColBias;
+    hasRelu_ = hasRelu;
+    ker_b0_ = new xbyak_gemm(false);
+    ker_b1_ = new xbyak_gemm(true);
+}
+
+jit_sse42_gemm_f32::~jit_sse42_gemm_f32()
+{
+    delete ker_b0_;
+    delete ker_b1_;
+}
+
+}
+}
+}
+
+// vim: et ts=4 sw=4 cindent cino^=l0,\:0,N-s
@@ -0,0 +1,87 @@
+/*******************************************************************************
+* Copyright 2018 Intel Corporation
+*
+* Licensed under the Apache License, Version 2.0 (the "License");
+* you may not use this file except in compliance with the License.
+* You may obtain a copy of the License at
+*
+*     http://www.apache.org/licenses/LICENSE-2.0
+*
+* Unless required by applicable law or agreed to in writing, software
+* distributed under the License is distributed on an "AS IS" BASIS,
+* WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+* See the License for the specific language governing permissions and
+* limitations under the License.
+*******************************************************************************/
+
+#ifndef JIT_SSE42_GEMM_F32_HPP
+#define JIT_SSE42_GEMM_F32_HPP
+
+#include "c_types_map.hpp"
+#include "jit_generator.hpp"
+
+namespace mkldnn {
+namespace impl {
+namespace cpu {
+
+/* sgemm for the hosts without AVX2, with the interface of jit_avx2_gemm_f32.
+ * A and B are copied by blocks into panels the 8x6 register blocked kernel
+ * streams, and each thread computes a block of C (no split along K). */
+class jit_sse42_gemm_f32 {
+public:
+    /* C = alpha * op(A) * op(B) + beta * C + bias, followed by a relu for an
+     * object created with hasRelu. bias has one value per row of C, or per
+     * column of C with isColBias. At most nthr_max threads are used, 0 means
+     * all of them. */
+    void sgemm(const char *transa, const char *transb, const int *M,
+            const int *N, const int *K, const float *alpha, const float *A,
+            const int *lda, const float *B, const int *ldb, const float *beta,
+            float *C, const int *ldc, const float *bias = NULL,
+            int nthr_max = 0);
+
+    /* Packed A, see jit_avx2_gemm_f32 */
+    static float *sgemm_pack_alloc(int m, int k);
+    static void sgemm_pack(const char *transa, const int *M, const int *K,
+            const float *A, const int *lda, float *packed_A);
+    static void sgemm_pack_free(float *packed_A);
+    void sgemm_compute(const char *transb, const int *M, const int *N,
+            const int *K, const float *alpha, const float *packed_A,
+            const float *B, const int *ldb, const float *beta, float *C,
+            const int *ldc, const float *bias = NULL);
+
+    /* Batch of gemms with the same sizes, see jit_avx2_gemm_f32 */
+    void sgemm_batch(const char *transa, const char *transb, const int *M,
+            const int *N, const int *K, const float *alpha, const float **A,
+            const int *lda, const float **B, const int *ldb,
+            const float *beta, float **C, const int *ldc, int batch,
+            const float **bias = NULL);
+    void sgemm_compute_batch(const char *transb, const int *M, const int *N,
+            const int *K, const float *alpha, const float **packed_A,
+            const float **B, const int *ldb, const float *beta, float **C,
+            const int *ldc, int batch, const float **bias = NULL);
+
+    jit_sse42_gemm_f32(char transa, char transb, float beta,
+            bool hasBias = false, bool isColBias = false,
+            bool hasRelu = false);
+    ~jit_sse42_gemm_f32();
+
+private:
+    void sgemm_thr(int m, int n, int k, float alpha, const float *a, int lda,
+            const float *b, int ldb, float beta, float *c, int ldc,
+            const float *bias, float *ws);
+    void post_tile(int m, int n, float *c, int ldc, const float *bias);
+    inline void calc_nthr_sse42(int m, int n, int nthrs, int *nthrs_m,
+            int *nthrs_n, int *BM, int *BN);
+    inline size_t ws_elems_per_thr(int m, int n, int k);
+
+    char transa_, transb_;
+    float beta_;
+    bool hasBias_, isColBias_, hasRelu_;
+    struct xbyak_gemm;
+    xbyak_gemm *ker_b0_, *ker_b1_;
+};
+}
+}
+}
+
+#endif
@@ -0,0 +1,110 @@
+/*******************************************************************************
+* Copyright 2018 Intel Corporation
+*
+* Licensed under the Apache License, Version 2.0 (the "License");
+* you may not use this file except in compliance with the License.
+* You may obtain a copy of the License at
+*
+*     http://www.apache.org/licenses/LICENSE-2.0
+*
+* Unless required by applicable law or agreed to in writing, software
+* distributed under the License is distributed on an "AS IS" BASIS,
+* WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+* See the License for the specific language governing permissions and
+* limitations under the License.
+*******************************************************************************/
+
+#ifndef JIT_UNI_CONV_IC_SPLIT_HPP
+#define JIT_UNI_CONV_IC_SPLIT_HPP
+
+#include "mkldnn_thread.hpp"
+#include "nstl.hpp"
+#include "utils.hpp"
+
+#include "jit_primitive_conf.hpp"
+
+namespace mkldnn {
+namespace impl {
+namespace cpu {
+
+/* With minibatch 1 the direct forward convolutions have only
+ * ngroups * oc_chunks * oh work items to share between the threads, which is
+ * less than the number of cores for the layers with few output channels or
+ * small images. The latency driver then also splits the reduction over the
+ * input channel blocks: each of the nthr_ic_b groups of the input channels
+ * accumulates its own copy of dst, and the copies are summed up together with
+ * the bias, the sum post-op and relu at the end.
+ *
+ * Returns nthr_ic_b minimizing the time of the busiest thread, 1 if the
+ * convolution is balanced well enough without the split. */
+inline int conv_fwd_ic_split_nthr(const jit_conv_conf_t &jcp, int work_amount,
+        int nthr) {
+    using namespace utils;
+
+    const int nthr_ic_b_max = nstl::min(jcp.nb_ic, nthr);
+    if (jcp.mb != 1 || jcp.with_depthwise || nthr_ic_b_max == 1)
+        return 1;
+
+    /* in vector operations per output row of a block of oc_block channels */
+    const int ker_cost = jcp.ic_block * jcp.kh * jcp.kw;
+    const int red_row_cost = 2;
+    const int nb_rows = jcp.ngroups * jcp.nb_oc * jcp.oh;
+
+    auto cost = [&](int nthr_ic_b) {
+        size_t c = (size_t)div_up(nthr_ic_b * work_amount, nthr)
+            * div_up(jcp.nb_ic, nthr_ic_b) * jcp.nb_oc_blocking * ker_cost;
+        if (nthr_ic_b > 1)
+            c += (size_t)div_up(nb_rows, nthr) * (nthr_ic_b + 2)
+                * red_row_cost;
+        return c;
+    };
+
+    int best_nthr_ic_b = 1;
+    size_t best_cost = cost(1);
+    for (int nthr_ic_b = 2; nthr_ic_b <= nthr_ic_b_max; ++nthr_ic_b) {
+        const size_t c = cost(nthr_ic_b);
+        /* the split costs memory, so it has to pay off noticeably */
+        if (10 * c < 9 * best_cost) {
+            best_cost = c;
+            best_nthr_ic_b = nthr_ic_b;
+        }
+    }
+    return best_nthr_ic_b;
+}
+
+/* dst[:] = sum_i part[i * part_size + :] + bias (+ dst with the sum post-op),
+ * followed by relu. dst and the partial results are in the dense blocked
+ * layout of minibatch 1, i.e. oh * ow * oc_block values per channel block */
+template <typename data_t>
+inline void conv_fwd_ic_split_reduce(const jit_conv_conf_t &jcp, data_t *dst,
+        const data_t *part, size_t part_size, const data_t *bias) {
+    const int nb_oc = jcp.ngroups * jcp.nb_oc;
+    const size_t row_size = (size_t)jcp.ow * jcp.oc_block;
+
+#   pragma omp parallel for collapse(2) schedule(static)
+    for (int ocb = 0; ocb < nb_oc; ++ocb)
+    for (int oh = 0; oh < jcp.oh; ++oh) {
+        const size_t row_off = ((size_t)ocb * jcp.oh + oh) * row_size;
+        const data_t *b = bias ? &bias[ocb * jcp.oc_block] : nullptr;
+        for (int ow = 0; ow < jcp.ow; ++ow) {
+            const size_t off = row_off + ow * jcp.oc_block;
+#           pragma omp simd
+            for (int oc = 0; oc < jcp.oc_block; ++oc) {
+                data_t v = b ? b[oc] : (data_t)0;
+                for (int i = 0; i < jcp.nthr_ic_b; ++i)
+                    v += part[i * part_size + off + oc];
+                if (jcp.with_sum)
+                    v += dst[off + oc];
+                if (jcp.with_relu && v < 0)
+                    v = (data_t)(v * jcp.relu_negative_slope);
+                dst[off + oc] = v;
+            }
+        }
+    }
+}
+
+}
+}
+}
+
+#endif
@@ -59,10 +59,23 @@ void jit_uni_dw_conv_fwd_kernel_f32<isa>::load_src(int ur_ch_blocks, int ur_w) {
     }
 }
 
+template <cpu_isa_t isa>
+void jit_uni_dw_conv_fwd_kernel_f32<isa>::load_src_channel(Vmm vmm_src,
+        const Address &op, int g_ic) {
+    if (jcp.ic == jcp.ngroups) {
+        uni_vmovups(vmm_src, op);
+    } else {
+        /* a group takes one 128-bit lane: replicate its g_ic-th input
+         * channel over the four output channels of the group */
+        vpermilps(vmm_src, op, g_ic * 0x55);
+    }
+}
+
 template <cpu_isa_t isa>
 void jit_uni_dw_conv_fwd_kernel_f32<isa>::apply_filter(
         int ur_ch_blocks, int ur_w) {
     int ch_blk = jcp.ch_block;
+    int ch_per_g = jcp.ic / jcp.ngroups;
     int dilate_h = jcp.dilate_h + 1;
     int dilate_w = jcp.dilate_w + 1;
     int stride_w = jcp.stride_w;
@@ -86,21 +99,24 @@ void jit_uni_dw_conv_fwd_kernel_f32<isa>::apply_filter(
             int repeats = isa == sse42 ? 2 : 1;
             for (int i = 0; i < repeats; i++) {
                 for (int ch = 0; ch < ur_ch_blocks; ch++) {
-                    int ker_off = ch*jcp.kh*jcp.kw*ch_blk + i*4;
-                    Vmm vmm_ker = get_ker_reg(0);
-                    uni_vmovups(vmm_ker, ptr[aux1_reg_kernel
-                        + ker_off*sizeof(float)]);
-
-                    for (int ow = 0; ow < ur_w; ow++) {
-                        int inp_off = ch*jcp.ih*jcp.iw*ch_blk
-                            + ow*stride_w*ch_blk + i*4;
-                        Vmm vmm_src = get_src_reg(0);
-                        uni_vmovups(vmm_src, ptr[aux1_reg_input
-                            + inp_off*sizeof(float)]);
-
-                        Vmm vmm_acc = get_acc_reg(i*ur_ch_blocks*ur_w
-                            + ch*ur_w + ow);
-                        uni_vfmadd231ps(vmm_acc, vmm_src, vmm_ker);
+                    for (int g_ic = 0; g_ic < ch_per_g; g_ic++) {
+                        int ker_off = (ch*ch_per_g + g_ic)
+                            *jcp.kh*jcp.kw*ch_blk + i*4;
+                        Vmm vmm_ker = get_ker_reg(0);
+                        uni_vmovups(vmm_ker, ptr[aux1_reg_kernel
+                            + ker_off*sizeof(float)]);
+
+                        for (int ow = 0; ow < ur_w; ow++) {
+                            int inp_off = ch*jcp.ih*jcp.iw*ch_blk
+                                + ow*stride_w*ch_blk + i*4;
+                            Vmm vmm_src = get_src_reg(0);
+                            load_src_channel(vmm_src, ptr[aux1_reg_input
+                                + inp_off*sizeof(float)], g_ic);
+
+                            Vmm vmm_acc = get_acc_reg(i*ur_ch_blocks*ur_w
+                                + ch*ur_w + ow);
+                            uni_vfmadd231ps(vmm_acc, vmm_src, vmm_ker);
+                        }
                     }
                 }
             }
@@ -126,6 +142,7 @@ template <cpu_isa_t isa>
 void jit_uni_dw_conv_fwd_kernel_f32<isa>::apply_filter_unrolled(
         int ur_ch_blocks, int ur_w) {
     int ch_blk = jcp.ch_block;
+    int ch_per_g = jcp.ic / jcp.ngroups;
     int dilate_h = jcp.dilate_h + 1;
     int dilate_w = jcp.dilate_w + 1;
     int stride_w = jcp.stride_w;
@@ -141,24 +158,28 @@ void jit_uni_dw_conv_fwd_kernel_f32<isa>::apply_filter_unrolled(
         int repeats = isa == sse42 ? 2 : 1;
         for (int i = 0; i < repeats; i++) {
             for (int ch = 0; ch < ur_ch_blocks; ch++) {
-                for (int kw = 0; kw < jcp.kw; kw++) {
-                    int ker_off = ch*jcp.kh*jcp.kw*ch_blk + kw*ch_blk + i*4;
-
-                    Vmm vmm_ker = get_ker_reg(0);
-                    uni_vmovups(vmm_ker, ptr[aux_reg_kernel
-                        + ker_off*sizeof(float)]);
-
-                    for (int ow = 0; ow < ur_w; ow++) {
-                        int inp_off = ch*jcp.ih*jcp.iw*ch_blk
-                            + ow*stride_w*ch_blk + kw*ch_blk*dilate_w + i*4;
-
-                        Vmm vmm_src = get_src_reg(0);
-                        uni_vmovups(vmm_src, ptr[aux_reg_input
-                            + inp_off*sizeof(float)]);
-
-                        Vmm vmm_acc = get_acc_reg(i*ur_ch_blocks*ur_w
-                            + ch*ur_w + ow);
-                        uni_vfmadd231ps(vmm_acc, vmm_src, vmm_ker);
+                for (int g_ic = 0; g_ic < ch_per_g; g_ic++) {
+                    for (int kw = 0; kw < jcp.kw; kw++) {
+                        int ker_off = (ch*ch_per_g + g_ic)
+                            *jcp.kh*jcp.kw*ch_blk + kw*ch_blk + i*4;
+
+                        Vmm vmm_ker = get_ker_reg(0);
+                        uni_vmovups(vmm_ker, ptr[aux_reg_kernel
+                            + ker_off*sizeof(float)]);
+
+                        for (int ow = 0; ow < ur_w; ow++) {
+                            int inp_off = ch*jcp.ih*jcp.iw*ch_blk
+                                + ow*stride_w*ch_blk + kw*ch_blk*dilate_w
+                                + i*4;
+
+                            Vmm vmm_src = get_src_reg(0);
+                            load_src_channel(vmm_src, ptr[aux_reg_input
+                                + inp_off*sizeof(float)], g_ic);
+
+                            Vmm vmm_acc = get_acc_reg(i*ur_ch_blocks*ur_w
+                                + ch*ur_w + ow);
+                            uni_vfmadd231ps(vmm_acc, vmm_src, vmm_ker);
+                        }
                     }
                 }
             }
@@ -397,20 +418,30 @@ status_t jit_uni_dw_conv_fwd_kernel_f32<isa>::init_conf(jit_conv_conf_t &jcp,
         }
     }
 
+    const int simd_w = isa == avx512_common ? 16 : 8;
+
+    /* groups of 4 channels are packed into 128-bit lanes of a vector,
+     * which sse42 cannot do for the memory-based in-lane broadcast */
+    const bool is_small_group = isa != sse42
+        && jcp.oc == 4 * jcp.ngroups
+        && jcp.ic == 4 * jcp.ngroups
+        && jcp.oc % simd_w == 0;
+
     auto desired_act_fmt = isa == avx512_common ? nChw16c : nChw8c;
-    auto desired_wei_fmt = isa == avx512_common ? Goihw16g : Goihw8g;
+    auto desired_wei_fmt = is_small_group
+        ? (isa == avx512_common ? GOihw4g4o : GOihw2g4o)
+        : (isa == avx512_common ? Goihw16g : Goihw8g);
 
     bool args_ok = true
-        && jcp.oc == jcp.ngroups
-        && jcp.ic == jcp.ngroups
+        && utils::implication(!is_small_group, true
+                && jcp.oc == jcp.ngroups
+                && jcp.ic == jcp.ngroups)
         && src_d.format() == desired_act_fmt
         && weights_d.format() == desired_wei_fmt
         && one_of(cd.bias_desc.format, memory_format::undef, any, x)
         && dst_d.format() == desired_act_fmt;
     if (!args_ok) return status::unimplemented;
 
-    const int simd_w = isa == avx512_common ? 16 : 8;
-
     jcp.ur_w = isa == avx512_common ? 6 : isa == avx2 ? 4 : 3;
 
     jcp.ch_block = simd_w;
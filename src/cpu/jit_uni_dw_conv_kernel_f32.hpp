@@ -75,6 +75,8 @@ private:
     inline Vmm get_acc_reg(int idx) { return Vmm(idx + 4); }
 
     inline void load_src(int ur_ch_blocks, int ur_w);
+    inline void load_src_channel(Vmm vmm_src, const Xbyak::Address &op,
+            int g_ic);
     inline void apply_filter(int ur_ch_blocks, int ur_w);
     inline void apply_filter_unrolled(int ur_ch_blocks, int ur_w);
     inline void apply_activation(int ur_ch_blocks, int ur_w);
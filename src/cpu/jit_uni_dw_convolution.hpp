@@ -70,8 +70,14 @@ struct _jit_uni_dw_convolution_fwd_t: public cpu_primitive_t {
     protected:
         virtual status_t set_default_params() override {
             using namespace memory_format;
+            const auto &w_dims = this->cdesc_().weights_desc.dims;
+            const bool is_small_group = isa != sse42 && this->with_groups()
+                && w_dims[1] == 4 && w_dims[2] == 4;
+
             auto desired_act_fmt = isa == avx512_common ? nChw16c : nChw8c;
-            auto desired_wei_fmt = isa == avx512_common ? Goihw16g : Goihw8g;
+            auto desired_wei_fmt = is_small_group
+                ? (isa == avx512_common ? GOihw4g4o : GOihw2g4o)
+                : (isa == avx512_common ? Goihw16g : Goihw8g);
 
             if (this->src_pd_.desc()->format == any)
                 CHECK(this->src_pd_.set_format(desired_act_fmt));
@@ -20,6 +20,7 @@
 #include "nstl.hpp"
 #include "utils.hpp"
 #include "jit_generator.hpp"
+#include "jit_uni_exp_injector.hpp"
 
 #include "jit_uni_eltwise.hpp"
 
@@ -32,9 +33,9 @@ namespace cpu {
 using namespace Xbyak;
 
 struct jit_args {
-    const float *from;
-    const float *for_comparison;
-    const float *to;
+    const void *from;
+    const void *for_comparison;
+    const void *to;
     size_t work_amount;
 };
 
@@ -50,6 +51,8 @@ struct jit_uni_eltwise_kernel_f32 : public c_compatible {
 
 protected:
     bool is_bwd() const { return desc_.prop_kind == prop_kind::backward_data; }
+    bool is_bf16() const
+    { return desc_.data_desc.data_type == data_type::bf16; }
 };
 
 /* jit kernels */
@@ -61,19 +64,61 @@ struct jit_uni_relu_kernel_f32 : public jit_uni_eltwise_kernel_f32,
 {
     DECLARE_CPU_JIT_AUX_FUNCTIONS(jit_uni_relu_kernel_f32)
 
-    void compute_step(bool vectorize, const int uf, const int shift) {
-        for (int i = 0; i < uf; i++) {
+    /* bf16 is widened to f32 on load by a 16-bit left shift */
+    void load(bool vectorize, int idx, const Reg64 &base, int offt) {
+        if (is_bf16()) {
             if (vectorize) {
-                uni_vmovups(Vmm(i + 1), ptr[reg_from + i * shift]);
-                if (is_bwd())
-                    uni_vmovups(Vmm(uf + i + 1),
-                                ptr[reg_for_comparison + i * shift]);
+                vpmovzxwd(Vmm(idx), ptr[base + offt]);
+                vpslld(Vmm(idx), Vmm(idx), 16);
             } else {
-                movss(Xmm(i + 1), ptr[reg_from + i * shift]);
-                if (is_bwd())
-                    movss(Xmm(uf + i + 1),
-                          ptr[reg_for_comparison + i * shift]);
+                movzx(reg_bf16_tmp.cvt32(), word[base + offt]);
+                shl(reg_bf16_tmp.cvt32(), 16);
+                movd(Xmm(idx), reg_bf16_tmp.cvt32());
             }
+        } else {
+            if (vectorize)
+                uni_vmovups(Vmm(idx), ptr[base + offt]);
+            else
+                movss(Xmm(idx), ptr[base + offt]);
+        }
+    }
+
+    /* f32 is narrowed to bf16 on store by rounding the lower half to
+     * nearest even: x + 0x7fff + (bit 16 of x), then a 16-bit right shift.
+     * NaN inputs are not special-cased, a bf16 NaN times the slope is still
+     * a NaN with zero lower half. */
+    void store(bool vectorize, const Reg64 &base, int offt, int idx) {
+        if (is_bf16()) {
+            if (vectorize) {
+                vpsrld(vmm_bf16_tmp, Vmm(idx), 16);
+                vpandd(vmm_bf16_tmp, vmm_bf16_tmp, vmm_bf16_one);
+                vpaddd(vmm_bf16_tmp, vmm_bf16_tmp, vmm_bf16_round);
+                vpaddd(vmm_bf16_tmp, vmm_bf16_tmp, Vmm(idx));
+                vpsrld(vmm_bf16_tmp, vmm_bf16_tmp, 16);
+                vpmovdw(ptr[base + offt], vmm_bf16_tmp);
+            } else {
+                movd(reg_bf16_tmp.cvt32(), Xmm(idx));
+                mov(reg_bf16_lsb.cvt32(), reg_bf16_tmp.cvt32());
+                shr(reg_bf16_lsb.cvt32(), 16);
+                and_(reg_bf16_lsb.cvt32(), 1);
+                add(reg_bf16_lsb.cvt32(), 0x7fff);
+                add(reg_bf16_tmp.cvt32(), reg_bf16_lsb.cvt32());
+                shr(reg_bf16_tmp.cvt32(), 16);
+                mov(word[base + offt], reg_bf16_tmp.cvt16());
+            }
+        } else {
+            if (vectorize)
+                uni_vmovups(ptr[base + offt], Vmm(idx));
+            else
+                movss(ptr[base + offt], Xmm(idx));
+        }
+    }
+
+    void compute_step(bool vectorize, const int uf, const int shift) {
+        for (int i = 0; i < uf; i++) {
+            load(vectorize, i + 1, reg_from, i * shift);
+            if (is_bwd())
+                load(vectorize, uf + i + 1, reg_for_comparison, i * shift);
         }
 
         if (isa == sse42) {
@@ -114,26 +159,23 @@ struct jit_uni_relu_kernel_f32 : public jit_uni_eltwise_kernel_f32,
             }
         }
 
-        for (int i = 0; i < uf; i++) {
-            if (vectorize) {
-                uni_vmovups(ptr[reg_to + i * shift], Vmm(2 * uf + i + 1));
-            } else {
-                movss(ptr[reg_to + i * shift], Xmm(2 * uf + i + 1));
-            }
-        }
+        for (int i = 0; i < uf; i++)
+            store(vectorize, reg_to, i * shift, 2 * uf + i + 1);
     }
 
     jit_uni_relu_kernel_f32(const eltwise_desc_t &desc)
         : jit_uni_eltwise_kernel_f32(desc), jit_generator() {
         assert(desc.alg_kind == alg_kind::eltwise_relu);
         assert(isa == sse42 || isa == avx2 || isa == avx512_common);
+        assert(utils::implication(is_bf16(), isa == avx512_common));
 
         Reg64 param = abi_param1;
 
         const int simd_w = cpu_isa_traits<isa>::vlen / sizeof(float);
+        const int typesize = is_bf16() ? sizeof(bfloat16_t) : sizeof(float);
         const int loop_dec[] = {simd_w, 1};
         const int uf[] = {1, 1};
-        const int shift[] = {cpu_isa_traits<isa>::vlen, sizeof(float)};
+        const int shift[] = {simd_w * typesize, typesize};
         const bool loop_vectorize[] = {true, false};
 
         this->preamble();
@@ -150,6 +192,13 @@ struct jit_uni_relu_kernel_f32 : public jit_uni_eltwise_kernel_f32,
 
         uni_vpxor(vmm_zero, vmm_zero, vmm_zero);
 
+        if (is_bf16()) {
+            mov(reg_bf16_tmp.cvt32(), 1);
+            vpbroadcastd(vmm_bf16_one, reg_bf16_tmp.cvt32());
+            mov(reg_bf16_tmp.cvt32(), 0x7fff);
+            vpbroadcastd(vmm_bf16_round, reg_bf16_tmp.cvt32());
+        }
+
         Label loop_label[3];
 
         for (int id = 0; id < 2; id++) {
@@ -191,6 +240,12 @@ private:
 
     Vmm vmm_mask = Vmm(isa == avx512_common ? 28 : 12);
     Opmask k_mask = Opmask(1);
+
+    Reg64 reg_bf16_tmp = r9;
+    Reg64 reg_bf16_lsb = r10;
+    Vmm vmm_bf16_one = Vmm(isa == avx512_common ? 25 : 11);
+    Vmm vmm_bf16_round = Vmm(isa == avx512_common ? 26 : 10);
+    Vmm vmm_bf16_tmp = Vmm(isa == avx512_common ? 27 : 9);
 };
 
 template <cpu_isa_t isa>
@@ -199,7 +254,9 @@ struct jit_uni_kernel_fwd_f32: public jit_uni_eltwise_kernel_f32,
     DECLARE_CPU_JIT_AUX_FUNCTIONS(jit_uni_kernel_fwd_f32)
 
     jit_uni_kernel_fwd_f32(const eltwise_desc_t &desc)
-        : jit_uni_eltwise_kernel_f32(desc), jit_generator() {
+        : jit_uni_eltwise_kernel_f32(desc), jit_generator()
+        , exp_injector(this, vmm_one, Vmm(5), Vmm(6), Vmm(8), vmm_tmp2,
+                imm_addr64, k_mask_tmp) {
         using namespace alg_kind;
 
         assert(is_bwd() == false);
@@ -254,7 +311,7 @@ struct jit_uni_kernel_fwd_f32: public jit_uni_eltwise_kernel_f32,
             prepare_table = &jit_uni_kernel_fwd_f32<isa>::not_prepare_table;
             break;
         case eltwise_soft_relu:
-            prepare_const = &jit_uni_kernel_fwd_f32<isa>::exp_prepare_const;
+            prepare_const = &jit_uni_kernel_fwd_f32<isa>::soft_relu_prepare_const;
             vectorized_body = &jit_uni_kernel_fwd_f32<isa>::soft_relu_vectorized_body;
             reminder_body = &jit_uni_kernel_fwd_f32<isa>::soft_relu_reminder_body;
             prepare_table = &jit_uni_kernel_fwd_f32<isa>::soft_relu_prepare_table;
@@ -368,86 +425,23 @@ private:
 
     Label l_table;
 
+    jit_uni_exp_injector_f32<isa> exp_injector;
+
     void not_prepare_table() {}
 
     void not_prepare_const() {}
 
     void exp_prepare_table() {
-        const unsigned int cvals[] = {
-            0x3f800000, // [0] 1.0f
-            0x3f000000, // [1] 0.5f
-            0x3fb8aa3b, // [2] log2ef = 1.44269502f
-            0x3f317218, // [3] ln2f =   0.69314718f
-            0x0000007f, // [4] 0x7f
-            // exp(x) polynomial
-            0x3f800001, // [5] p0 = 1.0000001f
-            0x3efffe85, // [6] p2 = 0.4999887f
-            0x3e2aaa3e, // [7] p3 = 0.16666505f
-            0x3d2bb1b1, // [8] p4 = 0.041917507f
-            0x3c091ec1, // [9] p5 = 0.008369149f
-            0x42b0c0a5, //[10] max logf = 88.3762589f
-            0xc1766666  //[11] min logf = -14.5f
-        };
-
-        align(64);
-        L(l_table);
-        for (size_t i = 0; i < sizeof(cvals) / sizeof(cvals[0]); ++i) {
-            for (size_t d = 0; d < vlen / sizeof(float); ++d) {
-                dd(cvals[i]);
-            }
-        }
+        exp_injector.prepare_table();
     }
 
     void exp_prepare_const() {
         // required for exp calculation
-        mov(imm_addr64, l_table);
-        uni_vmovups(vmm_one, ptr[imm_addr64 + 0 * vlen]);
+        exp_injector.load_table_addr();
     }
 
     void exp_vectorized() {
-        uni_vminps(vmm_src, vmm_src, ptr[imm_addr64 + 10 * vlen]);
-        uni_vmaxps(vmm_src, vmm_src, ptr[imm_addr64 + 11 * vlen]);
-        uni_vmovups(Vmm(8), vmm_src);
-        // calculate exp(x)
-        // fx = x * log2ef + 0.5
-        uni_vmulps(vmm_src, vmm_src, ptr[imm_addr64 + 2 * vlen]);
-        uni_vaddps(vmm_src, vmm_src, ptr[imm_addr64 + 1 * vlen]);
-
-        // tmp = floorf(fx)
-        if (isa < avx512_common) {
-            uni_vroundps(Vmm(5), vmm_src, _op_floor);
-        } else {
-            vcvtps2dq(Vmm(5) | T_rd_sae, vmm_src);
-            vcvtdq2ps(Vmm(5), Vmm(5));
-
-            vcmpps(k_mask_tmp, Vmm(5), vmm_src, _cmp_nle_us);
-            vmovups(vmm_tmp2 | k_mask_tmp | T_z, zword[imm_addr64 + 0 * vlen]);
-
-            // fx = fx - 1 (if there are fraction bits)
-            uni_vsubps(Vmm(5), Vmm(5), vmm_tmp2);
-        }
-        // keep fx for further computations
-        uni_vmovups(vmm_src, Vmm(5)); //vmm_src = fx
-        // x = x - fx * ln2
-        uni_vfnmadd231ps(Vmm(8), Vmm(5), ptr[imm_addr64 + 3 * vlen]);
-        // y = p5
-        uni_vmovups(vmm_dst, ptr[imm_addr64 + 9 * vlen]);
-        // y = y * x + p4
-        uni_vfmadd213ps(vmm_dst, Vmm(8), ptr[imm_addr64 + 8 * vlen]);
-        // y = y * x + p3
-        uni_vfmadd213ps(vmm_dst, Vmm(8), ptr[imm_addr64 + 7 * vlen]);
-        // y = y * x + p2
-        uni_vfmadd213ps(vmm_dst, Vmm(8), ptr[imm_addr64 + 6 * vlen]);
-        // y = y * x + p1
-        uni_vfmadd213ps(vmm_dst, Vmm(8), vmm_one);
-        // y = y * x + p0
-        uni_vfmadd213ps(vmm_dst, Vmm(8), ptr[imm_addr64 + 5 * vlen]);  //exp(q)
-        // compute 2^n
-        uni_vcvtps2dq(Vmm(6), vmm_src);
-        uni_vpaddd(Vmm(6), Vmm(6), ptr[imm_addr64 + 4 * vlen]);
-        uni_vpslld(Vmm(6), Vmm(6), 23); //Vmm(6) = 2^-fx
-        // y = y * 2^n
-        uni_vmulps(vmm_dst, vmm_dst, Vmm(6));
+        exp_injector.exp_vector(vmm_dst, vmm_src);
     }
 
     void exp_scalar() {
@@ -497,18 +491,8 @@ private:
     void tanh_vectorized_body() {
         uni_vmovups(vmm_src, ptr[reg_from]);
 
-        // compute exp(2x)
-        uni_vaddps(vmm_src, vmm_src, vmm_src);
-        exp_vectorized();
-
-        // dup exp(2x)
-        uni_vmovups(Vmm(14), vmm_dst);
-        // (exp(2x) - 1)
-        uni_vsubps(vmm_dst, vmm_dst, vmm_one);
-        // (exp(2x) + 1)
-        uni_vaddps(Vmm(14), Vmm(14), vmm_one);
         // y = (exp(2x) - 1) / (exp(2x) + 1)
-        uni_vdivps(vmm_dst, vmm_dst, Vmm(14));
+        exp_injector.tanh_vector(vmm_dst, vmm_src);
 
         // store result
         uni_vmovups(ptr[reg_to], vmm_dst);
@@ -541,8 +525,7 @@ private:
         uni_vpxor(vmm_zero, vmm_zero, vmm_zero);
 
         //need for exp calculation
-        mov(imm_addr64, l_table);
-        uni_vmovups(vmm_one, ptr[imm_addr64 + 0 * vlen]);
+        exp_injector.load_table_addr();
     }
 
     void elu_vectorized_body() {
@@ -775,6 +758,11 @@ private:
         movss(ptr[reg_to], xmm_src);
     }
 
+    void soft_relu_prepare_const() {
+        mov(imm_addr64, l_table);
+        uni_vmovups(vmm_one, ptr[imm_addr64 + 0 * vlen]);
+    }
+
     void soft_relu_prepare_table() {
         const unsigned int cvals[] = {
             0x3f800000, // [0] 1.0f
@@ -906,14 +894,8 @@ private:
     void logistic_vectorized_body() {
         uni_vmovups(vmm_src, ptr[reg_from]);
 
-        // compute exp(x)
-        exp_vectorized();
-        // dup exp(x)
-        uni_vmovups(Vmm(14), vmm_dst);
-        // (exp(x) + 1)
-        uni_vaddps(Vmm(14), Vmm(14), vmm_one);
         // y = exp(x) / (exp(x) + 1)
-        uni_vdivps(vmm_dst, vmm_dst, Vmm(14));
+        exp_injector.logistic_vector(vmm_dst, vmm_src);
 
         // store result
         uni_vmovups(ptr[reg_to], vmm_dst);
@@ -937,8 +919,8 @@ private:
 
 } /* namespace */
 
-template <cpu_isa_t isa>
-status_t jit_uni_eltwise_fwd_t<isa>::pd_t::init() {
+template <cpu_isa_t isa, data_type_t d_type>
+status_t jit_uni_eltwise_fwd_t<isa, d_type>::pd_t::init() {
     using namespace alg_kind;
 
     assert(engine()->kind() == engine_kind::cpu);
@@ -951,15 +933,18 @@ status_t jit_uni_eltwise_fwd_t<isa>::pd_t::init() {
                     desc()->alg_kind, eltwise_relu, eltwise_tanh, eltwise_elu,
                     eltwise_square, eltwise_abs, eltwise_sqrt, eltwise_linear,
                     eltwise_bounded_relu, eltwise_soft_relu, eltwise_logistic))
-        && utils::everyone_is(data_type::f32, desc()->data_desc.data_type)
+        && desc()->data_desc.data_type == d_type
+        && utils::implication(d_type == data_type::bf16, true
+                && isa == avx512_common
+                && desc()->alg_kind == eltwise_relu)
         && memory_desc_wrapper(src_pd()).is_dense()
         && attr()->has_default_values();
 
     return ok ? status::success : status::unimplemented;
 }
 
-template <cpu_isa_t isa>
-jit_uni_eltwise_fwd_t<isa>::jit_uni_eltwise_fwd_t(const pd_t *pd,
+template <cpu_isa_t isa, data_type_t d_type>
+jit_uni_eltwise_fwd_t<isa, d_type>::jit_uni_eltwise_fwd_t(const pd_t *pd,
         const input_vector &inputs, const output_vector &outputs)
     : cpu_primitive_t(&conf_, inputs, outputs), conf_(*pd), kernel_(nullptr) {
     const auto &desc = *conf_.desc();
@@ -971,12 +956,12 @@ jit_uni_eltwise_fwd_t<isa>::jit_uni_eltwise_fwd_t(const pd_t *pd,
     }
 }
 
-template <cpu_isa_t isa>
-jit_uni_eltwise_fwd_t<isa>::~jit_uni_eltwise_fwd_t()
+template <cpu_isa_t isa, data_type_t d_type>
+jit_uni_eltwise_fwd_t<isa, d_type>::~jit_uni_eltwise_fwd_t()
 { delete kernel_; }
 
-template <cpu_isa_t isa>
-void jit_uni_eltwise_fwd_t<isa>::execute_forward() {
+template <cpu_isa_t isa, data_type_t d_type>
+void jit_uni_eltwise_fwd_t<isa, d_type>::execute_forward() {
     auto src = reinterpret_cast<const data_t *>(this->input_memory(0));
     auto dst = reinterpret_cast<data_t *>(this->memory(0));
 
@@ -1011,15 +996,17 @@ void jit_uni_eltwise_fwd_t<isa>::execute_forward() {
     }
 }
 
-template <cpu_isa_t isa>
-status_t jit_uni_eltwise_bwd_t<isa>::pd_t::init() {
+template <cpu_isa_t isa, data_type_t d_type>
+status_t jit_uni_eltwise_bwd_t<isa, d_type>::pd_t::init() {
     assert(engine()->kind() == engine_kind::cpu);
 
     bool ok = true
         && mayiuse(isa)
         && desc()->prop_kind == prop_kind::backward_data
         && utils::one_of(desc()->alg_kind, alg_kind::eltwise_relu)
-        && src_pd()->desc()->data_type == data_type::f32
+        && src_pd()->desc()->data_type == d_type
+        && utils::implication(d_type == data_type::bf16,
+                isa == avx512_common)
         && memory_desc_wrapper(src_pd()).is_dense()
         && memory_desc_wrapper(diff_dst_pd()) == memory_desc_wrapper(src_pd())
         && attr()->has_default_values();
@@ -1027,8 +1014,8 @@ status_t jit_uni_eltwise_bwd_t<isa>::pd_t::init() {
     return ok ? status::success : status::unimplemented;
 }
 
-template <cpu_isa_t isa>
-jit_uni_eltwise_bwd_t<isa>::jit_uni_eltwise_bwd_t(const pd_t *pd,
+template <cpu_isa_t isa, data_type_t d_type>
+jit_uni_eltwise_bwd_t<isa, d_type>::jit_uni_eltwise_bwd_t(const pd_t *pd,
         const input_vector &inputs, const output_vector &outputs)
     : cpu_primitive_t(&conf_, inputs, outputs), conf_(*pd), kernel_(nullptr) {
     const auto &desc = *conf_.desc();
@@ -1039,12 +1026,12 @@ jit_uni_eltwise_bwd_t<isa>::jit_uni_eltwise_bwd_t(const pd_t *pd,
     }
 }
 
-template <cpu_isa_t isa>
-jit_uni_eltwise_bwd_t<isa>::~jit_uni_eltwise_bwd_t()
+template <cpu_isa_t isa, data_type_t d_type>
+jit_uni_eltwise_bwd_t<isa, d_type>::~jit_uni_eltwise_bwd_t()
 { delete kernel_; }
 
-template <cpu_isa_t isa>
-void jit_uni_eltwise_bwd_t<isa>::execute_backward() {
+template <cpu_isa_t isa, data_type_t d_type>
+void jit_uni_eltwise_bwd_t<isa, d_type>::execute_backward() {
     auto src = reinterpret_cast<const data_t *>(this->input_memory(0));
     auto diff_dst = reinterpret_cast<const data_t *>(this->input_memory(1));
     auto diff_src = reinterpret_cast<data_t *>(this->memory(0));
@@ -1088,6 +1075,8 @@ template struct jit_uni_eltwise_fwd_t<avx2>;
 template struct jit_uni_eltwise_bwd_t<avx2>;
 template struct jit_uni_eltwise_fwd_t<avx512_common>;
 template struct jit_uni_eltwise_bwd_t<avx512_common>;
+template struct jit_uni_eltwise_fwd_t<avx512_common, data_type::bf16>;
+template struct jit_uni_eltwise_bwd_t<avx512_common, data_type::bf16>;
 
 }
 }
@@ -0,0 +1,160 @@
+/*******************************************************************************
+* Copyright 2018 Intel Corporation
+*
+* Licensed under the Apache License, Version 2.0 (the "License");
+* you may not use this file except in compliance with the License.
+* You may obtain a copy of the License at
+*
+*     http://www.apache.org/licenses/LICENSE-2.0
+*
+* Unless required by applicable law or agreed to in writing, software
+* distributed under the License is distributed on an "AS IS" BASIS,
+* WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+* See the License for the specific language governing permissions and
+* limitations under the License.
+*******************************************************************************/
+
+#ifndef JIT_UNI_EXP_INJECTOR_HPP
+#define JIT_UNI_EXP_INJECTOR_HPP
+
+#include "utils.hpp"
+#include "jit_generator.hpp"
+
+namespace mkldnn {
+namespace impl {
+namespace cpu {
+
+/* vectorized exp, and tanh and logistic computed from it, emitted into the
+ * code of a jit kernel.
+ *
+ * The constants are in a table the kernel emits after its code with
+ * prepare_table(), each of them broadcast to a full vector, and addresses
+ * through p_table once load_table_addr() was called. The vector registers
+ * aux0..aux3 are clobbered by the computations and vmm_one holds 1.f, k_mask
+ * is only used on avx512. */
+template <cpu_isa_t isa>
+struct jit_uni_exp_injector_f32 {
+    typedef typename utils::conditional3<isa == sse42, Xbyak::Xmm,
+            isa == avx2, Xbyak::Ymm, Xbyak::Zmm>::type Vmm;
+
+    jit_uni_exp_injector_f32(jit_generator *host, Vmm vmm_one, Vmm aux0,
+            Vmm aux1, Vmm aux2, Vmm aux3, Xbyak::Reg64 p_table,
+            Xbyak::Opmask k_mask)
+        : h(host), vmm_one(vmm_one), aux0(aux0), aux1(aux1), aux2(aux2)
+        , aux3(aux3), p_table(p_table), k_mask(k_mask) {}
+
+    void load_table_addr() {
+        h->mov(p_table, l_table);
+        h->uni_vmovups(vmm_one, h->ptr[p_table + 0 * vlen]);
+    }
+
+    /* vmm_dst = exp(vmm_src), vmm_src is clobbered */
+    void exp_vector(const Vmm &vmm_dst, const Vmm &vmm_src) {
+        h->uni_vminps(vmm_src, vmm_src, h->ptr[p_table + 10 * vlen]);
+        h->uni_vmaxps(vmm_src, vmm_src, h->ptr[p_table + 11 * vlen]);
+        h->uni_vmovups(aux2, vmm_src);
+        // calculate exp(x)
+        // fx = x * log2ef + 0.5
+        h->uni_vmulps(vmm_src, vmm_src, h->ptr[p_table + 2 * vlen]);
+        h->uni_vaddps(vmm_src, vmm_src, h->ptr[p_table + 1 * vlen]);
+
+        // tmp = floorf(fx)
+        if (isa < avx512_common) {
+            h->uni_vroundps(aux0, vmm_src, _op_floor);
+        } else {
+            h->vcvtps2dq(aux0 | h->T_rd_sae, vmm_src);
+            h->vcvtdq2ps(aux0, aux0);
+
+            h->vcmpps(k_mask, aux0, vmm_src, jit_generator::_cmp_nle_us);
+            h->vmovups(aux3 | k_mask | h->T_z,
+                    h->zword[p_table + 0 * vlen]);
+
+            // fx = fx - 1 (if there are fraction bits)
+            h->uni_vsubps(aux0, aux0, aux3);
+        }
+        // keep fx for further computations
+        h->uni_vmovups(vmm_src, aux0); // vmm_src = fx
+        // x = x - fx * ln2
+        h->uni_vfnmadd231ps(aux2, aux0, h->ptr[p_table + 3 * vlen]);
+        // y = p5
+        h->uni_vmovups(vmm_dst, h->ptr[p_table + 9 * vlen]);
+        // y = y * x + p4
+        h->uni_vfmadd213ps(vmm_dst, aux2, h->ptr[p_table + 8 * vlen]);
+        // y = y * x + p3
+        h->uni_vfmadd213ps(vmm_dst, aux2, h->ptr[p_table + 7 * vlen]);
+        // y = y * x + p2
+        h->uni_vfmadd213ps(vmm_dst, aux2, h->ptr[p_table + 6 * vlen]);
+        // y = y * x + p1
+        h->uni_vfmadd213ps(vmm_dst, aux2, vmm_one);
+        // y = y * x + p0
+        h->uni_vfmadd213ps(vmm_dst, aux2, h->ptr[p_table + 5 * vlen]);
+        // compute 2^n
+        h->uni_vcvtps2dq(aux1, vmm_src);
+        h->uni_vpaddd(aux1, aux1, h->ptr[p_table + 4 * vlen]);
+        h->uni_vpslld(aux1, aux1, 23); // aux1 = 2^-fx
+        // y = y * 2^n
+        h->uni_vmulps(vmm_dst, vmm_dst, aux1);
+    }
+
+    /* vmm_dst = tanh(vmm_src) = (exp(2x) - 1) / (exp(2x) + 1) */
+    void tanh_vector(const Vmm &vmm_dst, const Vmm &vmm_src) {
+        h->uni_vaddps(vmm_src, vmm_src, vmm_src);
+        exp_vector(vmm_dst, vmm_src);
+        h->uni_vmovups(aux0, vmm_dst);
+        h->uni_vsubps(vmm_dst, vmm_dst, vmm_one);
+        h->uni_vaddps(aux0, aux0, vmm_one);
+        h->uni_vdivps(vmm_dst, vmm_dst, aux0);
+    }
+
+    /* vmm_dst = logistic(vmm_src) = exp(x) / (exp(x) + 1) */
+    void logistic_vector(const Vmm &vmm_dst, const Vmm &vmm_src) {
+        exp_vector(vmm_dst, vmm_src);
+        h->uni_vmovups(aux0, vmm_dst);
+        h->uni_vaddps(aux0, aux0, vmm_one);
+        h->uni_vdivps(vmm_dst, vmm_dst, aux0);
+    }
+
+    void prepare_table() {
+        const unsigned int cvals[] = {
+            0x3f800000, // [0] 1.0f
+            0x3f000000, // [1] 0.5f
+            0x3fb8aa3b, // [2] log2ef = 1.44269502f
+            0x3f317218, // [3] ln2f =   0.69314718f
+            0x0000007f, // [4] 0x7f
+            // exp(x) polynomial
+            0x3f800001, // [5] p0 = 1.0000001f
+            0x3efffe85, // [6] p2 = 0.4999887f
+            0x3e2aaa3e, // [7] p3 = 0.16666505f
+            0x3d2bb1b1, // [8] p4 = 0.041917507f
+            0x3c091ec1, // [9] p5 = 0.008369149f
+            0x42b0c0a5, //[10] max logf = 88.3762589f
+            0xc1766666  //[11] min logf = -14.5f
+        };
+
+        h->align(64);
+        h->L(l_table);
+        for (size_t i = 0; i < sizeof(cvals) / sizeof(cvals[0]); ++i) {
+            for (size_t d = 0; d < vlen / sizeof(float); ++d) {
+                h->dd(cvals[i]);
+            }
+        }
+    }
+
+private:
+    static const int vlen = cpu_isa_traits<isa>::vlen;
+    static const unsigned char _op_floor = 1;
+
+    jit_generator *h;
+    Vmm vmm_one, aux0, aux1, aux2, aux3;
+    Xbyak::Reg64 p_table;
+    Xbyak::Opmask k_mask;
+    Xbyak::Label l_table;
+};
+
+}
+}
+}
+
+#endif
+
+// vim: et ts=4 sw=4 cindent cino^=l0,\:0,N-s
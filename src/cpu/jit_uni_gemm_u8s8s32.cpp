@@ -0,0 +1,370 @@
+/*******************************************************************************
+* Copyright 2018 Intel Corporation
+*
+* Licensed under the Apache License, Version 2.0 (the "License");
+* you may not use this file except in compliance with the License.
+* You may obtain a copy of the License at
+*
+*     http://www.apache.org/licenses/LICENSE-2.0
+*
+* Unless required by applicable law or agreed to in writing, software
+* distributed under the License is distributed on an "AS IS" BASIS,
+* WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+* See the License for the specific language governing permissions and
+* limitations under the License.
+*******************************************************************************/
+
+#include <string.h>
+
+#include "mkldnn_thread.hpp"
+#include "nstl.hpp"
+#include "utils.hpp"
+
+#include "simple_q10n.hpp"
+
+#include "jit_uni_gemm_u8s8s32.hpp"
+
+#define GET_OFF(field) offsetof(ker_params_t, field)
+
+namespace mkldnn {
+namespace impl {
+namespace cpu {
+
+using namespace mkldnn::impl::utils;
+
+using namespace Xbyak;
+
+namespace {
+/* the blocking of the driver: a thread computes mc x nc blocks of C, the
+ * reduction is done by kc steps, so that the packed A block stays in L2 and
+ * the packed B tile (kc x n_unroll) in L1 */
+const int kc_blk = 512;
+const int mc_tiles = 4;
+const int nc_tiles = 16;
+}
+
+/* computes an m_unroll x n_unroll tile of C from the packed A and B:
+ *   a: [k2][m_unroll][2] s16, b: [k2][n_unroll][2] s16 */
+template <cpu_isa_t isa>
+struct jit_uni_gemm_u8s8s32::xbyak_igemm: public jit_generator {
+    DECLARE_CPU_JIT_AUX_FUNCTIONS(jit_uni_gemm_u8s8s32::xbyak_igemm)
+
+    using Vmm = typename utils::conditional<isa == avx2, Ymm, Zmm>::type;
+    static constexpr int vlen = cpu_isa_traits<isa>::vlen;
+    static constexpr int simd_w = vlen / sizeof(int32_t);
+    static constexpr int m_unroll = isa == avx2 ? 16 : 48;
+    static constexpr int n_unroll = isa == avx2 ? 6 : 8;
+    static constexpr int m_vecs = m_unroll / simd_w;
+
+    Reg64 reg_param = abi_param1;
+    Reg64 reg_a = r8;
+    Reg64 reg_b = r9;
+    Reg64 reg_c = r10;
+    Reg64 reg_ldc = r11;
+    Reg64 reg_k = rax;
+    Reg64 reg_accumulate = rdx;
+
+    Vmm vacc(int i, int j) { return Vmm(j * m_vecs + i); }
+    Vmm va(int i) { return Vmm(m_vecs * n_unroll + i); }
+    Vmm vb = Vmm(m_vecs * n_unroll + m_vecs);
+    Vmm vtmp = Vmm(m_vecs * n_unroll + m_vecs + 1);
+
+    void store(bool accumulate) {
+        for (int j = 0; j < n_unroll; ++j) {
+            for (int i = 0; i < m_vecs; ++i) {
+                auto c = ptr[reg_c + i * vlen];
+                if (accumulate)
+                    vpaddd(vacc(i, j), vacc(i, j), c);
+                vmovups(c, vacc(i, j));
+            }
+            add(reg_c, reg_ldc);
+        }
+    }
+
+    xbyak_igemm(bool use_vnni) {
+        assert(m_vecs * n_unroll + m_vecs + 2 <= cpu_isa_traits<isa>::n_vregs);
+
+        preamble();
+
+        mov(reg_a, ptr[reg_param + GET_OFF(a)]);
+        mov(reg_b, ptr[reg_param + GET_OFF(b)]);
+        mov(reg_c, ptr[reg_param + GET_OFF(c)]);
+        mov(reg_ldc, ptr[reg_param + GET_OFF(ldc)]);
+        mov(reg_k, ptr[reg_param + GET_OFF(k2)]);
+        mov(reg_accumulate, ptr[reg_param + GET_OFF(accumulate)]);
+
+        for (int j = 0; j < n_unroll; ++j)
+            for (int i = 0; i < m_vecs; ++i)
+                uni_vpxor(vacc(i, j), vacc(i, j), vacc(i, j));
+
+        Label k_loop, k_loop_end, store_accumulate, end;
+
+        test(reg_k, reg_k);
+        jz(k_loop_end, T_NEAR);
+
+        L(k_loop); {
+            for (int i = 0; i < m_vecs; ++i)
+                vmovups(va(i), ptr[reg_a + i * vlen]);
+            for (int j = 0; j < n_unroll; ++j) {
+                vpbroadcastd(vb, ptr[reg_b + j * 2 * sizeof(int16_t)]);
+                for (int i = 0; i < m_vecs; ++i) {
+                    if (use_vnni) {
+                        vpdpwssd(vacc(i, j), va(i), vb);
+                    } else {
+                        vpmaddwd(vtmp, va(i), vb);
+                        vpaddd(vacc(i, j), vacc(i, j), vtmp);
+                    }
+                }
+            }
+            add(reg_a, m_unroll * 2 * sizeof(int16_t));
+            add(reg_b, n_unroll * 2 * sizeof(int16_t));
+            dec(reg_k);
+            jnz(k_loop, T_NEAR);
+        }
+        L(k_loop_end);
+
+        test(reg_accumulate, reg_accumulate);
+        jnz(store_accumulate, T_NEAR);
+        store(false);
+        jmp(end, T_NEAR);
+        L(store_accumulate);
+        store(true);
+        L(end);
+
+        postamble();
+    }
+};
+
+jit_uni_gemm_u8s8s32::jit_uni_gemm_u8s8s32(char transa, char transb,
+        char offsetc)
+    : transa_(transa), transb_(transb), offsetc_(offsetc)
+    , ker_gen_(nullptr), ker_(nullptr)
+{
+    assert(is_available());
+    if (mayiuse(avx512_core)) {
+        typedef xbyak_igemm<avx512_core> ker_t;
+        m_unroll_ = ker_t::m_unroll;
+        n_unroll_ = ker_t::n_unroll;
+        auto ker = new ker_t(mayiuse(avx512_core_vnni));
+        ker_ = ker->getCode<void (*)(const ker_params_t *)>();
+        ker_gen_ = ker;
+    } else {
+        typedef xbyak_igemm<avx2> ker_t;
+        m_unroll_ = ker_t::m_unroll;
+        n_unroll_ = ker_t::n_unroll;
+        auto ker = new ker_t(false);
+        ker_ = ker->getCode<void (*)(const ker_params_t *)>();
+        ker_gen_ = ker;
+    }
+}
+
+jit_uni_gemm_u8s8s32::~jit_uni_gemm_u8s8s32() {
+    delete ker_gen_;
+}
+
+/* packs the m x k block of A into tiles of m_unroll rows, widening to s16
+ * and padding m to m_unroll and k to 2 with zeros */
+void jit_uni_gemm_u8s8s32::pack_a(int m, int k, const int8_t *a, int lda,
+        int16_t *ws) const {
+    const bool trans = transa_ == 'T' || transa_ == 't';
+    const int k2 = div_up(k, 2);
+    for (int i0 = 0; i0 < m; i0 += m_unroll_) {
+        const int mb = nstl::min(m_unroll_, m - i0);
+        int16_t *w = &ws[(size_t)i0 * k2 * 2];
+        for (int p = 0; p < k2; ++p) {
+            const int kb = nstl::min(2, k - 2 * p);
+            for (int i = 0; i < m_unroll_; ++i)
+            for (int t = 0; t < 2; ++t) {
+                const int kk = 2 * p + t;
+                int16_t v = 0;
+                if (i < mb && t < kb)
+                    v = trans ? a[kk + (size_t)(i0 + i) * lda]
+                        : a[i0 + i + (size_t)kk * lda];
+                w[(p * m_unroll_ + i) * 2 + t] = v;
+            }
+        }
+    }
+}
+
+/* packs the k x n (n <= n_unroll) block of B, widening to s16 and padding
+ * n to n_unroll and k to 2 with zeros */
+void jit_uni_gemm_u8s8s32::pack_b(int k, int n, const uint8_t *b, int ldb,
+        int16_t *ws) const {
+    const bool trans = transb_ == 'T' || transb_ == 't';
+    const int k2 = div_up(k, 2);
+    for (int p = 0; p < k2; ++p) {
+        const int kb = nstl::min(2, k - 2 * p);
+        for (int j = 0; j < n_unroll_; ++j)
+        for (int t = 0; t < 2; ++t) {
+            const int kk = 2 * p + t;
+            int16_t v = 0;
+            if (j < n && t < kb)
+                v = trans ? b[j + (size_t)kk * ldb]
+                    : b[kk + (size_t)j * ldb];
+            ws[(p * n_unroll_ + j) * 2 + t] = v;
+        }
+    }
+}
+
+/* acc (ld = rnd_up(m, m_unroll)) = A * B for an m x n block of C */
+void jit_uni_gemm_u8s8s32::igemm_thr(int m, int n, int k, const int8_t *a,
+        int lda, const uint8_t *b, int ldb, int32_t *acc, int16_t *ws_a,
+        int16_t *ws_b) const {
+    const bool trans_a = transa_ == 'T' || transa_ == 't';
+    const bool trans_b = transb_ == 'T' || transb_ == 't';
+    const int ld_acc = rnd_up(m, m_unroll_);
+
+    if (k == 0) {
+        memset(acc, 0, sizeof(int32_t) * ld_acc * rnd_up(n, n_unroll_));
+        return;
+    }
+
+    for (int k0 = 0; k0 < k; k0 += kc_blk) {
+        const int kb = nstl::min(kc_blk, k - k0);
+        const int k2 = div_up(kb, 2);
+        pack_a(m, kb, &a[trans_a ? k0 : (size_t)k0 * lda], lda, ws_a);
+
+        for (int j0 = 0; j0 < n; j0 += n_unroll_) {
+            pack_b(kb, nstl::min(n_unroll_, n - j0),
+                    &b[trans_b ? (size_t)k0 * ldb + j0
+                        : k0 + (size_t)j0 * ldb], ldb, ws_b);
+
+            for (int i0 = 0; i0 < m; i0 += m_unroll_) {
+                ker_params_t p;
+                p.a = &ws_a[(size_t)i0 * k2 * 2];
+                p.b = ws_b;
+                p.c = &acc[(size_t)j0 * ld_acc + i0];
+                p.ldc = ld_acc * sizeof(int32_t);
+                p.k2 = k2;
+                p.accumulate = k0 > 0;
+                ker_(&p);
+            }
+        }
+    }
+}
+
+void jit_uni_gemm_u8s8s32::igemm(const int *p_m, const int *p_n,
+        const int *p_k, const float *p_alpha, const int8_t *a,
+        const int *p_lda, const int8_t *p_ao, const uint8_t *b,
+        const int *p_ldb, const int8_t *p_bo, const float *p_beta,
+        int32_t *c, const int *p_ldc, const int32_t *co) {
+    const int m = *p_m, n = *p_n, k = *p_k;
+    const int lda = *p_lda, ldb = *p_ldb, ldc = *p_ldc;
+    const float alpha = *p_alpha, beta = *p_beta;
+    const int32_t ao = *p_ao, bo = *p_bo;
+    if (m <= 0 || n <= 0) return;
+
+    const bool trans_a = transa_ == 'T' || transa_ == 't';
+    const bool trans_b = transb_ == 'T' || transb_ == 't';
+
+    /* (A + ao) * (B + bo) = A * B + ao * sum_k B + bo * sum_k A + k ao bo */
+    int32_t *row_sum_a = nullptr, *col_sum_b = nullptr;
+    if (bo != 0) {
+        row_sum_a = (int32_t *)malloc(sizeof(int32_t) * m, 64);
+#       pragma omp parallel for schedule(static)
+        for (int i = 0; i < m; ++i) {
+            int32_t s = 0;
+            for (int kk = 0; kk < k; ++kk)
+                s += trans_a ? a[kk + (size_t)i * lda]
+                    : a[i + (size_t)kk * lda];
+            row_sum_a[i] = s;
+        }
+    }
+    if (ao != 0) {
+        col_sum_b = (int32_t *)malloc(sizeof(int32_t) * n, 64);
+#       pragma omp parallel for schedule(static)
+        for (int j = 0; j < n; ++j) {
+            int32_t s = 0;
+            for (int kk = 0; kk < k; ++kk)
+                s += trans_b ? b[j + (size_t)kk * ldb]
+                    : b[kk + (size_t)j * ldb];
+            col_sum_b[j] = s;
+        }
+    }
+    const int32_t off_k = ao * bo * k;
+
+    const bool int_alpha_beta = alpha == 1.f && one_of(beta, 0.f, 1.f);
+    const round_mode_t rmode = round_mode::nearest;
+
+    /* make the blocks smaller if there are not enough of them for all the
+     * threads */
+    const int nthr_max = omp_in_parallel() ? 1 : omp_get_max_threads();
+    int mc = m_unroll_ * mc_tiles, nc = n_unroll_ * nc_tiles;
+    if (div_up(m, mc) * div_up(n, nc) < nthr_max) {
+        const int nbm = div_up(m, mc);
+        nc = nstl::min(nc, rnd_up(div_up(n, div_up(nthr_max, nbm)),
+                    n_unroll_));
+        const int nbn = div_up(n, nc);
+        if (nbm * nbn < nthr_max)
+            mc = nstl::min(mc, rnd_up(div_up(m, div_up(nthr_max, nbn)),
+                        m_unroll_));
+    }
+    const int nbm = div_up(m, mc), nbn = div_up(n, nc);
+    const int work_amount = nbm * nbn;
+    const int nthr = nstl::min(nthr_max, work_amount);
+
+#   pragma omp parallel num_threads(nthr)
+    {
+        const int ithr = omp_get_thread_num();
+        const int nthr = omp_get_num_threads();
+
+        int start{0}, end{0};
+        balance211(work_amount, nthr, ithr, start, end);
+
+        int16_t *ws_a = nullptr, *ws_b = nullptr;
+        int32_t *acc = nullptr;
+        if (start < end) {
+            ws_a = (int16_t *)malloc(sizeof(int16_t) * mc
+                    * rnd_up(nstl::min(k, kc_blk), 2), 64);
+            ws_b = (int16_t *)malloc(sizeof(int16_t) * n_unroll_
+                    * rnd_up(nstl::min(k, kc_blk), 2), 64);
+            acc = (int32_t *)malloc(sizeof(int32_t) * mc * nc, 64);
+        }
+
+        for (int iwork = start; iwork < end; ++iwork) {
+            const int i0 = (iwork % nbm) * mc, j0 = (iwork / nbm) * nc;
+            const int mb = nstl::min(mc, m - i0), nb = nstl::min(nc, n - j0);
+
+            igemm_thr(mb, nb, k,
+                    &a[trans_a ? (size_t)i0 * lda : i0], lda,
+                    &b[trans_b ? j0 : (size_t)j0 * ldb], ldb,
+                    acc, ws_a, ws_b);
+
+            const int ld_acc = rnd_up(mb, m_unroll_);
+            for (int j = 0; j < nb; ++j) {
+                const int32_t *acc_j = &acc[(size_t)j * ld_acc];
+                int32_t *c_j = &c[(size_t)(j0 + j) * ldc + i0];
+                const int32_t off_j = off_k
+                    + (ao != 0 ? ao * col_sum_b[j0 + j] : 0);
+                for (int i = 0; i < mb; ++i) {
+                    int32_t v = acc_j[i] + off_j;
+                    if (bo != 0) v += bo * row_sum_a[i0 + i];
+
+                    if (int_alpha_beta)
+                        v += beta == 0.f ? 0 : c_j[i];
+                    else
+                        v = round_and_saturate<int32_t>(alpha * v
+                                + (beta == 0.f ? 0.f : beta * c_j[i]), rmode);
+
+                    switch (offsetc_) {
+                    case 'F': case 'f': v += co[0]; break;
+                    case 'C': case 'c': v += co[i0 + i]; break;
+                    case 'R': case 'r': v += co[j0 + j]; break;
+                    }
+                    c_j[i] = v;
+                }
+            }
+        }
+
+        free(ws_a);
+        free(ws_b);
+        free(acc);
+    }
+
+    free(row_sum_a);
+    free(col_sum_b);
+}
+
+}
+}
+}
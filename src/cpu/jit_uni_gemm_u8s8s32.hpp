@@ -0,0 +1,78 @@
+/*******************************************************************************
+* Copyright 2018 Intel Corporation
+*
+* Licensed under the Apache License, Version 2.0 (the "License");
+* you may not use this file except in compliance with the License.
+* You may obtain a copy of the License at
+*
+*     http://www.apache.org/licenses/LICENSE-2.0
+*
+* Unless required by applicable law or agreed to in writing, software
+* distributed under the License is distributed on an "AS IS" BASIS,
+* WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+* See the License for the specific language governing permissions and
+* limitations under the License.
+*******************************************************************************/
+
+#ifndef JIT_UNI_GEMM_U8S8S32_HPP
+#define JIT_UNI_GEMM_U8S8S32_HPP
+
+#include <stdint.h>
+
+#include "c_types_map.hpp"
+#include "jit_generator.hpp"
+
+namespace mkldnn {
+namespace impl {
+namespace cpu {
+
+/* Integer gemm with the semantics of cblas_gemm_s8u8s32 (column major):
+ *     C := alpha * (op(A) + ao) * (op(B) + bo) + beta * C + co
+ * where A is s8, B is u8 and C is s32. offsetc is 'F' (co[0] is added to all
+ * the elements of C), 'C' (co[i] is added to the row i, i.e. to every
+ * column) or 'R' (co[j] is added to the column j, i.e. to every row).
+ *
+ * The operands are widened to s16 while being packed and multiplied with
+ * vpmaddwd (vpdpwssd on avx512_core_vnni), so unlike vpmaddubsw the result
+ * does not saturate. Available on avx2 and avx512_core. */
+class jit_uni_gemm_u8s8s32 {
+public:
+    void igemm(const int *M, const int *N, const int *K, const float *alpha,
+            const int8_t *A, const int *lda, const int8_t *ao,
+            const uint8_t *B, const int *ldb, const int8_t *bo,
+            const float *beta, int32_t *C, const int *ldc,
+            const int32_t *co);
+
+    jit_uni_gemm_u8s8s32(char transa, char transb, char offsetc);
+    ~jit_uni_gemm_u8s8s32();
+
+    static bool is_available() { return mayiuse(avx2); }
+
+private:
+    struct ker_params_t {
+        const int16_t *a; /* m_unroll x k2 x 2 */
+        const int16_t *b; /* k2 x n_unroll x 2 */
+        int32_t *c; /* m_unroll x n_unroll tile with the leading dim ldc */
+        size_t ldc; /* in bytes */
+        size_t k2; /* number of the k pairs */
+        size_t accumulate; /* add to c instead of overwriting it */
+    };
+    template <cpu_isa_t isa> struct xbyak_igemm;
+
+    void pack_a(int m, int k, const int8_t *a, int lda, int16_t *ws) const;
+    void pack_b(int k, int n, const uint8_t *b, int ldb, int16_t *ws) const;
+    void igemm_thr(int m, int n, int k, const int8_t *a, int lda,
+            const uint8_t *b, int ldb, int32_t *acc, int16_t *ws_a,
+            int16_t *ws_b) const;
+
+    char transa_, transb_, offsetc_;
+    int m_unroll_, n_unroll_;
+    jit_generator *ker_gen_;
+    void (*ker_)(const ker_params_t *);
+};
+
+}
+}
+}
+
+#endif
@@ -20,6 +20,8 @@
 
 #include "jit_avx2_gemm_f32.hpp"
 #include "jit_avx512_common_gemm_f32.hpp"
+#include "jit_small_gemm_f32.hpp"
+#include "jit_sse42_gemm_f32.hpp"
 #include "jit_uni_inner_product.hpp"
 
 namespace mkldnn {
@@ -36,14 +38,23 @@ template <cpu_isa_t isa>
 jit_uni_inner_product_fwd_t<isa>::jit_uni_inner_product_fwd_t(const pd_t *pd,
         const input_vector &inputs, const output_vector &outputs)
     : cpu_primitive_t(&conf_, inputs, outputs), conf_(*pd)
+    , small_sgemm_(nullptr)
 {
     sgemm_ = new jit_uni_gemm_f32('T', 'N', 0.0, conf_.with_bias());
+
+    const int MB = conf_.MB();
+    const int OC = conf_.OC();
+    const int IC = conf_.IC_total();
+    if (jit_small_gemm_f32::is_applicable('T', 'N', OC, MB, IC, IC, IC, OC))
+        small_sgemm_ = new jit_small_gemm_f32('T', 'N', OC, MB, IC, IC, IC,
+                OC, 0.0, conf_.with_bias());
 }
 
 template <cpu_isa_t isa>
 jit_uni_inner_product_fwd_t<isa>::~jit_uni_inner_product_fwd_t()
 {
     delete sgemm_;
+    delete small_sgemm_;
 }
 
 template <cpu_isa_t isa>
@@ -59,23 +70,182 @@ void jit_uni_inner_product_fwd_t<isa>::execute_forward()
     int OC = conf_.OC();
     int IC = conf_.IC_total();
 
+    if (small_sgemm_) {
+        small_sgemm_->sgemm(weights, src, dst, bias);
+        return;
+    }
+
     float alpha = 1.0, beta = 0.0;
     sgemm_->sgemm("T", "N", &OC, &MB, &IC, &alpha, weights, &IC, src, &IC, &beta,
             dst, &OC, bias);
 }
 
+namespace {
+void cvt_bf16_to_f32(float *out, const bfloat16_t *inp, size_t nelems) {
+#   pragma omp simd
+    for (size_t i = 0; i < nelems; ++i)
+        out[i] = inp[i];
+}
+
+/* output channels whose widened weights take half of L2, the rest is for
+ * the src and dst tiles of the sgemm; at least a vector of channels and no
+ * fewer blocks than threads */
+int widened_oc_block(int OC, int IC, int nthr, int simd_w) {
+    const size_t L2_size = get_cache_size(2, true);
+    int oc_block = utils::rnd_dn((int)(L2_size / 2 / (sizeof(float) * IC)),
+            simd_w);
+    oc_block = nstl::max(simd_w, nstl::min(oc_block,
+                utils::rnd_up(utils::div_up(OC, nthr), simd_w)));
+    return nstl::min(oc_block, OC);
+}
+}
+
+jit_avx512_common_inner_product_bf16_fwd_t::
+jit_avx512_common_inner_product_bf16_fwd_t(const pd_t *pd,
+        const input_vector &inputs, const output_vector &outputs)
+    : cpu_primitive_t(&conf_, inputs, outputs), conf_(*pd)
+    , oc_block_(0), src_f32_(nullptr), wei_f32_(nullptr)
+{
+    sgemm_ = new jit_avx512_common_gemm_f32('T', 'N', 0.0, conf_.with_bias());
+
+    const int MB = conf_.MB();
+    const int OC = conf_.OC();
+    const int IC = conf_.IC_total();
+    const int nthr = omp_get_max_threads();
+
+    oc_block_ = widened_oc_block(OC, IC, nthr, 16);
+
+    src_f32_ = (float *)malloc(sizeof(float) * MB * IC, 64);
+    wei_f32_ = (float *)malloc(sizeof(float) * nthr * oc_block_ * IC, 64);
+}
+
+jit_avx512_common_inner_product_bf16_fwd_t::
+~jit_avx512_common_inner_product_bf16_fwd_t()
+{
+    delete sgemm_;
+    free(src_f32_);
+    free(wei_f32_);
+}
+
+void jit_avx512_common_inner_product_bf16_fwd_t::execute_forward()
+{
+    auto src = reinterpret_cast<const src_data_t *>(this->input_memory(0));
+    auto weights = reinterpret_cast<const wei_data_t *>(this->input_memory(1));
+    auto bias = reinterpret_cast<const dst_data_t *>(this->input_memory(2));
+    auto dst = reinterpret_cast<dst_data_t *>(this->memory());
+
+    const int MB = conf_.MB();
+    const int OC = conf_.OC();
+    const int IC = conf_.IC_total();
+    const int nb_oc = utils::div_up(OC, oc_block_);
+
+#   pragma omp parallel
+    {
+        const int ithr = omp_get_thread_num();
+        const int nthr = omp_get_num_threads();
+
+        size_t start{0}, end{0};
+        balance211((size_t)MB * IC, nthr, ithr, start, end);
+        cvt_bf16_to_f32(&src_f32_[start], &src[start], end - start);
+#       pragma omp barrier
+
+        int ocb_start{0}, ocb_end{0};
+        balance211(nb_oc, nthr, ithr, ocb_start, ocb_end);
+        float *wei = &wei_f32_[(size_t)ithr * oc_block_ * IC];
+        for (int ocb = ocb_start; ocb < ocb_end; ++ocb) {
+            const int oc = ocb * oc_block_;
+            int cur_oc = nstl::min(oc_block_, OC - oc);
+            cvt_bf16_to_f32(wei, &weights[(size_t)oc * IC],
+                    (size_t)cur_oc * IC);
+
+            float alpha = 1.0, beta = 0.0;
+            sgemm_->sgemm("T", "N", &cur_oc, &MB, &IC, &alpha, wei, &IC,
+                    src_f32_, &IC, &beta, &dst[oc], &OC,
+                    bias ? &bias[oc] : nullptr);
+        }
+    }
+}
+
+template <cpu_isa_t isa>
+jit_uni_inner_product_f16_fwd_t<isa>::jit_uni_inner_product_f16_fwd_t(
+        const pd_t *pd, const input_vector &inputs,
+        const output_vector &outputs)
+    : cpu_primitive_t(&conf_, inputs, outputs), conf_(*pd)
+    , oc_block_(0), wei_f32_(nullptr)
+{
+    sgemm_ = new jit_uni_gemm_f32('T', 'N', 0.0, conf_.with_bias());
+    cvt_ = new jit_avx2_cvt_f16_to_f32();
+
+    const int IC = conf_.IC_total();
+    const int nthr = omp_get_max_threads();
+    oc_block_ = widened_oc_block(conf_.OC(), IC, nthr,
+            cpu_isa_traits<isa>::vlen / sizeof(float));
+    wei_f32_ = (float *)malloc(sizeof(float) * nthr * oc_block_ * IC, 64);
+}
+
+template <cpu_isa_t isa>
+jit_uni_inner_product_f16_fwd_t<isa>::~jit_uni_inner_product_f16_fwd_t()
+{
+    delete sgemm_;
+    delete cvt_;
+    free(wei_f32_);
+}
+
+template <cpu_isa_t isa>
+void jit_uni_inner_product_f16_fwd_t<isa>::execute_forward()
+{
+    auto src = reinterpret_cast<const data_t *>(this->input_memory(0));
+    auto weights = reinterpret_cast<const wei_data_t *>(this->input_memory(1));
+    auto bias = reinterpret_cast<const data_t *>(this->input_memory(2));
+    auto dst = reinterpret_cast<data_t *>(this->memory());
+
+    const int MB = conf_.MB();
+    const int OC = conf_.OC();
+    const int IC = conf_.IC_total();
+    const int nb_oc = utils::div_up(OC, oc_block_);
+
+#   pragma omp parallel
+    {
+        const int ithr = omp_get_thread_num();
+        const int nthr = omp_get_num_threads();
+
+        int ocb_start{0}, ocb_end{0};
+        balance211(nb_oc, nthr, ithr, ocb_start, ocb_end);
+        float *wei = &wei_f32_[(size_t)ithr * oc_block_ * IC];
+        for (int ocb = ocb_start; ocb < ocb_end; ++ocb) {
+            const int oc = ocb * oc_block_;
+            int cur_oc = nstl::min(oc_block_, OC - oc);
+            (*cvt_)(wei, &weights[(size_t)oc * IC], (size_t)cur_oc * IC);
+
+            float alpha = 1.0, beta = 0.0;
+            sgemm_->sgemm("T", "N", &cur_oc, &MB, &IC, &alpha, wei, &IC,
+                    src, &IC, &beta, &dst[oc], &OC,
+                    bias ? &bias[oc] : nullptr);
+        }
+    }
+}
+
 template <cpu_isa_t isa>
 jit_uni_inner_product_bwd_weights_t<isa>::jit_uni_inner_product_bwd_weights_t(const pd_t *pd,
         const input_vector &inputs, const output_vector &outputs)
     : cpu_primitive_t(&conf_, inputs, outputs), conf_(*pd)
+    , small_sgemm_(nullptr)
 {
     sgemm_ = new jit_uni_gemm_f32('N', 'T', 0.0, false);
+
+    const int MB = conf_.MB();
+    const int OC = conf_.OC();
+    const int IC = conf_.IC_total();
+    if (jit_small_gemm_f32::is_applicable('N', 'T', IC, OC, MB, IC, OC, IC))
+        small_sgemm_ = new jit_small_gemm_f32('N', 'T', IC, OC, MB, IC, OC,
+                IC, 0.0);
 }
 
 template <cpu_isa_t isa>
 jit_uni_inner_product_bwd_weights_t<isa>::~jit_uni_inner_product_bwd_weights_t()
 {
     delete sgemm_;
+    delete small_sgemm_;
 }
 
 template <cpu_isa_t isa>
@@ -97,8 +267,11 @@ void jit_uni_inner_product_bwd_weights_t<isa>::execute_backward_weights()
     int IC = conf_.IC_total();
 
     float alpha = 1.0, beta = 0.0;
-    sgemm_->sgemm("N", "T", &IC, &OC, &MB, &alpha, src, &IC, diff_dst, &OC, &beta,
-            diff_weights, &IC, nullptr);
+    if (small_sgemm_)
+        small_sgemm_->sgemm(src, diff_dst, diff_weights);
+    else
+        sgemm_->sgemm("N", "T", &IC, &OC, &MB, &alpha, src, &IC, diff_dst,
+                &OC, &beta, diff_weights, &IC, nullptr);
 
     if (diff_bias) {
         diff_bias += diff_bias_d.blocking_desc().offset_padding;
@@ -143,14 +316,23 @@ template <cpu_isa_t isa>
 jit_uni_inner_product_bwd_data_t<isa>::jit_uni_inner_product_bwd_data_t(const pd_t *pd,
         const input_vector &inputs, const output_vector &outputs)
     : cpu_primitive_t(&conf_, inputs, outputs), conf_(*pd)
+    , small_sgemm_(nullptr)
 {
     sgemm_ = new jit_uni_gemm_f32('N', 'N', 0.0, false);
+
+    const int MB = conf_.MB();
+    const int OC = conf_.OC();
+    const int IC = conf_.IC_total();
+    if (jit_small_gemm_f32::is_applicable('N', 'N', IC, MB, OC, IC, OC, IC))
+        small_sgemm_ = new jit_small_gemm_f32('N', 'N', IC, MB, OC, IC, OC,
+                IC, 0.0);
 }
 
 template <cpu_isa_t isa>
 jit_uni_inner_product_bwd_data_t<isa>::~jit_uni_inner_product_bwd_data_t()
 {
     delete sgemm_;
+    delete small_sgemm_;
 }
 
 template <cpu_isa_t isa>
@@ -165,6 +347,11 @@ void jit_uni_inner_product_bwd_data_t<isa>::execute_backward_data()
     int OC = conf_.OC();
     int IC = conf_.IC_total();
 
+    if (small_sgemm_) {
+        small_sgemm_->sgemm(weights, diff_dst, diff_src);
+        return;
+    }
+
     float alpha = 1.0, beta = 0.0;
 
     sgemm_->sgemm("N", "N", &IC, &MB, &OC, &alpha, weights, &IC, diff_dst, &OC, &beta,
@@ -174,9 +361,14 @@ void jit_uni_inner_product_bwd_data_t<isa>::execute_backward_data()
 template struct jit_uni_inner_product_bwd_data_t<avx512_common>;
 template struct jit_uni_inner_product_bwd_weights_t<avx512_common>;
 template struct jit_uni_inner_product_fwd_t<avx512_common>;
+template struct jit_uni_inner_product_f16_fwd_t<avx512_common>;
 template struct jit_uni_inner_product_bwd_data_t<avx2>;
 template struct jit_uni_inner_product_bwd_weights_t<avx2>;
 template struct jit_uni_inner_product_fwd_t<avx2>;
+template struct jit_uni_inner_product_f16_fwd_t<avx2>;
+template struct jit_uni_inner_product_bwd_data_t<sse42>;
+template struct jit_uni_inner_product_bwd_weights_t<sse42>;
+template struct jit_uni_inner_product_fwd_t<sse42>;
 
 }
 }
@@ -22,8 +22,11 @@
 #include "c_types_map.hpp"
 #include "cpu_engine.hpp"
 #include "cpu_inner_product_pd.hpp"
+#include "jit_avx2_cvt_f16.hpp"
 #include "jit_avx2_gemm_f32.hpp"
 #include "jit_avx512_common_gemm_f32.hpp"
+#include "jit_small_gemm_f32.hpp"
+#include "jit_sse42_gemm_f32.hpp"
 #include "type_helpers.hpp"
 #include "utils.hpp"
 
@@ -52,12 +55,12 @@ struct jit_uni_inner_product_fwd_t : public cpu_primitive_t {
             using namespace utils;
 
             assert(engine()->kind() == engine_kind::cpu);
-            auto desired_data_fmt = isa == avx2
-                ? memory_format::nChw8c
-                : memory_format::nChw16c;
-            auto desired_weight_fmt = isa == avx2
-                ? memory_format::oIhw8i
-                : memory_format::oIhw16i;
+            auto desired_data_fmt = isa == avx512_common
+                ? memory_format::nChw16c
+                : memory_format::nChw8c;
+            auto desired_weight_fmt = isa == avx512_common
+                ? memory_format::oIhw16i
+                : memory_format::oIhw8i;
             bool ok = true
                     && mayiuse(isa)
                     && this->set_default_params() == status::success
@@ -100,9 +103,176 @@ struct jit_uni_inner_product_fwd_t : public cpu_primitive_t {
 private:
     void execute_forward();
     pd_t conf_;
-    using jit_uni_gemm_f32 = typename utils::conditional
-         <isa == avx2, jit_avx2_gemm_f32, jit_avx512_common_gemm_f32>::type;
+    using jit_uni_gemm_f32 = typename utils::conditional3
+         <isa == sse42, jit_sse42_gemm_f32, isa == avx2, jit_avx2_gemm_f32,
+         jit_avx512_common_gemm_f32>::type;
     jit_uni_gemm_f32 *sgemm_;
+    jit_small_gemm_f32 *small_sgemm_; // for the shapes it is applicable to
+};
+
+/* bf16 src and weights with f32 dst and bias. The sgemm works on f32, so
+ * the src is widened once per call and the weights are widened in blocks of
+ * output channels small enough to stay in L2 right before they are used:
+ * every bf16 byte is read from memory once and the f32 copies never leave
+ * the cache. */
+struct jit_avx512_common_inner_product_bf16_fwd_t : public cpu_primitive_t {
+    struct pd_t : public cpu_inner_product_fwd_pd_t {
+        pd_t(engine_t *engine, const inner_product_desc_t *adesc,
+                const primitive_attr_t *attr,
+                const inner_product_fwd_pd_t *hint_fwd_pd)
+            : cpu_inner_product_fwd_pd_t(engine, adesc, attr, hint_fwd_pd)
+        {
+        }
+
+        DECLARE_COMMON_PD_T(
+                JIT_IMPL_NAME_HELPER("gemm_bf16:", avx512_common, ""),
+                jit_avx512_common_inner_product_bf16_fwd_t);
+
+        virtual status_t init() override
+        {
+            using namespace prop_kind;
+            using namespace memory_format;
+            using namespace utils;
+
+            assert(engine()->kind() == engine_kind::cpu);
+            bool ok = true
+                    && mayiuse(avx512_common)
+                    && this->set_default_params() == status::success
+                    && one_of(desc()->prop_kind, forward_training,
+                               forward_inference)
+                    && everyone_is(data_type::bf16, desc()->src_desc.data_type,
+                               desc()->weights_desc.data_type)
+                    && desc()->dst_desc.data_type == data_type::f32
+                    && implication(this->with_bias(),
+                               data_type::f32 == desc()->bias_desc.data_type)
+                    && implication(src_pd_.desc()->format == nChw16c,
+                               weights_pd_.desc()->format == oIhw16i)
+                    && implication(src_pd_.desc()->format == nchw,
+                               weights_pd_.desc()->format == oihw)
+                    && implication(src_pd_.desc()->format == ncdhw,
+                               weights_pd_.desc()->format == oidhw)
+                    && implication(src_pd_.desc()->format == nc,
+                               weights_pd_.desc()->format == oi)
+                    && one_of(src_pd_.desc()->format, nChw16c, nchw, ncdhw,
+                               nc)
+                    && dst_pd_.desc()->format == nc
+                    && memory_desc_wrapper(src_pd()).is_dense()
+                    && memory_desc_wrapper(dst_pd()).is_dense()
+                    && memory_desc_wrapper(weights_pd()).is_dense()
+                    && attr()->has_default_values();
+            return ok ? status::success : status::unimplemented;
+        }
+    };
+
+    jit_avx512_common_inner_product_bf16_fwd_t(const pd_t *pd,
+            const input_vector &inputs, const output_vector &outputs);
+    ~jit_avx512_common_inner_product_bf16_fwd_t();
+
+    typedef typename prec_traits<data_type::bf16>::type src_data_t;
+    typedef typename prec_traits<data_type::bf16>::type wei_data_t;
+    typedef typename prec_traits<data_type::f32>::type dst_data_t;
+
+    virtual void execute(event_t *e)
+    {
+        execute_forward();
+        e->set_state(event_t::ready);
+    }
+
+private:
+    void execute_forward();
+    pd_t conf_;
+    jit_avx512_common_gemm_f32 *sgemm_;
+
+    int oc_block_; // output channels whose f32 weights fit L2
+    float *src_f32_;
+    float *wei_f32_; // oc_block_ x IC per thread
+};
+
+/* f32 src, dst and bias with f16 weights. Only the weights are stored in
+ * f16 to halve the bandwidth of the weights bound (small batch) case: they
+ * are widened with F16C in L2 sized blocks of output channels right before
+ * the f32 sgemm consumes the block, so the computations stay in f32. */
+template <cpu_isa_t isa>
+struct jit_uni_inner_product_f16_fwd_t : public cpu_primitive_t {
+    struct pd_t : public cpu_inner_product_fwd_pd_t {
+        pd_t(engine_t *engine, const inner_product_desc_t *adesc,
+                const primitive_attr_t *attr,
+                const inner_product_fwd_pd_t *hint_fwd_pd)
+            : cpu_inner_product_fwd_pd_t(engine, adesc, attr, hint_fwd_pd)
+        {
+        }
+
+        DECLARE_COMMON_PD_T(
+                JIT_IMPL_NAME_HELPER("gemm_f16:", isa, ""),
+                jit_uni_inner_product_f16_fwd_t<isa>);
+
+        virtual status_t init() override
+        {
+            using namespace prop_kind;
+            using namespace memory_format;
+            using namespace utils;
+
+            assert(engine()->kind() == engine_kind::cpu);
+            auto desired_data_fmt = isa == avx512_common
+                ? memory_format::nChw16c
+                : memory_format::nChw8c;
+            auto desired_weight_fmt = isa == avx512_common
+                ? memory_format::oIhw16i
+                : memory_format::oIhw8i;
+            bool ok = true
+                    && mayiuse(isa)
+                    && jit_avx2_cvt_f16_to_f32::is_applicable()
+                    && this->set_default_params() == status::success
+                    && one_of(desc()->prop_kind, forward_training,
+                               forward_inference)
+                    && everyone_is(data_type::f32, desc()->src_desc.data_type,
+                               desc()->dst_desc.data_type)
+                    && desc()->weights_desc.data_type == data_type::f16
+                    && implication(this->with_bias(),
+                               data_type::f32 == desc()->bias_desc.data_type)
+                    && implication(src_pd_.desc()->format == desired_data_fmt,
+                               weights_pd_.desc()->format == desired_weight_fmt)
+                    && implication(src_pd_.desc()->format == nchw,
+                               weights_pd_.desc()->format == oihw)
+                    && implication(src_pd_.desc()->format == ncdhw,
+                               weights_pd_.desc()->format == oidhw)
+                    && implication(src_pd_.desc()->format == nc,
+                               weights_pd_.desc()->format == oi)
+                    && one_of(src_pd_.desc()->format, desired_data_fmt, nchw,
+                               ncdhw, nc)
+                    && dst_pd_.desc()->format == nc
+                    && memory_desc_wrapper(src_pd()).is_dense()
+                    && memory_desc_wrapper(dst_pd()).is_dense()
+                    && memory_desc_wrapper(weights_pd()).is_dense()
+                    && attr()->has_default_values();
+            return ok ? status::success : status::unimplemented;
+        }
+    };
+
+    jit_uni_inner_product_f16_fwd_t(const pd_t *pd,
+            const input_vector &inputs, const output_vector &outputs);
+    ~jit_uni_inner_product_f16_fwd_t();
+
+    typedef typename prec_traits<data_type::f32>::type data_t;
+    typedef typename prec_traits<data_type::f16>::type wei_data_t;
+
+    virtual void execute(event_t *e)
+    {
+        execute_forward();
+        e->set_state(event_t::ready);
+    }
+
+private:
+    void execute_forward();
+    pd_t conf_;
+    using jit_uni_gemm_f32 = typename utils::conditional3
+         <isa == sse42, jit_sse42_gemm_f32, isa == avx2, jit_avx2_gemm_f32,
+         jit_avx512_common_gemm_f32>::type;
+    jit_uni_gemm_f32 *sgemm_;
+    jit_avx2_cvt_f16_to_f32 *cvt_;
+
+    int oc_block_; // output channels whose f32 weights fit L2
+    float *wei_f32_; // oc_block_ x IC per thread
 };
 
 template <cpu_isa_t isa>
@@ -126,12 +296,12 @@ struct jit_uni_inner_product_bwd_weights_t : public cpu_primitive_t {
             using namespace memory_format;
             using namespace utils;
             assert(engine()->kind() == engine_kind::cpu);
-            auto desired_data_fmt = isa == avx2
-                ? memory_format::nChw8c
-                : memory_format::nChw16c;
-            auto desired_weight_fmt = isa == avx2
-                ? memory_format::oIhw8i
-                : memory_format::oIhw16i;
+            auto desired_data_fmt = isa == avx512_common
+                ? memory_format::nChw16c
+                : memory_format::nChw8c;
+            auto desired_weight_fmt = isa == avx512_common
+                ? memory_format::oIhw16i
+                : memory_format::oIhw8i;
             bool ok = true && mayiuse(isa)
                     && this->set_default_params() == status::success
                     && desc()->prop_kind == backward_weights
@@ -173,9 +343,11 @@ struct jit_uni_inner_product_bwd_weights_t : public cpu_primitive_t {
 private:
     void execute_backward_weights();
     pd_t conf_;
-    using jit_uni_gemm_f32 = typename utils::conditional
-        <isa == avx2, jit_avx2_gemm_f32, jit_avx512_common_gemm_f32>::type;
+    using jit_uni_gemm_f32 = typename utils::conditional3
+        <isa == sse42, jit_sse42_gemm_f32, isa == avx2, jit_avx2_gemm_f32,
+        jit_avx512_common_gemm_f32>::type;
     jit_uni_gemm_f32 *sgemm_;
+    jit_small_gemm_f32 *small_sgemm_;
 };
 
 template <cpu_isa_t isa>
@@ -199,13 +371,13 @@ struct jit_uni_inner_product_bwd_data_t : public cpu_primitive_t {
             using namespace utils;
             assert(engine()->kind() == engine_kind::cpu);
 
-            auto desired_data_fmt = isa == avx2
-                ? memory_format::nChw8c
-                : memory_format::nChw16c;
+            auto desired_data_fmt = isa == avx512_common
+                ? memory_format::nChw16c
+                : memory_format::nChw8c;
 
-            auto desired_weight_fmt = isa == avx2
-                ? memory_format::oIhw8i
-                : memory_format::oIhw16i;
+            auto desired_weight_fmt = isa == avx512_common
+                ? memory_format::oIhw16i
+                : memory_format::oIhw8i;
 
             bool ok = true && mayiuse(isa)
                     && this->set_default_params() == status::success
@@ -247,9 +419,11 @@ struct jit_uni_inner_product_bwd_data_t : public cpu_primitive_t {
 private:
     void execute_backward_data();
     pd_t conf_;
-    using jit_uni_gemm_f32 = typename utils::conditional
-        <isa == avx2, jit_avx2_gemm_f32, jit_avx512_common_gemm_f32>::type;
+    using jit_uni_gemm_f32 = typename utils::conditional3
+        <isa == sse42, jit_sse42_gemm_f32, isa == avx2, jit_avx2_gemm_f32,
+        jit_avx512_common_gemm_f32>::type;
     jit_uni_gemm_f32 *sgemm_;
+    jit_small_gemm_f32 *small_sgemm_;
 };
 }
 }
@@ -0,0 +1,314 @@
+/*******************************************************************************
+* Copyright 2018 Intel Corporation
+*
+* Licensed under the Apache License, Version 2.0 (the "License");
+* you may not use this file except in compliance with the License.
+* You may obtain a copy of the License at
+*
+*     http://www.apache.org/licenses/LICENSE-2.0
+*
+* Unless required by applicable law or agreed to in writing, software
+* distributed under the License is distributed on an "AS IS" BASIS,
+* WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+* See the License for the specific language governing permissions and
+* limitations under the License.
+*******************************************************************************/
+
+#include "mkldnn_types.h"
+#include "nstl.hpp"
+#include "utils.hpp"
+#include "jit_generator.hpp"
+#include "jit_uni_exp_injector.hpp"
+
+#include "jit_uni_rnn_elemwise.hpp"
+
+#define GET_OFF(field) offsetof(jit_rnn_elemwise_call_s, field)
+
+namespace mkldnn {
+namespace impl {
+namespace cpu {
+
+using namespace Xbyak;
+using namespace mkldnn::impl::alg_kind;
+
+namespace {
+
+template <cpu_isa_t isa>
+struct jit_uni_rnn_elemwise_kernel: public jit_uni_rnn_elemwise_kernel_f32,
+    public jit_generator {
+    DECLARE_CPU_JIT_AUX_FUNCTIONS(jit_uni_rnn_elemwise_kernel)
+
+    typedef typename utils::conditional3<isa == sse42, Xmm, isa == avx2,
+            Ymm, Zmm>::type Vmm;
+
+    jit_uni_rnn_elemwise_kernel(alg_kind_t cell_kind,
+            alg_kind_t activation_kind, bool is_fwd, int s_size)
+        : jit_uni_rnn_elemwise_kernel_f32(s_size / simd_w * simd_w)
+        , jit_generator()
+        , cell_kind_(cell_kind), activation_kind_(activation_kind)
+        , gate_off_(s_size * sizeof(float))
+        , exp_injector_(this, vmm_one, Vmm(11), Vmm(12), Vmm(13), Vmm(14),
+                reg_table, Opmask(1)) {
+        assert(len_ > 0);
+        preamble();
+
+        // the pointers the cell uses, all advanced by a vector per step
+        const bool is_lstm = cell_kind == vanilla_lstm;
+        Reg64 regs[9];
+        int n_regs = 0;
+        auto load_ptr = [&](const Reg64 &reg, size_t off) {
+            mov(reg, ptr[abi_param1 + off]);
+            regs[n_regs++] = reg;
+        };
+        load_ptr(reg_gates, GET_OFF(ws_gates));
+        if (is_fwd) {
+            load_ptr(reg_bias, GET_OFF(bias));
+            load_ptr(reg_h, GET_OFF(states_t_l));
+        } else {
+            load_ptr(reg_diff_h_tp1, GET_OFF(diff_states_tp1_l));
+            load_ptr(reg_diff_h_lp1, GET_OFF(diff_states_t_lp1));
+        }
+        if (is_lstm) {
+            load_ptr(reg_c, GET_OFF(c_states_t_l));
+            load_ptr(reg_c_tm1, GET_OFF(c_states_tm1_l));
+            if (!is_fwd) {
+                load_ptr(reg_diff_c_tp1, GET_OFF(diff_c_states_tp1_l));
+                load_ptr(reg_diff_c, GET_OFF(diff_c_states_t_l));
+            }
+        }
+        exp_injector_.load_table_addr();
+        uni_vpxor(vmm_zero, vmm_zero, vmm_zero);
+
+        mov(reg_loop, len_ / simd_w);
+        L("vec_loop");
+        {
+            if (is_lstm) {
+                if (is_fwd)
+                    lstm_fwd_step();
+                else
+                    lstm_bwd_step();
+            } else {
+                if (is_fwd)
+                    rnn_fwd_step();
+                else
+                    rnn_bwd_step();
+            }
+
+            for (int i = 0; i < n_regs; i++)
+                add(regs[i], vlen);
+            dec(reg_loop);
+        }
+        jnz("vec_loop", T_NEAR);
+
+        postamble();
+
+        exp_injector_.prepare_table();
+
+        ker_ = (decltype(ker_))this->getCode();
+    }
+
+    static const int simd_w = cpu_isa_traits<isa>::vlen / sizeof(float);
+
+private:
+    static const int vlen = cpu_isa_traits<isa>::vlen;
+
+    alg_kind_t cell_kind_, activation_kind_;
+    int gate_off_; // the gates of a row are [n_gates][s_size]
+
+    Reg64 reg_gates = rax;
+    Reg64 reg_bias = rbx;
+    Reg64 reg_h = rdx;
+    Reg64 reg_c = rsi;
+    Reg64 reg_c_tm1 = r8;
+    Reg64 reg_diff_h_tp1 = r9;
+    Reg64 reg_diff_c_tp1 = r10;
+    Reg64 reg_diff_h_lp1 = r11;
+    Reg64 reg_diff_c = r12;
+    Reg64 reg_loop = r13;
+    Reg64 reg_table = r14;
+
+    Vmm vmm_zero = Vmm(10);
+    Vmm vmm_one = Vmm(15);
+
+    jit_uni_exp_injector_f32<isa> exp_injector_;
+
+    Address gate(int g) { return ptr[reg_gates + g * gate_off_]; }
+
+    /* the injector clobbers its source, vmm_src is kept */
+    void logistic(const Vmm &vmm_dst, const Vmm &vmm_src) {
+        uni_vmovups(Vmm(0), vmm_src);
+        exp_injector_.logistic_vector(vmm_dst, Vmm(0));
+    }
+    void tanh(const Vmm &vmm_dst, const Vmm &vmm_src) {
+        uni_vmovups(Vmm(0), vmm_src);
+        exp_injector_.tanh_vector(vmm_dst, Vmm(0));
+    }
+
+    /* vmm_dst = 1 - vmm_src */
+    void one_m(const Vmm &vmm_dst, const Vmm &vmm_src) {
+        uni_vmovups(vmm_dst, vmm_one);
+        uni_vsubps(vmm_dst, vmm_dst, vmm_src);
+    }
+
+    void rnn_fwd_step() {
+        uni_vmovups(Vmm(1), gate(0));
+        uni_vmovups(Vmm(2), ptr[reg_bias]);
+        uni_vaddps(Vmm(1), Vmm(1), Vmm(2));
+        if (activation_kind_ == eltwise_relu)
+            uni_vmaxps(Vmm(1), Vmm(1), vmm_zero);
+        else
+            tanh(Vmm(1), Vmm(1));
+        uni_vmovups(gate(0), Vmm(1));
+        uni_vmovups(ptr[reg_h], Vmm(1));
+    }
+
+    void lstm_fwd_step() {
+        // the input, forget and output gates get a logistic, the candidate
+        // state a tanh
+        for (int g = 0; g < 4; g++) {
+            uni_vmovups(Vmm(5), gate(g));
+            uni_vmovups(Vmm(6), ptr[reg_bias + g * gate_off_]);
+            uni_vaddps(Vmm(5), Vmm(5), Vmm(6));
+            if (g < 3)
+                logistic(Vmm(1 + g), Vmm(5));
+            else
+                tanh(Vmm(1 + g), Vmm(5));
+            uni_vmovups(gate(g), Vmm(1 + g));
+        }
+        // c = g0 * c_tm1 + g1 * g3
+        uni_vmovups(Vmm(5), ptr[reg_c_tm1]);
+        uni_vmulps(Vmm(5), Vmm(5), Vmm(1));
+        uni_vmulps(Vmm(2), Vmm(2), Vmm(4));
+        uni_vaddps(Vmm(5), Vmm(5), Vmm(2));
+        uni_vmovups(ptr[reg_c], Vmm(5));
+        // h = g2 * tanh(c)
+        tanh(Vmm(6), Vmm(5));
+        uni_vmulps(Vmm(6), Vmm(6), Vmm(3));
+        uni_vmovups(ptr[reg_h], Vmm(6));
+    }
+
+    void rnn_bwd_step() {
+        uni_vmovups(Vmm(1), ptr[reg_diff_h_lp1]);
+        uni_vmovups(Vmm(2), ptr[reg_diff_h_tp1]);
+        uni_vaddps(Vmm(1), Vmm(1), Vmm(2));
+        uni_vmovups(Vmm(2), gate(0));
+        if (activation_kind_ == eltwise_relu) {
+            // dH where the gate is positive, 0 elsewhere
+            if (isa == avx512_common) {
+                vcmpps(Opmask(2), vmm_zero, Vmm(2), _cmp_lt_os);
+                vmovups(Vmm(3) | Opmask(2) | T_z, Vmm(1));
+            } else {
+                uni_vmovups(Vmm(3), vmm_zero);
+                if (isa == sse42)
+                    cmpps(Xmm(3), Xmm(2), _cmp_lt_os);
+                else
+                    vcmpps(Ymm(3), Ymm(3), Ymm(2), _cmp_lt_os);
+                uni_vandps(Vmm(3), Vmm(3), Vmm(1));
+            }
+        } else {
+            // dH * (1 - tanh(g)^2)
+            tanh(Vmm(4), Vmm(2));
+            uni_vmulps(Vmm(4), Vmm(4), Vmm(4));
+            one_m(Vmm(3), Vmm(4));
+            uni_vmulps(Vmm(3), Vmm(3), Vmm(1));
+        }
+        uni_vmovups(gate(0), Vmm(3));
+    }
+
+    /* vmm_dst = vmm_dd * logistic(vmm_s) * (1 - logistic(vmm_s)) */
+    void logistic_bwd(const Vmm &vmm_dst, const Vmm &vmm_dd,
+            const Vmm &vmm_s) {
+        logistic(vmm_dst, vmm_s);
+        one_m(Vmm(7), vmm_dst);
+        uni_vmulps(vmm_dst, vmm_dst, Vmm(7));
+        uni_vmulps(vmm_dst, vmm_dst, vmm_dd);
+    }
+
+    void lstm_bwd_step() {
+        // Vmm(1) = tanh(Ct)
+        uni_vmovups(Vmm(5), ptr[reg_c]);
+        tanh(Vmm(1), Vmm(5));
+        // Vmm(2) = dHt, from the next iteration and the next layer
+        uni_vmovups(Vmm(2), ptr[reg_diff_h_tp1]);
+        uni_vmovups(Vmm(3), ptr[reg_diff_h_lp1]);
+        uni_vaddps(Vmm(2), Vmm(2), Vmm(3));
+        // Vmm(3) = dCt = dCt+1 + (1 - tanh(Ct)^2) * g2 * dHt
+        uni_vmovups(Vmm(3), Vmm(1));
+        uni_vmulps(Vmm(3), Vmm(3), Vmm(1));
+        one_m(Vmm(4), Vmm(3));
+        uni_vmovups(Vmm(5), gate(2));
+        uni_vmulps(Vmm(4), Vmm(4), Vmm(5));
+        uni_vmulps(Vmm(4), Vmm(4), Vmm(2));
+        uni_vmovups(Vmm(3), ptr[reg_diff_c_tp1]);
+        uni_vaddps(Vmm(3), Vmm(3), Vmm(4));
+
+        // dG2 = logistic_bwd(tanh(Ct) * dHt, g2)
+        uni_vmulps(Vmm(2), Vmm(2), Vmm(1));
+        logistic_bwd(Vmm(6), Vmm(2), Vmm(5));
+        uni_vmovups(gate(2), Vmm(6));
+
+        // dCt-1 = dCt * g0, dG0 = c_tm1 * logistic_bwd(dCt, g0)
+        uni_vmovups(Vmm(5), gate(0));
+        uni_vmovups(Vmm(6), Vmm(3));
+        uni_vmulps(Vmm(6), Vmm(6), Vmm(5));
+        uni_vmovups(ptr[reg_diff_c], Vmm(6));
+        logistic_bwd(Vmm(6), Vmm(3), Vmm(5));
+        uni_vmovups(Vmm(7), ptr[reg_c_tm1]);
+        uni_vmulps(Vmm(6), Vmm(6), Vmm(7));
+        uni_vmovups(gate(0), Vmm(6));
+
+        // dG1 = g3 * logistic_bwd(dCt, g1)
+        uni_vmovups(Vmm(5), gate(1));
+        uni_vmovups(Vmm(4), gate(3));
+        logistic_bwd(Vmm(6), Vmm(3), Vmm(5));
+        uni_vmulps(Vmm(6), Vmm(6), Vmm(4));
+        uni_vmovups(gate(1), Vmm(6));
+
+        // dG3 = g1 * tanh_bwd(dCt, g3) = g1 * dCt * (1 - tanh(g3)^2)
+        tanh(Vmm(6), Vmm(4));
+        uni_vmulps(Vmm(6), Vmm(6), Vmm(6));
+        one_m(Vmm(8), Vmm(6));
+        uni_vmulps(Vmm(8), Vmm(8), Vmm(3));
+        uni_vmulps(Vmm(8), Vmm(8), Vmm(5));
+        uni_vmovups(gate(3), Vmm(8));
+    }
+};
+
+template <cpu_isa_t isa>
+jit_uni_rnn_elemwise_kernel_f32 *create_kernel(alg_kind_t cell_kind,
+        alg_kind_t activation_kind, bool is_fwd, int s_size) {
+    if (s_size < jit_uni_rnn_elemwise_kernel<isa>::simd_w)
+        return nullptr;
+    return new jit_uni_rnn_elemwise_kernel<isa>(cell_kind, activation_kind,
+            is_fwd, s_size);
+}
+
+}
+
+jit_uni_rnn_elemwise_kernel_f32 *jit_uni_rnn_elemwise_kernel_f32::create(
+        alg_kind_t cell_kind, alg_kind_t activation_kind, bool is_fwd,
+        int s_size) {
+    const bool ok = false
+        || cell_kind == vanilla_lstm
+        || (cell_kind == vanilla_rnn
+                && utils::one_of(activation_kind, eltwise_relu, eltwise_tanh));
+    if (!ok)
+        return nullptr;
+
+    if (mayiuse(avx512_common))
+        return create_kernel<avx512_common>(cell_kind, activation_kind,
+                is_fwd, s_size);
+    if (mayiuse(avx2))
+        return create_kernel<avx2>(cell_kind, activation_kind, is_fwd,
+                s_size);
+    if (mayiuse(sse42))
+        return create_kernel<sse42>(cell_kind, activation_kind, is_fwd,
+                s_size);
+    return nullptr;
+}
+
+}
+}
+}
+
+// vim: et ts=4 sw=4 cindent cino^=l0,\:0,N-s
@@ -0,0 +1,72 @@
+/*******************************************************************************
+* Copyright 2018 Intel Corporation
+*
+* Licensed under the Apache License, Version 2.0 (the "License");
+* you may not use this file except in compliance with the License.
+* You may obtain a copy of the License at
+*
+*     http://www.apache.org/licenses/LICENSE-2.0
+*
+* Unless required by applicable law or agreed to in writing, software
+* distributed under the License is distributed on an "AS IS" BASIS,
+* WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+* See the License for the specific language governing permissions and
+* limitations under the License.
+*******************************************************************************/
+
+#ifndef JIT_UNI_RNN_ELEMWISE_HPP
+#define JIT_UNI_RNN_ELEMWISE_HPP
+
+#include "c_types_map.hpp"
+#include "utils.hpp"
+
+namespace mkldnn {
+namespace impl {
+namespace cpu {
+
+/* the pointers to a row of the batch of a cell, the gates are
+ * [n_gates][s_size] and the states [s_size] */
+struct jit_rnn_elemwise_call_s {
+    float *ws_gates;
+    const float *bias;
+    float *states_t_l;
+    float *c_states_t_l;
+    const float *c_states_tm1_l;
+    const float *diff_states_tp1_l;
+    const float *diff_c_states_tp1_l;
+    const float *diff_states_t_lp1;
+    float *diff_c_states_t_l;
+};
+
+/* the elementwise part of a vanilla rnn or lstm cell after its gemms, on a
+ * row of the batch: the bias, the activations of the gates and the update of
+ * the states in forward, the diffs of the gates and of the c state in
+ * backward. It computes the same functions as the reference elemwise of
+ * ref_rnn, the exp based ones approximated as in jit_uni_eltwise.
+ *
+ * The kernel computes the first len() elements of the row, the full vectors,
+ * the caller the remaining ones. */
+struct jit_uni_rnn_elemwise_kernel_f32 : public c_compatible {
+    /* nullptr when no kernel handles the cell or s_size is under a vector */
+    static jit_uni_rnn_elemwise_kernel_f32 *create(alg_kind_t cell_kind,
+            alg_kind_t activation_kind, bool is_fwd, int s_size);
+
+    void operator()(const jit_rnn_elemwise_call_s *p) const { ker_(p); }
+    int len() const { return len_; }
+
+    virtual ~jit_uni_rnn_elemwise_kernel_f32() {}
+
+protected:
+    jit_uni_rnn_elemwise_kernel_f32(int len) : ker_(nullptr), len_(len) {}
+
+    void (*ker_)(const jit_rnn_elemwise_call_s *);
+    int len_;
+};
+
+}
+}
+}
+
+#endif
+
+// vim: et ts=4 sw=4 cindent cino^=l0,\:0,N-s
@@ -0,0 +1,229 @@
+/*******************************************************************************
+* Copyright 2018 Intel Corporation
+*
+* Licensed under the Apache License, Version 2.0 (the "License");
+* you may not use this file except in compliance with the License.
+* You may obtain a copy of the License at
+*
+*     http://www.apache.org/licenses/LICENSE-2.0
+*
+* Unless required by applicable law or agreed to in writing, software
+* distributed under the License is distributed on an "AS IS" BASIS,
+* WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+* See the License for the specific language governing permissions and
+* limitations under the License.
+*******************************************************************************/
+
+#include "c_types_map.hpp"
+#include "nstl.hpp"
+#include "type_helpers.hpp"
+#include "utils.hpp"
+#include "cpu_memory.hpp"
+
+#include "jit_uni_sparse_conv_kernel_f32.hpp"
+
+#define GET_OFF(field) offsetof(jit_sparse_conv_call_s, field)
+
+namespace mkldnn {
+namespace impl {
+namespace cpu {
+
+using namespace mkldnn::impl::prop_kind;
+using namespace mkldnn::impl::memory_format;
+using namespace mkldnn::impl::utils;
+
+using namespace Xbyak;
+
+template <cpu_isa_t isa>
+void jit_uni_sparse_conv_fwd_kernel_f32<isa>::compute(int ur_w) {
+    Label nnz_loop_label;
+    Label store_label;
+
+    const int src_row_stride = jcp.stride_h * jcp.iwp * sizeof(float);
+    const int dst_row_stride = jcp.owp * sizeof(float);
+
+    for (int h = 0; h < jcp.ur_h; h++)
+    for (int i = 0; i < ur_w; i++) {
+        Vmm vmm_acc = get_acc_reg(h * ur_w + i);
+        uni_vpxor(vmm_acc, vmm_acc, vmm_acc);
+    }
+
+    mov(aux_reg_wei_val, reg_wei_val);
+    mov(aux_reg_wei_off, reg_wei_off);
+    mov(reg_nnz_iter, reg_nnz);
+    test(reg_nnz_iter, reg_nnz_iter);
+    je(store_label, T_NEAR);
+
+    L(nnz_loop_label); {
+        movsxd(reg_off, dword[aux_reg_wei_off]);
+        add(reg_off, reg_src);
+        uni_vbroadcastss(vmm_wei, ptr[aux_reg_wei_val]);
+        for (int h = 0; h < jcp.ur_h; h++)
+        for (int i = 0; i < ur_w; i++)
+            uni_vfmadd231ps(get_acc_reg(h * ur_w + i), vmm_wei,
+                    vmmword[reg_off + h * src_row_stride + i * vlen]);
+
+        add(aux_reg_wei_val, sizeof(float));
+        add(aux_reg_wei_off, sizeof(int32_t));
+        dec(reg_nnz_iter);
+        jnz(nnz_loop_label, T_NEAR);
+    }
+
+    L(store_label);
+    for (int h = 0; h < jcp.ur_h; h++)
+    for (int i = 0; i < ur_w; i++)
+        uni_vmovups(vmmword[reg_dst + h * dst_row_stride + i * vlen],
+                get_acc_reg(h * ur_w + i));
+}
+
+template <cpu_isa_t isa>
+void jit_uni_sparse_conv_fwd_kernel_f32<isa>::generate() {
+    this->preamble();
+
+    mov(reg_src, ptr[this->param1 + GET_OFF(src)]);
+    mov(reg_dst, ptr[this->param1 + GET_OFF(dst)]);
+    mov(reg_wei_val, ptr[this->param1 + GET_OFF(wei_val)]);
+    mov(reg_wei_off, ptr[this->param1 + GET_OFF(wei_off)]);
+    mov(reg_nnz, ptr[this->param1 + GET_OFF(nnz)]);
+
+    const int simd_w = vlen / sizeof(float);
+    const int nb_ow = jcp.owp / simd_w / jcp.ur_w;
+
+    if (nb_ow > 0) {
+        Label ow_loop_label;
+        mov(reg_ow_blocks, nb_ow);
+        L(ow_loop_label); {
+            compute(jcp.ur_w);
+            add(reg_src, jcp.ur_w * vlen);
+            add(reg_dst, jcp.ur_w * vlen);
+            dec(reg_ow_blocks);
+            jnz(ow_loop_label, T_NEAR);
+        }
+    }
+
+    if (jcp.ur_w_tail)
+        compute(jcp.ur_w_tail);
+
+    this->postamble();
+}
+
+template <cpu_isa_t isa>
+bool jit_uni_sparse_conv_fwd_kernel_f32<isa>::post_ops_ok(
+        jit_conv_conf_t &jcp, const primitive_attr_t &attr) {
+    const auto &p = attr.post_ops_;
+
+    auto is_relu = [&](int idx) { return p.entry_[idx].is_relu(); };
+    auto is_sum = [&](int idx) { return p.entry_[idx].is_sum(); };
+
+    switch (p.len_) {
+    case 0: return true; // no post_ops
+    case 1: return is_relu(0) || is_sum(0); // sum OR relu
+    case 2: return is_sum(0) && is_relu(1); // sum->relu
+    default: return false;
+    }
+
+    return false;
+}
+
+template <cpu_isa_t isa>
+status_t jit_uni_sparse_conv_fwd_kernel_f32<isa>::init_conf(
+        jit_conv_conf_t &jcp, const convolution_desc_t &cd,
+        const memory_desc_wrapper &src_d, const memory_desc_wrapper &weights_d,
+        const memory_desc_wrapper &dst_d, const primitive_attr_t &attr)
+{
+    if (!mayiuse(isa) || !attr.sparse_weights_) return status::unimplemented;
+
+    jcp.prop_kind = cd.prop_kind;
+
+    const bool with_groups = weights_d.ndims() == src_d.ndims() + 1;
+    if (with_groups || src_d.ndims() != 4) return status::unimplemented;
+
+    jcp.ngroups = 1;
+    jcp.mb = src_d.dims()[0];
+
+    jcp.oc = dst_d.dims()[1];
+    jcp.ic = src_d.dims()[1];
+
+    jcp.ih = src_d.dims()[2];
+    jcp.iw = src_d.dims()[3];
+    jcp.oh = dst_d.dims()[2];
+    jcp.ow = dst_d.dims()[3];
+
+    jcp.kh = weights_d.dims()[2];
+    jcp.kw = weights_d.dims()[3];
+
+    jcp.t_pad = cd.padding[0][0];
+    jcp.l_pad = cd.padding[0][1];
+    jcp.b_pad = cd.padding[1][0];
+    jcp.r_pad = cd.padding[1][1];
+
+    jcp.stride_h = cd.strides[0];
+    jcp.stride_w = cd.strides[1];
+
+    jcp.dilate_h = cd.dilates[0];
+    jcp.dilate_w = cd.dilates[1];
+
+    jcp.src_fmt = src_d.format();
+    jcp.with_bias = cd.bias_desc.format != memory_format::undef;
+
+    if (!post_ops_ok(jcp, attr))
+        return status::unimplemented;
+
+    const auto &p = attr.post_ops_;
+    jcp.with_sum = p.find(primitive_kind::sum) != -1;
+    jcp.with_relu = false;
+    jcp.relu_negative_slope = 0.f;
+    int eltwise_ind = p.find(primitive_kind::eltwise);
+    if (eltwise_ind != -1) {
+        jcp.with_relu = true;
+        jcp.relu_negative_slope = p.entry_[eltwise_ind].eltwise.alpha;
+    }
+
+    /* the output points of a row are contiguous in nchw and so are the input
+     * points they see only for the unit stride along w */
+    bool args_ok = true
+        && src_d.format() == nchw
+        && weights_d.format() == oihw
+        && one_of(cd.bias_desc.format, memory_format::undef, any, x)
+        && dst_d.format() == nchw
+        && jcp.stride_w == 1
+        && jcp.l_pad >= 0 && jcp.t_pad >= 0;
+    if (!args_ok) return status::unimplemented;
+
+    const int simd_w = cpu_isa_traits<isa>::vlen / sizeof(float);
+    const int max_ur = isa == avx512_common ? 28 : 14;
+
+    /* a broadcast weight is reused for ur_h output rows of ur_w vectors
+     * each, so narrow rows are blocked over oh to keep enough independent
+     * accumulators in flight */
+    jcp.owp = rnd_up(jcp.ow, simd_w);
+    const int nb_vec = jcp.owp / simd_w;
+    jcp.ur_w = nstl::min(nb_vec, max_ur);
+    jcp.ur_w_tail = nb_vec % jcp.ur_w;
+    const int max_ur_h = nstl::max(1, max_ur / jcp.ur_w);
+    jcp.ur_h = div_up(jcp.oh, div_up(jcp.oh, max_ur_h));
+    jcp.ohp = rnd_up(jcp.oh, jcp.ur_h);
+
+    /* the input image is zero-padded so that every output vector reads
+     * its input points without masking: the rows are wide enough for the
+     * last (rounded up) output vector and there are enough of them for
+     * the last (rounded up) block of output rows */
+    const int ext_kh = (jcp.kh - 1) * (jcp.dilate_h + 1) + 1;
+    const int ext_kw = (jcp.kw - 1) * (jcp.dilate_w + 1) + 1;
+    jcp.iwp = nstl::max(jcp.owp + ext_kw - 1, jcp.iw + jcp.l_pad);
+    jcp.ihp = nstl::max((jcp.ohp - 1) * jcp.stride_h + ext_kh,
+            jcp.ih + jcp.t_pad);
+
+    /* weights are addressed with 32-bit byte offsets into the image */
+    if ((size_t)jcp.ic * jcp.ihp * jcp.iwp * sizeof(float) >= INT32_MAX)
+        return status::unimplemented;
+
+    return status::success;
+}
+
+template struct jit_uni_sparse_conv_fwd_kernel_f32<avx512_common>;
+template struct jit_uni_sparse_conv_fwd_kernel_f32<avx2>;
+
+}
+}
+}
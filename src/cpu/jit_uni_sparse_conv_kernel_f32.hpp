@@ -0,0 +1,81 @@
+/*******************************************************************************
+* Copyright 2018 Intel Corporation
+*
+* Licensed under the Apache License, Version 2.0 (the "License");
+* you may not use this file except in compliance with the License.
+* You may obtain a copy of the License at
+*
+*     http://www.apache.org/licenses/LICENSE-2.0
+*
+* Unless required by applicable law or agreed to in writing, software
+* distributed under the License is distributed on an "AS IS" BASIS,
+* WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+* See the License for the specific language governing permissions and
+* limitations under the License.
+*******************************************************************************/
+
+#ifndef JIT_UNI_SPARSE_CONV_KERNEL_F32_HPP
+#define JIT_UNI_SPARSE_CONV_KERNEL_F32_HPP
+
+#include "c_types_map.hpp"
+#include "jit_generator.hpp"
+#include "jit_primitive_conf.hpp"
+
+namespace mkldnn {
+namespace impl {
+namespace cpu {
+
+/* Computes ur_h output rows of one output channel as a sum over the nonzero
+ * weights of the channel only. The rows are vectorized over ow: every
+ * nonzero weight is broadcast and multiplied by the ow-contiguous input
+ * points it sees, which start at the precomputed byte offset of the weight
+ * in the zero-padded input image. */
+template <cpu_isa_t isa>
+struct jit_uni_sparse_conv_fwd_kernel_f32: public jit_generator {
+    DECLARE_CPU_JIT_AUX_FUNCTIONS(jit_uni_sparse_conv_fwd_kernel_f32)
+
+    jit_uni_sparse_conv_fwd_kernel_f32(jit_conv_conf_t ajcp): jcp(ajcp) {
+        this->generate();
+        jit_ker = (void (*)(jit_sparse_conv_call_s *))this->getCode();
+    }
+
+    static bool post_ops_ok(jit_conv_conf_t &jcp,
+            const primitive_attr_t &attr);
+    static status_t init_conf(jit_conv_conf_t &jcp,
+            const convolution_desc_t &cd, const memory_desc_wrapper &src_d,
+            const memory_desc_wrapper &weights_d,
+            const memory_desc_wrapper &dst_d, const primitive_attr_t &attr);
+
+    jit_conv_conf_t jcp;
+    void (*jit_ker)(jit_sparse_conv_call_s *);
+
+private:
+    using Vmm = typename utils::conditional<isa == avx2, Xbyak::Ymm,
+        Xbyak::Zmm>::type;
+    using reg64_t = const Xbyak::Reg64;
+    const Xbyak::AddressFrame &vmmword = (isa == avx2) ? yword : zword;
+    const int vlen = cpu_isa_traits<isa>::vlen;
+
+    reg64_t reg_src = r8;
+    reg64_t reg_dst = r9;
+    reg64_t reg_wei_val = r10;
+    reg64_t reg_wei_off = r11;
+    reg64_t reg_nnz = r12;
+    reg64_t aux_reg_wei_val = r13;
+    reg64_t aux_reg_wei_off = r14;
+    reg64_t reg_nnz_iter = r15;
+    reg64_t reg_off = rax;
+    reg64_t reg_ow_blocks = rbx;
+
+    Vmm vmm_wei = Vmm(0);
+    inline Vmm get_acc_reg(int idx) { return Vmm(idx + 1); }
+
+    inline void compute(int ur_w);
+    void generate();
+};
+
+}
+}
+}
+
+#endif
@@ -0,0 +1,180 @@
+/*******************************************************************************
+* Copyright 2018 Intel Corporation
+*
+* Licensed under the Apache License, Version 2.0 (the "License");
+* you may not use this file except in compliance with the License.
+* You may obtain a copy of the License at
+*
+*     http://www.apache.org/licenses/LICENSE-2.0
+*
+* Unless required by applicable law or agreed to in writing, software
+* distributed under the License is distributed on an "AS IS" BASIS,
+* WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+* See the License for the specific language governing permissions and
+* limitations under the License.
+*******************************************************************************/
+
+#include "mkldnn_types.h"
+
+#include "c_types_map.hpp"
+#include "jit_uni_sparse_convolution.hpp"
+#include "mkldnn_thread.hpp"
+
+namespace mkldnn {
+namespace impl {
+namespace cpu {
+
+using namespace mkldnn::impl::status;
+using namespace mkldnn::impl::memory_format;
+using namespace mkldnn::impl::utils;
+
+template <cpu_isa_t isa>
+_jit_uni_sparse_convolution_fwd_t<isa>::_jit_uni_sparse_convolution_fwd_t(
+        const pd_t *pd, const input_vector &inputs,
+        const output_vector &outputs)
+    : cpu_primitive_t(&conf_, inputs, outputs), conf_(*pd)
+    , kernel_(nullptr), src_padded_(nullptr), dst_row_(nullptr)
+    , wei_compressed_(false), wei_row_ptr_(nullptr), wei_off_(nullptr)
+    , wei_val_(nullptr)
+{
+    kernel_ = new jit_uni_sparse_conv_fwd_kernel_f32<isa>(conf_.jcp_);
+
+    const auto &jcp = kernel_->jcp;
+    src_padded_ = (data_t *)malloc(
+            sizeof(data_t) * jcp.ic * jcp.ihp * jcp.iwp, 64);
+    dst_row_ = (data_t *)malloc(sizeof(data_t) * omp_get_max_threads()
+            * jcp.ur_h * jcp.owp, 64);
+}
+
+template <cpu_isa_t isa>
+void _jit_uni_sparse_convolution_fwd_t<isa>::compress_weights() {
+    auto weights = reinterpret_cast<const data_t *>(this->input_memory(1));
+    const memory_desc_wrapper weights_d(conf_.weights_pd(0));
+
+    const auto &jcp = kernel_->jcp;
+    const int dil_h = jcp.dilate_h + 1;
+    const int dil_w = jcp.dilate_w + 1;
+
+    wei_row_ptr_ = (int *)malloc(sizeof(int) * (jcp.oc + 1), 64);
+    wei_row_ptr_[0] = 0;
+    for (int oc = 0; oc < jcp.oc; ++oc) {
+        const data_t *w = &weights[weights_d.blk_off(oc)];
+        int nnz = 0;
+        for (int i = 0; i < jcp.ic * jcp.kh * jcp.kw; ++i)
+            nnz += w[i] != 0;
+        wei_row_ptr_[oc + 1] = wei_row_ptr_[oc] + nnz;
+    }
+
+    const int nnz = nstl::max(wei_row_ptr_[jcp.oc], 1);
+    wei_off_ = (int32_t *)malloc(sizeof(int32_t) * nnz, 64);
+    wei_val_ = (data_t *)malloc(sizeof(data_t) * nnz, 64);
+
+#   pragma omp parallel for schedule(static)
+    for (int oc = 0; oc < jcp.oc; ++oc) {
+        int idx = wei_row_ptr_[oc];
+        for (int ic = 0; ic < jcp.ic; ++ic)
+        for (int kh = 0; kh < jcp.kh; ++kh)
+        for (int kw = 0; kw < jcp.kw; ++kw) {
+            const data_t w = weights[weights_d.blk_off(oc, ic, kh, kw)];
+            if (w == 0) continue;
+            const size_t off = ((size_t)ic * jcp.ihp + kh * dil_h) * jcp.iwp
+                + kw * dil_w;
+            wei_off_[idx] = (int32_t)(off * sizeof(data_t));
+            wei_val_[idx] = w;
+            ++idx;
+        }
+    }
+
+    wei_compressed_ = true;
+}
+
+template <cpu_isa_t isa>
+void _jit_uni_sparse_convolution_fwd_t<isa>::execute_forward() {
+    auto src = reinterpret_cast<const data_t *>(this->input_memory(0));
+    auto bias = reinterpret_cast<const data_t *>(this->input_memory(2));
+    auto dst = reinterpret_cast<data_t *>(this->memory());
+
+    const memory_desc_wrapper src_d(conf_.src_pd());
+    const memory_desc_wrapper dst_d(conf_.dst_pd());
+    const memory_desc_wrapper bias_d(conf_.weights_pd(1));
+
+    const auto &jcp = kernel_->jcp;
+
+    if (!wei_compressed_)
+        compress_weights();
+
+    const int nb_oh = jcp.ohp / jcp.ur_h;
+    const size_t work_amount = (size_t)jcp.oc * nb_oh;
+
+    for (int n = 0; n < jcp.mb; ++n) {
+#       pragma omp parallel for collapse(2) schedule(static)
+        for (int ic = 0; ic < jcp.ic; ++ic)
+        for (int ih_p = 0; ih_p < jcp.ihp; ++ih_p) {
+            data_t *row = &src_padded_[((size_t)ic * jcp.ihp + ih_p)
+                * jcp.iwp];
+            const int ih = ih_p - jcp.t_pad;
+            if (ih < 0 || ih >= jcp.ih) {
+                for (int iw_p = 0; iw_p < jcp.iwp; ++iw_p)
+                    row[iw_p] = 0;
+                continue;
+            }
+
+            const data_t *s = &src[src_d.blk_off(n, ic, ih)];
+            for (int iw_p = 0; iw_p < jcp.l_pad; ++iw_p)
+                row[iw_p] = 0;
+            for (int iw = 0; iw < jcp.iw; ++iw)
+                row[jcp.l_pad + iw] = s[iw];
+            for (int iw_p = jcp.l_pad + jcp.iw; iw_p < jcp.iwp; ++iw_p)
+                row[iw_p] = 0;
+        }
+
+#       pragma omp parallel
+        {
+            const int ithr = omp_get_thread_num();
+            const int nthr = omp_get_num_threads();
+
+            size_t start{0}, end{0};
+            balance211(work_amount, nthr, ithr, start, end);
+
+            int oc{0}, ohb{0};
+            nd_iterator_init(start, oc, jcp.oc, ohb, nb_oh);
+
+            data_t *rows = &dst_row_[(size_t)ithr * jcp.ur_h * jcp.owp];
+            for (size_t iwork = start; iwork < end; ++iwork) {
+                const int oh_s = ohb * jcp.ur_h;
+                jit_sparse_conv_call_s par_conv = {};
+                par_conv.src = &src_padded_[(size_t)oh_s * jcp.stride_h
+                    * jcp.iwp];
+                par_conv.dst = rows;
+                par_conv.wei_val = &wei_val_[wei_row_ptr_[oc]];
+                par_conv.wei_off = &wei_off_[wei_row_ptr_[oc]];
+                par_conv.nnz = wei_row_ptr_[oc + 1] - wei_row_ptr_[oc];
+                kernel_->jit_ker(&par_conv);
+
+                const data_t b = bias ? bias[bias_d.off(oc)] : 0;
+                const int oh_e = nstl::min(oh_s + jcp.ur_h, jcp.oh);
+                for (int oh = oh_s; oh < oh_e; ++oh) {
+                    const data_t *row = &rows[(oh - oh_s) * jcp.owp];
+                    data_t *d = &dst[dst_d.blk_off(n, oc, oh)];
+#                   pragma omp simd
+                    for (int ow = 0; ow < jcp.ow; ++ow) {
+                        data_t v = row[ow] + b;
+                        if (jcp.with_sum) v += d[ow];
+                        if (jcp.with_relu && v < 0)
+                            v *= jcp.relu_negative_slope;
+                        d[ow] = v;
+                    }
+                }
+
+                nd_iterator_step(oc, jcp.oc, ohb, nb_oh);
+            }
+        }
+    }
+}
+
+template struct _jit_uni_sparse_convolution_fwd_t<avx512_common>;
+template struct _jit_uni_sparse_convolution_fwd_t<avx2>;
+
+}
+}
+}
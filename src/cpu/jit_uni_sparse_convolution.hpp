@@ -0,0 +1,133 @@
+/*******************************************************************************
+* Copyright 2018 Intel Corporation
+*
+* Licensed under the Apache License, Version 2.0 (the "License");
+* you may not use this file except in compliance with the License.
+* You may obtain a copy of the License at
+*
+*     http://www.apache.org/licenses/LICENSE-2.0
+*
+* Unless required by applicable law or agreed to in writing, software
+* distributed under the License is distributed on an "AS IS" BASIS,
+* WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+* See the License for the specific language governing permissions and
+* limitations under the License.
+*******************************************************************************/
+
+#ifndef CPU_JIT_UNI_SPARSE_CONVOLUTION_HPP
+#define CPU_JIT_UNI_SPARSE_CONVOLUTION_HPP
+
+#include "c_types_map.hpp"
+#include "cpu_convolution_pd.hpp"
+#include "cpu_engine.hpp"
+#include "jit_primitive_conf.hpp"
+#include "jit_uni_sparse_conv_kernel_f32.hpp"
+
+namespace mkldnn {
+namespace impl {
+namespace cpu {
+
+/* Forward convolution for pruned models, used only when the sparse weights
+ * attribute is set. The attribute promises constant weights, so they are
+ * compressed on the first execution into per-output-channel lists of the
+ * nonzero values and their offsets in the padded input image (CSR), and
+ * the kernel issues FMAs for the nonzero weights only. */
+template <cpu_isa_t isa>
+struct _jit_uni_sparse_convolution_fwd_t: public cpu_primitive_t {
+    struct pd_t: public cpu_convolution_fwd_pd_t {
+        pd_t(engine_t *engine, const convolution_desc_t *adesc,
+                const primitive_attr_t *attr,
+                const typename pd_t::base_class *hint_fwd_pd)
+            : cpu_convolution_fwd_pd_t(engine, adesc, attr, hint_fwd_pd)
+            , jcp_({}) {}
+
+        DECLARE_COMMON_PD_T(
+                JIT_IMPL_NAME_HELPER("jit_sparse:", isa, ""),
+                _jit_uni_sparse_convolution_fwd_t<isa>);
+
+        virtual status_t init() override {
+            using namespace prop_kind;
+            assert(this->engine()->kind() == engine_kind::cpu);
+            bool ok = true
+                && this->attr()->sparse_weights_
+                && this->set_default_params() == status::success
+                && utils::one_of(this->cdesc_().prop_kind, forward_training,
+                        forward_inference)
+                && this->cdesc_().alg_kind == alg_kind::convolution_direct
+                && utils::everyone_is(data_type::f32,
+                        this->cdesc_().src_desc.data_type,
+                        this->cdesc_().weights_desc.data_type,
+                        this->cdesc_().dst_desc.data_type)
+                && utils::implication(this->with_bias(),
+                        data_type::f32 == this->cdesc_().bias_desc.data_type);
+
+            if (!ok) return status::unimplemented;
+
+            return jit_uni_sparse_conv_fwd_kernel_f32<isa>::init_conf(jcp_,
+                        this->cdesc_(),
+                        this->src_pd_.desc(), *this->weights_pd_.desc(),
+                        *this->dst_pd_.desc(), *this->attr());
+        }
+
+        jit_conv_conf_t jcp_;
+
+    protected:
+        virtual status_t set_default_params() override {
+            using namespace memory_format;
+            if (this->src_pd_.desc()->format == any)
+                CHECK(this->src_pd_.set_format(nchw));
+            if (this->dst_pd_.desc()->format == any)
+                CHECK(this->dst_pd_.set_format(nchw));
+            if (this->weights_pd_.desc()->format == any)
+                CHECK(this->weights_pd_.set_format(oihw));
+            if (this->bias_pd_.desc()->format == any)
+                CHECK(this->bias_pd_.set_format(x));
+            return status::success;
+        }
+    };
+
+    _jit_uni_sparse_convolution_fwd_t(const pd_t *pd,
+            const input_vector &inputs, const output_vector &outputs);
+    ~_jit_uni_sparse_convolution_fwd_t() {
+        delete kernel_;
+        free(src_padded_);
+        free(dst_row_);
+        free(wei_row_ptr_);
+        free(wei_off_);
+        free(wei_val_);
+    };
+
+    typedef typename prec_traits<data_type::f32>::type data_t;
+
+    virtual void execute(event_t *e) {
+        execute_forward();
+        e->set_state(event_t::ready);
+    }
+
+private:
+    void compress_weights();
+    void execute_forward();
+    pd_t conf_;
+    jit_uni_sparse_conv_fwd_kernel_f32<isa> *kernel_;
+
+    data_t *src_padded_; // zero-padded input image
+    data_t *dst_row_; // ur_h rounded up output rows of each thread
+
+    /* nonzero weights of the output channel oc are in [wei_row_ptr_[oc],
+     * wei_row_ptr_[oc + 1]) of wei_val_ and wei_off_ */
+    bool wei_compressed_;
+    int *wei_row_ptr_;
+    int32_t *wei_off_;
+    data_t *wei_val_;
+};
+
+using jit_avx512_common_sparse_convolution_fwd_t =
+    _jit_uni_sparse_convolution_fwd_t<avx512_common>;
+using jit_avx2_sparse_convolution_fwd_t =
+    _jit_uni_sparse_convolution_fwd_t<avx2>;
+
+}
+}
+}
+
+#endif
@@ -0,0 +1,382 @@
+/*******************************************************************************
+* Copyright 2018 Intel Corporation
+*
+* Licensed under the Apache License, Version 2.0 (the "License");
+* you may not use this file except in compliance with the License.
+* You may obtain a copy of the License at
+*
+*     http://www.apache.org/licenses/LICENSE-2.0
+*
+* Unless required by applicable law or agreed to in writing, software
+* distributed under the License is distributed on an "AS IS" BASIS,
+* WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+* See the License for the specific language governing permissions and
+* limitations under the License.
+*******************************************************************************/
+
+#include "mkldnn_types.h"
+
+#include "c_types_map.hpp"
+#include "nhwc_gemm_convolution.hpp"
+#include "utils.hpp"
+#include "type_helpers.hpp"
+#include "mkldnn_thread.hpp"
+
+namespace mkldnn {
+namespace impl {
+namespace cpu {
+
+using namespace mkldnn::impl::status;
+using namespace mkldnn::impl::memory_format;
+using namespace mkldnn::impl::utils;
+
+namespace {
+/* range [ow_s, ow_e) of the output points of a row that see an input
+ * point for the filter column kw */
+inline void get_ow_range(const jit_gemm_conv_conf_t &jcp, int kw, int &ow_s,
+        int &ow_e) {
+    const int iw_0 = kw * (jcp.dilate_w + 1) - jcp.l_pad;
+    ow_s = nstl::min(jcp.ow, div_up(nstl::max(0, -iw_0), jcp.stride_w));
+    ow_e = jcp.iw - 1 - iw_0 < 0 ? 0
+        : nstl::min(jcp.ow, (jcp.iw - 1 - iw_0) / jcp.stride_w + 1);
+}
+
+inline int get_iw(const jit_gemm_conv_conf_t &jcp, int ow, int kw) {
+    return ow * jcp.stride_w + kw * (jcp.dilate_w + 1) - jcp.l_pad;
+}
+}
+
+template <bool with_relu, cpu_isa_t isa>
+void _nhwc_gemm_convolution_fwd_t<with_relu, isa>::execute_forward() {
+    auto src = reinterpret_cast<const data_t *>(this->input_memory(0));
+    auto weights = reinterpret_cast<const data_t *>(this->input_memory(1));
+    auto bias = reinterpret_cast<const data_t *>(this->input_memory(2));
+    auto dst = reinterpret_cast<data_t*>(this->memory());
+
+    const jit_gemm_conv_conf_t &jcp = this->conf_.jcp_;
+
+    const auto &post_ops = conf_.attr()->post_ops_;
+    const bool with_sum = post_ops.find(primitive_kind::sum) >= 0;
+
+    float nslope = jcp.with_relu ? jcp.relu_negative_slope : 0.f;
+    int entry_idx = -1;
+    for (int idx = 0; idx < post_ops.len_; ++idx) {
+        const auto &e = post_ops.entry_[idx];
+        if (e.is_relu(true, false)) {
+            entry_idx = idx;
+            nslope = post_ops.entry_[entry_idx].eltwise.alpha;
+            break;
+        }
+    }
+    const bool do_relu = jcp.with_relu || entry_idx >= 0;
+
+    /* a 1x1 convolution without strides and padding treats the whole
+     * image as one row */
+    const bool is_flat = !jcp.need_im2col;
+    const int nrows = is_flat ? 1 : jcp.oh;
+    const int row_len = is_flat ? jcp.os : jcp.ow;
+
+    /* groups are interleaved in the channels of nhwc and hwigo, so all
+     * the leading dimensions are over the channels of all the groups */
+    const int IC = jcp.ic, OC = jcp.oc;
+    const int G_IC = jcp.ngroups * IC, G_OC = jcp.ngroups * OC;
+    const int LDB = is_flat ? G_IC : jcp.stride_w * G_IC;
+    const size_t src_row_sz = (size_t)jcp.iw * G_IC;
+    const size_t dst_row_sz = (size_t)row_len * G_OC;
+    const data_t one = 1.0;
+
+    const size_t work_amount = (size_t)jcp.mb * nrows;
+#   pragma omp parallel
+    {
+        const int ithr = omp_get_thread_num();
+        const int nthr = omp_get_num_threads();
+
+        int n{0}, oh{0};
+        size_t start = 0, end = 0;
+        balance211(work_amount, nthr, ithr, start, end);
+        nd_iterator_init(start, n, jcp.mb, oh, nrows);
+
+        for (size_t iwork = start; iwork < end; ++iwork) {
+            data_t *d = dst + ((size_t)n * nrows + oh) * dst_row_sz;
+
+            for (int ow = 0; ow < row_len; ++ow) {
+                data_t *_d = d + (size_t)ow * G_OC;
+#               pragma omp simd
+                for (int oc = 0; oc < G_OC; ++oc)
+                    _d[oc] = (with_sum ? _d[oc] : 0)
+                        + (jcp.with_bias ? bias[oc] : 0);
+            }
+
+            for (int g = 0; g < jcp.ngroups; ++g) {
+                if (is_flat) {
+                    const data_t *_src = src + (size_t)n * jcp.os * G_IC
+                        + g * IC;
+                    sgemm_->sgemm("N", "N", &OC, &row_len, &IC, &one,
+                            weights + g * OC, &G_OC, _src, &LDB, &one,
+                            d + g * OC, &G_OC);
+                    continue;
+                }
+
+                for (int kh = 0; kh < jcp.kh; ++kh) {
+                    const int ih = oh * jcp.stride_h - jcp.t_pad
+                        + kh * (jcp.dilate_h + 1);
+                    if (ih < 0 || ih >= jcp.ih) continue;
+
+                    for (int kw = 0; kw < jcp.kw; ++kw) {
+                        int ow_s, ow_e;
+                        get_ow_range(jcp, kw, ow_s, ow_e);
+                        const int len = ow_e - ow_s;
+                        if (len <= 0) continue;
+
+                        const data_t *_wei = weights
+                            + (size_t)(kh * jcp.kw + kw) * IC * G_OC + g * OC;
+                        const data_t *_src = src
+                            + ((size_t)n * jcp.ih + ih) * src_row_sz
+                            + (size_t)get_iw(jcp, ow_s, kw) * G_IC + g * IC;
+                        sgemm_->sgemm("N", "N", &OC, &len, &IC, &one, _wei,
+                                &G_OC, _src, &LDB, &one,
+                                d + (size_t)ow_s * G_OC + g * OC, &G_OC);
+                    }
+                }
+            }
+
+            if (do_relu) {
+#               pragma omp simd
+                for (size_t i = 0; i < dst_row_sz; ++i)
+                    if (d[i] < 0) d[i] *= nslope;
+            }
+
+            nd_iterator_step(n, jcp.mb, oh, nrows);
+        }
+    }
+}
+
+template <cpu_isa_t isa>
+void _nhwc_gemm_convolution_bwd_data_t<isa>::execute_backward_data() {
+    auto diff_dst = reinterpret_cast<const data_t *>(this->input_memory(0));
+    auto weights = reinterpret_cast<const data_t *>(this->input_memory(1));
+    auto diff_src = reinterpret_cast<data_t*>(this->memory());
+
+    const jit_gemm_conv_conf_t &jcp = this->conf_.jcp_;
+
+    const bool is_flat = !jcp.need_im2col;
+    const int nrows = is_flat ? 1 : jcp.ih;
+    const int row_len = is_flat ? jcp.os : jcp.iw;
+
+    const int IC = jcp.ic, OC = jcp.oc;
+    const int G_IC = jcp.ngroups * IC, G_OC = jcp.ngroups * OC;
+    const int LDC = is_flat ? G_IC : jcp.stride_w * G_IC;
+    const size_t diff_src_row_sz = (size_t)row_len * G_IC;
+    const size_t diff_dst_row_sz = (size_t)jcp.ow * G_OC;
+    const data_t one = 1.0;
+
+    /* every thread owns whole rows of diff_src, so the contributions of
+     * all the filter taps are accumulated without synchronization */
+    const size_t work_amount = (size_t)jcp.mb * nrows;
+#   pragma omp parallel
+    {
+        const int ithr = omp_get_thread_num();
+        const int nthr = omp_get_num_threads();
+
+        int n{0}, ih{0};
+        size_t start = 0, end = 0;
+        balance211(work_amount, nthr, ithr, start, end);
+        nd_iterator_init(start, n, jcp.mb, ih, nrows);
+
+        for (size_t iwork = start; iwork < end; ++iwork) {
+            data_t *ds = diff_src + ((size_t)n * nrows + ih) * diff_src_row_sz;
+
+#           pragma omp simd
+            for (size_t i = 0; i < diff_src_row_sz; ++i)
+                ds[i] = 0;
+
+            for (int g = 0; g < jcp.ngroups; ++g) {
+                if (is_flat) {
+                    const data_t *_diff_dst = diff_dst
+                        + (size_t)n * jcp.os * G_OC + g * OC;
+                    sgemm_->sgemm("T", "N", &IC, &row_len, &OC, &one,
+                            weights + g * OC, &G_OC, _diff_dst, &G_OC, &one,
+                            ds + g * IC, &LDC);
+                    continue;
+                }
+
+                for (int kh = 0; kh < jcp.kh; ++kh) {
+                    const int oh_s = ih + jcp.t_pad - kh * (jcp.dilate_h + 1);
+                    if (oh_s < 0 || oh_s % jcp.stride_h != 0) continue;
+                    const int oh = oh_s / jcp.stride_h;
+                    if (oh >= jcp.oh) continue;
+
+                    for (int kw = 0; kw < jcp.kw; ++kw) {
+                        int ow_s, ow_e;
+                        get_ow_range(jcp, kw, ow_s, ow_e);
+                        const int len = ow_e - ow_s;
+                        if (len <= 0) continue;
+
+                        const data_t *_wei = weights
+                            + (size_t)(kh * jcp.kw + kw) * IC * G_OC + g * OC;
+                        const data_t *_diff_dst = diff_dst
+                            + ((size_t)n * jcp.oh + oh) * diff_dst_row_sz
+                            + (size_t)ow_s * G_OC + g * OC;
+                        sgemm_->sgemm("T", "N", &IC, &len, &OC, &one, _wei,
+                                &G_OC, _diff_dst, &G_OC, &one,
+                                ds + (size_t)get_iw(jcp, ow_s, kw) * G_IC
+                                + g * IC, &LDC);
+                    }
+                }
+            }
+
+            nd_iterator_step(n, jcp.mb, ih, nrows);
+        }
+    }
+}
+
+template <cpu_isa_t isa>
+_nhwc_gemm_convolution_bwd_weights_t<isa>::
+_nhwc_gemm_convolution_bwd_weights_t(const pd_t *pd,
+        const input_vector &inputs, const output_vector &outputs)
+    : cpu_primitive_t(&conf_, inputs, outputs), conf_(*pd)
+    , sgemm_(nullptr), wei_reduction_(nullptr)
+{
+    const auto &jcp = conf_.jcp_;
+    sgemm_ = new jit_uni_gemm_f32('N', 'T', 1.0, false);
+
+    const size_t work_amount = (size_t)jcp.mb
+        * (jcp.need_im2col ? jcp.oh : 1);
+    nthr_ = (int)nstl::min((size_t)omp_get_max_threads(), work_amount);
+
+    if (nthr_ > 1) {
+        const size_t sz_per_thr = (size_t)jcp.ngroups * jcp.oc
+            * (jcp.ks * jcp.ic + 1);
+        wei_reduction_ = (data_t *)malloc(
+                (nthr_ - 1) * sz_per_thr * sizeof(data_t), 64);
+    }
+}
+
+template <cpu_isa_t isa>
+void _nhwc_gemm_convolution_bwd_weights_t<isa>::execute_backward_weights() {
+    auto src = reinterpret_cast<const data_t *>(this->input_memory(0));
+    auto diff_dst = reinterpret_cast<const data_t *>(this->input_memory(1));
+    auto diff_weights = reinterpret_cast<data_t*>(this->memory(0));
+    auto diff_bias = reinterpret_cast<data_t *>(this->memory(1));
+
+    const jit_gemm_conv_conf_t &jcp = this->conf_.jcp_;
+
+    const bool is_flat = !jcp.need_im2col;
+    const int nrows = is_flat ? 1 : jcp.oh;
+    const int row_len = is_flat ? jcp.os : jcp.ow;
+
+    const int IC = jcp.ic, OC = jcp.oc;
+    const int G_IC = jcp.ngroups * IC, G_OC = jcp.ngroups * OC;
+    const int LDB = is_flat ? G_IC : jcp.stride_w * G_IC;
+    const size_t wei_sz = (size_t)jcp.ks * IC * G_OC;
+    const size_t src_row_sz = (size_t)jcp.iw * G_IC;
+    const size_t diff_dst_row_sz = (size_t)row_len * G_OC;
+    const data_t one = 1.0;
+
+    const size_t work_amount = (size_t)jcp.mb * nrows;
+#   pragma omp parallel num_threads(this->nthr_)
+    {
+        const int ithr = omp_get_thread_num();
+        const int nthr = omp_get_num_threads();
+
+        /* the first thread accumulates right to the destination, the rest
+         * to their private buffers which are reduced at the end */
+        data_t *dw = ithr == 0 ? diff_weights
+            : wei_reduction_ + (ithr - 1) * (wei_sz + G_OC);
+        data_t *db = ithr == 0 ? diff_bias : dw + wei_sz;
+
+#       pragma omp simd
+        for (size_t i = 0; i < wei_sz; ++i)
+            dw[i] = 0;
+        if (jcp.with_bias) {
+#           pragma omp simd
+            for (int oc = 0; oc < G_OC; ++oc)
+                db[oc] = 0;
+        }
+
+        int n{0}, oh{0};
+        size_t start = 0, end = 0;
+        balance211(work_amount, nthr, ithr, start, end);
+        nd_iterator_init(start, n, jcp.mb, oh, nrows);
+
+        for (size_t iwork = start; iwork < end; ++iwork) {
+            const data_t *dd = diff_dst
+                + ((size_t)n * nrows + oh) * diff_dst_row_sz;
+
+            for (int g = 0; g < jcp.ngroups; ++g) {
+                if (is_flat) {
+                    const data_t *_src = src + (size_t)n * jcp.os * G_IC
+                        + g * IC;
+                    sgemm_->sgemm("N", "T", &OC, &IC, &row_len, &one,
+                            dd + g * OC, &G_OC, _src, &LDB, &one, dw + g * OC,
+                            &G_OC);
+                    continue;
+                }
+
+                for (int kh = 0; kh < jcp.kh; ++kh) {
+                    const int ih = oh * jcp.stride_h - jcp.t_pad
+                        + kh * (jcp.dilate_h + 1);
+                    if (ih < 0 || ih >= jcp.ih) continue;
+
+                    for (int kw = 0; kw < jcp.kw; ++kw) {
+                        int ow_s, ow_e;
+                        get_ow_range(jcp, kw, ow_s, ow_e);
+                        const int len = ow_e - ow_s;
+                        if (len <= 0) continue;
+
+                        const data_t *_src = src
+                            + ((size_t)n * jcp.ih + ih) * src_row_sz
+                            + (size_t)get_iw(jcp, ow_s, kw) * G_IC + g * IC;
+                        sgemm_->sgemm("N", "T", &OC, &IC, &len, &one,
+                                dd + (size_t)ow_s * G_OC + g * OC, &G_OC,
+                                _src, &LDB, &one,
+                                dw + (size_t)(kh * jcp.kw + kw) * IC * G_OC
+                                + g * OC, &G_OC);
+                    }
+                }
+            }
+
+            if (jcp.with_bias) {
+                for (int ow = 0; ow < row_len; ++ow) {
+#                   pragma omp simd
+                    for (int oc = 0; oc < G_OC; ++oc)
+                        db[oc] += dd[(size_t)ow * G_OC + oc];
+                }
+            }
+
+            nd_iterator_step(n, jcp.mb, oh, nrows);
+        }
+
+        if (nthr > 1) {
+#           pragma omp barrier
+            const size_t red_sz = wei_sz + (jcp.with_bias ? G_OC : 0);
+            size_t red_start = 0, red_end = 0;
+            balance211(red_sz, nthr, ithr, red_start, red_end);
+            for (int thr = 1; thr < nthr; ++thr) {
+                const data_t *buf = wei_reduction_
+                    + (thr - 1) * (wei_sz + G_OC);
+                for (size_t i = red_start; i < red_end; ++i) {
+                    if (i < wei_sz)
+                        diff_weights[i] += buf[i];
+                    else
+                        diff_bias[i - wei_sz] += buf[i];
+                }
+            }
+        }
+    }
+}
+
+template struct _nhwc_gemm_convolution_fwd_t<true, avx512_common>;
+template struct _nhwc_gemm_convolution_fwd_t<true, avx2>;
+template struct _nhwc_gemm_convolution_fwd_t<false, avx512_common>;
+template struct _nhwc_gemm_convolution_fwd_t<false, avx2>;
+template struct _nhwc_gemm_convolution_bwd_data_t<avx512_common>;
+template struct _nhwc_gemm_convolution_bwd_data_t<avx2>;
+template struct _nhwc_gemm_convolution_bwd_weights_t<avx512_common>;
+template struct _nhwc_gemm_convolution_bwd_weights_t<avx2>;
+
+}
+}
+}
+
+// vim: et ts=4 sw=4 cindent cino^=l0,\:0,N-s
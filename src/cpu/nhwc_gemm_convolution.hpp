@@ -0,0 +1,351 @@
+/*******************************************************************************
+* Copyright 2018 Intel Corporation
+*
+* Licensed under the Apache License, Version 2.0 (the "License");
+* you may not use this file except in compliance with the License.
+* You may obtain a copy of the License at
+*
+*     http://www.apache.org/licenses/LICENSE-2.0
+*
+* Unless required by applicable law or agreed to in writing, software
+* distributed under the License is distributed on an "AS IS" BASIS,
+* WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+* See the License for the specific language governing permissions and
+* limitations under the License.
+*******************************************************************************/
+
+#ifndef CPU_NHWC_GEMM_CONVOLUTION_HPP
+#define CPU_NHWC_GEMM_CONVOLUTION_HPP
+
+#include "c_types_map.hpp"
+#include "cpu_convolution_pd.hpp"
+#include "cpu_engine.hpp"
+#include "jit_avx2_gemm_f32.hpp"
+#include "jit_avx512_common_gemm_f32.hpp"
+#include "jit_primitive_conf.hpp"
+#include "gemm_convolution_utils.hpp"
+
+namespace mkldnn {
+namespace impl {
+namespace cpu {
+
+/* Convolutions on nhwc activations and hwio (hwigo) weights.
+ *
+ * In nhwc a row of an image is a (w x c) row-major matrix, and in hwio a
+ * filter tap (kh, kw) is a (ic x oc) row-major matrix, so every tap
+ * contributes to an output row with a single sgemm over the input row,
+ * read with a leading dimension of stride_w * c. Neither im2col nor
+ * reorders to the blocked layouts are needed; a 1x1 convolution without
+ * strides and padding is a single sgemm per image. */
+
+template <bool with_relu, cpu_isa_t isa>
+struct _nhwc_gemm_convolution_fwd_t: public cpu_primitive_t {
+    struct pd_t: public _cpu_convolution_fwd_pd_t<with_relu> {
+        pd_t(engine_t *engine,
+                const typename pd_t::base_desc_t *adesc,
+                const primitive_attr_t *attr,
+                const typename pd_t::base_class *hint_fwd_pd)
+            : _cpu_convolution_fwd_pd_t<with_relu>(engine, adesc, attr,
+                    hint_fwd_pd)
+            , jcp_({}) {}
+
+        DECLARE_COMMON_PD_T(
+                JIT_IMPL_NAME_HELPER("gemm_nhwc:", isa, ""),
+                _nhwc_gemm_convolution_fwd_t<with_relu, isa>);
+
+        inline memory_format_t wei_format() {
+            using namespace memory_format;
+            return this->with_groups() ? hwigo : hwio;
+        }
+
+        virtual status_t init() override {
+            using namespace prop_kind;
+            using namespace memory_format;
+
+            assert(this->engine()->kind() == engine_kind::cpu);
+
+            /* nhwc is never chosen for format any: the blocked kernels are
+             * faster when the layout is up to the library */
+            bool ok = true
+                && mayiuse(isa)
+                && utils::one_of(this->cdesc_().prop_kind, forward_training,
+                           forward_inference)
+                && this->cdesc_().alg_kind == alg_kind::convolution_direct
+                && utils::everyone_is(data_type::f32,
+                           this->cdesc_().src_desc.data_type,
+                           this->cdesc_().weights_desc.data_type,
+                           this->cdesc_().dst_desc.data_type)
+                && utils::implication(this->with_bias(), data_type::f32
+                                   == this->cdesc_().bias_desc.data_type)
+                && this->src_pd_.desc()->format == nhwc
+                && utils::one_of(this->dst_pd_.desc()->format, any, nhwc)
+                && utils::one_of(this->weights_pd_.desc()->format, any,
+                        wei_format())
+                && this->set_default_params() == status::success
+                && this->post_ops_ok();
+            if (!ok) return status::unimplemented;
+
+            jit_gemm_convolution_utils::init_conf(jcp_, this->cdesc_(),
+                    this->src_pd(), this->weights_pd(0), this->dst_pd(),
+                    with_relu, this->negative_slope());
+            return status::success;
+        }
+
+        jit_gemm_conv_conf_t jcp_;
+
+    protected:
+        virtual status_t set_default_params() override {
+            using namespace memory_format;
+            if (this->dst_pd_.desc()->format == any)
+                CHECK(this->dst_pd_.set_format(nhwc));
+            if (this->weights_pd_.desc()->format == any)
+                CHECK(this->weights_pd_.set_format(wei_format()));
+            if (this->bias_pd_.desc()->format == any)
+                CHECK(this->bias_pd_.set_format(x));
+            return status::success;
+        }
+
+        bool post_ops_ok() const {
+            auto const &po = this->attr()->post_ops_;
+            switch (po.len_) {
+            case 0: return true; // no post_ops
+            case 1: return !with_relu // sum OR relu
+                    && (po.entry_[0].is_relu() || po.entry_[0].is_sum());
+            case 2: return !with_relu // sum->relu
+                    && (po.entry_[0].is_sum() && po.entry_[1].is_relu());
+            default: return false;
+            }
+        }
+    };
+
+    _nhwc_gemm_convolution_fwd_t(const pd_t *pd, const input_vector &inputs,
+           const output_vector &outputs)
+        : cpu_primitive_t(&conf_, inputs, outputs), conf_(*pd)
+    { sgemm_ = new jit_uni_gemm_f32('N', 'N', 1.0, false); }
+    ~_nhwc_gemm_convolution_fwd_t() { delete sgemm_; }
+
+    typedef typename prec_traits<data_type::f32>::type data_t;
+
+    virtual void execute(event_t *e) {
+        execute_forward();
+        e->set_state(event_t::ready);
+    }
+
+private:
+    void execute_forward();
+    pd_t conf_;
+    using jit_uni_gemm_f32 = typename utils::conditional
+          <isa == avx2, jit_avx2_gemm_f32, jit_avx512_common_gemm_f32>::type;
+    jit_uni_gemm_f32 *sgemm_;
+};
+
+using jit_avx512_common_nhwc_gemm_convolution_fwd_t =
+                         _nhwc_gemm_convolution_fwd_t<false, avx512_common>;
+using jit_avx512_common_nhwc_gemm_convolution_relu_t =
+                         _nhwc_gemm_convolution_fwd_t<true, avx512_common>;
+using jit_avx2_nhwc_gemm_convolution_fwd_t =
+                         _nhwc_gemm_convolution_fwd_t<false, avx2>;
+using jit_avx2_nhwc_gemm_convolution_relu_t =
+                         _nhwc_gemm_convolution_fwd_t<true, avx2>;
+
+template <cpu_isa_t isa>
+struct _nhwc_gemm_convolution_bwd_data_t: public cpu_primitive_t {
+    struct pd_t: public cpu_convolution_bwd_data_pd_t {
+        pd_t(engine_t *engine,
+                const convolution_desc_t *adesc,
+                const primitive_attr_t *attr,
+                const convolution_fwd_pd_t *hint_fwd_pd)
+            : cpu_convolution_bwd_data_pd_t(engine, adesc, attr, hint_fwd_pd)
+            , jcp_({})
+        {}
+
+        DECLARE_COMMON_PD_T(
+                JIT_IMPL_NAME_HELPER("gemm_nhwc:", isa, ""),
+                _nhwc_gemm_convolution_bwd_data_t<isa>);
+
+        inline memory_format_t wei_format() {
+            using namespace memory_format;
+            return this->with_groups() ? hwigo : hwio;
+        }
+
+        virtual status_t init() override {
+            using namespace prop_kind;
+            using namespace memory_format;
+
+            assert(this->engine()->kind() == engine_kind::cpu);
+
+            bool ok = true
+                && mayiuse(isa)
+                && utils::one_of(this->desc()->prop_kind, backward,
+                        backward_data)
+                && this->desc()->alg_kind == alg_kind::convolution_direct
+                && utils::everyone_is(data_type::f32,
+                        this->desc()->diff_src_desc.data_type,
+                        this->desc()->weights_desc.data_type,
+                        this->desc()->diff_dst_desc.data_type)
+                && this->diff_dst_pd_.desc()->format == nhwc
+                && utils::one_of(this->diff_src_pd_.desc()->format, any, nhwc)
+                && utils::one_of(this->weights_pd_.desc()->format, any,
+                        wei_format())
+                && this->set_default_params() == status::success;
+            if (!ok) return status::unimplemented;
+
+            jit_gemm_convolution_utils::init_conf(jcp_, *this->desc(),
+                    this->diff_src_pd(), this->weights_pd(0),
+                    this->diff_dst_pd());
+            return status::success;
+        }
+
+        jit_gemm_conv_conf_t jcp_;
+
+    protected:
+        virtual status_t set_default_params() override {
+            using namespace memory_format;
+            if (this->diff_src_pd_.desc()->format == any)
+                CHECK(this->diff_src_pd_.set_format(nhwc));
+            if (this->weights_pd_.desc()->format == any)
+                CHECK(this->weights_pd_.set_format(wei_format()));
+            return status::success;
+        }
+    };
+
+    _nhwc_gemm_convolution_bwd_data_t(const pd_t *pd,
+            const input_vector &inputs, const output_vector &outputs)
+        : cpu_primitive_t(&conf_, inputs, outputs), conf_(*pd)
+    { sgemm_ = new jit_uni_gemm_f32('T', 'N', 1.0, false); }
+    ~_nhwc_gemm_convolution_bwd_data_t() { delete sgemm_; }
+
+    typedef typename prec_traits<data_type::f32>::type data_t;
+
+    virtual void execute(event_t *e) {
+        switch (conf_.desc()->prop_kind) {
+        case prop_kind::backward:
+        case prop_kind::backward_data:
+            execute_backward_data();
+            break;
+        default:
+            assert(!"invalid prop_kind");
+        }
+        e->set_state(event_t::ready);
+    }
+
+private:
+    void execute_backward_data();
+    pd_t conf_;
+    using jit_uni_gemm_f32 = typename utils::conditional
+          <isa == avx2, jit_avx2_gemm_f32, jit_avx512_common_gemm_f32>::type;
+    jit_uni_gemm_f32 *sgemm_;
+};
+
+using jit_avx512_common_nhwc_gemm_convolution_bwd_data_t =
+                         _nhwc_gemm_convolution_bwd_data_t<avx512_common>;
+using jit_avx2_nhwc_gemm_convolution_bwd_data_t =
+                         _nhwc_gemm_convolution_bwd_data_t<avx2>;
+
+template <cpu_isa_t isa>
+struct _nhwc_gemm_convolution_bwd_weights_t: public cpu_primitive_t {
+    struct pd_t: public cpu_convolution_bwd_weights_pd_t {
+        pd_t(engine_t *engine,
+                const convolution_desc_t *adesc,
+                const primitive_attr_t *attr,
+                const convolution_fwd_pd_t *hint_fwd_pd)
+            : cpu_convolution_bwd_weights_pd_t(engine, adesc, attr, hint_fwd_pd)
+            , jcp_({})
+        {}
+
+        DECLARE_COMMON_PD_T(
+                JIT_IMPL_NAME_HELPER("gemm_nhwc:", isa, ""),
+                _nhwc_gemm_convolution_bwd_weights_t<isa>);
+
+        inline memory_format_t wei_format() {
+            using namespace memory_format;
+            return this->with_groups() ? hwigo : hwio;
+        }
+
+        virtual status_t init() override {
+            using namespace prop_kind;
+            using namespace memory_format;
+
+            assert(this->engine()->kind() == engine_kind::cpu);
+
+            bool ok = true
+                && mayiuse(isa)
+                && utils::one_of(this->desc()->prop_kind, backward,
+                        backward_weights)
+                && this->desc()->alg_kind == alg_kind::convolution_direct
+                && utils::everyone_is(data_type::f32,
+                        this->desc()->src_desc.data_type,
+                        this->desc()->diff_weights_desc.data_type,
+                        this->desc()->diff_dst_desc.data_type)
+                && utils::implication(this->with_bias(), data_type::f32
+                        == this->desc()->diff_bias_desc.data_type)
+                && this->src_pd_.desc()->format == nhwc
+                && this->diff_dst_pd_.desc()->format == nhwc
+                && utils::one_of(this->diff_weights_pd_.desc()->format,
+                        any, wei_format())
+                && this->set_default_params() == status::success;
+            if (!ok) return status::unimplemented;
+
+            jit_gemm_convolution_utils::init_conf(jcp_, *this->desc(),
+                    this->src_pd(), this->diff_weights_pd(0),
+                    this->diff_dst_pd());
+            return status::success;
+        }
+
+        jit_gemm_conv_conf_t jcp_;
+
+    protected:
+        virtual status_t set_default_params() override {
+            using namespace memory_format;
+            if (this->diff_weights_pd_.desc()->format == any)
+                CHECK(this->diff_weights_pd_.set_format(wei_format()));
+            if (this->diff_bias_pd_.desc()->format == any)
+                CHECK(this->diff_bias_pd_.set_format(x));
+            return status::success;
+        }
+    };
+
+    _nhwc_gemm_convolution_bwd_weights_t(const pd_t *pd,
+            const input_vector &inputs, const output_vector &outputs);
+    ~_nhwc_gemm_convolution_bwd_weights_t() {
+        delete sgemm_;
+        free(wei_reduction_);
+    }
+
+    typedef typename prec_traits<data_type::f32>::type data_t;
+
+    virtual void execute(event_t *e) {
+        switch (conf_.desc()->prop_kind) {
+        case prop_kind::backward:
+        case prop_kind::backward_weights:
+            execute_backward_weights();
+            break;
+        default:
+            assert(!"invalid prop_kind");
+        }
+        e->set_state(event_t::ready);
+    }
+
+private:
+    void execute_backward_weights();
+    pd_t conf_;
+    using jit_uni_gemm_f32 = typename utils::conditional
+          <isa == avx2, jit_avx2_gemm_f32, jit_avx512_common_gemm_f32>::type;
+    jit_uni_gemm_f32 *sgemm_;
+    /* per-thread diff_weights (and diff_bias) of all but the first thread */
+    data_t *wei_reduction_;
+    int nthr_;
+};
+
+using jit_avx512_common_nhwc_gemm_convolution_bwd_weights_t =
+                         _nhwc_gemm_convolution_bwd_weights_t<avx512_common>;
+using jit_avx2_nhwc_gemm_convolution_bwd_weights_t =
+                         _nhwc_gemm_convolution_bwd_weights_t<avx2>;
+
+}
+}
+}
+
+#endif
+
+// vim: et ts=4 sw=4 cindent cino^=l0,\:0,N-s
@@ -17,6 +17,12 @@
 /*
   General architecture
 
+  the states of the workspace are indexed as
+  [n_layer + 1][n_direction][n_states][n_iter + 1][batch][s_size]
+  so that the h states a layer gets from the previous one are contiguous over
+  the iterations, and the forward multiplies them by the input weights in one
+  gemm per layer before running the iterations
+
   for diff states, we have n_states + 1 as we have n_states diff
   to propagate to the previous iteration and 1 states to propagate
   to the previous layer
@@ -30,6 +36,7 @@
  */
 #include "c_types_map.hpp"
 #include "math_utils.hpp"
+#include "mkldnn_thread.hpp"
 #include "mkldnn_traits.hpp"
 #include "type_helpers.hpp"
 
@@ -46,6 +53,31 @@ using namespace alg_kind;
 
 #define AOC array_offset_calculator
 
+#if !defined(USE_CBLAS)
+namespace {
+/* the jit sgemms of all the isas have the same interface */
+template <typename gemm_t>
+void jit_sgemm_batch(gemm_t *gemm, bool is_A_packed, const char *transb,
+        int m, int n, int k, int n_cells, const float **a_, int lda,
+        const float **b_, int ldb, float beta, float **c_, int ldc) {
+    const float alpha = 1.0f;
+    if (is_A_packed)
+        gemm->sgemm_compute_batch(transb, &m, &n, &k, &alpha, a_, b_, &ldb,
+                &beta, c_, &ldc, n_cells);
+    else
+        gemm->sgemm_batch("N", transb, &m, &n, &k, &alpha, a_, &lda, b_,
+                &ldb, &beta, c_, &ldc, n_cells);
+}
+
+template <typename gemm_t>
+float *jit_sgemm_pack(int m, int k, const float *a) {
+    float *packed_a = gemm_t::sgemm_pack_alloc(m, k);
+    gemm_t::sgemm_pack("N", &m, &k, a, &m, packed_a);
+    return packed_a;
+}
+}
+#endif
+
 template <>
 float activation<alg_kind::eltwise_relu, prop_kind::forward>(
         float dd, float s, float alpha, float cliping) {
@@ -77,13 +109,20 @@ template <>
 elemwise_sig(_ref_rnn_common_t<prop_kind::forward>::rnn_elemwise) {
     AOC<float, 3> ws_gates(ws_gates_, batch, n_gates, s_size);
     AOC<const float, 2> bias(bias_, n_gates, s_size);
-    AOC<float, 3> states_t_l(states_t_l_, n_states, batch, s_size);
-#pragma omp parallel for
-    for (int i = 0; i < batch; i++) {
-        for (int j = 0; j < s_size; j++) {
+    AOC<float, 2> states_t_l(states_t_l_, batch, s_size);
+    const int j_jit = elemwise_ker_ ? elemwise_ker_->len() : 0;
+    for (int i = mb_start; i < mb_end; i++) {
+        if (j_jit > 0) {
+            jit_rnn_elemwise_call_s p;
+            p.ws_gates = &ws_gates(i, 0, 0);
+            p.bias = bias_;
+            p.states_t_l = &states_t_l(i, 0);
+            (*elemwise_ker_)(&p);
+        }
+        for (int j = j_jit; j < s_size; j++) {
             const float h
                     = activation_func(0, ws_gates(i, 0, j) + bias(0, j), 0, 0);
-            ws_gates(i, 0, j) = states_t_l(0, i, j) = h;
+            ws_gates(i, 0, j) = states_t_l(i, j) = h;
         }
     }
 }
@@ -95,9 +134,16 @@ elemwise_sig(_ref_rnn_common_t<prop_kind::backward>::rnn_elemwise) {
             diff_states_tp1_l_, n_states + 1, batch, s_size);
     AOC<float, 3> diff_states_t_lp1(
             diff_states_t_lp1_, n_states + 1, batch, s_size);
-#pragma omp parallel for
-    for (int i = 0; i < batch; ++i) {
-        for (int j = 0; j < s_size; ++j) {
+    const int j_jit = elemwise_ker_ ? elemwise_ker_->len() : 0;
+    for (int i = mb_start; i < mb_end; ++i) {
+        if (j_jit > 0) {
+            jit_rnn_elemwise_call_s p;
+            p.ws_gates = &ws_gates(i, 0, 0);
+            p.diff_states_tp1_l = &diff_states_tp1_l(0, i, 0);
+            p.diff_states_t_lp1 = &diff_states_t_lp1(n_states, i, 0);
+            (*elemwise_ker_)(&p);
+        }
+        for (int j = j_jit; j < s_size; ++j) {
             const float dH = diff_states_t_lp1(n_states, i, j)
                     + diff_states_tp1_l(0, i, j);
             auto g = ws_gates(i, 0, j);
@@ -110,22 +156,32 @@ template <>
 elemwise_sig(_ref_rnn_common_t<prop_kind::forward>::lstm_elemwise) {
     AOC<float, 3> ws_gates(ws_gates_, batch, n_gates, s_size);
     AOC<const float, 2> bias(bias_, n_gates, s_size);
-    AOC<float, 3> states_t_l(states_t_l_, n_states, batch, s_size);
-    AOC<float, 3> states_tm1_l(states_tm1_l_, n_states, batch, s_size);
-
-#pragma omp parallel for
-    for (int i = 0; i < batch; i++) {
+    AOC<float, 2> states_t_l(states_t_l_, batch, s_size);
+    AOC<float, 2> c_states_t_l(c_states_t_l_, batch, s_size);
+    AOC<float, 2> c_states_tm1_l(c_states_tm1_l_, batch, s_size);
+    const int j_jit = elemwise_ker_ ? elemwise_ker_->len() : 0;
+
+    for (int i = mb_start; i < mb_end; i++) {
+        if (j_jit > 0) {
+            jit_rnn_elemwise_call_s p;
+            p.ws_gates = &ws_gates(i, 0, 0);
+            p.bias = bias_;
+            p.states_t_l = &states_t_l(i, 0);
+            p.c_states_t_l = &c_states_t_l(i, 0);
+            p.c_states_tm1_l = &c_states_tm1_l(i, 0);
+            (*elemwise_ker_)(&p);
+        }
 #pragma omp simd
-        for (int j = 0; j < s_size; j++) {
+        for (int j = j_jit; j < s_size; j++) {
             ws_gates(i, 0, j) = logistic_fwd(ws_gates(i, 0, j) + bias(0, j));
             ws_gates(i, 1, j) = logistic_fwd(ws_gates(i, 1, j) + bias(1, j));
             ws_gates(i, 2, j) = logistic_fwd(ws_gates(i, 2, j) + bias(2, j));
             ws_gates(i, 3, j) = tanh_fwd(ws_gates(i, 3, j) + bias(3, j));
 
-            float tmp = ws_gates(i, 0, j) * states_tm1_l(1, i, j)
+            float tmp = ws_gates(i, 0, j) * c_states_tm1_l(i, j)
                     + ws_gates(i, 1, j) * ws_gates(i, 3, j);
-            states_t_l(0, i, j) = ws_gates(i, 2, j) * tanh_fwd(tmp);
-            states_t_l(1, i, j) = tmp;
+            states_t_l(i, j) = ws_gates(i, 2, j) * tanh_fwd(tmp);
+            c_states_t_l(i, j) = tmp;
         }
     }
 }
@@ -170,8 +226,8 @@ template <>
 elemwise_sig(_ref_rnn_common_t<prop_kind::backward>::lstm_elemwise) {
     AOC<float, 3> ws_gates(ws_gates_, batch, n_gates, s_size);
     AOC<const float, 2> bias(bias_, n_gates, s_size);
-    AOC<float, 3> states_t_l(states_t_l_, n_states, batch, s_size);
-    AOC<float, 3> states_tm1_l(states_tm1_l_, n_states, batch, s_size);
+    AOC<float, 2> c_states_t_l(c_states_t_l_, batch, s_size);
+    AOC<float, 2> c_states_tm1_l(c_states_tm1_l_, batch, s_size);
     AOC<float, 3> diff_states_t_l(
             diff_states_t_l_, n_states + 1, batch, s_size);
     AOC<float, 3> diff_states_tp1_l(
@@ -180,12 +236,23 @@ elemwise_sig(_ref_rnn_common_t<prop_kind::backward>::lstm_elemwise) {
             diff_states_t_lp1_, n_states + 1, batch, s_size);
 
     auto one_m_square = [](float a) -> float { return 1.0f - a * a; };
-
-#pragma omp parallel for
-    for (int i = 0; i < batch; i++) {
+    const int j_jit = elemwise_ker_ ? elemwise_ker_->len() : 0;
+
+    for (int i = mb_start; i < mb_end; i++) {
+        if (j_jit > 0) {
+            jit_rnn_elemwise_call_s p;
+            p.ws_gates = &ws_gates(i, 0, 0);
+            p.c_states_t_l = &c_states_t_l(i, 0);
+            p.c_states_tm1_l = &c_states_tm1_l(i, 0);
+            p.diff_states_tp1_l = &diff_states_tp1_l(0, i, 0);
+            p.diff_c_states_tp1_l = &diff_states_tp1_l(1, i, 0);
+            p.diff_states_t_lp1 = &diff_states_t_lp1(n_states, i, 0);
+            p.diff_c_states_t_l = &diff_states_t_l(1, i, 0);
+            (*elemwise_ker_)(&p);
+        }
 #pragma omp simd
-        for (int j = 0; j < s_size; j++) {
-            float Ct = states_t_l(1, i, j);
+        for (int j = j_jit; j < s_size; j++) {
+            float Ct = c_states_t_l(i, j);
             /// @todo save it in the workspace in fwd pass or recompute it to
             /// save bw
             float tanhCt = tanh_fwd(Ct);
@@ -195,7 +262,7 @@ elemwise_sig(_ref_rnn_common_t<prop_kind::backward>::lstm_elemwise) {
             float dCt = diff_states_tp1_l(1, i, j)
                     + one_m_square(tanhCt) * ws_gates(i, 2, j) * dHt;
 
-            float dG0 = states_tm1_l(1, i, j)
+            float dG0 = c_states_tm1_l(i, j)
                     * logistic_bwd(dCt, ws_gates(i, 0, j));
             float dG1
                     = ws_gates(i, 3, j) * logistic_bwd(dCt, ws_gates(i, 1, j));
@@ -215,13 +282,18 @@ elemwise_sig(_ref_rnn_common_t<prop_kind::backward>::lstm_elemwise) {
 template <prop_kind_t aprop>
 gemm_sig(_ref_rnn_common_t<aprop>::packed_gemm) {
 #if USE_MKL_PACKED_GEMM
-    cblas_sgemm_compute(CblasColMajor, CblasPacked,
-            is_B_trans ? CblasTrans : CblasNoTrans, m, n, k, a_, m, b_,
-            is_B_trans ? n : k, beta, c_, m);
+    for (int c = 0; c < n_cells; c++)
+        cblas_sgemm_compute(CblasColMajor, CblasPacked,
+                is_B_trans ? CblasTrans : CblasNoTrans, m, n, k, a_[c], m,
+                b_[c], is_B_trans ? n : k, beta, c_[c], m);
+#elif !defined(USE_CBLAS)
+    sgemm(is_B_trans, m, n, k, n_cells, a_, m, b_, is_B_trans ? n : k, beta,
+            c_, m, true);
 #else
     UNUSED(m);
     UNUSED(n);
     UNUSED(k);
+    UNUSED(n_cells);
     UNUSED(a_);
     UNUSED(b_);
     UNUSED(c_);
@@ -231,64 +303,250 @@ gemm_sig(_ref_rnn_common_t<aprop>::packed_gemm) {
 #endif
 }
 
+/* the gemms of the n_cells cells have the same sizes: the jit sgemm runs the
+ * small ones side by side on parts of the threads */
+template <prop_kind_t aprop>
+void _ref_rnn_common_t<aprop>::sgemm(bool is_B_trans, int m, int n, int k,
+        int n_cells, const float **a_, int lda, const float **b_, int ldb,
+        float beta, float **c_, int ldc, bool is_A_packed) {
+#if defined(USE_CBLAS)
+    assert(!is_A_packed);
+    UNUSED(is_A_packed);
+    for (int c = 0; c < n_cells; c++)
+        cblas_sgemm(CblasColMajor, CblasNoTrans,
+                is_B_trans ? CblasTrans : CblasNoTrans, m, n, k, 1.0f, a_[c],
+                lda, b_[c], ldb, beta, c_[c], ldc);
+#else
+    assert(one_of(beta, 0.0f, 1.0f) && implication(is_B_trans, beta == 1.0f));
+    const int idx = is_B_trans ?
+            sgemm_nt_beta1 :
+            (beta == 0.0f ? sgemm_nn_beta0 : sgemm_nn_beta1);
+    if (!is_A_packed && small_sgemm_[idx]
+            && small_sgemm_[idx]->has_shape(m, n, k, lda, ldb, ldc)) {
+        small_sgemm_[idx]->sgemm_batch(n_cells, a_, b_, c_);
+        return;
+    }
+    const char *transb = is_B_trans ? "T" : "N";
+    if (avx512_sgemm_[idx])
+        jit_sgemm_batch(avx512_sgemm_[idx], is_A_packed, transb, m, n, k,
+                n_cells, a_, lda, b_, ldb, beta, c_, ldc);
+    else if (avx2_sgemm_[idx])
+        jit_sgemm_batch(avx2_sgemm_[idx], is_A_packed, transb, m, n, k,
+                n_cells, a_, lda, b_, ldb, beta, c_, ldc);
+    else
+        jit_sgemm_batch(sse42_sgemm_[idx], is_A_packed, transb, m, n, k,
+                n_cells, a_, lda, b_, ldb, beta, c_, ldc);
+#endif
+}
+
 template <prop_kind_t aprop>
 gemm_sig(_ref_rnn_common_t<aprop>::gemm) {
-    cblas_sgemm(CblasColMajor, CblasNoTrans,
-            is_B_trans ? CblasTrans : CblasNoTrans, m, n, k, 1.0f, a_, m, b_,
-            is_B_trans ? n : k, beta, c_, m);
+    sgemm(is_B_trans, m, n, k, n_cells, a_, m, b_, is_B_trans ? n : k, beta,
+            c_, m);
+}
+
+/* a_ points to f16 weights: each block of wei_k_block_ columns of A is
+ * widened with F16C and multiplied right away, so the weights are read from
+ * memory in f16 and the f32 copy stays in cache */
+template <prop_kind_t aprop>
+gemm_sig(_ref_rnn_common_t<aprop>::gemm_f16) {
+    assert(!is_B_trans);
+    for (int c = 0; c < n_cells; c++) {
+        auto a = reinterpret_cast<const float16_t *>(a_[c]);
+        for (int k_s = 0; k_s < k; k_s += wei_k_block_) {
+            const int cur_k = nstl::min(wei_k_block_, k - k_s);
+            const size_t nelems = (size_t)m * cur_k;
+            const float16_t *a_blk = &a[(size_t)m * k_s];
+#pragma omp parallel
+            {
+                size_t start{ 0 }, end{ 0 };
+                balance211(nelems, omp_get_num_threads(),
+                        omp_get_thread_num(), start, end);
+                if (start < end)
+                    (*cvt_f16_)(&wei_f32_[start], &a_blk[start], end - start);
+            }
+            const float *a_f32 = wei_f32_;
+            const float *b_blk = b_[c] + k_s;
+            sgemm(false, m, n, cur_k, 1, &a_f32, m, &b_blk, k,
+                    k_s == 0 ? beta : 1.0f, &c_[c], m);
+        }
+    }
+}
+
+namespace {
+/* the gemms of the cells run together on the rows of the batch active in
+ * at least one of them */
+int max_active_batch(int n_cells, const rnn_cell_t *cells) {
+    int active_batch = 0;
+    for (int c = 0; c < n_cells; c++)
+        active_batch = nstl::max(active_batch, cells[c].active_batch);
+    return active_batch;
+}
 }
 
 /// @todo template this function on fwd or bwd, if the overhead
 ///  to pass argument for empty function is too big
 template <>
 cell_execution_sig(_ref_rnn_common_t<prop_kind::forward>::cell_execution) {
-    (this->*gemm_input_func)(n_gates * s_size, batch, x_size, w_input_,
-            states_t_lm1_, ws_gates_, false, 0.0f);
-    (this->*gemm_state_func)(n_gates * s_size, batch, h_size, w_state_,
-            states_tm1_l_, ws_gates_, false, 1.0f);
+    /* the products of the inputs were computed by the grid execution, for
+     * all the iterations of the layer at once in linear_execution, the gates
+     * accumulate the states */
+    const int active_batch = max_active_batch(n_cells, cells);
+    for (int c = 0; c < n_cells; c++) {
+        gemm_a_[c] = cells[c].w_state;
+        gemm_b_[c] = cells[c].states_tm1_l;
+        gemm_c_[c] = cells[c].ws_gates;
+    }
+    if (active_batch > 0)
+        (this->*gemm_state_func)(n_gates * s_size, active_batch, h_size,
+                n_cells, gemm_a_, gemm_b_, gemm_c_, false, 1.0f);
 
-    (this->*elemwise_func)(s_size, batch, n_states, n_gates, ws_gates_,
-            states_t_l_, states_t_lm1_, states_tm1_l_, diff_states_t_l_,
-            diff_states_t_lp1_, diff_states_tp1_l_, bias_);
+    elemwise_execution(s_size, batch, n_states, n_gates, n_cells, cells);
 }
 
 template <>
 cell_execution_sig(_ref_rnn_common_t<prop_kind::backward>::cell_execution) {
-    (this->*elemwise_func)(s_size, batch, n_states, n_gates, ws_gates_,
-            states_t_l_, states_t_lm1_, states_tm1_l_, diff_states_t_l_,
-            diff_states_t_lp1_, diff_states_tp1_l_, bias_);
+    elemwise_execution(s_size, batch, n_states, n_gates, n_cells, cells);
+
+    /* the gates of the rows of a cell past its active_batch are zero */
+    const int active_batch = max_active_batch(n_cells, cells);
+    if (active_batch == 0) {
+        copy_carried_diff_states(s_size, batch, n_states, n_cells, cells);
+        return;
+    }
 
     /// bwd by data on the cell
-    (this->*gemm_state_func)(h_size, batch, n_gates * s_size, w_state_,
-            ws_gates_, diff_states_t_l_, false, 0.0f);
-    (this->*gemm_input_func)(h_size, batch, n_gates * s_size, w_input_,
-            ws_gates_, diff_states_t_l_ + n_states * (batch * s_size), false,
-            0.0f);
+    for (int c = 0; c < n_cells; c++) {
+        gemm_a_[c] = cells[c].w_state;
+        gemm_b_[c] = cells[c].ws_gates;
+        gemm_c_[c] = cells[c].diff_states_t_l;
+    }
+    (this->*gemm_state_func)(h_size, active_batch, n_gates * s_size, n_cells,
+            gemm_a_, gemm_b_, gemm_c_, false, 0.0f);
+
+    for (int c = 0; c < n_cells; c++) {
+        gemm_a_[c] = cells[c].w_input;
+        gemm_c_[c] = cells[c].diff_states_t_l + n_states * (batch * s_size);
+    }
+    (this->*gemm_input_func)(h_size, active_batch, n_gates * s_size, n_cells,
+            gemm_a_, gemm_b_, gemm_c_, false, 0.0f);
+
+    copy_carried_diff_states(s_size, batch, n_states, n_cells, cells);
 
     /// bwd by weights on the cell
-    gemm(n_gates * x_size, s_size, batch, ws_gates_, states_t_lm1_,
-            diff_w_input_, true, 1.0f);
-    gemm(n_gates * h_size, s_size, batch, ws_gates_, states_tm1_l_,
-            diff_w_state_, true, 1.0f);
+    for (int c = 0; c < n_cells; c++) {
+        gemm_a_[c] = cells[c].ws_gates;
+        gemm_b_[c] = cells[c].states_t_lm1;
+        gemm_c_[c] = cells[c].diff_w_input;
+    }
+    gemm(n_gates * x_size, s_size, active_batch, n_cells, gemm_a_, gemm_b_,
+            gemm_c_, true, 1.0f);
+
+    for (int c = 0; c < n_cells; c++) {
+        gemm_b_[c] = cells[c].states_tm1_l;
+        gemm_c_[c] = cells[c].diff_w_state;
+    }
+    gemm(n_gates * h_size, s_size, active_batch, n_cells, gemm_a_, gemm_b_,
+            gemm_c_, true, 1.0f);
 
-/// bwd by bias we just accumulate diffs from the gates
+    /// bwd by bias we just accumulate diffs from the gates, of all the
+    /// cells at once
 #if (_OPENMP == 201307)
-#pragma omp parallel for simd collapse(2)
+#pragma omp parallel for simd collapse(3)
 #else
-#pragma omp parallel for collapse(2) ///@todo block k on simd-width
+#pragma omp parallel for collapse(3) ///@todo block k on simd-width
 #endif
-    for (int i = 0; i < n_gates; i++)
-        for (int k = 0; k < s_size; k++)
-            for (int j = 0; j < batch; j++)
-                diff_bias_[i * s_size + k]
-                        += ws_gates_[(j * n_gates + i) * s_size + k];
+    for (int c = 0; c < n_cells; c++)
+        for (int i = 0; i < n_gates; i++)
+            for (int k = 0; k < s_size; k++) {
+                const float *ws_gates_ = cells[c].ws_gates;
+                float *diff_bias_ = cells[c].diff_bias;
+                for (int j = 0; j < cells[c].active_batch; j++)
+                    diff_bias_[i * s_size + k]
+                            += ws_gates_[(j * n_gates + i) * s_size + k];
+            }
 }
 
-//*************** Grid computations strategy: linear ***************//
+/* the rows of the batches of all the cells are split between the threads in
+ * a single parallel region: the cells of a step, the directions of a
+ * bidirectional layer in particular, run side by side each on its share of
+ * the threads rather than one after the other on all of them */
 template <prop_kind_t aprop>
-grid_execution_sig(_ref_rnn_common_t<aprop>::linear_execution) {
-    AOC<float, 4> ws_states(ws_states_, n_layer + 1, n_direction, n_iter + 1,
-            n_states * batch * s_size);
+void _ref_rnn_common_t<aprop>::elemwise_execution(int s_size, int batch,
+        int n_states, int n_gates, int n_cells, const rnn_cell_t *cells) {
+    const int work_amount = n_cells * batch;
+#pragma omp parallel num_threads(nstl::min(work_amount, omp_get_max_threads()))
+    {
+        int start{ 0 }, end{ 0 };
+        balance211(work_amount, omp_get_num_threads(), omp_get_thread_num(),
+                start, end);
+        while (start < end) {
+            const int c = start / batch;
+            const int mb_start = start % batch;
+            const int mb_end = nstl::min(batch, mb_start + end - start);
+            const rnn_cell_t &cell = cells[c];
+            const int mb_active = nstl::min(mb_end, cell.active_batch);
+            if (mb_start < mb_active)
+                (this->*elemwise_func)(s_size, batch, mb_start, mb_active,
+                        n_states, n_gates, cell.ws_gates, cell.states_t_l,
+                        cell.states_t_lm1, cell.states_tm1_l,
+                        cell.c_states_t_l, cell.c_states_tm1_l,
+                        cell.diff_states_t_l, cell.diff_states_t_lp1,
+                        cell.diff_states_tp1_l, cell.bias);
+
+            /* the sequences over: their states are carried through the cell
+             * in forward, their gates do not contribute to the diffs of the
+             * weights in backward */
+            const int mb_carried = nstl::max(mb_start, cell.active_batch);
+            for (int i = mb_carried; i < mb_end; i++) {
+                if (aprop == prop_kind::forward) {
+                    array_copy(cell.states_t_l + i * s_size,
+                            cell.states_tm1_l + i * s_size, s_size);
+                    if (cell.c_states_t_l)
+                        array_copy(cell.c_states_t_l + i * s_size,
+                                cell.c_states_tm1_l + i * s_size, s_size);
+                } else {
+                    array_set(cell.ws_gates + i * n_gates * s_size, 0.0f,
+                            n_gates * s_size);
+                }
+            }
+            start += mb_end - mb_start;
+        }
+    }
+}
+
+/* the diffs of the carried states go to the previous iteration unchanged,
+ * the ones of the input of the cell are zero */
+template <prop_kind_t aprop>
+void _ref_rnn_common_t<aprop>::copy_carried_diff_states(int s_size,
+        int batch, int n_states, int n_cells, const rnn_cell_t *cells) {
+    bool is_carried = false;
+    for (int c = 0; c < n_cells; c++)
+        is_carried = is_carried || cells[c].active_batch < batch;
+    if (!is_carried)
+        return;
+
+#pragma omp parallel for collapse(2)
+    for (int c = 0; c < n_cells; c++)
+        for (int i = 0; i < batch; i++) {
+            const rnn_cell_t &cell = cells[c];
+            if (i < cell.active_batch)
+                continue;
+            AOC<float, 3> diff_states_t_l(
+                    cell.diff_states_t_l, n_states + 1, batch, s_size);
+            AOC<const float, 3> diff_states_tp1_l(
+                    cell.diff_states_tp1_l, n_states + 1, batch, s_size);
+            for (int state = 0; state < n_states; state++)
+                array_copy(&diff_states_t_l(state, i, 0),
+                        &diff_states_tp1_l(state, i, 0), s_size);
+            array_set(&diff_states_t_l(n_states, i, 0), 0.0f, s_size);
+        }
+}
+
+template <prop_kind_t aprop>
+grid_cell_sig(_ref_rnn_common_t<aprop>::set_grid_cell) {
+    AOC<float, 5> ws_states(ws_states_, n_layer + 1, n_direction, n_states,
+            n_iter + 1, batch * s_size);
     AOC<float, 4> ws_diff_states(ws_diff_states_, n_layer + 1, n_direction,
             n_iter + 1, (n_states + 1) * batch * s_size);
     AOC<float, 4> ws_gates(
@@ -302,198 +560,151 @@ grid_execution_sig(_ref_rnn_common_t<aprop>::linear_execution) {
             h_size * n_gates * s_size);
     AOC<float, 3> diff_bias(diff_bias_, n_layer, n_direction, n_gates * s_size);
 
-    // We run the grid of computation
-    for (int dir = 0; dir < n_direction; dir++) {
-        for (int j = 0; j < n_layer; j++) {
-            for (int i = 0; i < n_iter; i++) {
-                int lay, iter;
-                if (aprop == prop_kind::forward) {
-                    lay = j;
-                    iter = i;
-                } else { // backward
-                    lay = n_layer - j - 1;
-                    iter = n_iter - i - 1;
-                }
-                cell_execution(s_size, x_size, h_size, batch, n_gates, n_states,
-                        &(ws_states(lay + 1, dir, iter + 1, 0)),
-                        &(ws_diff_states(lay, dir, iter, 0)),
-                        weights_input(lay, dir), weights_states(lay, dir),
-                        &(bias(lay, dir, 0)),
-                        &(ws_states(lay, dir, iter + 1, 0)),
-                        &(ws_states(lay + 1, dir, iter, 0)),
-                        &(ws_diff_states(lay + 1, dir, iter, 0)),
-                        &(ws_diff_states(lay, dir, iter + 1, 0)),
-                        &(diff_weights_layer(lay, dir, 0)),
-                        &(diff_weights_iter(lay, dir, 0)),
-                        &(diff_bias(lay, dir, 0)),
-                        &(ws_gates(lay, dir, iter, 0)));
-            }
-        }
-    }
+    cell.states_t_l = &(ws_states(lay + 1, dir, 0, iter + 1, 0));
+    cell.diff_states_t_l = &(ws_diff_states(lay, dir, iter, 0));
+    cell.w_input = weights_input(lay, dir);
+    cell.w_state = weights_states(lay, dir);
+    cell.bias = &(bias(lay, dir, 0));
+    cell.states_t_lm1 = &(ws_states(lay, dir, 0, iter + 1, 0));
+    cell.states_tm1_l = &(ws_states(lay + 1, dir, 0, iter, 0));
+    if (n_states > 1) {
+        cell.c_states_t_l = &(ws_states(lay + 1, dir, 1, iter + 1, 0));
+        cell.c_states_tm1_l = &(ws_states(lay + 1, dir, 1, iter, 0));
+    } else
+        cell.c_states_t_l = cell.c_states_tm1_l = nullptr;
+    cell.diff_states_t_lp1 = &(ws_diff_states(lay + 1, dir, iter, 0));
+    cell.diff_states_tp1_l = &(ws_diff_states(lay, dir, iter + 1, 0));
+    cell.diff_w_input = &(diff_weights_layer(lay, dir, 0));
+    cell.diff_w_state = &(diff_weights_iter(lay, dir, 0));
+    cell.diff_bias = &(diff_bias(lay, dir, 0));
+    cell.ws_gates = &(ws_gates(lay, dir, iter, 0));
+    cell.active_batch = active_batch(dir, iter);
 }
 
-#if 0
-//************* Grid computations strategy: wavefront **************//
-
-/*
-  // To cover n_iter > n_layer and n_iter < n_layer
-  min_dim = min(n_layer, n_iter)
-  max_dim = max(n_layer, n_iter)
-  and we assume that i refers to the max_dim dimension and j to the min_dim dimension
-
-  We compute the the wavefront using 3 loop nests, each nest having 2 loops:
-  - one for the head of the form loop on n_layer, and loop on n_elem in wave
-      for (int i = 0; i < min_dim - 1; i++)
-          for(int j = 0; j < i+1; j++)
-  - one for the body:
-      for (int i = 0; i < max_dim - min_dim + 1; i++)
-          for(int j = 0; j < min_dim; j++)
-  - one for the tail
-      for (int i = min_dim; i > 0 ; i--)
-          for(int j = 0; j < i; j++)
-  Here, we define classes for each of the wavefront direction to compute
-  the coordinates of the recurrent cells when running a wavefront execution
- */
+#define GRID_ARGS                                                          \
+    s_size, x_size, h_size, batch, n_layer, n_direction, n_iter, n_gates, \
+            n_states, weights_input_, weights_states_, bias_, ws_states_, \
+            ws_diff_states_, ws_gates_, diff_weights_layer_,              \
+            diff_weights_iter_, diff_bias_
 
-typedef enum wavefront_loop_index_ {
-    head,
-    body,
-    tail
-} wavefront_loop_index;
-
-struct wavefront_indexer {
-    wavefront_indexer(int dim)
-        : dim_(dim){};
-    virtual int get(wavefront_loop_index idx,int i, int j) const;
-protected:
-    int dim_;
-};
+//*************** Grid computations strategy: linear ***************//
+template <prop_kind_t aprop>
+grid_execution_sig(_ref_rnn_common_t<aprop>::linear_execution) {
+    AOC<float, 5> ws_states(ws_states_, n_layer + 1, n_direction, n_states,
+            n_iter + 1, batch * s_size);
+    AOC<float, 4> ws_gates(
+            ws_gates_, n_layer, n_direction, n_iter, n_gates * batch * s_size);
+    AOC<float *, 2> weights_input(weights_input_, n_layer, n_direction);
 
-// bottom to top or left to right maxdim
-struct wi_b2t_l2r_maxdim : wavefront_indexer {
-    int get(wavefront_loop_index idx, int i, int j) const override {
-        switch(idx){
-        case head: return i - j;
-        case body: return i - j;
-        case tail: return dim_ - 1 - j;
-        default: return -1;
+    // We run the grid of computation, the directions being independent the
+    // cells of all the directions at a given layer and iteration run together
+    for (int j = 0; j < n_layer; j++) {
+        if (aprop == prop_kind::forward) {
+            /* the inputs of a layer do not depend on its states: they are
+             * multiplied by the weights for all the iterations at once, with
+             * n = batch * n_iter as the h states of a layer are contiguous */
+            if (!conf_.with_seq_lengths()) {
+                for (int dir = 0; dir < n_direction; dir++) {
+                    gemm_a_[dir] = weights_input(j, dir);
+                    gemm_b_[dir] = &(ws_states(j, dir, 0, 1, 0));
+                    gemm_c_[dir] = &(ws_gates(j, dir, 0, 0));
+                }
+                (this->*gemm_input_func)(n_gates * s_size, batch * n_iter,
+                        x_size, n_direction, gemm_a_, gemm_b_, gemm_c_, false,
+                        0.0f);
+            } else {
+                /* only the rows of the sequences covering an iteration are
+                 * multiplied: the iterations with the same active batch run
+                 * together, in a single gemm when it is the full batch */
+                for (int dir = 0; dir < n_direction; dir++) {
+                    int i = 0;
+                    while (i < n_iter) {
+                        const int active_batch = this->active_batch(dir, i);
+                        int n_cells = 0;
+                        for (; i < n_iter
+                                && this->active_batch(dir, i) == active_batch;
+                                i++) {
+                            gemm_a_[n_cells] = weights_input(j, dir);
+                            gemm_b_[n_cells]
+                                    = &(ws_states(j, dir, 0, i + 1, 0));
+                            gemm_c_[n_cells] = &(ws_gates(j, dir, i, 0));
+                            n_cells++;
+                        }
+                        if (active_batch == 0)
+                            continue;
+                        if (active_batch == batch)
+                            (this->*gemm_input_func)(n_gates * s_size,
+                                    batch * n_cells, x_size, 1, gemm_a_,
+                                    gemm_b_, gemm_c_, false, 0.0f);
+                        else
+                            (this->*gemm_input_func)(n_gates * s_size,
+                                    active_batch, x_size, n_cells, gemm_a_,
+                                    gemm_b_, gemm_c_, false, 0.0f);
+                    }
+                }
+            }
+        }
+        for (int i = 0; i < n_iter; i++) {
+            int lay, iter;
+            if (aprop == prop_kind::forward) {
+                lay = j;
+                iter = i;
+            } else { // backward
+                lay = n_layer - j - 1;
+                iter = n_iter - i - 1;
+            }
+            for (int dir = 0; dir < n_direction; dir++)
+                set_grid_cell(cells_[dir], lay, dir, iter, GRID_ARGS);
+            cell_execution(s_size, x_size, h_size, batch, n_gates, n_states,
+                    n_direction, cells_);
         }
     }
-};
+}
 
-// bottom to top or left to right mindim
-struct wi_b2t_l2r_mindim : wavefront_indexer {
-    int get(wavefront_loop_index idx, int i , int j) const override {
-        switch(idx){
-        case head: return j;
-        case body: return j;
-        case tail: return dim_ - i + j;
-        default: return -1;
+//************* Grid computations strategy: wavefront **************//
+/* the cell (lay, iter) only depends on the cells (lay - 1, iter) and
+ * (lay, iter - 1) in forward, (lay + 1, iter) and (lay, iter + 1) in
+ * backward: the cells of an anti-diagonal lay + iter = d, of all the
+ * directions, are independent and run together, their gemms side by side on
+ * parts of the threads. A stack of layers with a small batch then keeps
+ * min(n_layer, n_iter) * n_direction cells in flight instead of n_direction.
+ *
+ * The forward multiplies the inputs of each cell by the weights in the step
+ * of the cell, as the outputs of the previous layer are not all computed
+ * before the layer starts. */
+template <prop_kind_t aprop>
+grid_execution_sig(_ref_rnn_common_t<aprop>::wavefront_execution) {
+    for (int d = 0; d < n_layer + n_iter - 1; d++) {
+        int n_cells = 0;
+        const int j_start = nstl::max(0, d - n_iter + 1);
+        const int j_end = nstl::min(n_layer, d + 1);
+        for (int j = j_start; j < j_end; j++) {
+            int lay = j, iter = d - j;
+            if (aprop == prop_kind::backward) {
+                lay = n_layer - lay - 1;
+                iter = n_iter - iter - 1;
+            }
+            for (int dir = 0; dir < n_direction; dir++)
+                set_grid_cell(cells_[n_cells++], lay, dir, iter, GRID_ARGS);
         }
-    }
-};
 
-template<typename original_indexer>
-struct reversed_indexer : wavefront_indexer {
-    reversed_indexer(int dim) : wavefront_indexer(dim),
-                                wd(original_indexer(dim)){}
-
-    int get(wavefront_loop_index idx, int i, int j) const override {
-        switch(idx){
-        case head: return dim_ - 1 - wd.head(i,j);
-        case body: return dim_ - 1 - wd.body(i,j);
-        case tail: return dim_ - 1 - wd.tail(i,j);
-        default: return -1;
+        const int active_batch = max_active_batch(n_cells, cells_);
+        if (aprop == prop_kind::forward && active_batch > 0) {
+            for (int c = 0; c < n_cells; c++) {
+                gemm_a_[c] = cells_[c].w_input;
+                gemm_b_[c] = cells_[c].states_t_lm1;
+                gemm_c_[c] = cells_[c].ws_gates;
+            }
+            (this->*gemm_input_func)(n_gates * s_size, active_batch, x_size,
+                    n_cells, gemm_a_, gemm_b_, gemm_c_, false, 0.0f);
         }
+        cell_execution(s_size, x_size, h_size, batch, n_gates, n_states,
+                n_cells, cells_);
     }
-    
-private:
-    original_indexer wd;
-};
+}
 
-// top to bottom or right left maxdim and mindim
-using wi_t2b_r2l_maxdim = reversed_indexer<wi_b2t_l2r_maxdim>;
-using wi_t2b_r2l_mindim = reversed_indexer<wi_b2t_l2r_mindim>;
-
-template<prop_kind_t aprop>
-grid_execution_sig(_ref_rnn_common_t<aprop>::wavefront_execution){// (int s_size, int x_size,
-                         // int h_size, int batch,
-                         // int n_layer, int n_direction, int n_iter,
-                         // int n_gates, int n_states,
-                         // const float **weights_input_, //[n_gates*s_size][x_size],
-                         // const float **weights_states_, //[n_gates*s_size][s_size],
-                         // const float *bias_, //[n_gates][s_size],
-                         // float *ws_, //[n_layer+1][n_direction][n_iter+1][n_states][batch][s_size],
-                         // float *gates_){ //[n_layer][n_direction][n_iter][batch][n_gates][s_size]) {
-
-    AOC<float, 4> ws(ws_, n_layer + 1, n_direction, n_iter + 1, n_states * batch * s_size);
-    AOC<float, 4> gates(gates_, n_layer, n_direction, n_iter, n_gates * batch * s_size);
-    AOC<float*, 2> weights_input(weights_input_, n_layer, n_direction);
-    AOC<float*, 2> weights_states(weights_states_, n_layer, n_direction);
-    AOC<const float, 2> bias(bias_, n_layer, n_gates * s_size);
-    // Setup the indexers: we have to check directions and if max_dim or min_dim
-    bool is_niter_maxdim = n_iter >= n_layer;
-    wavefront_indexer wi_maxdim = (is_niter_maxdim)
-        ? (((exec_dir == b2t_l2r) || (exec_dir == t2b_l2r)) //niter is maxdim, we look for l2r
-           ? (wavefront_indexer) wi_b2t_l2r_maxdim(n_iter)
-           : (wavefront_indexer) wi_t2b_r2l_maxdim(n_iter))
-        : (((exec_dir == b2t_l2r) || (exec_dir == b2t_r2l)) //nlayer is maxdim, we look for b2t
-           ? (wavefront_indexer) wi_b2t_l2r_maxdim(n_layer)
-           : (wavefront_indexer) wi_t2b_r2l_maxdim(n_layer));
-    
-    wavefront_indexer wi_mindim = (!is_niter_maxdim)
-        ? (((exec_dir == b2t_l2r) || (exec_dir == t2b_l2r)) //niter is mindim, we look for l2r
-           ? (wavefront_indexer) wi_b2t_l2r_mindim(n_iter)
-           : (wavefront_indexer) wi_t2b_r2l_mindim(n_iter))
-        : (((exec_dir == b2t_l2r) || (exec_dir == b2t_r2l)) //nlayer is mindim, we look for b2t
-           ? (wavefront_indexer) wi_b2t_l2r_mindim(n_layer)
-           : (wavefront_indexer) wi_t2b_r2l_mindim(n_layer));
-    
-    // auto get_offset = [=](wavefront_loop_index idx, int i, int j){
-    //     int dim_min = wi_mindim.get(idx, i,j);
-    //     int dim_max = wi_maxdim.get(idx, i,j);
-    //     int offset = (is_niter_maxdim)
-    //     ? dim_min*n_iter + dim_max
-    //     : dim_max*n_iter + dim_min;
-    // };
-
-#define get_lay_n_iter(idx, i, j)               \
-    do {                                        \
-        int dim_min = wi_mindim.get(idx, i, j); \
-        int dim_max = wi_maxdim.get(idx, i, j); \
-        if (is_niter_maxdim) {                  \
-            lay = dim_min;                      \
-            iter = dim_max;                     \
-        } else {                                \
-            lay = dim_max;                      \
-            iter = dim_min;                     \
-        }                                       \
-    } while (0)
-
-    int min_dim = is_niter_maxdim ? n_layer : n_iter;
-    int max_dim = is_niter_maxdim ? n_iter :n_layer;
-    int lay, iter;
-    for (int i = 0; i < min_dim - 1; i++)
-        for(int j = 0; j < i+1; j++){
-            get_lay_n_iter(head,i,j);
-            cell_execution(s_size, x_size, h_size, batch,
-                 n_gates, n_states,
-                 &(ws(lay, iter, 0)), weights_input(lay - 1, 0),
-                 weights_states(lay - 1, 0), &(bias(lay-1, 0)),
-                 &(ws(lay - 1, iter, 0)), &(ws(lay, iter - 1, 0)), &(gates(lay-1, iter-1, 0)));
-        }
-    for (int i = min_dim - 1; i < max_dim; i++)
-        for(int j = 0; j < min_dim; j++){
-            get_lay_n_iter(body,i,j);
-        }
-    for (int i = min_dim - 1; i > 0 ; i--)
-        for(int j = 0; j < i; j++){
-            get_lay_n_iter(tail,i,j);
-        }
+#undef GRID_ARGS
 
-#undef get_lay_n_iter
-}
-#endif
 //********* GRID computations strategy: utility functions **********//
 
 template <>
@@ -501,18 +712,20 @@ void _ref_rnn_common_t<prop_kind::forward>::copy_init_layer(bool lr, bool rl,
         int n_layer, int n_direction, int n_iter, int batch, int x_size,
         int n_states, float *ws_states_, float *ws_diff_states_,
         const float *xt_, const float *diff_dst_layer_) {
-    AOC<float, 3> ws_states(
-            ws_states_, n_direction, n_iter + 1, n_states * batch * x_size);
+    AOC<float, 5> ws_states(
+            ws_states_, n_direction, n_states, n_iter + 1, batch, x_size);
     auto xt_d = memory_desc_wrapper(conf_.src_pd(0));
 
-#pragma omp parallel for
+#pragma omp parallel for collapse(2)
     for (int it = 0; it < n_iter; it++) {
-        auto xxt = xt_ + xt_d.blk_off(it);
-        if (lr)
-            array_copy(&(ws_states(0, it + 1, 0)), xxt, batch * x_size);
-        if (rl)
-            array_copy(&(ws_states(n_direction - 1, n_iter - it, 0)), xxt,
-                    batch * x_size);
+        for (int b = 0; b < batch; b++) {
+            auto xxt = xt_ + xt_d.blk_off(it, seq_order_[b]);
+            if (lr)
+                array_copy(&(ws_states(0, 0, it + 1, b, 0)), xxt, x_size);
+            if (rl)
+                array_copy(&(ws_states(n_direction - 1, 0, n_iter - it, b, 0)),
+                        xxt, x_size);
+        }
     }
 }
 
@@ -530,12 +743,12 @@ void _ref_rnn_common_t<prop_kind::backward>::copy_init_layer(bool lr, bool rl,
 #pragma omp parallel for collapse(2)
         for (int it = 0; it < n_iter; it++) {
             for (int b = 0; b < batch; b++) {
-                auto diff_dst_layer_x
-                        = diff_dst_layer_ + diff_dst_layer_d.blk_off(it, b);
+                auto diff_dst_layer_x = diff_dst_layer_
+                        + diff_dst_layer_d.blk_off(it, seq_order_[b]);
                 for (int s = 0; s < x_size; s++) {
                     ws_diff_states(n_layer, 0, it, n_states, b, s)
                             = diff_dst_layer_x[s];
-                    ws_diff_states(n_layer, 1, it, n_states, b, s)
+                    ws_diff_states(n_layer, 1, n_iter - 1 - it, n_states, b, s)
                             = diff_dst_layer_x[x_size + s];
                 }
             }
@@ -545,12 +758,12 @@ void _ref_rnn_common_t<prop_kind::backward>::copy_init_layer(bool lr, bool rl,
 #pragma omp parallel for collapse(2)
         for (int it = 0; it < n_iter; it++) {
             for (int b = 0; b < batch; b++) {
-                auto diff_dst_layer_x
-                        = diff_dst_layer_ + diff_dst_layer_d.blk_off(it, b);
+                auto diff_dst_layer_x = diff_dst_layer_
+                        + diff_dst_layer_d.blk_off(it, seq_order_[b]);
                 for (int s = 0; s < x_size; s++) {
                     ws_diff_states(n_layer, 0, it, n_states, b, s)
                             = diff_dst_layer_x[s];
-                    ws_diff_states(n_layer, 1, it, n_states, b, s)
+                    ws_diff_states(n_layer, 1, n_iter - 1 - it, n_states, b, s)
                             = diff_dst_layer_x[s];
                 }
             }
@@ -560,10 +773,11 @@ void _ref_rnn_common_t<prop_kind::backward>::copy_init_layer(bool lr, bool rl,
 #pragma omp parallel for collapse(2)
         for (int it = 0; it < n_iter; it++) {
             for (int b = 0; b < batch; b++) {
-                auto diff_dst_layer_x
-                        = diff_dst_layer_ + diff_dst_layer_d.blk_off(it, b);
+                auto diff_dst_layer_x = diff_dst_layer_
+                        + diff_dst_layer_d.blk_off(it, seq_order_[b]);
+                const int iter = lr ? it : n_iter - 1 - it;
                 for (int s = 0; s < x_size; s++) {
-                    ws_diff_states(n_layer, 0, it, n_states, b, s)
+                    ws_diff_states(n_layer, 0, iter, n_states, b, s)
                             = diff_dst_layer_x[s];
                 }
             }
@@ -577,19 +791,30 @@ void _ref_rnn_common_t<prop_kind::forward>::copy_init_iter(int n_layer,
         int n_direction, int n_states, int batch, int h_size, int n_iter,
         float *ws_states_, float *ws_diff_states_, const float *firstit_states_,
         const float *diff_dst_iter_) {
-    AOC<float, 6> ws_states(ws_states_, n_layer + 1, n_direction, n_iter + 1,
-            n_states, batch, h_size);
+    AOC<float, 6> ws_states(ws_states_, n_layer + 1, n_direction, n_states,
+            n_iter + 1, batch, h_size);
     auto firstit_states_d = memory_desc_wrapper(conf_.src_pd(1));
-    if (firstit_states_) {
+    if (conf_.is_stateful()) {
+        AOC<const float, 5> states(
+                states_, n_layer, n_direction, n_states, batch, h_size);
+#pragma omp parallel for collapse(2)
+        for (int lay = 0; lay < n_layer; lay++)
+            for (int dir = 0; dir < n_direction; dir++)
+                for (int state = 0; state < n_states; state++)
+                    for (int b = 0; b < batch; ++b)
+                        array_copy(&(ws_states(lay + 1, dir, state, 0, b, 0)),
+                                &(states(lay, dir, state, seq_order_[b], 0)),
+                                h_size);
+    } else if (firstit_states_) {
 #pragma omp parallel for collapse(2)
         for (int lay = 0; lay < n_layer; lay++)
             for (int dir = 0; dir < n_direction; dir++)
                 for (int state = 0; state < n_states; state++)
                     for (int b = 0; b < batch; ++b) {
-                        array_copy(&(ws_states(lay + 1, dir, 0, state, b, 0)),
+                        array_copy(&(ws_states(lay + 1, dir, state, 0, b, 0)),
                                 firstit_states_
-                                        + firstit_states_d.blk_off(
-                                                  lay, dir, state, b),
+                                        + firstit_states_d.blk_off(lay, dir,
+                                                  state, seq_order_[b]),
                                 h_size);
                     }
     } else {
@@ -599,7 +824,7 @@ void _ref_rnn_common_t<prop_kind::forward>::copy_init_iter(int n_layer,
                 for (int state = 0; state < n_states; state++)
                     for (int i = 0; i < batch; i++)
                         for (int j = 0; j < h_size; j++)
-                            ws_states(lay + 1, dir, 0, state, i, j) = 0.0f;
+                            ws_states(lay + 1, dir, state, 0, i, j) = 0.0f;
     }
 }
 
@@ -620,8 +845,8 @@ void _ref_rnn_common_t<prop_kind::backward>::copy_init_iter(int n_layer,
                         array_copy(&(ws_diff_states(
                                            lay, dir, n_iter, state, b, 0)),
                                 diff_dst_iter_
-                                        + diff_dst_iter_d.blk_off(
-                                                  lay, dir, state, b),
+                                        + diff_dst_iter_d.blk_off(lay, dir,
+                                                  state, seq_order_[b]),
                                 h_size);
                     }
     } else {
@@ -645,27 +870,37 @@ void _ref_rnn_common_t<prop_kind::forward>::copy_res_layer(bool lr, bool rl,
         const float *ws_diff_states_) {
     auto dst_layer_d = memory_desc_wrapper(conf_.dst_pd(0));
     AOC<const float, 6> ws_states(ws_states_, n_layer + 1, n_direction,
-            n_iter + 1, n_states, batch, s_size);
+            n_states, n_iter + 1, batch, s_size);
+    /* the iterations past the ones run are past the end of all the
+     * sequences */
 #pragma omp parallel for collapse(2)
-    for (int it = 0; it < n_iter; it++) {
+    for (int it = 0; it < conf_.T(); it++) {
         for (int b = 0; b < batch; b++) {
+            const int ob = seq_order_[b];
+            if (it >= seq_lengths_[b]) {
+                // past the end of the sequence
+                for (int s = 0; s < n_output_features * s_size; s++)
+                    dst_layer_[dst_layer_d.blk_off(it, ob, s)] = 0.0f;
+                continue;
+            }
             int dir = 0;
             if (lr) {
                 for (int s = 0; s < s_size; s++)
-                    dst_layer_[dst_layer_d.blk_off(it, b, dir * s_size + s)]
-                            = ws_states(n_layer, dir, it + 1, 0, b, s);
+                    dst_layer_[dst_layer_d.blk_off(it, ob, dir * s_size + s)]
+                            = ws_states(n_layer, dir, 0, it + 1, b, s);
                 dir = 1;
             }
             if (rl) {
                 for (int s = 0; s < s_size; s++)
                     switch (direction) {
                     case mkldnn_bidirectional_sum:
-                        dst_layer_[dst_layer_d.blk_off(it, b, s)] += ws_states(
-                                n_layer, dir, n_iter - it, 0, b, s);
+                        dst_layer_[dst_layer_d.blk_off(it, ob, s)] += ws_states(
+                                n_layer, dir, 0, n_iter - it, b, s);
                         break;
                     default:
-                        dst_layer_[dst_layer_d.blk_off(it, b, dir * s_size + s)]
-                                = ws_states(n_layer, dir, n_iter - it, 0, b, s);
+                        dst_layer_[dst_layer_d.blk_off(
+                                it, ob, dir * s_size + s)]
+                                = ws_states(n_layer, dir, 0, n_iter - it, b, s);
                     }
             }
         }
@@ -693,7 +928,7 @@ void _ref_rnn_common_t<prop_kind::backward>::copy_res_layer(bool lr, bool rl,
                                           == mkldnn_unidirectional_right2left) ?
                                           n_iter - 1 - it :
                                           it,
-                                  b, dir * s_size + s);
+                                  seq_order_[b], dir * s_size + s);
                 float res = ws_diff_states(0, 0, it, n_states, b, s);
                 if (n_direction - 1)
                     res += ws_diff_states(
@@ -711,17 +946,29 @@ void _ref_rnn_common_t<prop_kind::forward>::copy_res_iter(int n_layer,
         const float *ws_diff_states_) {
     auto dst_iter_d = memory_desc_wrapper(conf_.dst_pd(1));
     AOC<const float, 6> ws_states(ws_states_, n_layer + 1, n_direction,
-            n_iter + 1, n_states, batch, s_size);
-    if (dst_iter_) {
+            n_states, n_iter + 1, batch, s_size);
+    if (conf_.is_stateful()) {
+        AOC<float, 5> states(
+                states_, n_layer, n_direction, n_states, batch, s_size);
+#pragma omp parallel for collapse(4)
+        for (int lay = 0; lay < n_layer; lay++)
+            for (int dir = 0; dir < n_direction; dir++)
+                for (int state = 0; state < n_states; state++)
+                    for (int b = 0; b < batch; b++)
+                        array_copy(&(states(lay, dir, state, seq_order_[b], 0)),
+                                &(ws_states(lay + 1, dir, state, n_iter, b, 0)),
+                                s_size);
+    } else if (dst_iter_) {
 #pragma omp parallel for collapse(4)
         for (int lay = 0; lay < n_layer; lay++) {
             for (int dir = 0; dir < n_direction; dir++)
                 for (int state = 0; state < n_states; state++)
                     for (int b = 0; b < batch; b++)
                         for (int s = 0; s < s_size; s++) {
-                            dst_iter_[dst_iter_d.blk_off(lay, dir, state, b, s)]
+                            dst_iter_[dst_iter_d.blk_off(
+                                    lay, dir, state, seq_order_[b], s)]
                                     = ws_states(
-                                            lay + 1, dir, n_iter, state, b, s);
+                                            lay + 1, dir, state, n_iter, b, s);
                         }
         }
     }
@@ -743,7 +990,7 @@ void _ref_rnn_common_t<prop_kind::backward>::copy_res_iter(int n_layer,
                     for (int b = 0; b < batch; b++)
                         for (int s = 0; s < s_size; s++) {
                             diff_src_iter_[diff_src_iter_d.blk_off(
-                                    lay, dir, state, b, s)]
+                                    lay, dir, state, seq_order_[b], s)]
                                     = ws_diff_states(lay, dir, 0, state, b, s);
                         }
         }
@@ -779,6 +1026,36 @@ packing_sig(_ref_rnn_common_t<aprop>::pack_weights) {
                     &(w(i, d, 0)), ldA, weights(i, d));
         }
     }
+#elif !defined(USE_CBLAS)
+    /* the weights are packed as the A of the non packed gemm, i.e. m x k
+     * with lda = m in both directions */
+    UNUSED(n_weights);
+    UNUSED(batch);
+    AOC<const float, 3> w(
+            w_, n_layer, n_direction, n_gates * OC_size * IC_size);
+    AOC<float *, 2> weights(weights_, n_layer, n_direction);
+    int m = 0, k = 0;
+    if (aprop == prop_kind::forward) {
+        m = n_gates * OC_size;
+        k = IC_size;
+    }
+    if (aprop == prop_kind::backward) {
+        m = IC_size;
+        k = n_gates * OC_size;
+    }
+    for (int i = 0; i < n_layer; i++) {
+        for (int d = 0; d < n_direction; d++) {
+            if (avx512_sgemm_[0])
+                weights(i, d) = jit_sgemm_pack<jit_avx512_common_gemm_f32>(
+                        m, k, &(w(i, d, 0)));
+            else if (avx2_sgemm_[0])
+                weights(i, d) = jit_sgemm_pack<jit_avx2_gemm_f32>(
+                        m, k, &(w(i, d, 0)));
+            else
+                weights(i, d) = jit_sgemm_pack<jit_sse42_gemm_f32>(
+                        m, k, &(w(i, d, 0)));
+        }
+    }
 #else
     UNUSED(n_layer);
     UNUSED(n_direction);
@@ -805,12 +1082,34 @@ packing_sig(_ref_rnn_common_t<aprop>::no_pack_weights) {
     }
 }
 
+/* the pointers are to f16 weights, gemm_f16 is the only one to use them */
+template <prop_kind_t aprop>
+packing_sig(_ref_rnn_common_t<aprop>::no_pack_weights_f16) {
+    AOC<const float16_t, 3> w(reinterpret_cast<const float16_t *>(w_),
+            n_layer, n_direction, n_gates * OC_size * IC_size);
+    AOC<float *, 2> weights(weights_, n_layer, n_direction);
+    for (int i = 0; i < n_layer; i++) {
+        for (int d = 0; d < n_direction; d++) {
+            weights(i, d) = (float *)&(w(i, d, 0));
+        }
+    }
+}
+
 template <prop_kind_t aprop>
 free_packed_sig(_ref_rnn_common_t<aprop>::free_packed_weights) {
 #if USE_MKL_PACKED_GEMM
     for (int i = 0; i < n_layer; i++) {
         cblas_sgemm_free(weights_[i]);
     }
+#elif !defined(USE_CBLAS)
+    for (int i = 0; i < n_layer * conf_.D(); i++) {
+        if (avx512_sgemm_[0])
+            jit_avx512_common_gemm_f32::sgemm_pack_free(weights_[i]);
+        else if (avx2_sgemm_[0])
+            jit_avx2_gemm_f32::sgemm_pack_free(weights_[i]);
+        else
+            jit_sse42_gemm_f32::sgemm_pack_free(weights_[i]);
+    }
 #else
     UNUSED(n_layer);
     UNUSED(weights_);
@@ -824,6 +1123,50 @@ free_packed_sig(_ref_rnn_common_t<aprop>::free_no_packed_weights) {
     UNUSED(weights_);
 }
 
+/* the batch of the workspace is the one of the user sorted by decreasing
+ * length of the sequences, stable, the lengths clamped to [0, n_iter] */
+template <prop_kind_t aprop>
+void _ref_rnn_common_t<aprop>::set_seq_lengths(const int *seq_lengths) {
+    const int n_iter = conf_.T();
+    const int batch = conf_.MB();
+    auto length = [&](int b) {
+        return nstl::max(0, nstl::min(n_iter, seq_lengths[b]));
+    };
+
+    int row = 0;
+    for (int len = n_iter; len >= 0; len--)
+        for (int b = 0; b < batch; b++)
+            if (length(b) == len) {
+                seq_order_[row] = b;
+                seq_lengths_[row] = len;
+                row++;
+            }
+
+    int active_batch = 0;
+    for (int iter = n_iter - 1; iter >= 0; iter--) {
+        while (active_batch < batch && seq_lengths_[active_batch] > iter)
+            active_batch++;
+        active_batch_[iter] = active_batch;
+    }
+}
+
+template <prop_kind_t aprop>
+status_t _ref_rnn_common_t<aprop>::reset_states(int mb_begin, int mb_end) {
+    const int batch = conf_.MB();
+    bool args_ok = true && conf_.is_stateful() && 0 <= mb_begin
+            && mb_begin <= mb_end && mb_end <= batch;
+    if (!args_ok)
+        return status::invalid_arguments;
+
+    const int s_size = conf_.DIC();
+    AOC<float, 3> states(
+            states_, conf_.L() * conf_.D() * conf_.S(), batch, s_size);
+    for (int i = 0; i < conf_.L() * conf_.D() * conf_.S(); i++)
+        array_set(&states(i, mb_begin, 0), 0.0f,
+                (size_t)(mb_end - mb_begin) * s_size);
+    return status::success;
+}
+
 //********************* Execution function *********************//
 template <prop_kind_t aprop>
 void _ref_rnn_common_t<aprop>::execute_() {
@@ -889,6 +1232,17 @@ void _ref_rnn_common_t<aprop>::execute_() {
         ws_diff_states_ = ws_ptr + ws_diff_states_offset_;
     }
 
+    auto seq_lengths = conf_.with_seq_lengths() ?
+            reinterpret_cast<const int *>(this->input_memory(input_idx++)) :
+            nullptr;
+    if (seq_lengths) {
+        set_seq_lengths(seq_lengths);
+        /* the left to right inference stops at the end of the longest
+         * sequence, the workspace is then laid out for the iterations run */
+        if (conf_.desc()->prop_kind == forward_inference && exec_dir == b2t_l2r)
+            n_iter = seq_lengths_[0];
+    }
+
     auto diff_src_layer = is_fwd ?
             nullptr :
             reinterpret_cast<float *>(this->memory(output_idx++));
@@ -926,10 +1280,11 @@ void _ref_rnn_common_t<aprop>::execute_() {
             ws_states_, ws_diff_states_, states, diff_dst_iter);
 
     // run the execution on the grid
-    (this->*grid_computation)(s_size, x_size, h_size, batch, n_layer,
-            n_direction, n_iter, n_gates, n_states, ptr_wei_input_,
-            ptr_wei_state_, (float *)bias, ws_states_, ws_diff_states_,
-            ws_gates_, diff_weights_layer, diff_weights_iter, diff_bias);
+    if (n_iter > 0)
+        (this->*grid_computation)(s_size, x_size, h_size, batch, n_layer,
+                n_direction, n_iter, n_gates, n_states, ptr_wei_input_,
+                ptr_wei_state_, (float *)bias, ws_states_, ws_diff_states_,
+                ws_gates_, diff_weights_layer, diff_weights_iter, diff_bias);
 
     // Finally we copy the results to the result buffers
     copy_res_layer(is_lr, is_rl, n_layer, n_direction, n_iter, batch,
@@ -22,6 +22,12 @@
 #include "c_types_map.hpp"
 #include "cpu_engine.hpp"
 #include "cpu_rnn_pd.hpp"
+#include "jit_avx2_cvt_f16.hpp"
+#include "jit_avx2_gemm_f32.hpp"
+#include "jit_avx512_common_gemm_f32.hpp"
+#include "jit_small_gemm_f32.hpp"
+#include "jit_uni_rnn_elemwise.hpp"
+#include "jit_sse42_gemm_f32.hpp"
 #include "scratchpad.hpp"
 #include "type_helpers.hpp"
 #include "utils.hpp"
@@ -32,20 +38,42 @@ namespace mkldnn {
 namespace impl {
 namespace cpu {
 
+/* the elementwise functions compute the rows [mb_start, mb_end) of the batch
+ * of a cell, the threading is done by the caller */
 #define elemwise_sig(f)                                                        \
-    void f(int s_size, int batch, int n_states, int n_gates, float *ws_gates_, \
-            float *states_t_l_, float *states_t_lm1_, float *states_tm1_l_,    \
-            float *diff_states_t_l_, float *diff_states_t_lp1_,                \
-            float *diff_states_tp1_l_, const float *bias_)
-
-#define cell_execution_sig(f)                                                 \
-    void f(int s_size, int x_size, int h_size, int batch, int n_gates,        \
-            int n_states, float *states_t_l_, float *diff_states_t_l_,        \
-            const float *w_input_, const float *w_state_, const float *bias_, \
-            float *states_t_lm1_, float *states_tm1_l_,                       \
-            float *diff_states_t_lp1_, float *diff_states_tp1_l_,             \
-            float *diff_w_input_, float *diff_w_state_, float *diff_bias_,    \
-            float *ws_gates_)
+    void f(int s_size, int batch, int mb_start, int mb_end, int n_states,      \
+            int n_gates, float *ws_gates_, float *states_t_l_,                 \
+            float *states_t_lm1_, float *states_tm1_l_, float *c_states_t_l_,  \
+            float *c_states_tm1_l_, float *diff_states_t_l_,                   \
+            float *diff_states_t_lp1_, float *diff_states_tp1_l_,              \
+            const float *bias_)
+
+/* the pointers of a cell of the grid: the cells of a same step of the grid
+ * are independent and run together, so that their gemms are batched */
+struct rnn_cell_t {
+    float *states_t_l;
+    float *diff_states_t_l;
+    const float *w_input;
+    const float *w_state;
+    const float *bias;
+    float *states_t_lm1;
+    float *states_tm1_l;
+    float *c_states_t_l; // the c states of lstm
+    float *c_states_tm1_l;
+    float *diff_states_t_lp1;
+    float *diff_states_tp1_l;
+    float *diff_w_input;
+    float *diff_w_state;
+    float *diff_bias;
+    float *ws_gates;
+    /* the rows [0, active_batch) of the batch are the sequences that cover
+     * the cell, the states of the other ones are carried through it */
+    int active_batch;
+};
+
+#define cell_execution_sig(f)                                          \
+    void f(int s_size, int x_size, int h_size, int batch, int n_gates, \
+            int n_states, int n_cells, const rnn_cell_t *cells)
 
 #define grid_execution_sig(f)                                              \
     void f(int s_size, int x_size, int h_size, int batch, int n_layer,     \
@@ -55,9 +83,19 @@ namespace cpu {
             float *ws_gates_, float *diff_weights_layer_,                  \
             float *diff_weights_iter_, float *diff_bias_)
 
-#define gemm_sig(f)                                                    \
-    void f(int m, int n, int k, const float *a_, float *b_, float *c_, \
-            bool is_B_trans, float beta)
+/* the pointers of the cell (lay, iter) of the direction dir of the grid */
+#define grid_cell_sig(f)                                                   \
+    void f(rnn_cell_t &cell, int lay, int dir, int iter, int s_size,       \
+            int x_size, int h_size, int batch, int n_layer,                \
+            int n_direction, int n_iter, int n_gates, int n_states,        \
+            float **weights_input_, float **weights_states_,               \
+            const float *bias_, float *ws_states_, float *ws_diff_states_, \
+            float *ws_gates_, float *diff_weights_layer_,                  \
+            float *diff_weights_iter_, float *diff_bias_)
+
+#define gemm_sig(f)                                                \
+    void f(int m, int n, int k, int n_cells, const float **a_,     \
+            const float **b_, float **c_, bool is_B_trans, float beta)
 
 #define packing_sig(f)                                               \
     void f(int n_layer, int n_direction, int n_weights, int n_gates, \
@@ -111,7 +149,7 @@ struct _ref_rnn_common_t : public cpu_primitive_t {
 
             bool ok = true
 #if !defined(USE_CBLAS)
-                    && false
+                    && mayiuse(sse42)
 #endif
                     && one_of(cell_kind, alg_kind::vanilla_rnn,
                                alg_kind::vanilla_lstm, alg_kind::vanilla_gru)
@@ -132,6 +170,41 @@ struct _ref_rnn_common_t : public cpu_primitive_t {
                     && this->desc()->dst_layer_desc.format == tnc;
 
             ok = ok && this->with_bias();
+
+            ok = ok && implication(this->with_seq_lengths(),
+                               this->seq_lengths_pd_.desc()->format == x);
+
+            /* the states are kept in the order of the user batch, the
+             * directions not running left to right need the whole
+             * sequences */
+            ok = ok && implication(this->is_stateful(), true
+                               && this->desc()->prop_kind == forward_inference
+                               && this->direction()
+                                       == mkldnn_unidirectional_left2right
+                               && !this->with_src_iter()
+                               && !this->with_dst_iter());
+
+            /* the weights may be stored in f16 for inference, they are
+             * widened block by block for the f32 gemm */
+            const data_type_t wei_dt = this->desc()->weights_layer_desc.data_type;
+            ok = ok
+                    && everyone_is(data_type::f32,
+                               this->desc()->src_layer_desc.data_type,
+                               this->desc()->dst_layer_desc.data_type,
+                               this->desc()->bias_desc.data_type)
+                    && implication(this->with_src_iter(), data_type::f32
+                               == this->desc()->src_iter_desc.data_type)
+                    && implication(this->with_dst_iter(), data_type::f32
+                               == this->desc()->dst_iter_desc.data_type)
+                    && one_of(wei_dt, data_type::f32, data_type::f16)
+                    && this->desc()->weights_iter_desc.data_type == wei_dt
+                    && implication(wei_dt == data_type::f16, true
+                               && aprop == prop_kind::forward
+                               && jit_avx2_cvt_f16_to_f32::is_applicable()
+                               && this->desc()->weights_layer_desc.format
+                                       == ldigo
+                               && this->desc()->weights_iter_desc.format
+                                       == ldigo);
             switch (aprop) {
             case (prop_kind::forward):
                 ok = ok && utils::one_of(this->desc()->prop_kind,
@@ -189,21 +262,128 @@ struct _ref_rnn_common_t : public cpu_primitive_t {
                          &class_name::free_no_packed_weights;
         };
 
+        for (int i = 0; i < n_sgemms; ++i) {
+            avx512_sgemm_[i] = nullptr;
+            avx2_sgemm_[i] = nullptr;
+            sse42_sgemm_[i] = nullptr;
+            small_sgemm_[i] = nullptr;
+        }
+        /* the linear execution runs the cells of a layer and an iteration,
+         * one per direction, at a time. When their gemms are too small for
+         * all the threads, the layers of a stack run as a wavefront instead:
+         * the cells of an anti-diagonal of the grid run together. The
+         * threshold is the one under which the jit sgemms run the gemms of
+         * a batch side by side. */
+        const int nthr = omp_get_max_threads();
+        const double min_work_per_thr = 1 << 20;
+        const double step_work = (double)conf_.G() * conf_.DIC() * conf_.MB()
+                * conf_.DIC() * conf_.D();
+        const bool is_wavefront = conf_.L() > 1 && conf_.T() > 1
+                && nthr > conf_.D() && step_work < nthr * min_work_per_thr;
+        grid_computation = is_wavefront ? &class_name::wavefront_execution :
+                                          &class_name::linear_execution;
+
+#if !defined(USE_CBLAS)
+        const char sgemm_transb[n_sgemms] = { 'N', 'N', 'T' };
+        const float sgemm_beta[n_sgemms] = { 0.0f, 1.0f, 1.0f };
+        for (int i = 0; i < n_sgemms; ++i) {
+            if (mayiuse(avx512_common))
+                avx512_sgemm_[i] = new jit_avx512_common_gemm_f32(
+                        'N', sgemm_transb[i], sgemm_beta[i], false);
+            else if (mayiuse(avx2))
+                avx2_sgemm_[i] = new jit_avx2_gemm_f32(
+                        'N', sgemm_transb[i], sgemm_beta[i], false);
+            else
+                sse42_sgemm_[i] = new jit_sse42_gemm_f32(
+                        'N', sgemm_transb[i], sgemm_beta[i], false);
+        }
+
+        /* the m, n and k of the gemms of the cells, the small ones get a
+         * kernel generated for their shape */
+        const int G = conf_.G(), MB = conf_.MB(), SLC = conf_.SLC(),
+              DIC = conf_.DIC();
+        int sgemm_dims[n_sgemms][3] = { { 0 } };
+        if (aprop == prop_kind::forward) {
+            sgemm_dims[sgemm_nn_beta0][0] = G * DIC; // input
+            sgemm_dims[sgemm_nn_beta0][1] = is_wavefront ? MB : MB * conf_.T();
+            sgemm_dims[sgemm_nn_beta0][2] = SLC;
+            sgemm_dims[sgemm_nn_beta1][0] = G * DIC; // state
+            sgemm_dims[sgemm_nn_beta1][1] = MB;
+            sgemm_dims[sgemm_nn_beta1][2] = DIC;
+        } else {
+            sgemm_dims[sgemm_nn_beta0][0] = DIC; // input and state
+            sgemm_dims[sgemm_nn_beta0][1] = MB;
+            sgemm_dims[sgemm_nn_beta0][2] = G * DIC;
+            sgemm_dims[sgemm_nt_beta1][0] = G * SLC; // diff weights
+            sgemm_dims[sgemm_nt_beta1][1] = DIC;
+            sgemm_dims[sgemm_nt_beta1][2] = MB;
+        }
+        for (int i = 0; i < n_sgemms; ++i) {
+            const int m = sgemm_dims[i][0], n = sgemm_dims[i][1],
+                  k = sgemm_dims[i][2];
+            const int ldb = sgemm_transb[i] == 'T' ? n : k;
+            if (m > 0 && jit_small_gemm_f32::is_applicable('N',
+                        sgemm_transb[i], m, n, k, m, ldb, m))
+                small_sgemm_[i] = new jit_small_gemm_f32('N', sgemm_transb[i],
+                        m, n, k, m, ldb, m, sgemm_beta[i]);
+        }
+#endif
+
+        /* without Intel MKL the weights are packed for the jit sgemm, but
+         * the small one reads them in place. The forward input gemm of the
+         * linear execution runs once per layer and direction, its weights
+         * are not reused. */
+#if !defined(USE_CBLAS)
+        const bool weights_pack_cond = conf_.T() > 1;
+        const bool input_pack_cond = weights_pack_cond
+                && (aprop == prop_kind::backward || is_wavefront)
+                && small_sgemm_[sgemm_nn_beta0] == nullptr;
+        const bool state_pack_cond = weights_pack_cond
+                && small_sgemm_[aprop == prop_kind::forward ?
+                        sgemm_nn_beta1 : sgemm_nn_beta0] == nullptr;
+#else
         const bool weights_pack_cond = USE_MKL_PACKED_GEMM && conf_.T() > 1;
+        const bool input_pack_cond = weights_pack_cond;
+        const bool state_pack_cond = weights_pack_cond;
+#endif
         const bool is_weights_state_packed = USE_MKL_PACKED_GEMM
                 && conf_.desc()->weights_iter_desc.format == packed_format;
 
-        set_pack_funcs(weights_pack_cond || is_weights_state_packed,
-                gemm_state_func, weights_pack_cond && !is_weights_state_packed,
+        set_pack_funcs(state_pack_cond || is_weights_state_packed,
+                gemm_state_func, state_pack_cond && !is_weights_state_packed,
                 weights_state_pack_func, weights_state_free_packed_func);
 
         const bool is_weights_input_packed = USE_MKL_PACKED_GEMM
                 && conf_.desc()->weights_layer_desc.format == packed_format;
 
-        set_pack_funcs(weights_pack_cond || is_weights_input_packed,
-                gemm_input_func, weights_pack_cond && !is_weights_input_packed,
+        set_pack_funcs(input_pack_cond || is_weights_input_packed,
+                gemm_input_func, input_pack_cond && !is_weights_input_packed,
                 weights_input_pack_func, weights_input_free_packed_func);
 
+        is_wei_f16_ = conf_.desc()->weights_layer_desc.data_type
+                == data_type::f16;
+        wei_k_block_ = 0;
+        wei_f32_ = nullptr;
+        cvt_f16_ = nullptr;
+        if (is_wei_f16_) {
+            gemm_input_func = gemm_state_func = &class_name::gemm_f16;
+            weights_input_pack_func = weights_state_pack_func
+                    = &class_name::no_pack_weights_f16;
+            weights_input_free_packed_func = weights_state_free_packed_func
+                    = &class_name::free_no_packed_weights;
+
+            /* the f32 copy of a block of input channels takes half of the
+             * L2 of all the threads the sgemm splits it between */
+            const int m = conf_.G() * conf_.DIC();
+            const int k_max = nstl::max(conf_.SLC(), conf_.SIC());
+            const size_t L2_size = get_cache_size(2, true);
+            wei_k_block_ = (int)(omp_get_max_threads() * L2_size / 2
+                    / (sizeof(float) * m));
+            wei_k_block_ = nstl::max(1, nstl::min(wei_k_block_, k_max));
+            wei_f32_ = (float *)malloc(sizeof(float) * m * wei_k_block_, 64);
+            cvt_f16_ = new jit_avx2_cvt_f16_to_f32();
+        }
+
         switch (conf_.cell_kind()) {
         case alg_kind::vanilla_lstm:
             elemwise_func = &class_name::lstm_elemwise;
@@ -225,6 +405,9 @@ struct _ref_rnn_common_t : public cpu_primitive_t {
         //     elemwise_func = &class_name::gru_elemwise; break;
         default: break;
         }
+        elemwise_ker_ = jit_uni_rnn_elemwise_kernel_f32::create(
+                conf_.cell_kind(), conf_.activation_kind(),
+                aprop == prop_kind::forward, conf_.DIC());
 
         n_output_features
                 = (conf_.direction() == mkldnn_bidirectional_concat) ? 2 : 1;
@@ -236,10 +419,6 @@ struct _ref_rnn_common_t : public cpu_primitive_t {
         default: break;
         }
 
-        /// @todo put a heuristic to choose between linear execution and
-        /// wavefront
-        grid_computation = &class_name::linear_execution;
-
         conf_.set_ws_offsets(
                 ws_gates_offset_, ws_states_offset_, ws_diff_states_offset_);
 
@@ -288,12 +467,57 @@ struct _ref_rnn_common_t : public cpu_primitive_t {
         int ptr_wei_sz = conf_.L() * conf_.D();
         ptr_wei_input_ = (float **)malloc(sizeof(float *) * ptr_wei_sz, 64);
         ptr_wei_state_ = (float **)malloc(sizeof(float *) * ptr_wei_sz, 64);
+
+        /* at most one cell per layer and direction runs at a time, the
+         * input gemms of the iterations of a layer may be batched */
+        const int n_gemms = nstl::max(ptr_wei_sz, conf_.T());
+        cells_ = (rnn_cell_t *)malloc(sizeof(rnn_cell_t) * ptr_wei_sz, 64);
+        gemm_a_ = (const float **)malloc(sizeof(float *) * n_gemms, 64);
+        gemm_b_ = (const float **)malloc(sizeof(float *) * n_gemms, 64);
+        gemm_c_ = (float **)malloc(sizeof(float *) * n_gemms, 64);
+
+        /* the batch is the one of the user until the lengths of the
+         * sequences are known at execution */
+        seq_order_ = (int *)malloc(sizeof(int) * conf_.MB(), 64);
+        seq_lengths_ = (int *)malloc(sizeof(int) * conf_.MB(), 64);
+        active_batch_ = (int *)malloc(sizeof(int) * conf_.T(), 64);
+        for (int b = 0; b < conf_.MB(); b++) {
+            seq_order_[b] = b;
+            seq_lengths_[b] = conf_.T();
+        }
+        for (int iter = 0; iter < conf_.T(); iter++)
+            active_batch_[iter] = conf_.MB();
+
+        states_ = nullptr;
+        if (conf_.is_stateful()) {
+            const size_t states_size = (size_t)conf_.L() * conf_.D()
+                    * conf_.S() * conf_.MB() * conf_.DIC();
+            states_ = (float *)malloc(sizeof(float) * states_size, 64);
+            utils::array_set(states_, 0.0f, states_size);
+        }
     }
     ~_ref_rnn_common_t() {
         if (use_scratchpad_)
             delete scratchpad_;
         free(ptr_wei_input_);
         free(ptr_wei_state_);
+        free(cells_);
+        free(gemm_a_);
+        free(gemm_b_);
+        free(gemm_c_);
+        free(seq_order_);
+        free(seq_lengths_);
+        free(active_batch_);
+        free(states_);
+        free(wei_f32_);
+        delete cvt_f16_;
+        delete elemwise_ker_;
+        for (int i = 0; i < n_sgemms; ++i) {
+            delete avx512_sgemm_[i];
+            delete avx2_sgemm_[i];
+            delete sse42_sgemm_[i];
+            delete small_sgemm_[i];
+        }
     }
 
     // typedef typename prec_traits::type data_t;
@@ -303,23 +527,44 @@ struct _ref_rnn_common_t : public cpu_primitive_t {
         e->set_state(event_t::ready);
     }
 
+    virtual status_t reset_states(int mb_begin, int mb_end) override;
+
 private:
     void execute_();
     grid_execution_sig(linear_execution);
-    // grid_execution_sig(wavefront_execution);
+    grid_execution_sig(wavefront_execution);
+    grid_cell_sig(set_grid_cell);
     cell_execution_sig(cell_execution);
+    void elemwise_execution(int s_size, int batch, int n_states, int n_gates,
+            int n_cells, const rnn_cell_t *cells);
+    void copy_carried_diff_states(int s_size, int batch, int n_states,
+            int n_cells, const rnn_cell_t *cells);
+    void set_seq_lengths(const int *seq_lengths);
+    /* the right to left direction runs the iterations in reverse, and a
+     * sequence of length len from the iteration n_iter - len */
+    int active_batch(int dir, int iter) const {
+        const bool is_reversed = dir == conf_.D() - 1
+                && !utils::one_of(exec_dir, b2t_l2r, t2b_l2r);
+        return active_batch_[is_reversed ? conf_.T() - 1 - iter : iter];
+    }
     elemwise_sig(rnn_elemwise);
     elemwise_sig(lstm_elemwise);
     // elemwise_sig(gru_elemwise);
     gemm_sig(gemm);
     gemm_sig(packed_gemm);
+    gemm_sig(gemm_f16);
     packing_sig(pack_weights);
     packing_sig(no_pack_weights);
+    packing_sig(no_pack_weights_f16);
     free_packed_sig(free_packed_weights);
     free_packed_sig(free_no_packed_weights);
 
     float (*activation_func)(float dd, float s, float alpha, float cliping);
 
+    void sgemm(bool is_B_trans, int m, int n, int k, int n_cells,
+            const float **a_, int lda, const float **b_, int ldb, float beta,
+            float **c_, int ldc, bool is_A_packed = false);
+
     void copy_init_layer(bool lr, bool rl, int n_direction, int n_layer,
             int n_iter, int batch, int x_size, int n_states, float *ws_states_,
             float *ws_diff_states_, const float *xt_,
@@ -352,6 +597,23 @@ private:
     float **ptr_wei_input_;
     float **ptr_wei_state_;
 
+    rnn_cell_t *cells_;
+    const float **gemm_a_;
+    const float **gemm_b_;
+    float **gemm_c_;
+
+    /* the batch of the workspace is sorted by decreasing length of the
+     * sequences, so that the ones covering an iteration are its first
+     * active_batch_[iter] rows: seq_order_ is the element of the user batch
+     * at a row of the workspace, seq_lengths_ its length */
+    int *seq_order_;
+    int *seq_lengths_;
+    int *active_batch_;
+
+    /* the states kept between the executions of a stateful rnn, in the
+     * ldsnc layout of dst_iter */
+    float *states_;
+
     execution_direction exec_dir;
     grid_execution_f grid_computation;
     // cell_execution_f cell_execution;
@@ -362,9 +624,24 @@ private:
     gemm_t gemm_input_func;
     gemm_t gemm_state_func;
     elemwise_f elemwise_func;
+    /* computes the full vectors of the rows in the elemwise functions */
+    jit_uni_rnn_elemwise_kernel_f32 *elemwise_ker_;
 
     free_packed_t weights_input_free_packed_func;
     free_packed_t weights_state_free_packed_func;
+
+    /* f16 weights are widened in blocks of wei_k_block_ input channels */
+    bool is_wei_f16_;
+    int wei_k_block_;
+    float *wei_f32_;
+    jit_avx2_cvt_f16_to_f32 *cvt_f16_;
+
+    /* jit sgemms by the transposition of B and beta, used without CBLAS */
+    enum { sgemm_nn_beta0, sgemm_nn_beta1, sgemm_nt_beta1, n_sgemms };
+    jit_avx512_common_gemm_f32 *avx512_sgemm_[n_sgemms];
+    jit_avx2_gemm_f32 *avx2_sgemm_[n_sgemms];
+    jit_sse42_gemm_f32 *sse42_sgemm_[n_sgemms];
+    jit_small_gemm_f32 *small_sgemm_[n_sgemms];
 };
 
 using ref_rnn_fwd_t = _ref_rnn_common_t<prop_kind::forward>;
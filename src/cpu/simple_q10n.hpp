@@ -40,6 +40,17 @@ inline out_t round_and_saturate(float f, round_mode_t rmode) {
     return math::saturate<out_t>(f);
 }
 
+/* bf16 has the range of f32, so narrowing is a rounding to nearest even of
+ * the mantissa only, whatever the integer rounding mode is */
+template <>
+inline bfloat16_t round_and_saturate<bfloat16_t>(float f, round_mode_t rmode)
+{ UNUSED(rmode); return bfloat16_t(f); }
+
+/* f16 keeps infinities as the result of an overflow, like vcvtps2ph does */
+template <>
+inline float16_t round_and_saturate<float16_t>(float f, round_mode_t rmode)
+{ UNUSED(rmode); return float16_t(f); }
+
 /* Quantization with alpha == 1 and beta == 0 */
 template <typename in_t, typename out_t, typename enabled = void>
 struct qz_a1b0 {
@@ -995,6 +995,83 @@ struct simple_reorder_impl<SIMPLE_REORDER_TEMPL_CALL,
     }
 };
 
+template <SIMPLE_REORDER_TEMPL_DECL>
+struct simple_reorder_impl<SIMPLE_REORDER_TEMPL_CALL,
+    typename utils::enable_if<fmt_i == goihw
+    && (fmt_o == GOihw2g4o || fmt_o == GOihw4g4o)>::type>
+{
+    static bool is_applicable(const memory_desc_wrapper &input_d,
+            const memory_desc_wrapper &output_d, const primitive_attr_t *attr)
+    {
+        const int gblk = fmt_o == GOihw2g4o ? 2 : 4;
+        const auto &dims = input_d.dims();
+        return simple_fmt_check(order_keep, fmt_i, fmt_o, input_d, output_d)
+            && simple_attr_check(attr, false)
+            && dims[0] % gblk == 0 && dims[1] % 4 == 0;
+    }
+
+    static status_t execute(const cpu_reorder_pd_t *pd,
+        const data_t<type_i> *input, data_t<type_o> *output) {
+        DECLARE_COMMON_PARAMS();
+
+        const auto &_goihw_d = order_keep ? input_d : output_d;
+        const auto &dims = input_d.dims();
+        const int gblk = fmt_o == GOihw2g4o ? 2 : 4;
+        const int oblk = 4;
+
+        const int NG = dims[0];
+        const int NB_OC = dims[1] / oblk;
+        const auto g_stride = _goihw_d.blocking_desc().strides[0][0];
+        const auto oc_stride = _goihw_d.blocking_desc().strides[0][1];
+
+        auto ker = [&](const data_t<type_i> *i, data_t<type_o> *o) {
+            for (int g = 0; g < gblk; ++g) {
+                for (int oc = 0; oc < oblk; ++oc) {
+                    const auto _goihw_off = g * g_stride + oc * oc_stride;
+                    const auto blk_off = g * oblk + oc;
+                    if (alpha == 1.0 && beta == 0.0) {
+                        if (order_keep)
+                            o[blk_off] = data_t<type_o>(i[_goihw_off]);
+                        else
+                            o[_goihw_off] = data_t<type_o>(i[blk_off]);
+                    } else {
+                        if (order_keep)
+                            o[blk_off] = data_t<type_o>(alpha * i[_goihw_off]
+                                    + (beta ? beta * o[blk_off] : 0));
+                        else
+                            o[_goihw_off] = data_t<type_o>(alpha * i[blk_off]
+                                    + (beta ? beta * o[_goihw_off] : 0));
+                    }
+                }
+            }
+        };
+
+        const int i_mult_g = order_keep ? gblk : 1;
+        const int o_mult_g = order_keep ? 1 : gblk;
+        const int i_mult_o = order_keep ? oblk : 1;
+        const int o_mult_o = order_keep ? 1 : oblk;
+
+#       pragma omp parallel for collapse(5) schedule(static)
+        for (int G = 0; G < NG / gblk; ++G) {
+            for (int O = 0; O < NB_OC; ++O) {
+                for (int ic = 0; ic < dims[2]; ++ic) {
+                    for (int h = 0; h < dims[3]; ++h) {
+                        for (int w = 0; w < dims[4]; ++w) {
+                            auto i = &input[input_d.blk_off(G * i_mult_g,
+                                    O * i_mult_o, ic, h, w)];
+                            auto o = &output[output_d.blk_off(G * o_mult_g,
+                                    O * o_mult_o, ic, h, w)];
+                            ker(i, o);
+                        }
+                    }
+                }
+            }
+        }
+
+        return success;
+    }
+};
+
 template <SIMPLE_REORDER_TEMPL_DECL>
 struct simple_reorder_impl<SIMPLE_REORDER_TEMPL_CALL,
     typename utils::enable_if<
@@ -1552,7 +1629,7 @@ struct simple_reorder_impl<SIMPLE_REORDER_TEMPL_CALL,
             auto &o = output[output_d.off_l(e)];
 
             i = scale * i + (beta ? beta * (float)o : 0);
-            if (type_o != f32) {
+            if (!utils::one_of(type_o, f32, bf16, f16)) {
                 switch (pd->attr()->round_mode_) {
                 case round_mode::down: i = floorf(i); break;
                 case round_mode::nearest: i = nearbyintf(i); break;
@@ -20,6 +20,9 @@
 #include <float.h>
 #include <math.h>
 
+#include <string>
+#include <vector>
+
 #include "mkldnn.h"
 
 #include "mkldnn_common.hpp"
@@ -40,6 +43,7 @@ attr_t attr;
 const char *skip_impl = "";
 bool allow_unimpl = false;
 const char *perf_template = "perf,%n,%d,%GO,%GF,%-t,%-Gp,%0t,%0Gp";
+const char *tune_file = NULL;
 
 void reset_parameters() {
     cfg = conf_f32;
@@ -51,6 +55,99 @@ void reset_parameters() {
     attr = attr_t();
     skip_impl = "";
     allow_unimpl = false;
+    tune_file = NULL;
+}
+
+/* candidates of the blocking parameters of the tunable implementations, see
+ * src/cpu/jit_conv_tuning.hpp for the format */
+static void tune_candidates(const prb_t *p, const char *impl,
+        std::vector<std::string> &cands) {
+    char buf[128];
+    if (!strcmp(impl, "jit:avx512_common")) {
+        const int ur_ws[] = { 2, 3, 4, 6, 7, 8, 12, 14, 16, 28 };
+        const int nb_oc = p->oc / p->g / 16;
+        for (int ur_w: ur_ws)
+        for (int nb_oc_blocking = 1; nb_oc_blocking <= 6; ++nb_oc_blocking)
+        for (const char *loop_order: { "cgn", "gnc" }) {
+            if (ur_w > p->ow || nb_oc % nb_oc_blocking) continue;
+            snprintf(buf, sizeof(buf),
+                    "ur_w=%d,nb_oc_blocking=%d,loop_order=%s", ur_w,
+                    nb_oc_blocking, loop_order);
+            cands.push_back(buf);
+        }
+    } else if (!strcmp(impl, "jit_1x1:avx2")) {
+        for (int nb_bcast_blocking: { 8, 16, 32, 48 })
+        for (int nb_load_blocking: { 3, 6, 12, 15, 18 })
+        for (int nb_reduce_blocking: { 4, 8, 16, 32 }) {
+            snprintf(buf, sizeof(buf), "nb_bcast_blocking=%d,"
+                    "nb_load_blocking=%d,nb_reduce_blocking=%d",
+                    nb_bcast_blocking, nb_load_blocking, nb_reduce_blocking);
+            cands.push_back(buf);
+        }
+    }
+}
+
+/* measures the problem with every candidate of the blocking parameters and
+ * appends the fastest one to the tune_file if it beats the heuristics */
+static void tune(const prb_t *p, const char *pstr) {
+    const char *env = "MKLDNN_CONV_TUNING_PARAMS";
+    const bench_mode_t saved_bench_mode = bench_mode;
+    bench_mode = (bench_mode_t)(CORR | PERF);
+
+    char impl[64];
+    std::vector<std::string> cands;
+    unsetenv(env);
+    if (query_impl_name(p, impl, sizeof(impl)) == OK && p->id == 1
+            && p->dir & FLAG_FWD)
+        tune_candidates(p, impl, cands);
+
+    res_t res{};
+    if (cands.empty() || conv::doit(p, &res) != OK || res.state != PASSED) {
+        print(0, "tune: skipped: %s\n", pstr);
+        bench_mode = saved_bench_mode;
+        benchdnn_stat.skipped++;
+        return;
+    }
+
+    const double def_ms = res.timer.ms();
+    double best_ms = def_ms;
+    std::string best;
+    for (auto &cand: cands) {
+        setenv(env, cand.c_str(), 1);
+        char cand_impl[64];
+        if (query_impl_name(p, cand_impl, sizeof(cand_impl)) != OK
+                || strcmp(impl, cand_impl))
+            continue;
+        res = res_t();
+        if (conv::doit(p, &res) != OK || res.state != PASSED) {
+            print(0, "tune: %s failed with %s\n", pstr, cand.c_str());
+            continue;
+        }
+        print(2, "tune: %s %s %g\n", pstr, cand.c_str(), res.timer.ms());
+        if (res.timer.ms() < best_ms) {
+            best_ms = res.timer.ms();
+            best = cand;
+        }
+    }
+    unsetenv(env);
+    bench_mode = saved_bench_mode;
+
+    print(0, "tune: %s %s %g ms (default %g ms)\n", pstr,
+            best.empty() ? "default" : best.c_str(), best_ms, def_ms);
+    if (!best.empty()) {
+        FILE *fp = fopen(tune_file, "a");
+        if (fp == NULL) {
+            fprintf(stderr, "driver: cannot open `%s`, exiting...\n",
+                    tune_file);
+            exit(2);
+        }
+        fprintf(fp, "%s g%dmb%dic%dih%diw%doc%doh%dow%dkh%dkw%dsh%dsw%d"
+                "ph%dpw%ddh%ddw%d %s\n", impl, p->g, p->mb, p->ic, p->ih,
+                p->iw, p->oc, p->oh, p->ow, p->kh, p->kw, p->sh, p->sw,
+                p->ph, p->pw, p->dh, p->dw, best.c_str());
+        fclose(fp);
+    }
+    benchdnn_stat.passed++;
 }
 
 void check_correctness(const desc_t *c) {
@@ -62,6 +159,12 @@ void check_correctness(const desc_t *c) {
         return;
     print(1, "run: %s\n", pstr);
 
+    if (tune_file) {
+        tune(&p, pstr);
+        benchdnn_stat.tests++;
+        return;
+    }
+
     res_t res{};
     const int status = conv::doit(&p, &res);
     (void)status;
@@ -100,6 +203,8 @@ int bench(int argc, char **argv, bool main_bench) {
             allow_unimpl = str2bool(argv[arg] + 15);
         else if (!strncmp("--perf-template=", argv[arg], 16))
             perf_template = argv[arg] + 16;
+        else if (!strncmp("--tune=", argv[arg], 7))
+            tune_file = argv[arg] + 7;
         else if (!strcmp("--reset", argv[arg]))
             reset_parameters();
         else if (!strncmp("--mode=", argv[0], 7))
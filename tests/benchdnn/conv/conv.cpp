@@ -620,4 +620,20 @@ int doit(const prb_t *p, res_t *r) {
     return OK;
 }
 
+/* name of the implementation that the library picks for the problem */
+int query_impl_name(const prb_t *p, char *buffer, size_t len) {
+    res_t r{};
+    mkldnn_convolution_desc_t cd;
+    mkldnn_primitive_desc_t cpd;
+
+    SAFE(init_pd(p, cd, cpd, &r), WARN);
+    if (r.state == SKIPPED || r.state == UNIMPLEMENTED)
+        return FAIL;
+
+    snprintf(buffer, len, "%s", query_impl_info(cpd));
+    DNN_SAFE(mkldnn_primitive_desc_destroy(cpd), WARN);
+
+    return OK;
+}
+
 }
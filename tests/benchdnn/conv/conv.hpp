@@ -30,6 +30,7 @@
 namespace conv {
 
 int doit(const prb_t *p, res_t *res);
+int query_impl_name(const prb_t *p, char *buffer, size_t len);
 int bench(int argc, char **argv, bool main_bench = true);
 
 }
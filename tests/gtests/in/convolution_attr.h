@@ -28,3 +28,18 @@ INST_TEST_CASE(SimpleSmall_Blocked_Attributes,
         round_nearest, 0.5f, COMMON,
         2, 1, 32, 13, 13, 32, 12, 12, 3, 3, 0, 0, 1, 1)
 );
+
+INST_TEST_CASE(SimpleSmall_Gemm_Attributes,
+    PARAMS_ATTR(nhwc, hwio, FMT_BIAS, nhwc,
+        round_nearest, 0.3f, COMMON,
+        2, 1, 32, 13, 13, 48, 11, 11, 3, 3, 0, 0, 1, 1),
+    PARAMS_ATTR(nhwc, hwio, FMT_BIAS, nhwc,
+        round_down, 0.5f, COMMON,
+        2, 1, 3, 13, 13, 19, 13, 13, 3, 3, 1, 1, 1, 1),
+    PARAMS_ATTR(nhwc, hwigo, FMT_BIAS, nhwc,
+        round_nearest, 1.f, COMMON,
+        2, 2, 16, 7, 7, 34, 7, 7, 1, 1, 0, 0, 1, 1),
+    PARAMS_ATTR(nhwc, hwio, FMT_NO_BIAS, nhwc,
+        round_nearest, 1.f, COMMON,
+        1, 1, 64, 28, 28, 100, 14, 14, 1, 1, 0, 0, 2, 2)
+);
@@ -38,6 +38,23 @@ INST_TEST_CASE(SimpleSmall_NCHW,
         2, 2, 4, 4, 4, 6, 4, 4, 3, 3, 1, 1, 1, 1)
 );
 
+INST_TEST_CASE(SimpleSmall_NHWC,
+    PARAMS(nhwc, hwio, FMT_BIAS, nhwc,
+        2, 1, 32, 7, 7, 64, 7, 7, 1, 1, 0, 0, 1, 1),
+    PARAMS(nhwc, hwio, FMT_BIAS, nhwc,
+        2, 1, 32, 14, 14, 16, 7, 7, 1, 1, 0, 0, 2, 2),
+    PARAMS(nhwc, hwio, FMT_BIAS, nhwc,
+        2, 1, 24, 13, 13, 32, 13, 13, 3, 3, 1, 1, 1, 1),
+    PARAMS(nhwc, hwio, FMT_BIAS, nhwc,
+        2, 1, 16, 15, 15, 32, 8, 8, 3, 3, 1, 1, 2, 2),
+    PARAMS(nhwc, hwio, FMT_BIAS, nhwc,
+        1, 1, 8, 10, 17, 16, 10, 9, 3, 3, 1, 1, 1, 2),
+    PARAMS(nhwc, hwigo, FMT_BIAS, nhwc,
+        2, 2, 16, 9, 9, 32, 9, 9, 1, 1, 0, 0, 1, 1),
+    PARAMS(nhwc, hwigo, FMT_BIAS, nhwc,
+        2, 4, 32, 12, 12, 64, 12, 12, 3, 3, 1, 1, 1, 1)
+);
+
 INST_TEST_CASE(SimpleSmall_Blocked,
     PARAMS(FMT_DATA_BLOCKED, FMT_WEIGHTS_BLOCKED, FMT_BIAS, FMT_DATA_BLOCKED,
         2, 1, 32, 13, 13, 32, 12, 12, 3, 3, 0, 0, 1, 1),
@@ -96,6 +113,26 @@ INST_TEST_CASE(SimpleSmall_Blocked16,
         2, 1, 32, 9, 9, 48, 2, 2, 5, 5, 0, 0, 3, 3)
 );
 
+INST_TEST_CASE(SimpleSmall_Blocked_MB1,
+    PARAMS(FMT_DATA_BLOCKED, FMT_WEIGHTS_BLOCKED, FMT_BIAS, FMT_DATA_BLOCKED,
+        1, 1, 256, 7, 7, 16, 7, 7, 3, 3, 1, 1, 1, 1),
+    PARAMS(FMT_DATA_BLOCKED, FMT_WEIGHTS_BLOCKED, FMT_BIAS, FMT_DATA_BLOCKED,
+        1, 1, 128, 9, 9, 40, 4, 4, 3, 3, 0, 0, 2, 2),
+    PARAMS(FMT_DATA_BLOCKED, FMT_WEIGHTS_BLOCKED_G, FMT_BIAS, FMT_DATA_BLOCKED,
+        1, 2, 96, 5, 5, 32, 5, 5, 3, 3, 1, 1, 1, 1)
+);
+
+INST_TEST_CASE(SimpleSmall_Blocked16_MB1,
+    PARAMS(FMT_DATA_BLOCKED16, FMT_WEIGHTS_BLOCKED16, FMT_BIAS, FMT_DATA_BLOCKED16,
+        1, 1, 256, 7, 7, 16, 7, 7, 3, 3, 1, 1, 1, 1),
+    PARAMS(FMT_DATA_BLOCKED16, FMT_WEIGHTS_BLOCKED16, FMT_BIAS, FMT_DATA_BLOCKED16,
+        1, 1, 512, 3, 3, 64, 3, 3, 3, 3, 1, 1, 1, 1),
+    PARAMS(FMT_DATA_BLOCKED16, FMT_WEIGHTS_BLOCKED16, FMT_BIAS, FMT_DATA_BLOCKED16,
+        1, 1, 128, 9, 9, 48, 4, 4, 3, 3, 0, 0, 2, 2),
+    PARAMS(FMT_DATA_BLOCKED16, FMT_WEIGHTS_BLOCKED16_G, FMT_BIAS, FMT_DATA_BLOCKED16,
+        1, 2, 192, 5, 5, 32, 5, 5, 3, 3, 1, 1, 1, 1)
+);
+
 INST_TEST_CASE(SimpleSmall_Regression,
     PARAMS(FMT_DATA_BLOCKED16, FMT_WEIGHTS_BLOCKED16, FMT_BIAS, FMT_DATA_BLOCKED16,
         2, 1, 32, 16, 16, 32, 16, 16, 3, 3, 0, 0, 1, 1),
@@ -148,3 +185,25 @@ INST_TEST_CASE(SimpleSmall_Depthwise_Blocked16,
     PARAMS(FMT_DATA_BLOCKED16, Goihw16g, FMT_BIAS, FMT_DATA_BLOCKED16,
         1, 16, 16, 500, 500, 16, 698, 698, 3, 3, 100, 100, 1, 1)
 );
+
+INST_TEST_CASE(SimpleSmall_Grouped4_Blocked,
+    PARAMS(FMT_DATA_BLOCKED, GOihw2g4o, FMT_BIAS, FMT_DATA_BLOCKED,
+        2, 2, 8, 9, 13, 8, 7, 11, 3, 3, 0, 0, 1, 1),
+    PARAMS(FMT_DATA_BLOCKED, GOihw2g4o, FMT_BIAS, FMT_DATA_BLOCKED,
+        2, 8, 32, 14, 14, 32, 14, 14, 3, 3, 1, 1, 1, 1),
+    PARAMS(FMT_DATA_BLOCKED, GOihw2g4o, FMT_BIAS, FMT_DATA_BLOCKED,
+        2, 16, 64, 15, 15, 64, 8, 8, 3, 3, 1, 1, 2, 2),
+    PARAMS(FMT_DATA_BLOCKED, GOihw2g4o, FMT_BIAS, FMT_DATA_BLOCKED,
+        1, 32, 128, 10, 10, 128, 10, 10, 1, 1, 0, 0, 1, 1)
+);
+
+INST_TEST_CASE(SimpleSmall_Grouped4_Blocked16,
+    PARAMS(FMT_DATA_BLOCKED16, GOihw4g4o, FMT_BIAS, FMT_DATA_BLOCKED16,
+        2, 4, 16, 9, 13, 16, 7, 11, 3, 3, 0, 0, 1, 1),
+    PARAMS(FMT_DATA_BLOCKED16, GOihw4g4o, FMT_BIAS, FMT_DATA_BLOCKED16,
+        2, 8, 32, 14, 14, 32, 14, 14, 3, 3, 1, 1, 1, 1),
+    PARAMS(FMT_DATA_BLOCKED16, GOihw4g4o, FMT_BIAS, FMT_DATA_BLOCKED16,
+        2, 20, 80, 15, 15, 80, 8, 8, 3, 3, 1, 1, 2, 2),
+    PARAMS(FMT_DATA_BLOCKED16, GOihw4g4o, FMT_BIAS, FMT_DATA_BLOCKED16,
+        1, 32, 128, 10, 10, 128, 10, 10, 1, 1, 0, 0, 1, 1)
+);
@@ -42,7 +42,11 @@ INST_TEST_CASE(SimpleSmall_NCHW_Dilution,
      PARAMS(nchw, oihw, FMT_BIAS, nchw,
          2, 1, 8, 8, 8, 8, 3, 8, 3, 3, 1, 1, 2, 1, 1, 0),
      PARAMS(nchw, oihw, FMT_BIAS, nchw,
-         2, 1, 8, 8, 8, 8, 8, 2, 3, 3, 1, 1, 1, 3, 0, 2)
+         2, 1, 8, 8, 8, 8, 8, 2, 3, 3, 1, 1, 1, 3, 0, 2),
+     PARAMS(nchw, oihw, FMT_BIAS, nchw,
+         2, 1, 64, 40, 40, 32, 36, 36, 3, 3, 0, 0, 1, 1, 1, 1),
+     PARAMS(nchw, oihw, FMT_BIAS, nchw,
+         2, 1, 96, 41, 41, 16, 20, 20, 3, 3, 1, 1, 2, 2, 1, 1)
 );
 
 INST_TEST_CASE(SimpleSmall_Blocked_Dilution,
@@ -154,6 +154,7 @@ inline mkldnn::memory::desc create_md(mkldnn::memory::dims dims,
         ndims = 1; break;
     case f::nc:
     case f::oi:
+    case f::io:
         ndims = 2; break;
     case f::nchw:
     case f::nhwc:
@@ -181,6 +182,8 @@ inline mkldnn::memory::desc create_md(mkldnn::memory::dims dims,
     case f::gOhwi8o:
     case f::Goihw8g:
     case f::Goihw16g:
+    case f::GOihw2g4o:
+    case f::GOihw4g4o:
     case f::gOIhw8i8o:
     case f::gOIhw16i16o:
     case f::gOIhw8i16o2i:
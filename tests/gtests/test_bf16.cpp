@@ -0,0 +1,298 @@
+/*******************************************************************************
+* Copyright 2018 Intel Corporation
+*
+* Licensed under the Apache License, Version 2.0 (the "License");
+* you may not use this file except in compliance with the License.
+* You may obtain a copy of the License at
+*
+*     http://www.apache.org/licenses/LICENSE-2.0
+*
+* Unless required by applicable law or agreed to in writing, software
+* distributed under the License is distributed on an "AS IS" BASIS,
+* WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+* See the License for the specific language governing permissions and
+* limitations under the License.
+*******************************************************************************/
+
+#include <string.h>
+
+#include "mkldnn_test_common.hpp"
+#include "gtest/gtest.h"
+
+#include "mkldnn.hpp"
+
+namespace mkldnn {
+
+/* bf16 values are kept as their raw bits in the tests */
+typedef uint16_t bf16_bits_t;
+
+static bf16_bits_t f32_to_bf16_rne(float f) {
+    uint32_t u;
+    memcpy(&u, &f, sizeof(u));
+    if ((u & 0x7fffffff) > 0x7f800000)
+        return (bf16_bits_t)((u >> 16) | 0x40);
+    return (bf16_bits_t)((u + 0x7fff + ((u >> 16) & 1)) >> 16);
+}
+
+static float bf16_to_f32(bf16_bits_t b) {
+    uint32_t u = (uint32_t)b << 16;
+    float f;
+    memcpy(&f, &u, sizeof(f));
+    return f;
+}
+
+static void reorder_to(memory &from, memory &to) {
+    std::vector<primitive> pipeline;
+    pipeline.push_back(reorder(from, to));
+    stream(stream::kind::eager).submit(pipeline).wait();
+}
+
+/* fills an f32 memory with random values rounded to bf16 and returns the
+ * bf16 copy of it in the requested format */
+static memory make_bf16_twin(memory &f32_mem, memory::format fmt,
+        const engine &eng) {
+    const size_t sz = f32_mem.get_primitive_desc().get_size() / sizeof(float);
+    float *d = (float *)f32_mem.get_data_handle();
+    fill_data<float>(sz, d, 1., true);
+    for (size_t i = 0; i < sz; ++i)
+        d[i] = bf16_to_f32(f32_to_bf16_rne(d[i]));
+
+    auto md = f32_mem.get_primitive_desc().desc();
+    std::vector<int> dims(md.data.dims, md.data.dims + md.data.ndims);
+    memory bf16_mem({ { dims, memory::data_type::bf16, fmt }, eng });
+    reorder_to(f32_mem, bf16_mem);
+    return bf16_mem;
+}
+
+TEST(bf16_test, TestReorderRoundNearestEven) {
+    auto eng = engine(engine::kind::cpu, 0);
+
+    const float vals[] = { 0.f, -0.f, 1.f, -2.5f,
+        1.00390625f, /* 1 + 2^-8: a tie, rounds down to even */
+        1.01171875f, /* 1 + 3 * 2^-8: a tie, rounds up to even */
+        1.0039064f, /* just above the tie, rounds up */
+        3.0e38f, 1.0e-39f /* denormal */, 65504.f, -123.456f,
+        INFINITY, -INFINITY, NAN, 0.1f, 7.f };
+    const int n = sizeof(vals) / sizeof(vals[0]);
+
+    memory::desc f32_md({ n }, memory::data_type::f32, memory::format::x);
+    memory::desc bf16_md({ n }, memory::data_type::bf16, memory::format::x);
+    memory src({ f32_md, eng }), bf16({ bf16_md, eng }), back({ f32_md, eng });
+    memcpy(src.get_data_handle(), vals, sizeof(vals));
+
+    reorder_to(src, bf16);
+    reorder_to(bf16, back);
+
+    const bf16_bits_t *b = (const bf16_bits_t *)bf16.get_data_handle();
+    const float *f = (const float *)back.get_data_handle();
+    for (int i = 0; i < n; ++i) {
+        EXPECT_EQ(f32_to_bf16_rne(vals[i]), b[i]) << "Index: " << i;
+        if (std::isnan(vals[i]))
+            EXPECT_TRUE(std::isnan(f[i]));
+        else
+            EXPECT_EQ(bf16_to_f32(b[i]), f[i]) << "Index: " << i;
+    }
+    EXPECT_EQ(0x3f80, b[4]);
+    EXPECT_EQ(0x3f82, b[5]);
+    EXPECT_EQ(0x3f81, b[6]);
+}
+
+struct bf16_conv_test_params {
+    test_convolution_sizes_t sizes;
+    bool with_relu;
+};
+
+class bf16_convolution_test
+    : public ::testing::TestWithParam<bf16_conv_test_params> {
+protected:
+    virtual void SetUp() {
+        auto p = ::testing::TestWithParam<bf16_conv_test_params>::GetParam();
+        auto eng = engine(engine::kind::cpu, 0);
+        const auto &cd = p.sizes;
+        const auto f32 = memory::data_type::f32;
+        const auto bf16 = memory::data_type::bf16;
+
+        memory::dims src_dims = { cd.mb, cd.ic, cd.ih, cd.iw };
+        memory::dims wei_dims = { cd.oc, cd.ic, cd.kh, cd.kw };
+        memory::dims dst_dims = { cd.mb, cd.oc, cd.oh, cd.ow };
+
+        auto src = memory({ { src_dims, f32, memory::format::nchw }, eng });
+        auto wei = memory({ { wei_dims, f32, memory::format::oihw }, eng });
+        auto bias = memory({ { { cd.oc }, f32, memory::format::x }, eng });
+        auto dst = memory({ { dst_dims, f32, memory::format::nChw16c }, eng });
+        auto dst_ref = memory({ { dst_dims, f32, memory::format::nChw16c },
+                eng });
+
+        auto src_bf16 = make_bf16_twin(src, memory::format::nChw16c, eng);
+        auto wei_bf16 = make_bf16_twin(wei, memory::format::OIhw16i16o, eng);
+        fill_data<float>(cd.oc, (float *)bias.get_data_handle(), 1., true);
+
+        post_ops ops;
+        if (p.with_relu)
+            ops.append_eltwise(1.f, eltwise_relu, 0.f, 0.f);
+        primitive_attr attr;
+        attr.set_post_ops(ops);
+
+        auto make_desc = [&](memory::data_type in_dt) {
+            return convolution_forward::desc(prop_kind::forward_inference,
+                    convolution_direct,
+                    { src_dims, in_dt, memory::format::nChw16c },
+                    { wei_dims, in_dt, memory::format::OIhw16i16o },
+                    { { cd.oc }, f32, memory::format::x },
+                    { dst_dims, f32, memory::format::nChw16c },
+                    { cd.strh, cd.strw }, { cd.padh, cd.padw },
+                    { cd.padh, cd.padw }, padding_kind::zero);
+        };
+
+        std::shared_ptr<convolution_forward::primitive_desc> bf16_pd;
+        try {
+            bf16_pd.reset(new convolution_forward::primitive_desc(
+                        make_desc(bf16), attr, eng));
+        } catch (error &e) {
+            /* no bf16 convolution on this cpu */
+            if (e.status == mkldnn_unimplemented) return;
+            throw;
+        }
+        auto ref_pd = convolution_forward::primitive_desc(make_desc(f32),
+                attr, eng);
+
+        auto src_ref = memory(ref_pd.src_primitive_desc());
+        auto wei_ref = memory(ref_pd.weights_primitive_desc());
+        reorder_to(src, src_ref);
+        reorder_to(wei, wei_ref);
+
+        std::vector<primitive> pipeline;
+        pipeline.push_back(convolution_forward(*bf16_pd, src_bf16, wei_bf16,
+                    bias, dst));
+        pipeline.push_back(convolution_forward(ref_pd, src_ref, wei_ref,
+                    bias, dst_ref));
+        stream(stream::kind::lazy).submit(pipeline).wait();
+
+        compare_data<float>(dst_ref, dst);
+    }
+};
+
+TEST_P(bf16_convolution_test, TestConvolution) {}
+
+#define EXPAND_SIZES(mb, ic, ih, iw, oc, oh, ow, kh, kw, ph, pw, sh, sw) \
+    { mb, 1, ic, ih, iw, oc, oh, ow, kh, kw, ph, pw, sh, sw }
+
+INSTANTIATE_TEST_CASE_P(TestConvolution, bf16_convolution_test,
+    ::testing::Values(
+        bf16_conv_test_params{
+            EXPAND_SIZES(2, 32, 13, 13, 48, 13, 13, 3, 3, 1, 1, 1, 1), false },
+        bf16_conv_test_params{
+            EXPAND_SIZES(2, 64, 14, 14, 64, 14, 14, 1, 1, 0, 0, 1, 1), true },
+        bf16_conv_test_params{
+            EXPAND_SIZES(1, 16, 28, 28, 32, 14, 14, 3, 3, 1, 1, 2, 2), true },
+        bf16_conv_test_params{
+            EXPAND_SIZES(2, 16, 7, 40, 80, 5, 38, 3, 3, 0, 0, 1, 1), false }
+    ));
+
+struct bf16_ip_test_params {
+    int mb, ic, oc, kh, kw;
+};
+
+class bf16_inner_product_test
+    : public ::testing::TestWithParam<bf16_ip_test_params> {
+protected:
+    virtual void SetUp() {
+        auto p = ::testing::TestWithParam<bf16_ip_test_params>::GetParam();
+        auto eng = engine(engine::kind::cpu, 0);
+        const auto f32 = memory::data_type::f32;
+        const auto bf16 = memory::data_type::bf16;
+
+        memory::dims src_dims = { p.mb, p.ic, p.kh, p.kw };
+        memory::dims wei_dims = { p.oc, p.ic, p.kh, p.kw };
+        memory::dims dst_dims = { p.mb, p.oc };
+
+        auto src = memory({ { src_dims, f32, memory::format::nchw }, eng });
+        auto wei = memory({ { wei_dims, f32, memory::format::oihw }, eng });
+        auto bias = memory({ { { p.oc }, f32, memory::format::x }, eng });
+        auto dst = memory({ { dst_dims, f32, memory::format::nc }, eng });
+        auto dst_ref = memory({ { dst_dims, f32, memory::format::nc }, eng });
+
+        auto src_bf16 = make_bf16_twin(src, memory::format::nchw, eng);
+        auto wei_bf16 = make_bf16_twin(wei, memory::format::oihw, eng);
+        fill_data<float>(p.oc, (float *)bias.get_data_handle(), 1., true);
+
+        auto make_desc = [&](memory::data_type in_dt) {
+            return inner_product_forward::desc(prop_kind::forward_inference,
+                    { src_dims, in_dt, memory::format::nchw },
+                    { wei_dims, in_dt, memory::format::oihw },
+                    { { p.oc }, f32, memory::format::x },
+                    { dst_dims, f32, memory::format::nc });
+        };
+
+        std::shared_ptr<inner_product_forward::primitive_desc> bf16_pd;
+        try {
+            bf16_pd.reset(new inner_product_forward::primitive_desc(
+                        make_desc(bf16), eng));
+        } catch (error &e) {
+            /* no bf16 inner product on this cpu */
+            if (e.status == mkldnn_unimplemented) return;
+            throw;
+        }
+        auto ref_pd = inner_product_forward::primitive_desc(make_desc(f32),
+                eng);
+
+        std::vector<primitive> pipeline;
+        pipeline.push_back(inner_product_forward(*bf16_pd, src_bf16,
+                    wei_bf16, bias, dst));
+        pipeline.push_back(inner_product_forward(ref_pd, src, wei, bias,
+                    dst_ref));
+        stream(stream::kind::lazy).submit(pipeline).wait();
+
+        compare_data<float>(dst_ref, dst);
+    }
+};
+
+TEST_P(bf16_inner_product_test, TestInnerProduct) {}
+
+INSTANTIATE_TEST_CASE_P(TestInnerProduct, bf16_inner_product_test,
+    ::testing::Values(
+        bf16_ip_test_params{ 2, 32, 48, 6, 6 },
+        bf16_ip_test_params{ 1, 1024, 1000, 1, 1 },
+        bf16_ip_test_params{ 7, 300, 19, 3, 3 },
+        bf16_ip_test_params{ 64, 4096, 200, 1, 1 }
+    ));
+
+TEST(bf16_test, TestRelu) {
+    auto eng = engine(engine::kind::cpu, 0);
+    const auto f32 = memory::data_type::f32;
+    const auto bf16 = memory::data_type::bf16;
+    const float negative_slope = 0.1f;
+
+    /* not a multiple of the vector length to cover the tail */
+    memory::dims dims = { 2, 16, 5, 7 };
+    auto src = memory({ { dims, f32, memory::format::nChw16c }, eng });
+    auto src_bf16 = make_bf16_twin(src, memory::format::nChw16c, eng);
+    auto dst_bf16 = memory({ { dims, bf16, memory::format::nChw16c }, eng });
+
+    std::shared_ptr<eltwise_forward::primitive_desc> pd;
+    try {
+        pd.reset(new eltwise_forward::primitive_desc(
+                    eltwise_forward::desc(prop_kind::forward_inference,
+                        eltwise_relu, src_bf16.get_primitive_desc().desc(),
+                        negative_slope), eng));
+    } catch (error &e) {
+        /* no bf16 eltwise on this cpu */
+        if (e.status == mkldnn_unimplemented) return;
+        throw;
+    }
+
+    std::vector<primitive> pipeline;
+    pipeline.push_back(eltwise_forward(*pd, src_bf16, dst_bf16));
+    stream(stream::kind::lazy).submit(pipeline).wait();
+
+    const size_t n = dst_bf16.get_primitive_desc().get_size()
+        / sizeof(bf16_bits_t);
+    const float *s = (const float *)src.get_data_handle();
+    const bf16_bits_t *d = (const bf16_bits_t *)dst_bf16.get_data_handle();
+    for (size_t i = 0; i < n; ++i) {
+        const float ref = s[i] > 0 ? s[i] : s[i] * negative_slope;
+        EXPECT_EQ(f32_to_bf16_rne(ref), d[i]) << "Index: " << i;
+    }
+}
+
+}
@@ -0,0 +1,178 @@
+/*******************************************************************************
+* Copyright 2018 Intel Corporation
+*
+* Licensed under the Apache License, Version 2.0 (the "License");
+* you may not use this file except in compliance with the License.
+* You may obtain a copy of the License at
+*
+*     http://www.apache.org/licenses/LICENSE-2.0
+*
+* Unless required by applicable law or agreed to in writing, software
+* distributed under the License is distributed on an "AS IS" BASIS,
+* WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+* See the License for the specific language governing permissions and
+* limitations under the License.
+*******************************************************************************/
+
+#include "mkldnn_test_common.hpp"
+#include "gtest/gtest.h"
+
+#include "mkldnn.hpp"
+
+namespace mkldnn {
+
+struct conv_depthwise_test_params {
+    const engine::kind engine_kind;
+    test_convolution_sizes_t sizes;
+    bool with_sum;
+    bool with_relu;
+};
+
+class convolution_depthwise_test
+    : public ::testing::TestWithParam<conv_depthwise_test_params> {
+protected:
+    virtual void SetUp() {
+        auto p = ::testing::TestWithParam<
+            conv_depthwise_test_params>::GetParam();
+
+        ASSERT_TRUE(p.engine_kind == engine::kind::cpu);
+        auto eng = engine(p.engine_kind, 0);
+        const auto &cd = p.sizes;
+        const auto f32 = memory::data_type::f32;
+        const auto any = memory::format::any;
+
+        auto c_src_desc = memory::desc({ cd.mb, cd.ic, cd.ih, cd.iw },
+                f32, any);
+        auto c_weights_desc = cd.ng > 1
+            ? memory::desc({ cd.ng, cd.oc / cd.ng, cd.ic / cd.ng, cd.kh,
+                    cd.kw }, f32, any)
+            : memory::desc({ cd.oc, cd.ic, cd.kh, cd.kw }, f32, any);
+        auto c_bias_desc = memory::desc({ cd.oc }, f32, memory::format::x);
+        auto c_dst_desc = memory::desc({ cd.mb, cd.oc, cd.oh, cd.ow },
+                f32, any);
+
+        std::vector<int> padR = { cd.padh, cd.padw };
+        for (int i = 0; i < 2; ++i) {
+            if ((cd.ih - ((cd.kh - 1) * (cd.dilh + 1) + 1) + cd.padh + padR[0])
+                / cd.strh + 1 != cd.oh)
+                ++padR[0];
+            if ((cd.iw - ((cd.kw - 1) * (cd.dilw + 1) + 1) + cd.padw + padR[1])
+                / cd.strw + 1 != cd.ow)
+                ++padR[1];
+        }
+
+        auto conv_desc = convolution_forward::desc(prop_kind::forward_scoring,
+                convolution_direct, c_src_desc, c_weights_desc, c_bias_desc,
+                c_dst_desc, { cd.strh, cd.strw }, { cd.dilh, cd.dilw },
+                { cd.padh, cd.padw }, padR, padding_kind::zero);
+
+        std::vector<float> dw_weights(cd.oc), dw_biases(cd.oc);
+        fill_data<float>(cd.oc, &dw_weights[0], 1., true);
+        fill_data<float>(cd.oc, &dw_biases[0], 1., true);
+
+        post_ops ops;
+        if (p.with_sum)
+            ops.append_sum(1.f);
+        ops.append_depthwise(depthwise_scale_shift, &dw_weights[0],
+                &dw_biases[0]);
+        if (p.with_relu)
+            ops.append_eltwise(1.f, eltwise_relu, 0.f, 0.f);
+        primitive_attr attr;
+        attr.set_post_ops(ops);
+
+        std::shared_ptr<convolution_forward::primitive_desc> conv_pd;
+        try {
+            conv_pd.reset(new convolution_forward::primitive_desc(
+                        conv_desc, attr, eng));
+        } catch (error &e) {
+            /* no implementation supports depthwise post-op on this cpu */
+            if (e.status == mkldnn_unimplemented) return;
+            throw;
+        }
+
+        auto c_src = memory(conv_pd->src_primitive_desc());
+        auto c_weights = memory(conv_pd->weights_primitive_desc());
+        auto c_bias = memory(conv_pd->bias_primitive_desc());
+        auto c_dst = memory(conv_pd->dst_primitive_desc());
+        auto dst_ref = memory(conv_pd->dst_primitive_desc());
+
+        const size_t dst_size = c_dst.get_primitive_desc().get_size()
+            / sizeof(float);
+        fill_data<float>(c_src.get_primitive_desc().get_size()
+                / sizeof(float), (float *)c_src.get_data_handle(), 1., true);
+        fill_data<float>(c_weights.get_primitive_desc().get_size()
+                / sizeof(float), (float *)c_weights.get_data_handle(),
+                1., true);
+        fill_data<float>(cd.oc, (float *)c_bias.get_data_handle(), 1., true);
+        fill_data<float>(dst_size, (float *)c_dst.get_data_handle());
+        fill_data<float>(dst_size, (float *)dst_ref.get_data_handle());
+
+        /* reference: the same convolution without the depthwise post-op,
+         * followed by scale-shift and relu applied on the plain output */
+        post_ops ref_ops;
+        if (p.with_sum)
+            ref_ops.append_sum(1.f);
+        primitive_attr ref_attr;
+        ref_attr.set_post_ops(ref_ops);
+        auto ref_conv_desc = convolution_forward::desc(
+                prop_kind::forward_scoring, convolution_direct,
+                c_src.get_primitive_desc().desc(),
+                c_weights.get_primitive_desc().desc(),
+                c_bias.get_primitive_desc().desc(),
+                dst_ref.get_primitive_desc().desc(), { cd.strh, cd.strw },
+                { cd.dilh, cd.dilw }, { cd.padh, cd.padw }, padR,
+                padding_kind::zero);
+        auto ref_conv_pd = convolution_forward::primitive_desc(
+                ref_conv_desc, ref_attr, eng);
+
+        std::vector<primitive> pipeline;
+        pipeline.push_back(convolution_forward(*conv_pd, c_src, c_weights,
+                    c_bias, c_dst));
+        pipeline.push_back(convolution_forward(ref_conv_pd, c_src, c_weights,
+                    c_bias, dst_ref));
+        stream(stream::kind::lazy).submit(pipeline).wait();
+
+        const auto dst_d = dst_ref.get_primitive_desc().desc();
+        float *ref_data = (float *)dst_ref.get_data_handle();
+        const ptrdiff_t num = (ptrdiff_t)cd.mb * cd.oc * cd.oh * cd.ow;
+#       pragma omp parallel for schedule(static)
+        for (ptrdiff_t i = 0; i < num; ++i) {
+            const int c = (int)((i / (cd.oh * cd.ow)) % cd.oc);
+            float &d = ref_data[map_index(dst_d, i)];
+            d = d * dw_weights[c] + dw_biases[c];
+            if (p.with_relu && d < 0.f)
+                d = 0.f;
+        }
+
+        compare_data<float>(dst_ref, c_dst);
+    }
+};
+
+TEST_P(convolution_depthwise_test, TestConvolutionDepthwise) {}
+
+#define EXPAND_SIZES(mb, ng, ic, ih, iw, oc, oh, ow, kh, kw, ph, pw, sh, sw) \
+    { mb, ng, ic, ih, iw, oc, oh, ow, kh, kw, ph, pw, sh, sw }
+
+INSTANTIATE_TEST_CASE_P(TestConvolutionDepthwise, convolution_depthwise_test,
+    ::testing::Values(
+        conv_depthwise_test_params{ engine::kind::cpu,
+            EXPAND_SIZES(2, 1, 32, 13, 13, 48, 13, 13, 3, 3, 1, 1, 1, 1),
+            false, false },
+        conv_depthwise_test_params{ engine::kind::cpu,
+            EXPAND_SIZES(2, 1, 32, 13, 13, 48, 13, 13, 3, 3, 1, 1, 1, 1),
+            false, true },
+        conv_depthwise_test_params{ engine::kind::cpu,
+            EXPAND_SIZES(2, 2, 32, 13, 13, 64, 6, 6, 3, 3, 0, 0, 2, 2),
+            true, true },
+        conv_depthwise_test_params{ engine::kind::cpu,
+            EXPAND_SIZES(2, 1, 64, 7, 7, 96, 7, 7, 1, 1, 0, 0, 1, 1),
+            false, false },
+        conv_depthwise_test_params{ engine::kind::cpu,
+            EXPAND_SIZES(2, 1, 64, 7, 7, 96, 7, 7, 1, 1, 0, 0, 1, 1),
+            true, true },
+        conv_depthwise_test_params{ engine::kind::cpu,
+            EXPAND_SIZES(1, 1, 256, 14, 14, 512, 14, 14, 1, 1, 0, 0, 1, 1),
+            false, true }
+    ));
+
+}
@@ -0,0 +1,142 @@
+/*******************************************************************************
+* Copyright 2018 Intel Corporation
+*
+* Licensed under the Apache License, Version 2.0 (the "License");
+* you may not use this file except in compliance with the License.
+* You may obtain a copy of the License at
+*
+*     http://www.apache.org/licenses/LICENSE-2.0
+*
+* Unless required by applicable law or agreed to in writing, software
+* distributed under the License is distributed on an "AS IS" BASIS,
+* WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+* See the License for the specific language governing permissions and
+* limitations under the License.
+*******************************************************************************/
+
+#include "mkldnn_test_common.hpp"
+#include "gtest/gtest.h"
+
+#include "mkldnn.hpp"
+
+namespace mkldnn {
+
+struct conv_sparse_test_params {
+    const engine::kind engine_kind;
+    test_convolution_sizes_t sizes;
+    int sparsity; // percentage of zero weights
+    bool with_relu;
+};
+
+class convolution_sparse_test
+    : public ::testing::TestWithParam<conv_sparse_test_params> {
+protected:
+    virtual void SetUp() {
+        auto p = ::testing::TestWithParam<
+            conv_sparse_test_params>::GetParam();
+
+        ASSERT_TRUE(p.engine_kind == engine::kind::cpu);
+        auto eng = engine(p.engine_kind, 0);
+        const auto &cd = p.sizes;
+        const auto f32 = memory::data_type::f32;
+
+        auto src_desc = memory::desc({ cd.mb, cd.ic, cd.ih, cd.iw }, f32,
+                memory::format::nchw);
+        auto weights_desc = memory::desc({ cd.oc, cd.ic, cd.kh, cd.kw }, f32,
+                memory::format::oihw);
+        auto bias_desc = memory::desc({ cd.oc }, f32, memory::format::x);
+        auto dst_desc = memory::desc({ cd.mb, cd.oc, cd.oh, cd.ow }, f32,
+                memory::format::nchw);
+
+        std::vector<int> padR = { cd.padh, cd.padw };
+        for (int i = 0; i < 2; ++i) {
+            if ((cd.ih - cd.kh + cd.padh + padR[0]) / cd.strh + 1 != cd.oh)
+                ++padR[0];
+            if ((cd.iw - cd.kw + cd.padw + padR[1]) / cd.strw + 1 != cd.ow)
+                ++padR[1];
+        }
+
+        auto src = memory({ src_desc, eng });
+        auto weights = memory({ weights_desc, eng });
+        auto bias = memory({ bias_desc, eng });
+        auto dst = memory({ dst_desc, eng });
+        auto dst_ref = memory({ dst_desc, eng });
+
+        auto fill = [](memory &m) {
+            fill_data<float>(m.get_primitive_desc().get_size() / sizeof(float),
+                    (float *)m.get_data_handle(), 1., true);
+        };
+        fill(src);
+        fill(weights);
+        fill(bias);
+
+        /* prune the weights: zero out sparsity% of them spread evenly
+         * over the tensor */
+        const size_t wei_sz = weights.get_primitive_desc().get_size()
+            / sizeof(float);
+        float *w = (float *)weights.get_data_handle();
+        for (size_t i = 0; i < wei_sz; ++i)
+            if ((i * 37) % 100 < (size_t)p.sparsity)
+                w[i] = 0.f;
+
+        post_ops ops;
+        if (p.with_relu)
+            ops.append_eltwise(1.f, eltwise_relu, 0.f, 0.f);
+        primitive_attr attr;
+        attr.set_post_ops(ops);
+        primitive_attr sparse_attr;
+        sparse_attr.set_post_ops(ops);
+        sparse_attr.set_sparse_weights(true);
+        ASSERT_TRUE(sparse_attr.get_sparse_weights());
+
+        auto fwd_desc = convolution_forward::desc(prop_kind::forward_inference,
+                convolution_direct, src_desc, weights_desc, bias_desc,
+                dst_desc, { cd.strh, cd.strw }, { cd.padh, cd.padw }, padR,
+                padding_kind::zero);
+
+        /* the hint never makes a convolution unimplemented: the shapes the
+         * sparse kernel does not support go to the dense implementations */
+        auto sparse_pd = convolution_forward::primitive_desc(fwd_desc,
+                sparse_attr, eng);
+        auto ref_pd = convolution_forward::primitive_desc(fwd_desc, attr,
+                eng);
+
+        std::vector<primitive> pipeline;
+        pipeline.push_back(convolution_forward(sparse_pd, src, weights, bias,
+                    dst));
+        pipeline.push_back(convolution_forward(ref_pd, src, weights, bias,
+                    dst_ref));
+        stream(stream::kind::lazy).submit(pipeline).wait();
+
+        compare_data<float>(dst_ref, dst);
+    }
+};
+
+TEST_P(convolution_sparse_test, TestConvolutionSparse) {}
+
+#define EXPAND_SIZES(mb, ic, ih, iw, oc, oh, ow, kh, kw, ph, pw, sh, sw) \
+    { mb, 1, ic, ih, iw, oc, oh, ow, kh, kw, ph, pw, sh, sw }
+
+INSTANTIATE_TEST_CASE_P(TestConvolutionSparse, convolution_sparse_test,
+    ::testing::Values(
+        conv_sparse_test_params{ engine::kind::cpu,
+            EXPAND_SIZES(2, 64, 14, 14, 64, 14, 14, 1, 1, 0, 0, 1, 1),
+            80, false },
+        conv_sparse_test_params{ engine::kind::cpu,
+            EXPAND_SIZES(2, 32, 13, 13, 48, 13, 13, 3, 3, 1, 1, 1, 1),
+            70, true },
+        conv_sparse_test_params{ engine::kind::cpu,
+            EXPAND_SIZES(1, 16, 28, 28, 32, 14, 28, 3, 3, 1, 1, 2, 1),
+            90, false },
+        conv_sparse_test_params{ engine::kind::cpu,
+            EXPAND_SIZES(1, 4, 7, 500, 8, 5, 498, 3, 3, 0, 0, 1, 1),
+            80, true },
+        conv_sparse_test_params{ engine::kind::cpu,
+            EXPAND_SIZES(1, 8, 9, 9, 8, 9, 9, 3, 3, 1, 1, 1, 1),
+            100, false },
+        conv_sparse_test_params{ engine::kind::cpu,
+            EXPAND_SIZES(2, 16, 14, 14, 32, 7, 7, 3, 3, 1, 1, 2, 2),
+            80, true }
+    ));
+
+}
@@ -0,0 +1,200 @@
+/*******************************************************************************
+* Copyright 2018 Intel Corporation
+*
+* Licensed under the Apache License, Version 2.0 (the "License");
+* you may not use this file except in compliance with the License.
+* You may obtain a copy of the License at
+*
+*     http://www.apache.org/licenses/LICENSE-2.0
+*
+* Unless required by applicable law or agreed to in writing, software
+* distributed under the License is distributed on an "AS IS" BASIS,
+* WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+* See the License for the specific language governing permissions and
+* limitations under the License.
+*******************************************************************************/
+
+#include "mkldnn_test_common.hpp"
+#include "gtest/gtest.h"
+
+#include "mkldnn.hpp"
+
+namespace mkldnn {
+
+struct conv_winograd_test_params {
+    const engine::kind engine_kind;
+    prop_kind aprop_kind;
+    memory::format src_format;
+    memory::format weights_format;
+    test_convolution_sizes_t sizes;
+    bool with_relu;
+};
+
+/* Winograd F(4x4, 3x3) is less accurate than the direct convolution, so the
+ * results are compared with a looser tolerance than compare_data() uses */
+static void compare_winograd(memory &ref, memory &dst) {
+    const auto ref_d = ref.get_primitive_desc().desc();
+    const auto dst_d = dst.get_primitive_desc().desc();
+    ptrdiff_t num = 1;
+    for (int d = 0; d < ref_d.data.ndims; ++d)
+        num *= ref_d.data.dims[d];
+
+    const float *ref_data = (const float *)ref.get_data_handle();
+    const float *dst_data = (const float *)dst.get_data_handle();
+    for (ptrdiff_t i = 0; i < num; ++i) {
+        const float r = ref_data[map_index(ref_d, i)];
+        const float g = dst_data[map_index(dst_d, i)];
+        const float e = (g - r) / std::max(1.f, std::abs(r));
+        ASSERT_NEAR(e, 0.f, 1e-3f) << "Index: " << i << " Total: " << num;
+    }
+}
+
+class convolution_winograd_test
+    : public ::testing::TestWithParam<conv_winograd_test_params> {
+protected:
+    virtual void SetUp() {
+        auto p = ::testing::TestWithParam<
+            conv_winograd_test_params>::GetParam();
+
+        ASSERT_TRUE(p.engine_kind == engine::kind::cpu);
+        auto eng = engine(p.engine_kind, 0);
+        const auto &cd = p.sizes;
+        const auto f32 = memory::data_type::f32;
+
+        auto src_desc = memory::desc({ cd.mb, cd.ic, cd.ih, cd.iw }, f32,
+                p.src_format);
+        auto weights_desc = memory::desc({ cd.oc, cd.ic, cd.kh, cd.kw }, f32,
+                p.weights_format);
+        auto bias_desc = memory::desc({ cd.oc }, f32, memory::format::x);
+        auto dst_desc = memory::desc({ cd.mb, cd.oc, cd.oh, cd.ow }, f32,
+                p.src_format);
+
+        std::vector<int> padR = { cd.padh, cd.padw };
+        for (int i = 0; i < 2; ++i) {
+            if ((cd.ih - cd.kh + cd.padh + padR[0]) / cd.strh + 1 != cd.oh)
+                ++padR[0];
+            if ((cd.iw - cd.kw + cd.padw + padR[1]) / cd.strw + 1 != cd.ow)
+                ++padR[1];
+        }
+
+        auto src = memory({ src_desc, eng });
+        auto weights = memory({ weights_desc, eng });
+        auto bias = memory({ bias_desc, eng });
+        auto dst = memory({ dst_desc, eng });
+        auto dst_ref = memory({ dst_desc, eng });
+
+        auto fill = [](memory &m, bool init_negs) {
+            fill_data<float>(m.get_primitive_desc().get_size() / sizeof(float),
+                    (float *)m.get_data_handle(), 1., init_negs);
+        };
+
+        post_ops ops;
+        if (p.with_relu)
+            ops.append_eltwise(1.f, eltwise_relu, 0.f, 0.f);
+        primitive_attr attr;
+        attr.set_post_ops(ops);
+
+        auto make_fwd_desc = [&](algorithm alg) {
+            return convolution_forward::desc(prop_kind::forward_training,
+                    alg, src_desc, weights_desc, bias_desc, dst_desc,
+                    { cd.strh, cd.strw }, { cd.padh, cd.padw }, padR,
+                    padding_kind::zero);
+        };
+
+        if (p.aprop_kind == prop_kind::forward_training) {
+            std::shared_ptr<convolution_forward::primitive_desc> wino_pd;
+            try {
+                wino_pd.reset(new convolution_forward::primitive_desc(
+                            make_fwd_desc(convolution_winograd), attr, eng));
+            } catch (error &e) {
+                /* no winograd implementation for this cpu or formats */
+                if (e.status == mkldnn_unimplemented) return;
+                throw;
+            }
+            auto ref_pd = convolution_forward::primitive_desc(
+                    make_fwd_desc(convolution_direct), attr, eng);
+
+            fill(src, true);
+            fill(weights, true);
+            fill(bias, true);
+
+            std::vector<primitive> pipeline;
+            pipeline.push_back(convolution_forward(*wino_pd, src, weights,
+                        bias, dst));
+            pipeline.push_back(convolution_forward(ref_pd, src, weights,
+                        bias, dst_ref));
+            stream(stream::kind::lazy).submit(pipeline).wait();
+
+            compare_winograd(dst_ref, dst);
+        } else {
+            auto hint_pd = convolution_forward::primitive_desc(
+                    make_fwd_desc(convolution_direct), eng);
+            auto make_bwd_desc = [&](algorithm alg) {
+                return convolution_backward_data::desc(alg, src_desc,
+                        weights_desc, dst_desc, { cd.strh, cd.strw },
+                        { cd.padh, cd.padw }, padR, padding_kind::zero);
+            };
+
+            std::shared_ptr<convolution_backward_data::primitive_desc> wino_pd;
+            try {
+                wino_pd.reset(new convolution_backward_data::primitive_desc(
+                            make_bwd_desc(convolution_winograd), eng,
+                            hint_pd));
+            } catch (error &e) {
+                if (e.status == mkldnn_unimplemented) return;
+                throw;
+            }
+            auto ref_pd = convolution_backward_data::primitive_desc(
+                    make_bwd_desc(convolution_direct), eng, hint_pd);
+
+            /* dst and dst_ref hold diff_dst and diff_src respectively */
+            auto diff_src = memory({ src_desc, eng });
+            auto diff_src_ref = memory({ src_desc, eng });
+            fill(dst, true);
+            fill(weights, true);
+
+            std::vector<primitive> pipeline;
+            pipeline.push_back(convolution_backward_data(*wino_pd, dst,
+                        weights, diff_src));
+            pipeline.push_back(convolution_backward_data(ref_pd, dst,
+                        weights, diff_src_ref));
+            stream(stream::kind::lazy).submit(pipeline).wait();
+
+            compare_winograd(diff_src_ref, diff_src);
+        }
+    }
+};
+
+TEST_P(convolution_winograd_test, TestConvolutionWinograd) {}
+
+#define FMT_DATA_BLOCKED memory::format::nChw8c
+#define FMT_WEIGHTS_BLOCKED memory::format::OIhw8i8o
+#define FWD prop_kind::forward_training
+#define BWD_D prop_kind::backward_data
+
+#define EXPAND_SIZES(mb, ic, ih, iw, oc, oh, ow, ph, pw) \
+    { mb, 1, ic, ih, iw, oc, oh, ow, 3, 3, ph, pw, 1, 1 }
+
+INSTANTIATE_TEST_CASE_P(TestConvolutionWinograd, convolution_winograd_test,
+    ::testing::Values(
+        conv_winograd_test_params{ engine::kind::cpu, FWD,
+            FMT_DATA_BLOCKED, FMT_WEIGHTS_BLOCKED,
+            EXPAND_SIZES(2, 16, 13, 13, 24, 13, 13, 1, 1), false },
+        conv_winograd_test_params{ engine::kind::cpu, FWD,
+            FMT_DATA_BLOCKED, FMT_WEIGHTS_BLOCKED,
+            EXPAND_SIZES(1, 32, 16, 16, 32, 14, 14, 0, 0), true },
+        conv_winograd_test_params{ engine::kind::cpu, FWD,
+            FMT_DATA_BLOCKED, FMT_WEIGHTS_BLOCKED,
+            EXPAND_SIZES(3, 64, 9, 11, 48, 9, 11, 1, 1), true },
+        conv_winograd_test_params{ engine::kind::cpu, BWD_D,
+            FMT_DATA_BLOCKED, FMT_WEIGHTS_BLOCKED,
+            EXPAND_SIZES(2, 16, 13, 13, 24, 13, 13, 1, 1), false },
+        conv_winograd_test_params{ engine::kind::cpu, BWD_D,
+            FMT_DATA_BLOCKED, FMT_WEIGHTS_BLOCKED,
+            EXPAND_SIZES(1, 32, 16, 16, 32, 14, 14, 0, 0), false },
+        conv_winograd_test_params{ engine::kind::cpu, BWD_D,
+            FMT_DATA_BLOCKED, FMT_WEIGHTS_BLOCKED,
+            EXPAND_SIZES(3, 48, 9, 11, 64, 9, 11, 1, 1), false }
+    ));
+
+}
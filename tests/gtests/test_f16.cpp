@@ -0,0 +1,273 @@
+/*******************************************************************************
+* Copyright 2018 Intel Corporation
+*
+* Licensed under the Apache License, Version 2.0 (the "License");
+* you may not use this file except in compliance with the License.
+* You may obtain a copy of the License at
+*
+*     http://www.apache.org/licenses/LICENSE-2.0
+*
+* Unless required by applicable law or agreed to in writing, software
+* distributed under the License is distributed on an "AS IS" BASIS,
+* WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+* See the License for the specific language governing permissions and
+* limitations under the License.
+*******************************************************************************/
+
+#include <string.h>
+
+#include "mkldnn_test_common.hpp"
+#include "gtest/gtest.h"
+
+#include "mkldnn.hpp"
+
+namespace mkldnn {
+
+/* f16 values are kept as their raw bits in the tests */
+typedef uint16_t f16_bits_t;
+
+static void reorder_to(memory &from, memory &to) {
+    std::vector<primitive> pipeline;
+    pipeline.push_back(reorder(from, to));
+    stream(stream::kind::eager).submit(pipeline).wait();
+}
+
+/* fills an f32 memory with random values, returns the f16 copy of it and
+ * rounds the f32 values the same way, so that an f32 primitive on them is
+ * the reference for the f16 one */
+static memory make_f16_twin(memory &f32_mem, const engine &eng) {
+    const size_t sz = f32_mem.get_primitive_desc().get_size() / sizeof(float);
+    fill_data<float>(sz, (float *)f32_mem.get_data_handle(), 1., true);
+
+    auto md = f32_mem.get_primitive_desc().desc();
+    std::vector<int> dims(md.data.dims, md.data.dims + md.data.ndims);
+    memory f16_mem({ { dims, memory::data_type::f16,
+            (memory::format)md.data.format }, eng });
+    reorder_to(f32_mem, f16_mem);
+    reorder_to(f16_mem, f32_mem);
+    return f16_mem;
+}
+
+TEST(f16_test, TestReorderRoundNearestEven) {
+    auto eng = engine(engine::kind::cpu, 0);
+
+    const float vals[] = { 0.f, -0.f, 1.f, -2.5f,
+        1.00048828125f, /* 1 + 2^-11: a tie, rounds down to even */
+        1.00146484375f, /* 1 + 3 * 2^-11: a tie, rounds up to even */
+        65504.f, /* the largest f16 */
+        65520.f, /* a tie between 65504 and 2^16, overflows */
+        1e5f, -1e5f,
+        5.9604645e-8f, /* 2^-24, the smallest subnormal */
+        2.9802322e-8f, /* 2^-25: a tie, rounds down to zero */
+        4.4703484e-8f, /* 3 * 2^-26, rounds up to 2^-24 */
+        6.097555e-5f, /* the largest subnormal */
+        INFINITY, NAN };
+    const f16_bits_t expected[] = { 0x0000, 0x8000, 0x3c00, 0xc100,
+        0x3c00, 0x3c02, 0x7bff, 0x7c00, 0x7c00, 0xfc00,
+        0x0001, 0x0000, 0x0001, 0x03ff, 0x7c00, 0x7e00 };
+    const int n = sizeof(vals) / sizeof(vals[0]);
+
+    memory::desc f32_md({ n }, memory::data_type::f32, memory::format::x);
+    memory::desc f16_md({ n }, memory::data_type::f16, memory::format::x);
+    memory src({ f32_md, eng }), f16({ f16_md, eng }), back({ f32_md, eng });
+    memcpy(src.get_data_handle(), vals, sizeof(vals));
+
+    reorder_to(src, f16);
+    reorder_to(f16, back);
+
+    const f16_bits_t *h = (const f16_bits_t *)f16.get_data_handle();
+    const float *f = (const float *)back.get_data_handle();
+    for (int i = 0; i < n; ++i) {
+        if (std::isnan(vals[i])) {
+            EXPECT_EQ(0x7c00, h[i] & 0x7c00);
+            EXPECT_NE(0, h[i] & 0x03ff);
+            EXPECT_TRUE(std::isnan(f[i]));
+            continue;
+        }
+        EXPECT_EQ(expected[i], h[i]) << "Index: " << i;
+    }
+    EXPECT_EQ(1.f, f[4]);
+    EXPECT_EQ(65504.f, f[6]);
+    EXPECT_EQ(INFINITY, f[7]);
+    EXPECT_EQ(5.9604645e-8f, f[12]);
+}
+
+struct f16_ip_test_params {
+    int mb, ic, oc, kh, kw;
+};
+
+class f16_inner_product_test
+    : public ::testing::TestWithParam<f16_ip_test_params> {
+protected:
+    virtual void SetUp() {
+        auto p = ::testing::TestWithParam<f16_ip_test_params>::GetParam();
+        auto eng = engine(engine::kind::cpu, 0);
+        const auto f32 = memory::data_type::f32;
+        const auto f16 = memory::data_type::f16;
+
+        memory::dims src_dims = { p.mb, p.ic, p.kh, p.kw };
+        memory::dims wei_dims = { p.oc, p.ic, p.kh, p.kw };
+        memory::dims dst_dims = { p.mb, p.oc };
+
+        auto src = memory({ { src_dims, f32, memory::format::nchw }, eng });
+        auto wei = memory({ { wei_dims, f32, memory::format::oihw }, eng });
+        auto bias = memory({ { { p.oc }, f32, memory::format::x }, eng });
+        auto dst = memory({ { dst_dims, f32, memory::format::nc }, eng });
+        auto dst_ref = memory({ { dst_dims, f32, memory::format::nc }, eng });
+
+        fill_data<float>(src.get_primitive_desc().get_size() / sizeof(float),
+                (float *)src.get_data_handle(), 1., true);
+        auto wei_f16 = make_f16_twin(wei, eng);
+        fill_data<float>(p.oc, (float *)bias.get_data_handle(), 1., true);
+
+        auto make_desc = [&](memory::data_type wei_dt) {
+            return inner_product_forward::desc(prop_kind::forward_inference,
+                    { src_dims, f32, memory::format::nchw },
+                    { wei_dims, wei_dt, memory::format::oihw },
+                    { { p.oc }, f32, memory::format::x },
+                    { dst_dims, f32, memory::format::nc });
+        };
+
+        std::shared_ptr<inner_product_forward::primitive_desc> f16_pd;
+        try {
+            f16_pd.reset(new inner_product_forward::primitive_desc(
+                        make_desc(f16), eng));
+        } catch (error &e) {
+            /* no F16C on this cpu */
+            if (e.status == mkldnn_unimplemented) return;
+            throw;
+        }
+        auto ref_pd = inner_product_forward::primitive_desc(make_desc(f32),
+                eng);
+
+        std::vector<primitive> pipeline;
+        pipeline.push_back(inner_product_forward(*f16_pd, src, wei_f16, bias,
+                    dst));
+        pipeline.push_back(inner_product_forward(ref_pd, src, wei, bias,
+                    dst_ref));
+        stream(stream::kind::lazy).submit(pipeline).wait();
+
+        compare_data<float>(dst_ref, dst);
+    }
+};
+
+TEST_P(f16_inner_product_test, TestInnerProduct) {}
+
+INSTANTIATE_TEST_CASE_P(TestInnerProduct, f16_inner_product_test,
+    ::testing::Values(
+        f16_ip_test_params{ 1, 1024, 1000, 1, 1 },
+        f16_ip_test_params{ 2, 32, 48, 6, 6 },
+        f16_ip_test_params{ 7, 300, 19, 3, 3 },
+        f16_ip_test_params{ 1, 4096, 333, 1, 1 }
+    ));
+
+struct f16_rnn_test_params {
+    algorithm cell_kind;
+    algorithm activation;
+    rnn_direction direction;
+    int l, t, mb, c;
+};
+
+class f16_rnn_test : public ::testing::TestWithParam<f16_rnn_test_params> {
+protected:
+    virtual void SetUp() {
+        auto p = ::testing::TestWithParam<f16_rnn_test_params>::GetParam();
+        auto eng = engine(engine::kind::cpu, 0);
+        const auto f32 = memory::data_type::f32;
+        const auto f16 = memory::data_type::f16;
+
+        rnn_cell::desc cell(p.cell_kind, p.activation);
+        const int g = cell.get_gates_count();
+        const int s = cell.get_state_count();
+        const int d = (p.direction == bidirectional_concat
+                || p.direction == bidirectional_sum) ? 2 : 1;
+        const int dlc = p.direction == bidirectional_concat ? 2 * p.c : p.c;
+
+        memory::dims src_layer_dims = { p.t, p.mb, p.c };
+        memory::dims src_iter_dims = { p.l, d, s, p.mb, p.c };
+        memory::dims wei_dims = { p.l, d, p.c, g, p.c };
+        memory::dims bias_dims = { p.l, d, g, p.c };
+        memory::dims dst_layer_dims = { p.t, p.mb, dlc };
+
+        auto src_layer = memory({ { src_layer_dims, f32, memory::format::tnc },
+                eng });
+        auto src_iter = memory({ { src_iter_dims, f32, memory::format::ldsnc },
+                eng });
+        auto wei_layer = memory({ { wei_dims, f32, memory::format::ldigo },
+                eng });
+        auto wei_iter = memory({ { wei_dims, f32, memory::format::ldigo },
+                eng });
+        auto bias = memory({ { bias_dims, f32, memory::format::ldgo }, eng });
+        auto dst_layer = memory({ { dst_layer_dims, f32, memory::format::tnc },
+                eng });
+        auto dst_layer_ref = memory({ { dst_layer_dims, f32,
+                memory::format::tnc }, eng });
+        auto dst_iter = memory({ { src_iter_dims, f32, memory::format::ldsnc },
+                eng });
+        auto dst_iter_ref = memory({ { src_iter_dims, f32,
+                memory::format::ldsnc }, eng });
+
+        auto fill = [](memory &m) {
+            fill_data<float>(m.get_primitive_desc().get_size() / sizeof(float),
+                    (float *)m.get_data_handle(), 1., true);
+        };
+        fill(src_layer);
+        fill(src_iter);
+        fill(bias);
+        auto wei_layer_f16 = make_f16_twin(wei_layer, eng);
+        auto wei_iter_f16 = make_f16_twin(wei_iter, eng);
+
+        auto make_desc = [&](memory::data_type wei_dt) {
+            return rnn_forward::desc(prop_kind::forward_inference, cell,
+                    p.direction,
+                    { src_layer_dims, f32, memory::format::tnc },
+                    { src_iter_dims, f32, memory::format::ldsnc },
+                    { wei_dims, wei_dt, memory::format::ldigo },
+                    { wei_dims, wei_dt, memory::format::ldigo },
+                    { bias_dims, f32, memory::format::ldgo },
+                    { dst_layer_dims, f32, memory::format::tnc },
+                    { src_iter_dims, f32, memory::format::ldsnc });
+        };
+
+        std::shared_ptr<rnn_forward::primitive_desc> f16_pd, ref_pd;
+        try {
+            f16_pd.reset(new rnn_forward::primitive_desc(make_desc(f16),
+                        eng));
+            ref_pd.reset(new rnn_forward::primitive_desc(make_desc(f32),
+                        eng));
+        } catch (error &e) {
+            /* no rnn or no F16C on this cpu */
+            if (e.status == mkldnn_unimplemented) return;
+            throw;
+        }
+
+        memory null_ws(null_memory(eng));
+        std::vector<primitive> pipeline;
+        pipeline.push_back(rnn_forward(*f16_pd, src_layer, src_iter,
+                    wei_layer_f16, wei_iter_f16, bias, dst_layer, dst_iter,
+                    null_ws));
+        pipeline.push_back(rnn_forward(*ref_pd, src_layer, src_iter,
+                    wei_layer, wei_iter, bias, dst_layer_ref, dst_iter_ref,
+                    null_ws));
+        stream(stream::kind::lazy).submit(pipeline).wait();
+
+        compare_data<float>(dst_layer_ref, dst_layer);
+        compare_data<float>(dst_iter_ref, dst_iter);
+    }
+};
+
+TEST_P(f16_rnn_test, TestRnn) {}
+
+INSTANTIATE_TEST_CASE_P(TestRnn, f16_rnn_test,
+    ::testing::Values(
+        f16_rnn_test_params{ vanilla_lstm, algorithm_undef,
+            unidirectional_left2right, 1, 1, 1, 512 },
+        f16_rnn_test_params{ vanilla_lstm, algorithm_undef,
+            unidirectional_left2right, 2, 5, 4, 64 },
+        f16_rnn_test_params{ vanilla_lstm, algorithm_undef,
+            bidirectional_concat, 1, 3, 2, 32 },
+        f16_rnn_test_params{ vanilla_rnn, eltwise_tanh,
+            unidirectional_right2left, 2, 4, 3, 48 }
+    ));
+
+}
@@ -0,0 +1,191 @@
+/*******************************************************************************
+* Copyright 2018 Intel Corporation
+*
+* Licensed under the Apache License, Version 2.0 (the "License");
+* you may not use this file except in compliance with the License.
+* You may obtain a copy of the License at
+*
+*     http://www.apache.org/licenses/LICENSE-2.0
+*
+* Unless required by applicable law or agreed to in writing, software
+* distributed under the License is distributed on an "AS IS" BASIS,
+* WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+* See the License for the specific language governing permissions and
+* limitations under the License.
+*******************************************************************************/
+
+#include <cmath>
+
+#include "mkldnn_test_common.hpp"
+#include "gtest/gtest.h"
+
+#include "mkldnn.hpp"
+
+namespace mkldnn {
+
+struct test_gemm_params {
+    char layout, transa, transb;
+    int M, N, K;
+    float alpha, beta;
+    char bias_kind;
+    algorithm eltwise_alg;
+    float eltwise_alpha;
+    bool expect_to_fail;
+};
+
+/* element (i, j) of op(X), with X an r x c matrix for the layout */
+static float op_elem(const std::vector<float> &x, char layout, char trans,
+        int ld, int i, int j) {
+    const bool col_major = layout == 'C' || layout == 'c';
+    const bool t = trans == 'T' || trans == 't';
+    if (t) std::swap(i, j);
+    return col_major ? x[(size_t)j * ld + i] : x[(size_t)i * ld + j];
+}
+
+static float ref_eltwise(algorithm alg, float s, float alpha) {
+    switch (alg) {
+    case eltwise_relu: return s > 0 ? s : s * alpha;
+    case eltwise_tanh: return tanhf(s);
+    case eltwise_logistic: return 1.f / (1.f + expf(-s));
+    default: return s;
+    }
+}
+
+class gemm_test : public ::testing::TestWithParam<test_gemm_params> {
+protected:
+    virtual void SetUp() {
+        test_gemm_params p
+            = ::testing::TestWithParam<test_gemm_params>::GetParam();
+        catch_expected_failures([=](){Test();}, p.expect_to_fail,
+                    mkldnn_invalid_arguments);
+    }
+
+    void Test() {
+        test_gemm_params p
+            = ::testing::TestWithParam<test_gemm_params>::GetParam();
+        const bool col_major = p.layout == 'C' || p.layout == 'c';
+        const bool ta = p.transa == 'T' || p.transa == 't';
+        const bool tb = p.transb == 'T' || p.transb == 't';
+
+        /* A is M x K, B is K x N after op(), stored with a padded ld */
+        const int a_rows = ta ? p.K : p.M, a_cols = ta ? p.M : p.K;
+        const int b_rows = tb ? p.N : p.K, b_cols = tb ? p.K : p.N;
+        const int lda = (col_major ? a_rows : a_cols) + 3;
+        const int ldb = (col_major ? b_rows : b_cols) + 1;
+        const int ldc = (col_major ? p.M : p.N) + 2;
+
+        /* K may be 0, the matrices are never empty to keep them non-null */
+        std::vector<float> A(std::max(1,
+                    lda * (col_major ? a_cols : a_rows)));
+        std::vector<float> B(std::max(1,
+                    ldb * (col_major ? b_cols : b_rows)));
+        std::vector<float> C((size_t)ldc * (col_major ? p.N : p.M));
+        std::vector<float> bias(std::max(p.M, p.N));
+        fill_data<float>(A.size(), A.data(), 1., true);
+        fill_data<float>(B.size(), B.data(), 1., true);
+        fill_data<float>(C.size(), C.data(), 1., true);
+        fill_data<float>(bias.size(), bias.data(), 1., true);
+        std::vector<float> C_ref(C);
+
+        for (int i = 0; i < p.M; ++i)
+        for (int j = 0; j < p.N; ++j) {
+            double acc = 0;
+            for (int k = 0; k < p.K; ++k)
+                acc += (double)op_elem(A, p.layout, p.transa, lda, i, k)
+                    * op_elem(B, p.layout, p.transb, ldb, k, j);
+            float &c = col_major ? C_ref[(size_t)j * ldc + i]
+                : C_ref[(size_t)i * ldc + j];
+            float d = p.alpha * (float)acc + (p.beta == 0 ? 0 : p.beta * c);
+            if (p.bias_kind == 'R') d += bias[i];
+            if (p.bias_kind == 'C') d += bias[j];
+            c = ref_eltwise(p.eltwise_alg, d, p.eltwise_alpha);
+        }
+
+        sgemm(p.layout, p.transa, p.transb, p.M, p.N, p.K, p.alpha, A.data(),
+                lda, B.data(), ldb, p.beta, C.data(), ldc, p.bias_kind,
+                bias.data(), p.eltwise_alg, p.eltwise_alpha);
+
+        const float eps = 1e-4f * (p.K + 1);
+        for (int i = 0; i < p.M; ++i)
+        for (int j = 0; j < p.N; ++j) {
+            const size_t off = col_major ? (size_t)j * ldc + i
+                : (size_t)i * ldc + j;
+            const float ref = C_ref[off];
+            const float e = (C[off] - ref) / std::max(std::abs(ref), 1.f);
+            EXPECT_NEAR(e, 0.f, eps) << "i: " << i << " j: " << j;
+        }
+    }
+};
+
+TEST(gemm_test_plain, TestColumnMajor) {
+    const int M = 33, N = 17, K = 29;
+    std::vector<float> A(M * K), B(K * N), C(M * N, 2.f);
+    fill_data<float>(A.size(), A.data(), 1., true);
+    fill_data<float>(B.size(), B.data(), 1., true);
+    sgemm('N', 'N', M, N, K, 1.f, A.data(), M, B.data(), K, 0.f, C.data(), M);
+    for (int i = 0; i < M; ++i)
+    for (int j = 0; j < N; ++j) {
+        float ref = 0;
+        for (int k = 0; k < K; ++k)
+            ref += A[k * M + i] * B[j * K + k];
+        EXPECT_NEAR(C[j * M + i], ref, 1e-4 * K);
+    }
+}
+
+TEST_P(gemm_test, TestGEMM) {}
+
+const algorithm no_eltwise = algorithm::algorithm_undef;
+
+INSTANTIATE_TEST_CASE_P(TestGEMMPlain, gemm_test, ::testing::Values(
+    test_gemm_params{ 'C', 'N', 'N', 30, 20, 10, 1.0f, 0.0f, 'N', no_eltwise, 0.f },
+    test_gemm_params{ 'C', 'T', 'N', 30, 20, 10, 2.0f, 1.0f, 'N', no_eltwise, 0.f },
+    test_gemm_params{ 'C', 'N', 'T', 31, 47, 65, 1.0f, 0.5f, 'N', no_eltwise, 0.f },
+    test_gemm_params{ 'C', 'T', 'T', 100, 30, 400, 1.0f, 2.0f, 'N', no_eltwise,
+        0.f },
+    test_gemm_params{ 'R', 'N', 'N', 30, 20, 10, 1.0f, 0.0f, 'N', no_eltwise, 0.f },
+    test_gemm_params{ 'R', 'T', 'N', 47, 31, 65, 1.0f, 1.0f, 'N', no_eltwise, 0.f },
+    test_gemm_params{ 'C', 'N', 'N', 1, 1, 1, 0.0f, 1.0f, 'N', no_eltwise, 0.f }
+));
+
+INSTANTIATE_TEST_CASE_P(TestGEMMBias, gemm_test, ::testing::Values(
+    test_gemm_params{ 'C', 'N', 'N', 30, 20, 10, 1.0f, 0.0f, 'R', no_eltwise, 0.f },
+    test_gemm_params{ 'C', 'N', 'N', 30, 20, 10, 1.0f, 0.0f, 'C', no_eltwise, 0.f },
+    test_gemm_params{ 'C', 'T', 'N', 100, 70, 300, 1.0f, 1.0f, 'C', no_eltwise,
+        0.f },
+    test_gemm_params{ 'C', 'N', 'T', 71, 33, 50, 0.5f, 2.0f, 'R', no_eltwise, 0.f },
+    test_gemm_params{ 'R', 'N', 'N', 30, 20, 10, 1.0f, 0.0f, 'R', no_eltwise, 0.f },
+    test_gemm_params{ 'R', 'N', 'T', 65, 47, 31, 1.0f, 1.0f, 'C', no_eltwise, 0.f },
+    test_gemm_params{ 'C', 'N', 'N', 17, 9, 0, 1.0f, 0.0f, 'C', no_eltwise, 0.f }
+));
+
+INSTANTIATE_TEST_CASE_P(TestGEMMEltwise, gemm_test, ::testing::Values(
+    test_gemm_params{ 'C', 'N', 'N', 30, 20, 10, 1.0f, 0.0f, 'N',
+        eltwise_relu, 0.f },
+    test_gemm_params{ 'C', 'N', 'N', 100, 80, 60, 1.0f, 1.0f, 'C',
+        eltwise_relu, 0.f },
+    test_gemm_params{ 'C', 'T', 'N', 64, 48, 2000, 1.0f, 0.0f, 'R',
+        eltwise_relu, 0.f },
+    test_gemm_params{ 'R', 'N', 'T', 33, 65, 47, 1.0f, 0.0f, 'C',
+        eltwise_relu, 0.f },
+    test_gemm_params{ 'C', 'N', 'N', 30, 20, 10, 1.0f, 0.5f, 'R',
+        eltwise_relu, 0.f },
+    test_gemm_params{ 'C', 'N', 'N', 30, 20, 10, 1.0f, 0.0f, 'R',
+        eltwise_relu, 0.1f },
+    test_gemm_params{ 'C', 'T', 'T', 30, 20, 10, 1.0f, 0.0f, 'C',
+        eltwise_tanh, 0.f },
+    test_gemm_params{ 'R', 'N', 'N', 30, 20, 10, 1.0f, 1.0f, 'R',
+        eltwise_logistic, 0.f }
+));
+
+INSTANTIATE_TEST_CASE_P(TestGEMMExpectFail, gemm_test, ::testing::Values(
+    test_gemm_params{ 'X', 'N', 'N', 30, 20, 10, 1.0f, 0.0f, 'N', no_eltwise, 0.f,
+        true },
+    test_gemm_params{ 'C', 'X', 'N', 30, 20, 10, 1.0f, 0.0f, 'N', no_eltwise, 0.f,
+        true },
+    test_gemm_params{ 'C', 'N', 'N', -1, 20, 10, 1.0f, 0.0f, 'N', no_eltwise, 0.f,
+        true },
+    test_gemm_params{ 'C', 'N', 'N', 30, 20, 10, 1.0f, 0.0f, 'X', no_eltwise, 0.f,
+        true }
+));
+
+}
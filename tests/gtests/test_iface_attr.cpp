@@ -35,6 +35,15 @@ TEST_F(attr_test, TestIntOutputRoundMode) {
     }
 }
 
+TEST_F(attr_test, TestSparseWeights) {
+    mkldnn::primitive_attr attr;
+    EXPECT_FALSE(attr.get_sparse_weights());
+    attr.set_sparse_weights(true);
+    EXPECT_TRUE(attr.get_sparse_weights());
+    attr.set_sparse_weights(false);
+    EXPECT_FALSE(attr.get_sparse_weights());
+}
+
 TEST_F(attr_test, TestIntOutputScales) {
     mkldnn::primitive_attr attr;
 
@@ -95,4 +104,33 @@ TEST_F(attr_test, TestPostOps) {
     EXPECT_FLOAT_EQ(beta, 4.4f);
 }
 
+TEST_F(attr_test, TestPostOpsDepthwise) {
+    mkldnn::primitive_attr attr;
+    mkldnn::post_ops ops;
+
+    const float weights[] = { 1.f, 2.f }, biases[] = { 3.f, 4.f };
+    algorithm alg;
+    const float *w, *b;
+
+    ops.append_sum(1.f);
+    ops.append_depthwise(algorithm::depthwise_scale_shift, weights, biases);
+    ops.append_depthwise(algorithm::depthwise_scale_shift, weights, nullptr);
+    attr.set_post_ops(ops);
+
+    EXPECT_EQ(attr.get_post_ops().len(), 3);
+    EXPECT_EQ(attr.get_post_ops().kind(1), primitive::kind::depthwise);
+    attr.get_post_ops().get_params_depthwise(1, alg, w, b);
+    EXPECT_EQ(alg, algorithm::depthwise_scale_shift);
+    EXPECT_EQ(w, weights);
+    EXPECT_EQ(b, biases);
+    attr.get_post_ops().get_params_depthwise(2, alg, w, b);
+    EXPECT_EQ(w, weights);
+    EXPECT_TRUE(b == nullptr);
+
+    EXPECT_THROW(ops.append_depthwise(algorithm::eltwise_relu, weights,
+                biases), error);
+    EXPECT_THROW(attr.get_post_ops().get_params_depthwise(0, alg, w, b),
+            error);
+}
+
 }
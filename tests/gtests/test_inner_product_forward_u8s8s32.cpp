@@ -0,0 +1,210 @@
+/*******************************************************************************
+* Copyright 2018 Intel Corporation
+*
+* Licensed under the Apache License, Version 2.0 (the "License");
+* you may not use this file except in compliance with the License.
+* You may obtain a copy of the License at
+*
+*     http://www.apache.org/licenses/LICENSE-2.0
+*
+* Unless required by applicable law or agreed to in writing, software
+* distributed under the License is distributed on an "AS IS" BASIS,
+* WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+* See the License for the specific language governing permissions and
+* limitations under the License.
+*******************************************************************************/
+
+#include <cmath>
+
+#include "mkldnn_test_common.hpp"
+#include "gtest/gtest.h"
+
+#include "mkldnn.hpp"
+
+namespace mkldnn {
+
+struct test_inner_product_descr_t {
+    int mb;
+    int ic;
+    int oc;
+    int kh, kw;
+};
+
+template <typename data_t_dst>
+void compute_ref_inner_product_fwd_int8(const test_inner_product_descr_t &ipd,
+        const test_convolution_attr_t &attr, memory &src, memory &weights,
+        memory &bias, memory &dst)
+{
+    const bool w_bias
+        = (bias.get_primitive_desc().desc().data.format
+            != memory::format::format_undef);
+    uint8_t *src_data = (uint8_t *)src.get_data_handle();
+    int8_t *weights_data = (int8_t *)weights.get_data_handle();
+    int32_t *bias_data = w_bias ? (int32_t *)bias.get_data_handle() : nullptr;
+    data_t_dst *dst_data = (data_t_dst *)dst.get_data_handle();
+
+    const memory::desc src_d = src.get_primitive_desc().desc();
+    const memory::desc weights_d = weights.get_primitive_desc().desc();
+    const memory::desc bias_d = bias.get_primitive_desc().desc();
+    const memory::desc dst_d = dst.get_primitive_desc().desc();
+
+    const int KS = ipd.kh * ipd.kw;
+
+#pragma omp parallel for collapse(2) schedule(static)
+    for (int n = 0; n < ipd.mb; n++) {
+        for (int oc = 0; oc < ipd.oc; oc++) {
+            int32_t a = 0;
+            for (int ic = 0; ic < ipd.ic; ic++) {
+                for (int ks = 0; ks < KS; ks++) {
+                    int iidx = (n * ipd.ic + ic) * KS + ks;
+                    int widx = (oc * ipd.ic + ic) * KS + ks;
+                    a += (int32_t)src_data[map_index(src_d, iidx)]
+                        * weights_data[map_index(weights_d, widx)];
+                }
+            }
+
+            float a_fp = (float)a;
+            if (bias_data)
+                a_fp += (float)bias_data[map_index(bias_d, oc)];
+            if (attr.oscale.is_def())
+                a_fp *= attr.oscale.scale;
+
+            if (data_traits<data_t_dst>::data_type != memory::data_type::f32) {
+                using R = mkldnn::round_mode;
+                switch (attr.rmode) {
+                case R::round_down: a_fp = floorf(a_fp); break;
+                case R::round_nearest: a_fp = nearbyintf(a_fp); break;
+                }
+                const float lo = (float)std::numeric_limits<data_t_dst>::lowest();
+                const float hi = (float)std::numeric_limits<data_t_dst>::max();
+                a_fp = a_fp < lo ? lo : a_fp > hi ? hi : a_fp;
+            }
+
+            dst_data[map_index(dst_d, n * ipd.oc + oc)] = (data_t_dst)a_fp;
+        }
+    }
+}
+
+struct inprod_int8_test_params {
+    memory::format src_format;
+    memory::format weights_format;
+    memory::format bias_format;
+    memory::format dst_format;
+    test_convolution_attr_t attr;
+    test_inner_product_descr_t test_ipd;
+};
+
+template <typename data_t_dst>
+class inner_product_int8_test
+    : public ::testing::TestWithParam<inprod_int8_test_params> {
+protected:
+    virtual void SetUp()
+    {
+        inprod_int8_test_params p = ::testing::TestWithParam<
+            inprod_int8_test_params>::GetParam();
+        test_inner_product_descr_t ipd = p.test_ipd;
+        bool has_spatial = ipd.kh > 1 || ipd.kw > 1;
+        bool with_bias = p.bias_format != memory::format::format_undef;
+
+        auto eng = engine(engine::kind::cpu, 0);
+        using dt = memory::data_type;
+        const dt dst_type = data_traits<data_t_dst>::data_type;
+
+        test_convolution_attr_t attr = p.attr;
+        attr.mkldnn_attr_recreate();
+
+        auto ip_src_desc = has_spatial
+            ? create_md({ ipd.mb, ipd.ic, ipd.kh, ipd.kw }, dt::u8,
+                    p.src_format)
+            : create_md({ ipd.mb, ipd.ic }, dt::u8, p.src_format);
+        auto ip_weights_desc = has_spatial
+            ? create_md({ ipd.oc, ipd.ic, ipd.kh, ipd.kw }, dt::s8,
+                    p.weights_format)
+            : create_md({ ipd.oc, ipd.ic }, dt::s8, p.weights_format);
+        auto ip_bias_desc = with_bias
+            ? create_md({ ipd.oc }, dt::s32, p.bias_format)
+            : create_md({}, dt::s32, p.bias_format);
+        auto ip_dst_desc = create_md({ ipd.mb, ipd.oc }, dst_type,
+                p.dst_format);
+
+        auto ip_desc = with_bias
+            ? inner_product_forward::desc(prop_kind::forward_inference,
+                    ip_src_desc, ip_weights_desc, ip_bias_desc, ip_dst_desc)
+            : inner_product_forward::desc(prop_kind::forward_inference,
+                    ip_src_desc, ip_weights_desc, ip_dst_desc);
+        auto ip_primitive_desc = inner_product_forward::primitive_desc(
+                ip_desc, attr.mkl_attr, eng);
+
+        auto ip_src = memory(ip_primitive_desc.src_primitive_desc());
+        auto ip_weights = memory(ip_primitive_desc.weights_primitive_desc());
+        auto ip_bias = with_bias
+            ? memory(ip_primitive_desc.bias_primitive_desc())
+            : memory(memory::primitive_desc(ip_bias_desc, eng));
+        auto ip_dst = memory(ip_primitive_desc.dst_primitive_desc());
+        auto dst_ref = memory(ip_primitive_desc.dst_primitive_desc());
+
+        fill_data<uint8_t>(ip_src.get_primitive_desc().get_size(),
+                (uint8_t *)ip_src.get_data_handle());
+        fill_data<int8_t>(ip_weights.get_primitive_desc().get_size(),
+                (int8_t *)ip_weights.get_data_handle());
+        if (with_bias)
+            fill_data<int32_t>(ip_bias.get_primitive_desc().get_size()
+                    / sizeof(int32_t), (int32_t *)ip_bias.get_data_handle());
+
+        auto ip = with_bias
+            ? inner_product_forward(ip_primitive_desc, ip_src, ip_weights,
+                    ip_bias, ip_dst)
+            : inner_product_forward(ip_primitive_desc, ip_src, ip_weights,
+                    ip_dst);
+
+        std::vector<primitive> pipeline;
+        pipeline.push_back(ip);
+        stream(stream::kind::lazy).submit(pipeline).wait();
+
+        compute_ref_inner_product_fwd_int8<data_t_dst>(ipd, attr, ip_src,
+                ip_weights, ip_bias, dst_ref);
+
+        const data_t_dst *ref_data = (data_t_dst *)dst_ref.get_data_handle();
+        const data_t_dst *dst_data = (data_t_dst *)ip_dst.get_data_handle();
+        for (int i = 0; i < ipd.mb * ipd.oc; ++i)
+            ASSERT_EQ(ref_data[i], dst_data[i]) << "Index: " << i;
+    }
+};
+
+using inner_product_test_u8s8s32 = inner_product_int8_test<int32_t>;
+using inner_product_test_u8s8u8 = inner_product_int8_test<uint8_t>;
+using inner_product_test_u8s8s8 = inner_product_int8_test<int8_t>;
+
+using fmt = memory::format;
+using R = mkldnn::round_mode;
+using P = test_convolution_attr_t::scale_t;
+
+#define INT8_IP_CASES \
+    ::testing::Values( \
+        inprod_int8_test_params{ fmt::nc, fmt::oi, fmt::x, fmt::nc, \
+            { R::round_nearest, 1.f, P::COMMON }, { 2, 32, 48, 1, 1 } }, \
+        inprod_int8_test_params{ fmt::nc, fmt::oi, fmt::format_undef, \
+            fmt::nc, { R::round_down, 0.3f, P::COMMON }, \
+            { 3, 1000, 17, 1, 1 } }, \
+        inprod_int8_test_params{ fmt::nc, fmt::io, fmt::x, fmt::nc, \
+            { R::round_nearest, 0.5f, P::COMMON }, { 5, 67, 129, 1, 1 } }, \
+        inprod_int8_test_params{ fmt::nchw, fmt::oihw, fmt::x, fmt::nc, \
+            { R::round_nearest, 0.1f, P::COMMON }, { 2, 32, 48, 6, 6 } }, \
+        inprod_int8_test_params{ fmt::nhwc, fmt::hwio, fmt::x, fmt::nc, \
+            { R::round_down, 0.2f, P::COMMON }, { 7, 19, 64, 3, 3 } }, \
+        inprod_int8_test_params{ fmt::nc, fmt::oi, fmt::x, fmt::nc, \
+            { R::round_nearest, 1.f, P::COMMON }, { 64, 512, 96, 1, 1 } })
+
+TEST_P(inner_product_test_u8s8s32, TestsInnerProduct) {}
+INSTANTIATE_TEST_CASE_P(TestInnerProductForwardU8S8S32,
+        inner_product_test_u8s8s32, INT8_IP_CASES);
+
+TEST_P(inner_product_test_u8s8u8, TestsInnerProduct) {}
+INSTANTIATE_TEST_CASE_P(TestInnerProductForwardU8S8U8,
+        inner_product_test_u8s8u8, INT8_IP_CASES);
+
+TEST_P(inner_product_test_u8s8s8, TestsInnerProduct) {}
+INSTANTIATE_TEST_CASE_P(TestInnerProductForwardU8S8S8,
+        inner_product_test_u8s8s8, INT8_IP_CASES);
+
+}
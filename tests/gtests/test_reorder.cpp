@@ -237,7 +237,11 @@ TEST_P(reorder_simple_test_weights_f32_f32_1, TestsReorder) { }
 INSTANTIATE_TEST_CASE_P(TestReorder, reorder_simple_test_weights_f32_f32_1,
         ::testing::Values(
             cfg_f32{eng::cpu, fmt::goihw, fmt::Goihw16g, {32, 32, 32, 3, 3}},
-            cfg_f32{eng::cpu, fmt::Goihw16g, fmt::goihw, {32, 32, 32, 3, 3}}
+            cfg_f32{eng::cpu, fmt::Goihw16g, fmt::goihw, {32, 32, 32, 3, 3}},
+            cfg_f32{eng::cpu, fmt::goihw, fmt::GOihw2g4o, {32, 4, 4, 3, 3}},
+            cfg_f32{eng::cpu, fmt::GOihw2g4o, fmt::goihw, {32, 4, 4, 3, 3}},
+            cfg_f32{eng::cpu, fmt::goihw, fmt::GOihw4g4o, {32, 8, 4, 3, 3}},
+            cfg_f32{eng::cpu, fmt::GOihw4g4o, fmt::goihw, {32, 8, 4, 3, 3}}
             )
         );
 